@@ -6,6 +6,7 @@
   const $ = (id) => document.getElementById(id);
   const deviceInfo = $("device-info");
   const pcState = $("pc-state");
+  const pcReachability = $("pc-reachability");
   const tempDisplay = $("temperature");
   const hddLastActive = $("hdd-last-active");
   const wifiState = $("wifi-state");
@@ -34,8 +35,14 @@
   const pin4Raw = $("pin4-raw");
   const pin4SinceChange = $("pin4-since-change");
   const pin5Raw = $("pin5-raw");
+  const channelSelect = $("channel-select");
+  const sensorsCard = $("sensors-card");
+  const sensorSummary = $("sensor-summary");
+  const sensorList = $("sensor-list");
 
   let csrfToken = "";
+  let selectedChannel = 0;
+  let channels = [];
   let otaPollTimer = null;
 
   function initConfig() {
@@ -46,6 +53,17 @@
         $("power-pulse-ms").value = cfg.powerPulseMs || 500;
         $("reset-pulse-ms").value = cfg.resetPulseMs || 500;
         $("boot-grace-ms").value = cfg.bootGraceMs || 60000;
+        if (cfg.probe) {
+          $("probe-host").value = cfg.probe.host || "";
+          $("probe-ports").value = cfg.probe.ports || "";
+          $("probe-icmp").checked = cfg.probe.icmp !== false;
+        }
+        if (cfg.heartbeat) {
+          $("heartbeat-port").value = cfg.heartbeat.port || "";
+          $("heartbeat-timeout").value = cfg.heartbeat.timeoutSec || 60;
+          $("hang-recover").checked = !!cfg.heartbeat.recover;
+          $("hang-require-hdd-idle").checked = cfg.heartbeat.requireHddIdle !== false;
+        }
         // Integrations: MQTT
         if (cfg.mqtt) {
           $("mqtt-host").value = cfg.mqtt.host || "";
@@ -75,6 +93,61 @@
     return endpoint + separator + "csrf_token=" + encodeURIComponent(csrfToken);
   }
 
+  // PC channel picker (hidden with a single PC)
+  function renderChannels(list) {
+    channels = list;
+    channelSelect.classList.toggle("hidden", list.length <= 1);
+    if (channelSelect.options.length !== list.length) {
+      channelSelect.innerHTML = "";
+      list.forEach(function (ch) {
+        channelSelect.add(new Option(ch.name, ch.channel));
+      });
+      if (selectedChannel >= list.length) {
+        selectedChannel = 0;
+      }
+    }
+    list.forEach(function (ch, i) {
+      if (channelSelect.options[i].text !== ch.name) {
+        channelSelect.options[i].text = ch.name;
+      }
+    });
+    channelSelect.value = String(selectedChannel);
+  }
+
+  // I2C sensors; the card stays hidden with only the board's own TMP112
+  const SENSOR_UNITS = { temperature: " °C", humidity: " %", voltage: " V", current: " A", power: " W" };
+
+  function formatSensorValue(quantity, value) {
+    if (typeof value !== "number") {
+      return "—";
+    }
+    const digits = quantity === "humidity" || quantity === "power" ? 0 : 1;
+    return value.toFixed(digits) + (SENSOR_UNITS[quantity] || "");
+  }
+
+  function renderSensors(list, powerWatts) {
+    const hasPower = typeof powerWatts === "number";
+    sensorsCard.classList.toggle("hidden", list.length <= 1 && !hasPower);
+    const online = list.filter(function (sensor) { return sensor.online; }).length;
+    sensorSummary.textContent = hasPower ? formatSensorValue("power", powerWatts) : online + " online";
+    sensorList.textContent = list.map(function (sensor) {
+      if (!sensor.online) {
+        return sensor.model + ": offline";
+      }
+      const values = Object.keys(sensor.values).map(function (quantity) {
+        return formatSensorValue(quantity, sensor.values[quantity]);
+      });
+      return sensor.model + ": " + values.join(", ");
+    }).join(" · ") || "—";
+  }
+
+  channelSelect.addEventListener("change", function () {
+    selectedChannel = parseInt(channelSelect.value, 10) || 0;
+    if (channels[selectedChannel]) {
+      pcState.textContent = channels[selectedChannel].pcState;
+    }
+  });
+
   // Status display - simple direct updates
   function updateStatus(data) {
     if (data.hostname) {
@@ -86,12 +159,30 @@
     if (data.csrfToken) {
       csrfToken = data.csrfToken;
     }
-    if (data.pcState) {
+    if (Array.isArray(data.channels)) {
+      renderChannels(data.channels);
+    }
+    if (selectedChannel > 0 && channels[selectedChannel]) {
+      pcState.textContent = channels[selectedChannel].pcState;
+    } else if (data.pcState) {
       pcState.textContent = data.pcState;
     }
+    if (data.reachability && pcReachability) {
+      // Reachability is probed for channel 0 only
+      let sub = data.reachability === "UNKNOWN" || selectedChannel > 0 ? "—" : data.reachability;
+      // Hang watch (channel 0): show it once it does more than watch
+      const hang = data.hangState;
+      if (selectedChannel === 0 && hang && hang !== "OFF" && hang !== "IDLE" && hang !== "WATCHING") {
+        sub = (sub === "—" ? "" : sub + " · ") + "hang: " + hang;
+      }
+      pcReachability.textContent = sub;
+    }
     if (typeof data.temperature === "number") {
       tempDisplay.textContent = data.temperature.toFixed(1) + " °C";
     }
+    if (Array.isArray(data.sensors)) {
+      renderSensors(data.sensors, data.pcPowerWatts);
+    }
     if (typeof data.hddLastActiveSec === "number") {
       if (data.hddLastActiveSec < 0) {
         hddLastActive.textContent = "Never";
@@ -270,23 +361,168 @@
   let ws = null;
   let retryDelay = 500;
 
+  // Binary frames: MessagePack with integer map keys indexing the key
+  // table the device sends first on the connection (see WsCodec.h)
+  const WS_SUBPROTOCOL = "restarter.msgpack";
+  const utf8 = new TextDecoder();
+  let wsKeys = [];
+
+  function decodeMsgPack(buffer) {
+    const view = new DataView(buffer);
+    const bytes = new Uint8Array(buffer);
+    let pos = 0;
+
+    function take(n) {
+      const at = pos;
+      pos += n;
+      return at;
+    }
+    function str(n) {
+      const at = take(n);
+      return utf8.decode(bytes.subarray(at, at + n));
+    }
+    function array(n) {
+      const out = [];
+      for (let i = 0; i < n; i++) out.push(value());
+      return out;
+    }
+    function map(n) {
+      const out = {};
+      for (let i = 0; i < n; i++) {
+        const key = value();
+        out[typeof key === "number" ? wsKeys[key] : key] = value();
+      }
+      return out;
+    }
+    function value() {
+      const b = bytes[pos++];
+      if (b < 0x80) return b;
+      if (b < 0x90) return map(b & 0x0f);
+      if (b < 0xa0) return array(b & 0x0f);
+      if (b < 0xc0) return str(b & 0x1f);
+      if (b >= 0xe0) return b - 0x100;
+      switch (b) {
+        case 0xc0: return null;
+        case 0xc2: return false;
+        case 0xc3: return true;
+        // float32 printed with the precision the JSON path uses
+        case 0xca: return parseFloat(view.getFloat32(take(4)).toPrecision(7));
+        case 0xcb: return view.getFloat64(take(8));
+        case 0xcc: return view.getUint8(take(1));
+        case 0xcd: return view.getUint16(take(2));
+        case 0xce: return view.getUint32(take(4));
+        case 0xcf: { const at = take(8); return view.getUint32(at) * 4294967296 + view.getUint32(at + 4); }
+        case 0xd0: return view.getInt8(take(1));
+        case 0xd1: return view.getInt16(take(2));
+        case 0xd2: return view.getInt32(take(4));
+        case 0xd3: { const at = take(8); return view.getInt32(at) * 4294967296 + view.getUint32(at + 4); }
+        case 0xd9: return str(view.getUint8(take(1)));
+        case 0xda: return str(view.getUint16(take(2)));
+        case 0xdb: return str(view.getUint32(take(4)));
+        case 0xdc: return array(view.getUint16(take(2)));
+        case 0xdd: return array(view.getUint32(take(4)));
+        case 0xde: return map(view.getUint16(take(2)));
+        case 0xdf: return map(view.getUint32(take(4)));
+        default: throw new Error("Unsupported MessagePack type 0x" + b.toString(16));
+      }
+    }
+    return value();
+  }
+
+  // Status arrives per topic (device, pc, hdd, ...) as a snapshot, then
+  // as deltas of the changed keys, each topic with its own sequence
+  let statusTopics = {};
+  let resyncPending = {};
+
+  function renderStatusTopics() {
+    const merged = {};
+    Object.keys(statusTopics).forEach(function (topic) {
+      Object.assign(merged, statusTopics[topic].state);
+    });
+    updateStatus(merged);
+  }
+
+  function applyStatusSnapshot(msg) {
+    statusTopics[msg.topic] = { state: msg, seq: msg.seq };
+    resyncPending[msg.topic] = false;
+    renderStatusTopics();
+  }
+
+  function applyStatusDelta(msg) {
+    const topic = statusTopics[msg.topic];
+    if (!topic || msg.seq !== topic.seq + 1) {
+      // Missed a delta (or none received yet) - ask for a snapshot once
+      delete statusTopics[msg.topic];
+      if (!resyncPending[msg.topic]) {
+        resyncPending[msg.topic] = true;
+        ws.send(JSON.stringify({ type: "resync", topic: msg.topic }));
+      }
+      return;
+    }
+    Object.assign(topic.state, msg.set || {});
+    (msg.unset || []).forEach(function (key) {
+      delete topic.state[key];
+    });
+    topic.seq = msg.seq;
+    renderStatusTopics();
+  }
+
+  // Actions go over the WebSocket once it is authenticated (by the
+  // browser's credentials on the handshake); otherwise as a POST
+  const WS_COMMANDS = {
+    "/api/action/power": "power",
+    "/api/action/reset": "reset",
+    "/api/action/force-power": "forcePower",
+  };
+  let wsAuthenticated = false;
+  let nextRequestId = 1;
+  let pendingRequests = {};
+
+  function sendWsRequest(request, onAck) {
+    request.id = nextRequestId++;
+    pendingRequests[request.id] = onAck;
+    ws.send(JSON.stringify(request));
+  }
+
+  function handleAck(msg) {
+    const onAck = pendingRequests[msg.id];
+    if (onAck) {
+      delete pendingRequests[msg.id];
+      onAck(msg);
+    }
+  }
+
   function connectWs() {
     const proto = location.protocol === "https:" ? "wss:" : "ws:";
-    ws = new WebSocket(proto + "//" + location.host + "/ws");
+    ws = new WebSocket(proto + "//" + location.host + "/ws", WS_SUBPROTOCOL);
+    ws.binaryType = "arraybuffer";
 
     ws.onopen = function () {
       retryDelay = 500;
+      statusTopics = {};
+      resyncPending = {};
+      wsAuthenticated = false;
+      pendingRequests = {};
+      sendWsRequest({ type: "auth" }, function (ack) {
+        wsAuthenticated = ack.ok;
+      });
     };
 
     ws.onmessage = function (e) {
       try {
-        const msg = JSON.parse(e.data);
-        if (msg.type === "log") {
+        const msg = typeof e.data === "string" ? JSON.parse(e.data) : decodeMsgPack(e.data);
+        if (msg.type === "keys") {
+          wsKeys = msg.keys;
+        } else if (msg.type === "log") {
           addLog("[WS] " + JSON.stringify(msg));
           addLog(msg.message || "Action");
-        } else {
+        } else if (msg.type === "delta") {
+          applyStatusDelta(msg);
+        } else if (msg.type === "ack") {
+          handleAck(msg);
+        } else if (msg.type === "status") {
           addLog("[WS] " + JSON.stringify(msg));
-          updateStatus(msg);
+          applyStatusSnapshot(msg);
         }
       } catch (err) {
         // Ignore parse errors
@@ -294,17 +530,29 @@
     };
 
     ws.onclose = function () {
+      wsAuthenticated = false;
       setTimeout(connectWs, retryDelay + Math.random() * 200);
       retryDelay = Math.min(retryDelay * 2, 8000);
     };
   }
 
-  // API actions
+  // API actions (on the selected PC channel)
   function postAction(endpoint) {
+    if (wsAuthenticated && ws.readyState === WebSocket.OPEN) {
+      sendWsRequest({ type: "command", command: WS_COMMANDS[endpoint], channel: selectedChannel }, function (ack) {
+        if (!ack.ok) {
+          addLog("Action failed: " + ack.error);
+        }
+      });
+      return;
+    }
     if (!csrfToken) {
       addLog("Action blocked: missing CSRF token");
       return;
     }
+    if (selectedChannel > 0) {
+      endpoint += "?channel=" + selectedChannel;
+    }
     fetch(withCsrfToken(endpoint), {
       method: "POST",
       credentials: "include",
@@ -383,6 +631,17 @@
           powerPulseMs: parseInt($("power-pulse-ms").value, 10) || 500,
           resetPulseMs: parseInt($("reset-pulse-ms").value, 10) || 500,
           bootGraceMs: parseInt($("boot-grace-ms").value, 10) || 60000,
+          probe: {
+            host: ($("probe-host").value || "").trim(),
+            ports: ($("probe-ports").value || "").replace(/\s/g, ""),
+            icmp: $("probe-icmp").checked,
+          },
+          heartbeat: {
+            port: parseInt($("heartbeat-port").value, 10) || 0,
+            timeoutSec: parseInt($("heartbeat-timeout").value, 10) || 60,
+            recover: $("hang-recover").checked,
+            requireHddIdle: $("hang-require-hdd-idle").checked,
+          },
         };
         return fetch("/api/config", {
           method: "POST",
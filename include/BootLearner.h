@@ -0,0 +1,144 @@
+/**
+ * =============================================================================
+ * BootLearner.h - Learned Per-Machine Boot Duration
+ * =============================================================================
+ *
+ * A fixed bootGraceMs is too long for a fast NVMe box and too short for a
+ * server still in POST. After the power LED comes on, this class watches
+ * the HDD activity ratio and declares RUNNING once the boot's disk work
+ * has settled:
+ *
+ *   HDD  ___|‾|_|‾‾‾|__|‾‾‾‾‾‾|_|‾|________________________________
+ *       ^ power on           last busy ^        ^ settled = RUNNING
+ *                                      |<---->|  BOOT_QUIET_MS
+ *
+ *   busy      1 s activity ratio >= BOOT_BUSY_PERMILLE
+ *   settled   busy seen, then BOOT_QUIET_MS without busy, and at least
+ *             half the learned settle time (BOOT_MIN_MS until learned)
+ *   ceiling   RUNNING anyway after bootGraceMs until a profile is learned,
+ *             then after twice the learned settle time (at least
+ *             BOOT_CEILING_MARGIN_MS more, at most BOOT_MAX_MS)
+ *
+ * Each settled boot updates a rolling estimate (BootProfile, EWMA with
+ * BOOT_LEARN_WEIGHT_PCT); a boot that hits the ceiling keeps being
+ * watched up to BOOT_MAX_MS so a slow machine still teaches its time.
+ * Without an HDD LED nothing is learned and the old fixed timer applies.
+ *
+ * The profile is loaded from NVS at startup and saved by the telemetry
+ * task whenever `revision` changes (see main.cpp). Like
+ * PowerLedClassifier, the class sees only times and ratios, so traces can
+ * be replayed through it off the device.
+ *
+ * THREADING:
+ *   update() runs in the control task; status() can be read from any task.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Histogram.h"
+#include "SeqLock.h"
+
+/**
+ * Learned boot timing, relative to the power LED turning on.
+ */
+struct BootProfile {
+  uint32_t firstActivityMs;  // First HDD activity
+  uint32_t settleMs;         // Activity settled (RUNNING declared)
+  uint16_t samples;          // Boots learned (saturates; 0 = nothing learned)
+};
+
+enum class BootDecision : uint8_t {
+  SETTLED = 0,  // HDD activity settled
+  TIMEOUT,      // Ceiling reached first
+};
+
+static constexpr size_t BOOT_DECISION_COUNT = 2;
+
+/**
+ * Metric label for a decision ("settled", "timeout").
+ */
+const char *bootDecisionName(BootDecision decision);
+
+struct BootLearnerStatus {
+  BootProfile profile;
+  uint32_t revision;             // Bumped on every learned boot
+  bool booting;
+  uint32_t lastDetectMs;         // Power on -> RUNNING, last boot (0 = none yet)
+  int32_t lastDetectVsFixedMs;   // lastDetectMs - bootGraceMs (< 0 = earlier)
+  uint32_t decisions[BOOT_DECISION_COUNT];
+};
+
+class BootLearner {
+public:
+  BootLearner();
+
+  /**
+   * Install a profile loaded from NVS. Call before the tasks start.
+   */
+  void setProfile(const BootProfile &profile);
+
+  /**
+   * Power LED came on (or a reset press was released): BOOTING until
+   * settled or the ceiling.
+   *
+   * @param learn  false if the boot didn't start at power-on (device
+   *               restart with the PC on, reset press): decide, but don't
+   *               learn from it
+   */
+  void start(uint64_t nowMs, bool learn);
+
+  /**
+   * Power LED went off or to sleep: forget the boot in progress.
+   */
+  void stop();
+
+  /**
+   * Advance with the last 1 s HDD activity ratio.
+   *
+   * @param fixedGraceMs  The configured bootGraceMs
+   * @return true while BOOTING
+   */
+  bool update(uint64_t nowMs, uint16_t activityPermille, uint32_t fixedGraceMs);
+
+  bool booting() const { return phase == Phase::BOOTING; }
+
+  /**
+   * Since the last start(): HDD activity seen / activity settled.
+   */
+  bool activitySeen() const { return sawActivity; }
+  bool settled() const { return settledSeen; }
+
+  BootLearnerStatus status() const { return published.read(); }
+
+  /**
+   * Power on -> RUNNING, every decided boot (µs).
+   */
+  const LatencyHistogram &detectTime() const { return detectHistogram; }
+
+private:
+  enum class Phase : uint8_t {
+    IDLE,
+    BOOTING,
+    OBSERVING,  // RUNNING by timeout, still waiting for activity to settle
+  };
+
+  uint32_t ceilingMs(uint32_t fixedGraceMs) const;
+  uint32_t minSettleMs() const;
+  void declareRunning(uint32_t elapsedMs, BootDecision decision, uint32_t fixedGraceMs);
+  void learn(uint32_t settleMs);
+
+  Phase phase = Phase::IDLE;
+  bool learning = false;
+  uint64_t startMs = 0;
+  bool sawActivity = false;
+  bool sawBusy = false;
+  bool settledSeen = false;
+  uint32_t firstActivityMs = 0;
+  uint32_t lastBusyMs = 0;
+  BootProfile profile = {};
+  LatencyHistogram detectHistogram;
+  SeqLock<BootLearnerStatus> published;
+};
@@ -0,0 +1,118 @@
+/**
+ * =============================================================================
+ * BootTimeline.h - Boot Latency After a Remote Power/Reset Press
+ * =============================================================================
+ *
+ * Timestamps each phase of a boot started by pulsePower() (PC off) or
+ * pulseReset() (PC on), relative to the relay press:
+ *
+ *   press ──► power LED on ──► first HDD activity ──► HDD settled
+ *                                         └──► network reachable
+ *
+ *   POWER_LED       power LED turned on (power presses only)
+ *   FIRST_ACTIVITY  first 1 s window with HDD activity
+ *   SETTLED         HDD activity settled (BootLearner.h)
+ *   REACHABLE       first answered probe (only if probing is configured)
+ *
+ * A boot is COMPLETE once it settled and, with probing, answered. It ends
+ * INCOMPLETE after BOOT_MAX_MS and ABORTED if the PC goes off again (or
+ * another press starts a new boot). Every reached phase goes into a
+ * histogram per trigger; the last BOOT_HISTORY boots are kept in a ring
+ * for GET /api/boots.
+ *
+ * THREADING:
+ *   Started and advanced by the control task; REACHABLE is marked by the
+ *   network task. State is guarded by a short critical section.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Histogram.h"
+
+enum class BootTrigger : uint8_t {
+  POWER = 0,
+  RESET,
+};
+
+enum class BootPhase : uint8_t {
+  POWER_LED = 0,
+  FIRST_ACTIVITY,
+  SETTLED,
+  REACHABLE,
+};
+
+enum class BootOutcome : uint8_t {
+  IN_PROGRESS = 0,
+  COMPLETE,
+  INCOMPLETE,  // BOOT_MAX_MS passed first
+  ABORTED,     // PC went off, or a new press
+};
+
+static constexpr size_t BOOT_TRIGGER_COUNT = 2;
+static constexpr size_t BOOT_PHASE_COUNT = 4;
+static constexpr size_t BOOT_OUTCOME_COUNT = 4;
+static constexpr uint32_t BOOT_PHASE_MISSING = UINT32_MAX;
+
+struct BootRecord {
+  uint32_t pressUptimeSec;              // Device uptime at the press
+  BootTrigger trigger;
+  BootOutcome outcome;
+  uint32_t phaseMs[BOOT_PHASE_COUNT];   // Since the press; BOOT_PHASE_MISSING = not reached
+};
+
+/**
+ * Names for JSON and metric labels ("power", "reset"; "power_led",
+ * "first_activity", "settled", "reachable"; "in_progress", "complete",
+ * "incomplete", "aborted").
+ */
+const char *BootTimeline_triggerName(BootTrigger trigger);
+const char *BootTimeline_phaseName(BootPhase phase);
+const char *BootTimeline_outcomeName(BootOutcome outcome);
+
+/**
+ * Wait for REACHABLE before a boot is COMPLETE. Set by Reachability_setup().
+ */
+void BootTimeline_setExpectReachable(bool expect);
+
+/**
+ * A relay press starts a boot (an unfinished one is ABORTED).
+ */
+void BootTimeline_start(BootTrigger trigger, uint64_t nowMs);
+
+/**
+ * Mark a phase of the boot in progress; later marks of the same phase
+ * are ignored. Safe from any task.
+ */
+void BootTimeline_mark(BootPhase phase, uint64_t nowMs);
+
+/**
+ * Time out or abort the boot in progress. Call from the control task.
+ *
+ * @param powerOn  Power LED on (or sleeping)
+ */
+void BootTimeline_update(uint64_t nowMs, bool powerOn);
+
+/**
+ * Boot in progress, if any.
+ */
+bool BootTimeline_current(BootRecord &out);
+
+/**
+ * Copy up to `max` finished boots, newest first.
+ *
+ * @return Number copied
+ */
+size_t BootTimeline_history(BootRecord *out, size_t max);
+
+/**
+ * Finished boots per trigger and outcome.
+ */
+uint32_t BootTimeline_count(BootTrigger trigger, BootOutcome outcome);
+
+/**
+ * Press -> phase durations (µs).
+ */
+const LatencyHistogram &BootTimeline_phaseTime(BootTrigger trigger, BootPhase phase);
@@ -0,0 +1,114 @@
+/**
+ * =============================================================================
+ * CommandQueue.h - PC Action Queue (REST / MQTT / WebSocket → Control Task)
+ * =============================================================================
+ *
+ * All PC actions go through one bounded multi-producer queue that only the
+ * control task drains, so PCController is touched by a single task:
+ *
+ *   AsyncTCP task (REST, WS) ──┐
+ *   network task (MQTT)     ───┼──► queue ──► control task ──► relays
+ *   hang recovery (control) ───┘                  │
+ *                                                 └──► completion (ack)
+ *
+ * Every command carries its source, target PC channel (PcChannels.h), a
+ * sequence ID and the enqueue time.
+ * Submitting releases the control task immediately, so a command does not
+ * wait for the (possibly stretched) control period. The time from submit
+ * to relay actuation is recorded per source.
+ *
+ * ACKNOWLEDGEMENT:
+ *   CommandQueue_wait() blocks the caller until the control task executed
+ *   the command (or the timeout passes). Results are kept in a small ring
+ *   indexed by sequence ID, so fire-and-forget callers (MQTT) need not
+ *   collect them.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Histogram.h"
+
+enum class PcCommand : uint8_t {
+  POWER_PULSE = 0,
+  RESET_PULSE,
+  FORCE_POWER
+};
+
+enum class CommandSource : uint8_t {
+  REST = 0,
+  MQTT,
+  WEBSOCKET,
+  WATCHDOG,     // Hang recovery (HangRecovery.h)
+  COUNT
+};
+
+constexpr size_t COMMAND_SOURCE_COUNT = static_cast<size_t>(CommandSource::COUNT);
+
+enum class CommandStatus : uint8_t {
+  PENDING = 0,  // Queued, not executed yet
+  DONE,         // Relay actuated
+  REJECTED,     // Power relay held by a force shutdown, or no such channel
+  DROPPED,      // Queue full, never queued
+  UNKNOWN       // Result no longer in the ring
+};
+
+/**
+ * Outcome of one command (see CommandQueue_wait()).
+ */
+struct CommandResult {
+  uint32_t seq;
+  PcCommand command;
+  CommandSource source;
+  uint8_t channel;     // PC channel (0 = the board's own header)
+  CommandStatus status;
+  uint32_t latencyUs;  // Submit to actuation
+};
+
+/**
+ * Create the queue. Call once in setup(), before the web server and MQTT
+ * can submit commands.
+ */
+void CommandQueue_setup();
+
+/**
+ * Scheduler task index of the consumer (control task); submit wakes it.
+ */
+void CommandQueue_setConsumerTask(int taskIndex);
+
+/**
+ * Queue `command` without blocking. Safe from any task.
+ *
+ * @param channel  PC channel; checked when executed (REJECTED if not in use)
+ * @return sequence ID (never 0), or 0 if the queue was full
+ */
+uint32_t CommandQueue_submit(PcCommand command, CommandSource source, uint8_t channel = 0);
+
+/**
+ * Wait up to `timeoutMs` for command `seq` to complete.
+ *
+ * @param out  Optional copy of the result
+ * @return PENDING on timeout, otherwise the final status
+ */
+CommandStatus CommandQueue_wait(uint32_t seq, uint32_t timeoutMs, CommandResult *out = nullptr);
+
+/**
+ * Execute all queued commands. Call from the control task only.
+ *
+ * @return number of commands executed
+ */
+size_t CommandQueue_drain();
+
+/**
+ * Statistics per source (Prometheus labels / counters).
+ */
+const char *CommandQueue_sourceName(CommandSource source);
+uint32_t CommandQueue_count(CommandSource source, CommandStatus status);
+const LatencyHistogram &CommandQueue_latency(CommandSource source);
+
+/**
+ * Most commands that were waiting at once since boot.
+ */
+uint32_t CommandQueue_maxDepth();
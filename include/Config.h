@@ -24,6 +24,8 @@ constexpr uint8_t PIN_FACTORY_RESET = 9;  // Factory reset button
 constexpr uint8_t PIN_RELAY_POWER = 7;    // Power button relay
 constexpr uint8_t PIN_RELAY_RESET = 6;    // Reset button relay
 constexpr uint8_t PIN_WIFI_ERROR_LED = 10; // Status LED
+constexpr uint8_t PIN_I2C_SDA = 0;        // Sensors, GPIO expander
+constexpr uint8_t PIN_I2C_SCL = 1;
 
 // Input pin mode for LED sense lines.
 // Optocoupler outputs are typically open-collector, so internal pull-up is default.
@@ -41,16 +43,130 @@ constexpr bool RESET_RELAY_ACTIVE_HIGH = true;
 constexpr uint32_t POWER_PULSE_MS = 500;
 constexpr uint32_t RESET_PULSE_MS = 500;
 constexpr uint32_t FORCE_SHUTDOWN_PULSE_MS = 11000;
-constexpr uint32_t POWER_SIGNAL_DEBOUNCE_MS = 250;
+constexpr uint32_t RELAY_PULSE_ERROR_BUDGET_US = 2000;  // Pulse width error counted as overrun
 
-constexpr uint32_t BOOT_GRACE_MS = 60000;
+constexpr uint32_t BOOT_GRACE_MS = 60000;  // BOOTING ceiling until a boot is learned
 constexpr uint32_t FACTORY_RESET_HOLD_MS = 5000;
 
 constexpr uint32_t WIFI_CONNECT_TIMEOUT_MS = 15000;
 constexpr uint32_t AP_IDLE_TIMEOUT_MS = 300000;
 constexpr uint32_t MQTT_RECONNECT_MS = 5000;
+constexpr uint16_t MQTT_BUFFER_SIZE = 1024;  // Largest publish (discovery, status with channels)
 
-constexpr uint32_t STATUS_BROADCAST_MS = 0;
+// Power LED classifier (see PowerLedClassifier.h)
+constexpr uint32_t POWER_LED_GLITCH_MS = 20;             // Shorter pulses are ignored
+constexpr uint32_t POWER_LED_BLINK_MAX_PHASE_MS = 2000;  // Longer on/off phases are steady
+constexpr uint32_t POWER_LED_SLEEP_MIN_PERIOD_MS = 500;  // Faster blinking is UNKNOWN_BLINK
+constexpr uint8_t POWER_LED_PERIOD_TOLERANCE_PCT = 25;   // Period jitter still counted as regular
+
+// Boot learning (see BootLearner.h)
+constexpr uint16_t BOOT_BUSY_PERMILLE = 50;           // 1 s HDD activity counted as boot work
+constexpr uint32_t BOOT_QUIET_MS = 5000;              // No busy second for this long = settled
+constexpr uint32_t BOOT_MIN_MS = 5000;                // Earliest settle until a boot is learned
+constexpr uint32_t BOOT_MAX_MS = 600000;              // Longest boot that is learned
+constexpr uint32_t BOOT_CEILING_MARGIN_MS = 15000;    // Learned ceiling is at least settle + this
+constexpr uint8_t BOOT_LEARN_WEIGHT_PCT = 25;         // Weight of a new boot in the estimate
+constexpr uint32_t BOOT_PROFILE_SAVE_MS = 10000;      // Telemetry task checks for a new profile
+constexpr size_t BOOT_HISTORY = 16;                   // Boots kept for /api/boots (BootTimeline.h)
+
+// PC reachability probing (see Reachability.h)
+constexpr uint32_t PROBE_TIMEOUT_MS = 1000;           // Round without an answer = unanswered
+constexpr uint32_t PROBE_BOOT_INTERVAL_MS = 2000;     // While BOOTING (first answer counts)
+constexpr uint32_t PROBE_STEADY_INTERVAL_MS = 5000;   // RUNNING and answering
+constexpr uint32_t PROBE_SUSPECT_INTERVAL_MS = 1000;  // After a miss, until confirmed
+constexpr uint32_t PROBE_BACKOFF_MAX_MS = 60000;      // UNRESPONSIVE back-off limit
+constexpr uint32_t PROBE_IDLE_CHECK_MS = 1000;        // PC off/asleep: recheck state
+constexpr uint8_t PROBE_FAIL_THRESHOLD = 3;           // Unanswered rounds before UNRESPONSIVE
+constexpr uint8_t PROBE_MAX_PORTS = 4;
+
+// Heartbeats from an agent on the PC and hang recovery (see Heartbeat.h, HangRecovery.h)
+constexpr uint32_t HEARTBEAT_DEFAULT_TIMEOUT_S = 60;     // Silence while RUNNING = hung
+constexpr uint32_t HANG_CHECK_INTERVAL_MS = 1000;
+constexpr uint32_t HANG_RECOVERY_WAIT_MS = 180000;       // Reset/power-on until heartbeats must be back
+constexpr uint32_t HANG_FORCE_OFF_WAIT_MS = 20000;       // Force power until the LED must be off
+constexpr uint32_t HANG_POWER_OFF_DWELL_MS = 5000;       // Off time before powering on again
+constexpr uint32_t HANG_RECOVERY_COOLDOWN_MS = 600000;   // After a recovery, before watching again
+constexpr uint8_t HANG_RECOVERY_MAX_EPISODES = 3;        // Recoveries per HANG_RECOVERY_WINDOW_MS...
+constexpr uint32_t HANG_RECOVERY_WINDOW_MS = 86400000;   // ...more are only reported
+
+// Extra PCs on an I2C GPIO expander (see PcChannels.h, IoExpander.h)
+// Each PC takes 4 expander pins: power LED, HDD LED, power relay, reset
+// relay; LED/relay polarity as for the board's own header above.
+constexpr uint8_t EXPANDER_PINS = 16;             // 16 = MCP23017, 8 = PCF8574, 0 = no expander
+constexpr uint8_t EXPANDER_ADDRESS = 0x20;        // A2..A0 low
+constexpr int8_t PIN_EXPANDER_INT = 3;            // Expander INT (active low), -1 = poll only
+constexpr uint32_t EXPANDER_POLL_MS = 20;         // Input read without an interrupt (HDD LEDs)
+constexpr uint16_t EXPANDER_LOCK_TIMEOUT_MS = 10; // Expander transfer waiting for the bus
+constexpr size_t PC_CHANNELS_MAX = 1 + EXPANDER_PINS / 4;  // Channel 0 = the board's own header
+
+// GPIO trace capture (see GpioTrace.h)
+constexpr uint32_t GPIO_TRACE_RECORDS = 2048;  // 8 bytes each, allocated on first capture
+
+// HDD activity analytics (see HddActivity.h)
+constexpr uint32_t HDD_BURST_GAP_MS = 100;   // Shorter idle gaps belong to the same burst
+
+// I2C bus (see I2cBus.h)
+constexpr uint32_t I2C_CLOCK_HZ = 400000;           // Fast mode; all supported chips handle it
+constexpr uint16_t I2C_TIMEOUT_MS = 10;
+constexpr uint16_t I2C_LOCK_TIMEOUT_MS = 50;        // Sensor batch waiting for the bus
+constexpr uint8_t I2C_ERROR_LIMIT = 3;              // Failed reads of a device in a row before bus recovery
+
+// Sensors found on the I2C bus (see Sensors.h)
+constexpr size_t SENSORS_MAX = 6;
+constexpr uint32_t SENSOR_TICK_MS = 250;            // Scheduler tick; each driver has its own rate
+constexpr uint32_t SENSOR_OFFLINE_RETRY_MS = 10000;
+constexpr uint32_t TEMP_SAMPLE_INTERVAL_MS = 1000;  // TMP112; also sets its conversion rate
+constexpr float TEMP_EWMA_ALPHA = 0.25f;
+constexpr float TEMP_ALERT_HIGH_C = 70.0f;          // ALERT asserts above this...
+constexpr float TEMP_ALERT_LOW_C = 65.0f;           // ...and clears below this
+constexpr uint32_t HUMIDITY_SAMPLE_INTERVAL_MS = 2000;  // SHT3x (measures at 1 Hz)
+constexpr uint32_t POWER_SAMPLE_INTERVAL_MS = 250;  // INA219/INA226 (averaging over ~100 ms)
+constexpr float POWER_SHUNT_OHMS = 0.01f;           // INA219/INA226 shunt (in the PSU's 12 V feed)
+constexpr float PC_POWER_ON_WATTS = 20.0f;          // PSU draw above this = PC on...
+constexpr float PC_POWER_OFF_WATTS = 10.0f;         // ...below this = off or standby
+
+// Status publishing (see StatusPublisher.h)
+constexpr uint32_t STATUS_COALESCE_MS = 100;     // Min gap between change-driven publishes
+constexpr uint32_t STATUS_HEARTBEAT_MS = 10000;  // Full republish even without changes
+
+// Task scheduling (see TaskScheduler.h)
+// Control must stay above the AsyncTCP task (priority 10) so web requests
+// can never delay relay release or LED sensing.
+constexpr uint32_t CONTROL_TASK_PERIOD_MS = 5;
+constexpr uint32_t CONTROL_TASK_IDLE_PERIOD_MS = 50;  // Nothing pending; GPIO edges still wake it
+constexpr uint32_t CONTROL_TASK_DEADLINE_MS = 5;
+constexpr UBaseType_t CONTROL_TASK_PRIORITY = 12;
+constexpr uint32_t NETWORK_TASK_PERIOD_MS = 10;
+constexpr uint32_t NETWORK_TASK_DEADLINE_MS = 250;
+constexpr UBaseType_t NETWORK_TASK_PRIORITY = 3;
+constexpr uint32_t TELEMETRY_TASK_PERIOD_MS = 100;
+constexpr uint32_t TELEMETRY_TASK_DEADLINE_MS = 2000;
+constexpr UBaseType_t TELEMETRY_TASK_PRIORITY = 2;
+
+// PC actions (see CommandQueue.h)
+constexpr uint32_t COMMAND_ACK_TIMEOUT_MS = 100;  // REST handler waits this long for execution
+
+// WebSocket frames and clients (see WsFramePool.h, WsCodec.h)
+constexpr size_t WS_FRAME_POOL_SIZE = 4;     // Status frames queued at once before the heap is used
+constexpr size_t WS_FRAME_BYTES = 2048;      // Per pooled frame; the status JSON is ~1-1.5 KB
+constexpr size_t WS_LOG_FRAME_BYTES = 256;   // Per log history frame
+constexpr size_t WS_MAX_CLIENTS = 8;         // AsyncWebSocket's DEFAULT_MAX_WS_CLIENTS
+constexpr char WS_MSGPACK_SUBPROTOCOL[] = "restarter.msgpack";  // Binary frames (see WsCodec.h)
+
+// Subsystem stall detection (see HealthMonitor.h)
+// Timeouts for work in the network/telemetry tasks stay below the 30 s task
+// watchdog, so a targeted recovery runs before the whole device resets.
+constexpr uint32_t HEALTH_CHECK_INTERVAL_MS = 1000;
+constexpr uint32_t WIFI_STALL_MS = 60000;       // STA not connected
+constexpr uint32_t MQTT_STALL_MS = 20000;       // No completed loop()/connect while configured
+constexpr uint32_t LOKI_STALL_MS = 15000;       // One push taking this long
+constexpr uint32_t LOKI_BACKOFF_MS = 300000;    // Pause pushes after a stalled push
+constexpr uint32_t OTA_STALL_MS = 45000;        // No download progress
+constexpr uint32_t WS_STALL_MS = 10000;         // A client's send queue stuck full
+
+// Power management (see PowerManager.h)
+constexpr uint32_t PM_MAX_FREQ_MHZ = 160;
+constexpr uint32_t PM_MIN_FREQ_MHZ = 40;   // XTAL; lowest clock that keeps WiFi working
 
 // Storage & identity
 constexpr char CONFIG_PATH[] = "/config.json";
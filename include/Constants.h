@@ -1,5 +1,10 @@
 #pragma once
 #include <Arduino.h>
+#include "Config.h"
+#include "SeqLock.h"
+#include "HangRecovery.h"
+#include "Reachability.h"
+#include "Sensors.h"
 
 // PC state
 enum class PCState : uint8_t {
@@ -7,6 +12,16 @@ enum class PCState : uint8_t {
   BOOTING,
   RUNNING,
   RESTARTING,
+  SLEEP,          // Power LED blinking slowly and regularly (S3)
+  UNKNOWN_BLINK,  // Power LED blinking, pattern not recognised
+};
+
+// Timing and name of one PC channel (see PcChannels.h)
+struct ChannelConfig {
+  String name;                    // Empty = "PC <n>"
+  uint32_t powerPulseMs = 500;
+  uint32_t resetPulseMs = 500;
+  uint32_t bootGraceMs = 60000;
 };
 
 // Settings stored in NVS/flash
@@ -30,10 +45,19 @@ struct StoredConfig {
   // Prometheus Integration
   bool prometheusEnabled = true;
   
-  // Timing
-  uint32_t powerPulseMs = 500;
-  uint32_t resetPulseMs = 500;
-  uint32_t bootGraceMs = 60000;
+  // Timing, per PC channel (0 = the board's own header)
+  ChannelConfig channels[Config::PC_CHANNELS_MAX];
+
+  // Reachability probe (see Reachability.h)
+  String probeHost;               // PC IPv4 address, empty = off
+  String probePorts;              // e.g. "22,3389"
+  bool probeIcmp = true;
+
+  // Heartbeats and hang recovery (see Heartbeat.h, HangRecovery.h)
+  uint16_t heartbeatPort = 0;     // UDP port, 0 = off
+  uint32_t heartbeatTimeoutS = Config::HEARTBEAT_DEFAULT_TIMEOUT_S;
+  bool hangRecovery = false;      // Press reset/power on a hang (false = only report it)
+  bool hangRequireHddIdle = true; // A hang also needs the HDD LED idle for the timeout
   
   // Security
   String adminPassword;
@@ -50,7 +74,6 @@ struct RuntimeState {
   PCState pcState = PCState::OFF;
   bool powerRelayActive = false;
   bool resetRelayActive = false;
-  float temperature = 0.0f;
   uint8_t pwrLedRaw = 0;          // Raw GPIO level for PIN_PWR_LED (0/1)
   uint8_t hddLedRaw = 0;          // Raw GPIO level for PIN_HDD_LED (0/1)
   uint32_t lastHddActiveMs = 0;
@@ -59,9 +82,55 @@ struct RuntimeState {
   uint32_t totalHeap = 0;
   uint8_t cpuLoad = 0;
   uint8_t authFailCount = 0;      // Rate limiting: failed auth attempts
-  uint32_t authBlockedUntilMs = 0; // Rate limiting: blocked until this time
+  uint64_t authBlockedUntilMs = 0; // Rate limiting: blocked until (TimerService_nowMs)
+};
+
+// State of one PC channel, as published by the control task
+struct PcChannelStatus {
+  PCState pcState = PCState::OFF;
+  bool powerRelayActive = false;
+  bool resetRelayActive = false;
+  uint16_t hddActivityPermille = 0;  // HDD LED lit, last 1 s window
+};
+
+// Consistent copy of the changing part of RuntimeState for readers in other
+// tasks (web handlers, metrics, status publishing). Each task publishes the
+// fields it owns; hostname/deviceId/apPassword are fixed after setup and
+// are still read from g_state.
+struct StatusSnapshot {
+  // network task
+  bool apMode = false;
+  bool wifiConnected = false;
+  char ssid[33] = {};             // AP SSID, connected SSID or configured SSID
+  uint32_t ip = 0;                // IPv4 in network byte order (0 = none)
+  PcReachability reachability = PcReachability::UNKNOWN;  // Probe result (Reachability.h)
+  // control task
+  PCState pcState = PCState::OFF;
+  bool powerRelayActive = false;
+  bool resetRelayActive = false;
+  uint8_t pwrLedRaw = 0;
+  uint8_t hddLedRaw = 0;
+  uint32_t lastHddActiveMs = 0;
+  uint32_t lastHddChangeMs = 0;
+  uint16_t hddActivityPermille = 0;    // HDD LED lit, last 1 s window
+  uint16_t hddActivity60sPermille = 0; // Mean over 60 s
+  uint16_t hddEdgeRate = 0;            // HDD LED edges per second
+  uint8_t channelCount = 1;            // PC channels in use (PcChannels.h)
+  PcChannelStatus channels[Config::PC_CHANNELS_MAX];  // [0] mirrors the fields above
+  HangState hangState = HangState::OFF;   // Heartbeat watch of channel 0 (HangRecovery.h)
+  // telemetry task
+  float temperature = 0.0f;       // First temperature sensor; NAN while it is offline
+  uint8_t sensorCount = 0;        // I2C sensors found (Sensors.h)
+  SensorStatus sensors[Config::SENSORS_MAX];
+  float pcPowerWatts = NAN;       // PSU power monitor, NAN without one
+  int8_t pcPowerDraw = -1;        // From pcPowerWatts: 1 = on, 0 = off/standby, -1 = unknown
+  int8_t rssi = 0;
+  uint32_t freeHeap = 0;
+  uint32_t totalHeap = 0;
+  uint8_t cpuLoad = 0;
 };
 
 // Global instances (defined in main.cpp)
 extern StoredConfig g_config;
 extern RuntimeState g_state;
+extern SeqLock<StatusSnapshot> g_statusSnapshot;
@@ -17,7 +17,7 @@ void FactoryReset_setup();
 
 /**
  * Check factory reset button state.
- * Call every loop iteration. Handles LED blinking feedback
- * and triggers reset after hold duration.
+ * Call every control tick. Press/release edges arm and cancel the
+ * LED blink and hold timers on the control timer wheel.
  */
 void FactoryReset_loop();
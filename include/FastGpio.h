@@ -0,0 +1,102 @@
+/**
+ * =============================================================================
+ * FastGpio.h - Compile-Time GPIO Pins (Direct Register Access)
+ * =============================================================================
+ *
+ * digitalWrite()/digitalRead() look the pin up at run time and go through
+ * the GPIO driver; the relay and LED code also branched on polarity flags.
+ * Here pin number and polarity are template arguments, so every call
+ * inlines to one store to GPIO_OUT_W1TS/W1TC or one load of GPIO_IN:
+ *
+ *   PowerRelayPin::setActive(true);     // closes the relay (any polarity)
+ *   if (HddLedPin::active()) { ... }    // HDD LED lit
+ *
+ * All accessors are force-inlined and touch only peripheral registers, so
+ * they are safe in IRAM interrupt handlers and with the cache disabled.
+ *
+ * pinMode() is still used once in begin(); the GPIO matrix setup is not
+ * on any hot path. GET /api/debug/gpio compares the cycle cost of both
+ * paths on the device (see FastGpio_benchmark()).
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <hal/gpio_ll.h>
+#include <soc/gpio_struct.h>
+
+#include "Config.h"
+
+namespace FastGpio {
+
+/**
+ * Output pin. `ActiveHigh` maps "active" (relay closed, LED on) to a level.
+ */
+template <uint8_t Pin, bool ActiveHigh>
+struct Output {
+  static constexpr uint8_t pin = Pin;
+
+  static void begin() {
+    pinMode(Pin, OUTPUT);
+  }
+
+  FORCE_INLINE_ATTR void setLevel(bool high) {
+    gpio_ll_set_level(&GPIO, static_cast<gpio_num_t>(Pin), high ? 1 : 0);
+  }
+
+  FORCE_INLINE_ATTR void setActive(bool active) {
+    setLevel(active == ActiveHigh);
+  }
+};
+
+/**
+ * Input pin. `ActiveHigh` maps the raw level to "active" (LED lit,
+ * button pressed); `Mode` is the pinMode() used by begin().
+ */
+template <uint8_t Pin, bool ActiveHigh, uint8_t Mode>
+struct Input {
+  static constexpr uint8_t pin = Pin;
+
+  static void begin() {
+    pinMode(Pin, Mode);
+  }
+
+  FORCE_INLINE_ATTR bool level() {
+    return gpio_ll_get_level(&GPIO, static_cast<gpio_num_t>(Pin)) != 0;
+  }
+
+  FORCE_INLINE_ATTR bool active() {
+    return level() == ActiveHigh;
+  }
+};
+
+}  // namespace FastGpio
+
+// Board pins (wiring and polarity from Config.h)
+typedef FastGpio::Output<Config::PIN_RELAY_POWER, Config::POWER_RELAY_ACTIVE_HIGH> PowerRelayPin;
+typedef FastGpio::Output<Config::PIN_RELAY_RESET, Config::RESET_RELAY_ACTIVE_HIGH> ResetRelayPin;
+typedef FastGpio::Input<Config::PIN_PWR_LED, Config::PWR_LED_ACTIVE_HIGH, Config::PWR_LED_PIN_MODE> PowerLedPin;
+typedef FastGpio::Input<Config::PIN_HDD_LED, Config::HDD_LED_ACTIVE_HIGH, Config::HDD_LED_PIN_MODE> HddLedPin;
+typedef FastGpio::Input<Config::PIN_FACTORY_RESET, false, INPUT_PULLUP> FactoryButtonPin;  // Pressed = LOW
+
+/**
+ * Cycle cost per call (CPU cycles, loop overhead subtracted).
+ */
+struct GpioBenchResult {
+  uint32_t iterations;
+  uint32_t digitalReadCycles;
+  uint32_t fastReadCycles;
+  uint32_t digitalWriteCycles;  // 0 if skipped (relay closed)
+  uint32_t fastWriteCycles;
+  bool writesMeasured;
+};
+
+/**
+ * Time both GPIO paths on the power LED input and the power relay output.
+ * Writes only re-apply the inactive level and are skipped while the power
+ * relay is closed. Runs with interrupts off for well under a millisecond.
+ */
+GpioBenchResult FastGpio_benchmark();
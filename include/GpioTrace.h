@@ -0,0 +1,106 @@
+/**
+ * =============================================================================
+ * GpioTrace.h - Front Panel GPIO Edge Capture
+ * =============================================================================
+ *
+ * While capturing, every edge on the power LED, HDD LED and both relays is
+ * stored with its timestamp in a RAM ring (oldest records are overwritten,
+ * so the ring always holds the latest GPIO_TRACE_RECORDS edges). The trace
+ * is downloaded from GET /api/debug/trace and replayed off the device with
+ * tools/trace_replay (see its header for usage).
+ *
+ * FILE FORMAT (little-endian, packed):
+ *
+ *   GpioTraceHeader                       36 bytes
+ *   GpioTraceRecord[recordCount]          8 bytes each, oldest first
+ *
+ *   Levels are logical ("active" = LED lit / relay closed), polarity is
+ *   already applied. `baseLevels` holds every channel's level at `baseUs`
+ *   (capture start, or the last overwritten record), so the trace replays
+ *   from a known state. Times are esp_timer microseconds since boot.
+ *
+ * The ring (16 KB) is allocated on the first start and kept for download
+ * after stop.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+enum class GpioTraceChannel : uint8_t {
+  POWER_LED = 0,
+  HDD_LED,
+  POWER_RELAY,
+  RESET_RELAY,
+};
+
+static constexpr size_t GPIO_TRACE_CHANNEL_COUNT = 4;
+static constexpr uint8_t GPIO_TRACE_VERSION = 1;
+
+struct __attribute__((packed)) GpioTraceHeader {
+  char magic[4];          // "RTRC"
+  uint8_t version;        // GPIO_TRACE_VERSION
+  uint8_t recordSize;     // sizeof(GpioTraceRecord)
+  uint8_t baseLevels;     // Bit n = channel n active at baseUs
+  uint8_t flags;          // GPIO_TRACE_FLAG_*
+  uint32_t recordCount;
+  uint32_t overwritten;   // Oldest records dropped by the ring
+  uint32_t bootGraceMs;   // Device setting at download (for replay)
+  uint64_t baseUs;
+  uint64_t endUs;         // Download time
+};
+
+struct __attribute__((packed)) GpioTraceRecord {
+  uint32_t timeLo;        // esp_timer µs, 48 bits (8.9 years)
+  uint16_t timeHi;
+  uint8_t channel;        // GpioTraceChannel
+  uint8_t level;          // 1 = active
+};
+
+static constexpr uint8_t GPIO_TRACE_FLAG_CAPTURING = 0x01;  // Still running when downloaded
+static constexpr uint8_t GPIO_TRACE_FLAG_NO_HDD = 0x02;     // HDD LED not recorded
+
+struct GpioTraceStatus {
+  bool allocated;
+  bool capturing;
+  bool hdd;
+  uint32_t records;
+  uint32_t overwritten;
+  uint32_t capacity;
+};
+
+/**
+ * Channel name ("power_led", "hdd_led", "power_relay", "reset_relay").
+ */
+const char *GpioTrace_channelName(GpioTraceChannel channel);
+
+/**
+ * Clear the ring and start capturing.
+ *
+ * @param hdd  Record the HDD LED too (it can fill the ring within seconds)
+ * @return false if the ring could not be allocated
+ */
+bool GpioTrace_start(bool hdd);
+
+/**
+ * Stop capturing; the ring stays available for download.
+ */
+void GpioTrace_stop();
+
+/**
+ * Record one edge. Safe from interrupts and any task; returns at once
+ * while not capturing.
+ */
+void IRAM_ATTR GpioTrace_record(GpioTraceChannel channel, bool active);
+
+GpioTraceStatus GpioTrace_status();
+
+/**
+ * Copy header + records (oldest first) into `out`.
+ *
+ * @return false if nothing was ever captured
+ */
+bool GpioTrace_export(std::vector<uint8_t> &out);
@@ -0,0 +1,110 @@
+/**
+ * =============================================================================
+ * HangRecovery.h - Heartbeat Watch and Hang Recovery (Channel 0)
+ * =============================================================================
+ *
+ * Turns missing heartbeats (Heartbeat.h) into a hang and, if enabled,
+ * into front panel presses that escalate until the heartbeats return:
+ *
+ *   IDLE ──RUNNING + heartbeat──► WATCHING
+ *                                    │ no heartbeat for heartbeatTimeoutS
+ *                                    │ (+ HDD idle as long, if required)
+ *                                    ▼
+ *                        recovery off / limit reached ──► HUNG (reported only)
+ *                                    │
+ *                                    ▼
+ *   RESETTING     reset pressed; heartbeat within HANG_RECOVERY_WAIT_MS ──► COOLDOWN
+ *      │ none
+ *      ▼
+ *   FORCING_OFF   power held (force off); LED off, HANG_POWER_OFF_DWELL_MS
+ *      ▼
+ *   POWERING_ON   power pressed; heartbeat within HANG_RECOVERY_WAIT_MS ──► COOLDOWN
+ *      │ none (or the LED never went off)
+ *      ▼
+ *   GAVE_UP       until heartbeats return (someone fixed it by hand)
+ *
+ * Only a PC whose agent has been heard since it reached RUNNING is
+ * watched, so a PC without an agent (or with the agent stopped on
+ * purpose before a shutdown) is never reset. Powering the PC off during
+ * an episode aborts it.
+ *
+ * LIMITS:
+ *   At most HANG_RECOVERY_MAX_EPISODES episodes per
+ *   HANG_RECOVERY_WINDOW_MS; further hangs are only reported (HUNG).
+ *   After a successful recovery the watch pauses for
+ *   HANG_RECOVERY_COOLDOWN_MS.
+ *
+ * THREADING:
+ *   The check runs every HANG_CHECK_INTERVAL_MS on g_controlTimers and
+ *   submits its presses through CommandQueue.h (source "watchdog"), like
+ *   any other client. Statistics are safe to read from any task.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Histogram.h"
+
+enum class HangState : uint8_t {
+  OFF = 0,       // No heartbeat port configured
+  IDLE,          // PC not RUNNING, or no heartbeat heard yet
+  WATCHING,
+  HUNG,          // Hang detected, no action (recovery off or limit reached)
+  RESETTING,
+  FORCING_OFF,
+  POWERING_ON,
+  COOLDOWN,
+  GAVE_UP,
+};
+
+enum class HangAction : uint8_t {
+  RESET = 0,
+  FORCE_OFF,
+  POWER_ON,
+};
+
+enum class HangOutcome : uint8_t {
+  RESET = 0,     // Heartbeats back after the reset
+  POWER_CYCLE,   // Heartbeats back after force off + power on
+  FAILED,        // Still silent after the power cycle
+  ABORTED,       // PC turned off by someone else during the episode
+};
+
+static constexpr size_t HANG_ACTION_COUNT = 3;
+static constexpr size_t HANG_OUTCOME_COUNT = 4;
+
+/**
+ * Status / metric names ("WATCHING"...; "reset", "force_off", "power_on";
+ * "reset", "power_cycle", "failed", "aborted").
+ */
+const char *HangRecovery_stateName(HangState state);
+const char *HangRecovery_actionName(HangAction action);
+const char *HangRecovery_outcomeName(HangOutcome outcome);
+
+struct HangRecoveryStats {
+  bool enabled;                  // Heartbeat port configured
+  bool recover;                  // Presses allowed (otherwise report only)
+  HangState state;
+  uint32_t hangsTotal;           // Hangs detected
+  uint32_t suppressedTotal;      // Hangs not acted on because of the episode limit
+  uint32_t actions[HANG_ACTION_COUNT];
+  uint32_t outcomes[HANG_OUTCOME_COUNT];
+};
+
+/**
+ * Read the settings from g_config and start the check timer. Call once
+ * in setup(), after PcChannels_setup() and Heartbeat_setup().
+ */
+void HangRecovery_setup();
+
+/**
+ * Consistent copy of the counters. Safe from any task.
+ */
+HangRecoveryStats HangRecovery_stats();
+
+/**
+ * Hang detection to the first heartbeat after a successful recovery (µs).
+ */
+const LatencyHistogram &HangRecovery_timeToRecovery();
@@ -0,0 +1,72 @@
+/**
+ * =============================================================================
+ * HddActivity.h - HDD LED Edge Capture & Activity Analytics
+ * =============================================================================
+ *
+ * The HDD LED interrupt pushes every edge, timestamped, into a lock-free
+ * single-producer/single-consumer ring. The control task drains it and
+ * derives:
+ *
+ *   - activity ratio: share of time the LED was lit, per 1 s window and
+ *     averaged over the last 60 windows
+ *   - edge rate: LED edges per second (last window)
+ *   - bursts: runs of activity separated by less than HDD_BURST_GAP_MS;
+ *     burst length and the idle gaps between bursts go into histograms
+ *
+ *   HDD ISR ──► edge ring (256) ──► control task ──► windows / bursts
+ *
+ * A busy build box shows a high ratio and long bursts; a hung one shows
+ * the ratio dropping to zero while the power LED stays on.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Histogram.h"
+
+/**
+ * Derived values, updated by HddActivity_process().
+ */
+struct HddActivityStats {
+  uint16_t ratioPermille;       // LED lit, last full 1 s window (0..1000)
+  uint16_t ratio60sPermille;    // Mean over the last 60 windows
+  uint16_t edgesPerSecond;      // Last full window
+  bool active;                  // LED lit now
+  uint32_t lastActiveMs;        // millis() of the last activity (0 = never)
+  uint32_t lastChangeMs;        // millis() of the last edge (0 = never)
+  uint32_t edgesTotal;
+  uint32_t burstsTotal;
+  uint32_t ringOverflows;       // Edges lost because the ring was full
+};
+
+/**
+ * Start tracking with the current LED level. Call before attaching the ISR.
+ */
+void HddActivity_setup(bool activeNow);
+
+/**
+ * Record one edge. Call from the HDD LED interrupt only (single producer).
+ *
+ * @param active  LED lit after the edge
+ */
+void IRAM_ATTR HddActivity_recordEdgeFromIsr(bool active);
+
+/**
+ * Drain the ring and update windows and bursts. Call from the control task
+ * only (single consumer). `activeNow` (polled level) resynchronises the
+ * tracker after a ring overflow.
+ */
+void HddActivity_process(bool activeNow);
+
+/**
+ * Snapshot of the derived values (control task, or any task for display).
+ */
+HddActivityStats HddActivity_stats();
+
+/**
+ * Burst lengths and idle gaps between bursts (µs).
+ */
+const LatencyHistogram &HddActivity_burstDurations();
+const LatencyHistogram &HddActivity_idleGaps();
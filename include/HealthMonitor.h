@@ -0,0 +1,99 @@
+/**
+ * =============================================================================
+ * HealthMonitor.h - Subsystem Heartbeats & Targeted Recovery
+ * =============================================================================
+ *
+ * Soft watchdog per subsystem. Each monitored component reports progress
+ * with HealthMonitor_beat(); a periodic check on the control task's timer
+ * wheel flags a stall when a watched subsystem has not beaten within its
+ * timeout. Only that component is then torn down and re-initialized -
+ * the relays, the other integrations and the WiFi link keep running.
+ *
+ *   Subsystem   Watched while          Recovery (in the owner task)
+ *   ─────────   ────────────────────   ──────────────────────────────────
+ *   wifi        STA mode               WiFi driver off/on, reconnect
+ *   mqtt        WiFi up, broker set    Socket shut down, client re-created
+ *   loki        a push is running      Pushes paused for LOKI_BACKOFF_MS
+ *   ota         a download is running  Update aborted, hold released
+ *   websocket   clients connected      Clients with a stuck queue closed
+ *
+ * RECOVERY:
+ *   A stall sets a recovery request that the owner task takes with
+ *   HealthMonitor_takeRecovery() at a point where it is safe to rebuild
+ *   its own objects. An optional abort hook runs immediately in the
+ *   control task to unblock an owner stuck in a blocking call (it must be
+ *   short and thread-safe, e.g. shutting down a socket). If the subsystem
+ *   stays silent for another timeout, recovery is requested again.
+ *
+ * The whole-task watchdog (esp_task_wdt) stays in place as last resort.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Histogram.h"
+
+enum class Subsystem : uint8_t {
+  WIFI = 0,
+  MQTT,
+  LOKI,
+  OTA,
+  WEBSOCKET,
+  COUNT
+};
+
+constexpr size_t SUBSYSTEM_COUNT = static_cast<size_t>(Subsystem::COUNT);
+
+typedef void (*SubsystemAbortFn)();
+
+/**
+ * Arm the periodic stall check on the control timer wheel.
+ * Call once in setup() after the timer wheels have begun.
+ */
+void HealthMonitor_setup();
+
+/**
+ * Set the stall timeout and optional abort hook of `sub`.
+ * Call from the owning module's setup.
+ */
+void HealthMonitor_configure(Subsystem sub, uint32_t stallTimeoutMs, SubsystemAbortFn abortFn = nullptr);
+
+/**
+ * Start / stop watching `sub`. start() counts as a heartbeat; stopping a
+ * stalled subsystem ends the stall. Both are cheap and idempotent.
+ */
+void HealthMonitor_start(Subsystem sub);
+void HealthMonitor_stop(Subsystem sub);
+
+/**
+ * Report progress. Ends a pending stall (its duration is recorded).
+ */
+void HealthMonitor_beat(Subsystem sub);
+
+/**
+ * True once per requested recovery. Call from the owner task.
+ */
+bool HealthMonitor_takeRecovery(Subsystem sub);
+
+/**
+ * Subsystem name (used as Prometheus label).
+ */
+const char *HealthMonitor_name(Subsystem sub);
+
+/**
+ * False while `sub` is stalled (an unwatched subsystem counts as healthy).
+ */
+bool HealthMonitor_healthy(Subsystem sub);
+
+/**
+ * Stalls detected / recoveries requested since boot.
+ */
+uint32_t HealthMonitor_stallCount(Subsystem sub);
+uint32_t HealthMonitor_recoveryCount(Subsystem sub);
+
+/**
+ * Duration of finished stalls (last heartbeat to next heartbeat or stop).
+ */
+const LatencyHistogram &HealthMonitor_stallDurations(Subsystem sub);
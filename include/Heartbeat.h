@@ -0,0 +1,53 @@
+/**
+ * =============================================================================
+ * Heartbeat.h - UDP Heartbeats from an Agent on the PC
+ * =============================================================================
+ *
+ * A frozen OS keeps the power LED lit, so the PC still looks RUNNING. A
+ * small agent on the PC sends a datagram to g_config.heartbeatPort every
+ * few seconds; as long as it does, the OS schedules user processes:
+ *
+ *   while true; do echo -n hb > /dev/udp/<device>/<port>; sleep 5; done
+ *
+ * The content is ignored. If a probe address is configured (Reachability.h)
+ * only datagrams from that address count; others are counted as rejected.
+ *
+ * COST:
+ *   The socket is an lwIP raw-API PCB. Its receive callback runs in the
+ *   tcpip thread and only stores a timestamp and a counter before freeing
+ *   the packet: no copy, no socket buffer, no task wakeup. A flood of
+ *   heartbeats costs the stack's own per-packet work and nothing else.
+ *
+ * HangRecovery.h decides what a missing heartbeat means.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+struct HeartbeatStats {
+  bool enabled;        // Listening (port configured)
+  uint16_t port;
+  uint32_t accepted;
+  uint32_t rejected;   // From another address than the probe address
+  int64_t lastUs;      // esp_timer time of the last accepted one (0 = never)
+};
+
+/**
+ * Bind the UDP port from g_config. Call once in setup(), after
+ * Networking_setup() started the network stack.
+ */
+void Heartbeat_setup();
+
+/**
+ * Consistent copy of the counters. Safe from any task.
+ */
+HeartbeatStats Heartbeat_stats();
+
+/**
+ * esp_timer time of the last accepted heartbeat (0 = none since boot).
+ * Safe from any task.
+ */
+int64_t Heartbeat_lastUs();
@@ -0,0 +1,159 @@
+/**
+ * =============================================================================
+ * Histogram.h - Fixed-Bucket Latency Histogram
+ * =============================================================================
+ *
+ * A small, allocation-free histogram for durations in microseconds.
+ * Buckets are fixed so recording is a short linear scan and the memory
+ * cost is constant. Three bucket sets are available:
+ *
+ *   latencyBoundsUs()   2µs .. 1s      (task stages, wake latency)
+ *   activityBoundsUs()  1ms .. 60s     (HDD bursts and idle gaps)
+ *   outageBoundsUs()    100ms .. 30min (subsystem stalls)
+ *
+ * Percentiles are estimated as the upper bound of the bucket that
+ * contains the requested rank (clamped to the observed maximum).
+ *
+ * Recording is guarded by a spinlock, so a histogram may be fed from
+ * several tasks.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class LatencyHistogram {
+public:
+  static constexpr size_t FINITE_BUCKETS = 14;
+  static constexpr size_t BUCKET_COUNT = FINITE_BUCKETS + 1;  // + overflow (+Inf)
+
+  static const uint32_t *latencyBoundsUs() {
+    static const uint32_t kBoundsUs[FINITE_BUCKETS] = {
+      2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 10000, 50000, 250000, 1000000
+    };
+    return kBoundsUs;
+  }
+
+  static const uint32_t *activityBoundsUs() {
+    static const uint32_t kBoundsUs[FINITE_BUCKETS] = {
+      1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000,
+      500000, 1000000, 2500000, 5000000, 10000000, 60000000
+    };
+    return kBoundsUs;
+  }
+
+  static const uint32_t *outageBoundsUs() {
+    static const uint32_t kBoundsUs[FINITE_BUCKETS] = {
+      100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000, 15000000,
+      30000000, 60000000, 120000000, 300000000, 600000000, 1800000000
+    };
+    return kBoundsUs;
+  }
+
+  /**
+   * @param budgetUs  Samples above this count as overruns (0 = no budget)
+   * @param boundsUs  FINITE_BUCKETS ascending upper bounds
+   */
+  explicit LatencyHistogram(uint32_t budgetUs = 0, const uint32_t *boundsUs = latencyBoundsUs())
+      : budgetUs_(budgetUs), bounds_(boundsUs) {}
+
+  /**
+   * Upper bound (inclusive, µs) of finite bucket `index`.
+   */
+  uint32_t bucketBoundUs(size_t index) const { return bounds_[index]; }
+
+  void record(uint32_t us) {
+    size_t bucket = 0;
+    while (bucket < FINITE_BUCKETS && us > bucketBoundUs(bucket)) {
+      bucket++;
+    }
+    portENTER_CRITICAL(&mux_);
+    counts_[bucket]++;
+    count_++;
+    sumUs_ += us;
+    if (us > maxUs_) maxUs_ = us;
+    if (budgetUs_ > 0 && us > budgetUs_) overruns_++;
+    portEXIT_CRITICAL(&mux_);
+  }
+
+  void reset() {
+    portENTER_CRITICAL(&mux_);
+    memset(counts_, 0, sizeof(counts_));
+    count_ = 0;
+    sumUs_ = 0;
+    maxUs_ = 0;
+    overruns_ = 0;
+    portEXIT_CRITICAL(&mux_);
+  }
+
+  uint32_t count() const { return count_; }
+  uint64_t sumUs() const { return sumUs_; }
+  uint32_t maxUs() const { return maxUs_; }
+  uint32_t overruns() const { return overruns_; }
+  uint32_t budgetUs() const { return budgetUs_; }
+  uint32_t bucketCount(size_t index) const { return counts_[index]; }
+
+  uint32_t meanUs() const {
+    return count_ > 0 ? static_cast<uint32_t>(sumUs_ / count_) : 0;
+  }
+
+  /**
+   * Estimated percentile (0-100) in µs.
+   */
+  uint32_t percentileUs(uint8_t pct) const {
+    if (count_ == 0) return 0;
+    uint64_t rank = ((uint64_t)count_ * pct + 99) / 100;
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < FINITE_BUCKETS; i++) {
+      seen += counts_[i];
+      if (seen >= rank) {
+        uint32_t bound = bucketBoundUs(i);
+        return bound < maxUs_ ? bound : maxUs_;
+      }
+    }
+    return maxUs_;
+  }
+
+  /**
+   * Append this histogram in Prometheus text format (values in seconds).
+   *
+   * @param m       Output buffer
+   * @param metric  Metric base name, e.g. "restarter_stage_duration_seconds"
+   * @param labels  Label pairs without braces, e.g. device="x",stage="mqtt"
+   */
+  void appendPrometheus(String &m, const char *metric, const String &labels) const {
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+      cumulative += counts_[i];
+      m += metric;
+      m += "_bucket{";
+      m += labels;
+      m += ",le=\"";
+      if (i < FINITE_BUCKETS) {
+        m += String(bucketBoundUs(i) / 1e6, 6);
+      } else {
+        m += "+Inf";
+      }
+      m += "\"} ";
+      m += String((uint32_t)cumulative);
+      m += "\n";
+    }
+    m += metric;
+    m += "_sum{" + labels + "} " + String(sumUs_ / 1e6, 6) + "\n";
+    m += metric;
+    m += "_count{" + labels + "} " + String(count_) + "\n";
+  }
+
+private:
+  uint32_t counts_[BUCKET_COUNT] = {};
+  uint32_t count_ = 0;
+  uint64_t sumUs_ = 0;
+  uint32_t maxUs_ = 0;
+  uint32_t overruns_ = 0;
+  uint32_t budgetUs_ = 0;
+  const uint32_t *bounds_;
+  portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+};
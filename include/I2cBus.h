@@ -0,0 +1,92 @@
+/**
+ * =============================================================================
+ * I2cBus.h - Shared I2C Bus (Sensors, GPIO Expander)
+ * =============================================================================
+ *
+ * Owns Wire. Every device on the bus goes through this module:
+ *
+ *   telemetry task ──► Sensors_sample() ──► one batch: all due sensors
+ *   control task   ──► IoExpander_read()       ┐
+ *   esp_timer task ──► IoExpander_setOutput()  ┴► single transfers
+ *
+ * The bus runs in fast mode (I2C_CLOCK_HZ). A caller holds the bus with
+ * an I2cLock for as many transfers as belong together, so a sensor batch
+ * is not interleaved with expander traffic and a bus recovery can never
+ * run in the middle of someone else's transfer.
+ *
+ * BUS RECOVERY:
+ *   A slave that lost sync (reset mid-transfer) can hold SDA low forever.
+ *   I2cBus_recover() clocks SCL until it lets go, sends a STOP and
+ *   restarts the driver. It runs at setup and after repeated errors from
+ *   one device (Sensors.cpp).
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+struct I2cBusStats {
+  uint32_t transfers;
+  uint32_t errors;        // NACK, timeout, short read
+  uint32_t recoveries;
+  uint32_t lockTimeouts;  // Gave up waiting for the bus
+};
+
+/**
+ * Release a stuck bus and start Wire at I2C_CLOCK_HZ. Call once in setup
+ * before any device is touched.
+ */
+void I2cBus_setup();
+
+/**
+ * Holds the bus for its lifetime (recursive, so helpers may lock again).
+ * Check held() before any transfer.
+ */
+class I2cLock {
+public:
+  explicit I2cLock(uint32_t timeoutMs);
+  ~I2cLock();
+  bool held() const { return _held; }
+
+private:
+  I2cLock(const I2cLock &) = delete;
+  I2cLock &operator=(const I2cLock &) = delete;
+  bool _held;
+};
+
+// -----------------------------------------------------------------------------
+// Transfers (hold an I2cLock)
+// -----------------------------------------------------------------------------
+
+/**
+ * Address-only write: true if a device acknowledged (not counted in the
+ * statistics; scans expect NACKs).
+ */
+bool I2cBus_probe(uint8_t address);
+
+bool I2cBus_write(uint8_t address, const uint8_t *data, size_t length);
+
+/**
+ * Plain read (no register pointer).
+ */
+bool I2cBus_read(uint8_t address, uint8_t *data, size_t length);
+
+/**
+ * Write `reg`, repeated start, read `length` bytes.
+ */
+bool I2cBus_readRegister(uint8_t address, uint8_t reg, uint8_t *data, size_t length);
+
+/**
+ * 16-bit registers, MSB first (TMP112, INA219/INA226).
+ */
+bool I2cBus_writeRegister16(uint8_t address, uint8_t reg, uint16_t value);
+bool I2cBus_readRegister16(uint8_t address, uint8_t reg, uint16_t &value);
+
+/**
+ * Free a stuck bus (SCL clocked, STOP) and restart the driver.
+ */
+void I2cBus_recover();
+
+I2cBusStats I2cBus_stats();
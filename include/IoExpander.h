@@ -0,0 +1,140 @@
+/**
+ * =============================================================================
+ * IoExpander.h - I2C GPIO Expander for Extra PC Channels
+ * =============================================================================
+ *
+ * Drives an MCP23017 (16 pins) or PCF8574 (8 pins) on the sensors' I2C
+ * bus (I2cBus.h), so one board can watch and press the front panels of several PCs.
+ * Every PC channel takes four consecutive pins:
+ *
+ *   MCP23017  GPA0..3  channel 1     GPB0..3  channel 3
+ *             GPA4..7  channel 2     GPB4..7  channel 4
+ *
+ *   +0 power LED   +1 HDD LED   +2 power relay   +3 reset relay
+ *
+ * INPUTS:
+ *   All inputs are read in one bus transfer (IoExpander_read()). The
+ *   expander's INT output (PIN_EXPANDER_INT) marks a change: the MCP23017
+ *   raises it only for the power LEDs, the PCF8574 for any input. HDD LEDs
+ *   are picked up by the periodic read (EXPANDER_POLL_MS).
+ *
+ * OUTPUTS:
+ *   A shadow of the output latch is kept; each relay change writes the
+ *   whole latch (one transfer) while holding the bus (I2cLock). Relay
+ *   presses and releases are both written from the control task, never
+ *   from the esp_timer task, which must not wait for the bus. A failed
+ *   write leaves the latch marked dirty and IoExpander_flush() repeats it
+ *   from the control task. The latch last written to the chip is kept
+ *   too, with the time each pin changed there, so a relay pulse can be
+ *   timed from the writes that actually moved the relay.
+ *
+ *   PCF8574 outputs are quasi-bidirectional: high is only a weak pull-up,
+ *   so relay boards there should be active low.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Histogram.h"
+
+/**
+ * Pins of one PC channel, in expander pin order.
+ */
+enum class ChannelPin : uint8_t {
+  POWER_LED = 0,
+  HDD_LED,
+  POWER_RELAY,
+  RESET_RELAY,
+};
+
+static constexpr uint8_t EXPANDER_PINS_PER_CHANNEL = 4;
+static constexpr size_t EXPANDER_CHANNELS = Config::EXPANDER_PINS / EXPANDER_PINS_PER_CHANNEL;
+
+/**
+ * Expander pin of `pin` for PC channel `channel` (1..EXPANDER_CHANNELS).
+ */
+constexpr uint8_t IoExpander_pin(size_t channel, ChannelPin pin) {
+  return static_cast<uint8_t>((channel - 1) * EXPANDER_PINS_PER_CHANNEL + static_cast<uint8_t>(pin));
+}
+
+struct IoExpanderStats {
+  bool present;
+  uint32_t reads;
+  uint32_t readErrors;
+  uint32_t writes;
+  uint32_t writeErrors;
+  uint32_t interrupts;
+};
+
+/**
+ * Program directions, pull-ups and inactive relays. Call once after the
+ * I2C bus is up (I2cBus_setup()).
+ *
+ * @return false if no expander answered (Config::EXPANDER_PINS = 0 or not fitted)
+ */
+bool IoExpander_setup();
+
+bool IoExpander_present();
+
+/**
+ * INT asserted. Call from the INT interrupt only.
+ */
+void IRAM_ATTR IoExpander_markInterruptFromIsr();
+
+/**
+ * Take the interrupt flag.
+ *
+ * @param atUs  esp_timer time of the first interrupt since the last call
+ * @return true if INT fired since the last call
+ */
+bool IoExpander_takeInterrupt(int64_t &atUs);
+
+/**
+ * Read all input levels in one transfer (clears INT). Control task only.
+ *
+ * @param levels  Bit n = raw level of pin n
+ * @return false on a bus error (levels unchanged)
+ */
+bool IoExpander_read(uint16_t &levels);
+
+/**
+ * Levels of the last successful read.
+ */
+uint16_t IoExpander_levels();
+
+/**
+ * Set an output pin's level. May wait up to EXPANDER_LOCK_TIMEOUT_MS for
+ * the bus, so not from the esp_timer task or ISRs.
+ *
+ * @return false if the write did not reach the expander yet (retried by
+ *         IoExpander_flush())
+ */
+bool IoExpander_setOutput(uint8_t pin, bool high);
+
+/**
+ * Whether output `pin` is at level `high` on the chip (not just in the
+ * shadow latch).
+ *
+ * @param atUs  esp_timer time of the write that set that level (0 = setup)
+ */
+bool IoExpander_outputWritten(uint8_t pin, bool high, int64_t &atUs);
+
+/**
+ * Repeat a failed output write. Call from the control task every tick.
+ */
+void IoExpander_flush();
+
+/**
+ * An output write is waiting to be repeated.
+ */
+bool IoExpander_outputsPending();
+
+IoExpanderStats IoExpander_stats();
+
+/**
+ * Duration of one input read transfer (µs).
+ */
+const LatencyHistogram &IoExpander_readLatency();
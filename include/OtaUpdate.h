@@ -2,8 +2,29 @@
 
 #include <Arduino.h>
 
+// Copy of the OTA state for other tasks, published on every change.
+// Text fields are truncated to fit (on a UTF-8 character boundary) and
+// then end in "…". Release notes are not part of it: they can be several
+// KB (see OtaUpdate_notes()).
+struct OtaStatus {
+  bool checking = false;
+  bool updateInProgress = false;
+  bool available = false;
+  bool lastCheckOk = false;
+  bool rebootRequired = false;
+  uint8_t progress = 0;
+  uint32_t lastCheckMs = 0;
+  char remoteVersion[24] = {};
+  char error[96] = {};
+};
+
 void OtaUpdate_setup();
 bool OtaUpdate_checkVersion();
 bool OtaUpdate_startUpdate();
 bool OtaUpdate_isBusy();
+OtaStatus OtaUpdate_status();
+
+// Release notes of the last check, in full. Copied under the OTA mutex,
+// which is only held briefly (never during a download or HTTP request).
+String OtaUpdate_notes();
 String OtaUpdate_getStatusJson();
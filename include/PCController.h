@@ -7,7 +7,7 @@
  *   - Reading the power LED to determine if PC is on/off
  *   - Triggering the power button (short press or force shutdown)
  *   - Triggering the reset button
- *   - Tracking the PC's state (off, booting, running)
+ *   - Tracking the PC's state (off, booting, running, sleeping)
  * 
  * HOW IT WORKS:
  * 
@@ -22,14 +22,63 @@
  *   │ Reset SW  ──┼──[Relay]← GPIO │  (press reset button)
  *   └─────────────┘        └──────┘
  * 
+ * RELAY PULSES:
+ *   A pulse closes the relay in the calling (control) task and arms an
+ *   esp_timer one-shot for the release. On channel 0 the release runs in
+ *   the esp_timer task (priority 22), so a stalled control task can never
+ *   stretch a 500 ms press into a forced shutdown. Each pulse's measured
+ *   width is compared with the requested width; the error goes into a
+ *   histogram.
+ *
+ *   Expander relays need the I2C bus, which a sensor batch or bus
+ *   recovery may hold for a while; the esp_timer task must never wait
+ *   for it. Their one-shot only wakes the control task, which puts the
+ *   release into the expander latch. The pulse counts from the write that
+ *   closed the relay to the one that opened it, whenever those reached
+ *   the chip (see IoExpander_outputWritten()).
+ * 
+ * POWER LED:
+ *   The power LED interrupt timestamps each edge into a small ring
+ *   (recordPowerEdgeFromIsr()); update() feeds them to a
+ *   PowerLedClassifier, which recognises sleep blinking and decides
+ *   steady changes after POWER_LED_GLITCH_MS.
+ * 
+ * BOOTING -> RUNNING:
+ *   Decided by a BootLearner from the HDD activity after power-on (see
+ *   BootLearner.h); bootGraceMs is only the ceiling until a boot is
+ *   learned. A reset press restarts the decision when it is released.
+ * 
+ * BOOT TIMELINE:
+ *   Power presses (PC off) and reset presses (PC on) start a BootTimeline
+ *   (see BootTimeline.h); update() marks its LED, HDD and settle phases.
+ * 
+ * CHANNELS:
+ *   Channel 0 is the board's own front panel header (FastGpio pins, GPIO
+ *   trace, boot timeline). Channels 1..n sit on the I2C expander
+ *   (IoExpander.h): relays are written through it and power LED edges are
+ *   fed by PcChannels_update() with recordPowerEdge(). Each channel has
+ *   its own timing in g_config.channels[].
+ * 
+ * THREADING:
+ *   Only the control task may call the action methods; other tasks submit
+ *   actions through CommandQueue.h.
+ * 
  * =============================================================================
  */
 
 #pragma once
 
 #include <Arduino.h>
+#include <esp_timer.h>
+#include "BootLearner.h"
+#include "BootTimeline.h"
 #include "Config.h"
 #include "Constants.h"
+#include "FastGpio.h"
+#include "GpioTrace.h"
+#include "Histogram.h"
+#include "IoExpander.h"
+#include "PowerLedClassifier.h"
 
 class PCController {
 public:
@@ -40,17 +89,31 @@ public:
   /**
    * Initialize GPIO pins and set safe defaults.
    * Call this once in setup().
+   *
+   * @param channel  0 = the board's own header, 1.. = expander channel
+   *                 (call after IoExpander_setup())
+   */
+  void begin(uint8_t channel = 0);
+
+  /**
+   * Scheduler task index of the control task; expander pulse timers wake
+   * it at their release time.
    */
-  void begin();
+  static void setControlTask(int taskIndex);
   
   /**
    * Main update function - call this frequently in loop().
    * Reads inputs, manages relay timing, and updates PC state.
+   *
+   * @param hddActivityPermille  HDD LED activity of the last full second
    */
-  void update();
+  void update(uint16_t hddActivityPermille);
+
+  uint8_t channel() const { return channelIndex; }
 
   /**
-   * Get the current PC state (OFF, BOOTING, RUNNING, RESTARTING).
+   * Get the current PC state (OFF, BOOTING, RUNNING, RESTARTING, SLEEP,
+   * UNKNOWN_BLINK).
    */
   PCState state() const;
   
@@ -64,25 +127,65 @@ public:
    */
   bool resetRelayActive() const;
 
+  /**
+   * True while a power LED change is still being debounced.
+   */
+  bool powerSignalSettling() const;
+
+  /**
+   * Record a power LED edge. Call from the power LED interrupt only.
+   *
+   * @param active  LED lit after the edge
+   */
+  void IRAM_ATTR recordPowerEdgeFromIsr(bool active);
+
+  /**
+   * Record a power LED edge read from the expander. Control task only.
+   *
+   * @param active  LED lit after the edge
+   * @param atUs    esp_timer time of the edge
+   */
+  void recordPowerEdge(bool active, int64_t atUs);
+
+  /**
+   * Power LED classifier (decision latencies, blink period).
+   */
+  const PowerLedClassifier &powerLed() const { return powerLedClassifier; }
+
+  /**
+   * Boot duration learner (learned profile, detection times).
+   */
+  const BootLearner &boot() const { return bootLearner; }
+
+  /**
+   * Install the boot profile loaded from NVS. Call before the tasks start.
+   */
+  void setBootProfile(const BootProfile &profile) { bootLearner.setProfile(profile); }
+
   /**
    * Trigger a short power button press.
-   * Duration is set by config.powerPulseMs (default 500ms).
+   * Duration is set by the channel's powerPulseMs (default 500ms).
    * Use this to turn PC on/off normally.
+   * @return false while a force shutdown holds the power relay
    */
-  void pulsePower();
+  bool pulsePower();
   
   /**
    * Trigger a short reset button press.
-   * Duration is set by config.resetPulseMs (default 500ms).
+   * Duration is set by the channel's resetPulseMs (default 500ms).
+   * @return true (the reset relay is never latched)
    */
-  void pulseReset();
+  bool pulseReset();
   
   /**
    * Force shutdown: hold power button for 11 seconds.
    * This forces the PC off even if it's frozen.
    * WARNING: This is like pulling the power cord - may cause data loss!
+   * The power relay stays latched until the hold ends: further power
+   * presses would cut it short into a normal press.
+   * @return false while a force shutdown already holds the power relay
    */
-  void forcePower();
+  bool forcePower();
   
   /**
    * Immediately deactivate both relays.
@@ -90,39 +193,152 @@ public:
    */
   void setOutputsInactive();
 
+  /**
+   * Pulse accuracy: |measured - requested| width per completed pulse (µs).
+   */
+  const LatencyHistogram &powerPulseError() const;
+  const LatencyHistogram &resetPulseError() const;
+
+  /**
+   * Measured width of the last completed pulse (µs, 0 = none yet).
+   */
+  uint32_t lastPowerPulseUs() const;
+  uint32_t lastResetPulseUs() const;
+
 private:
+  /**
+   * One relay and its pulse in progress. On channel 0, `active`,
+   * `released` and the measurements are written by the esp_timer task on
+   * release; expander pulses are only touched by the control task.
+   */
+  struct RelayPulse {
+    typedef void (*SetActiveFn)(bool active);
+
+    RelayPulse(SetActiveFn setActive, GpioTraceChannel channel, const char *name)
+        : setActive(setActive), channel(channel), name(name),
+          error(Config::RELAY_PULSE_ERROR_BUDGET_US) {}
+
+    // Drive the relay and record the edge in a running GPIO trace
+    void drive(bool on) const {
+      if (expanderPin >= 0) {
+        IoExpander_setOutput(static_cast<uint8_t>(expanderPin), on == activeHigh);
+        return;
+      }
+      setActive(on);
+      GpioTrace_record(channel, on);
+    }
+
+    const SetActiveFn setActive;    // FastGpio pin, polarity resolved at compile time
+    const GpioTraceChannel channel;
+    const char *const name;
+    int8_t expanderPin = -1;        // Expander channels: pin instead of setActive
+    bool activeHigh = true;         // Expander pin level that closes the relay
+    esp_timer_handle_t timer = nullptr;
+    bool timed = false;             // Release (expander: wake) armed on the esp_timer
+    bool closeWritten = false;      // Expander: the close reached the chip
+    bool releasing = false;         // Expander: release in the latch, not on the chip yet
+    volatile bool active = false;   // Relay closed by a pulse
+    volatile bool released = false; // Released, not yet logged by update()
+    int64_t startUs = 0;            // Relay closed
+    int64_t deadlineUs = 0;         // Requested release
+    volatile uint32_t lastWidthUs = 0;
+    LatencyHistogram error;
+  };
+
   // =========================================================================
   // PRIVATE HELPER METHODS
   // =========================================================================
-  
+
+  bool primary() const { return channelIndex == 0; }
+
+  const ChannelConfig &settings() const;
+
   /**
-   * Set a relay to active or inactive state.
-   * Handles polarity conversion (active high vs active low).
+   * Queue a power LED edge (ISR or control task).
    */
-  void setRelay(uint8_t pin, bool active, bool activeHigh);
-  
+  void IRAM_ATTR pushPowerEdge(bool active, int64_t atUs);
+
   /**
-   * Read an input pin and return whether it's "active".
-   * Handles polarity conversion for optocoupler signals.
+   * Current power LED level (native pin or last expander read).
    */
-  bool readActive(uint8_t pin, bool activeHigh) const;
+  bool powerLedActive() const;
+
+  /**
+   * Close the relay (or extend a running pulse) until now + durationMs.
+   */
+  void startPulse(RelayPulse &pulse, uint32_t durationMs);
+
+  /**
+   * Open a channel 0 relay and record the pulse width. Runs in the
+   * esp_timer task, or in update() if the one-shot could not be armed.
+   */
+  static void releasePulse(RelayPulse &pulse);
+
+  /**
+   * Record the width of a pulse that ended at `endUs`.
+   */
+  static void finishPulse(RelayPulse &pulse, int64_t endUs);
+  static void onPulseTimer(void *arg);
+
+  /**
+   * Expander pulse: note when the close reached the chip, put the release
+   * into the latch once due, finish it once that reached the chip.
+   * Control task only.
+   *
+   * @return false if the pulse ended without the relay ever closing
+   */
+  bool serviceExpanderPulse(RelayPulse &pulse, int64_t nowUs);
+
+  /**
+   * A force shutdown still holds the power relay; clears the latch once
+   * its pulse has ended.
+   */
+  bool powerRelayForced();
+
+  /**
+   * Log a release done by the timer; fall back to polling without one.
+   *
+   * @return true if the pulse was released since the last call
+   */
+  bool servicePulse(RelayPulse &pulse, int64_t nowUs);
+
+  /**
+   * Mark BootTimeline phases reported by the boot learner.
+   */
+  void updateBootTimeline(uint64_t nowMs);
   
+  /**
+   * Feed queued power LED edges to the classifier and act on its decision.
+   */
+  void updatePowerSignal(uint64_t nowMs, int64_t nowUs);
+
   /**
    * Update the internal state machine based on inputs and timing.
    */
-  void updateState(uint32_t nowMs);
+  void updateState();
 
   // =========================================================================
   // PRIVATE STATE VARIABLES
   // =========================================================================
   
-  uint32_t lastPowerOnMs = 0;       // When the power LED last turned ON
-  uint32_t lastPowerSignalChangeMs = 0; // When the raw power LED signal last changed
-  uint32_t powerPulseUntilMs = 0;   // When to release the power relay (0 = inactive)
-  uint32_t resetPulseUntilMs = 0;   // When to release the reset relay (0 = inactive)
-  bool powerRelayLatched = false;
-  bool resetRelayLatched = false;
-  bool rawPowerSignal = false;      // Immediate, non-debounced power LED state
-  bool currentPowerSignal = false;  // Current power LED state
+  uint8_t channelIndex = 0;
+  char logTag[10] = "";             // Log line prefix, "[chN] " for expander channels
+  RelayPulse powerPulse{&PowerRelayPin::setActive, GpioTraceChannel::POWER_RELAY, "Power"};
+  RelayPulse resetPulse{&ResetRelayPin::setActive, GpioTraceChannel::RESET_RELAY, "Reset"};
+  bool powerRelayLatched = false;   // Held by forcePower() (see powerRelayForced())
+
+  // Power LED edges: written by the ISR (head), read by update() (tail).
+  // Entry = low 32 bits of esp_timer_get_time() with bit 0 = level.
+  static constexpr uint32_t POWER_EDGE_RING_SIZE = 32;  // Power of two
+  volatile uint32_t powerEdges[POWER_EDGE_RING_SIZE] = {};
+  volatile uint32_t powerEdgeHead = 0;
+  volatile uint32_t powerEdgeTail = 0;
+  bool powerLevelMismatch = false;  // Polled level disagreed last update
+  PowerLedClassifier powerLedClassifier;
+  PowerLedSignal powerSignal = PowerLedSignal::OFF;  // Classifier decision
+  BootLearner bootLearner;
+  bool booting = false;             // BootLearner decision, last update
+  bool bootActivitySeen = false;    // BootLearner flags already marked on the timeline
+  bool bootSettled = false;
   PCState currentState = PCState::OFF;  // Current derived PC state
 };
@@ -0,0 +1,76 @@
+/**
+ * =============================================================================
+ * PcChannels.h - One Board, Several PCs
+ * =============================================================================
+ *
+ * Channel 0 is g_pc on the board's own front panel header. With an I2C
+ * GPIO expander fitted (IoExpander.h), channels 1..n are further
+ * PCController instances wired to its pins:
+ *
+ *   control tick ──► INT fired / poll due ──► one expander read
+ *                                               ├─► power LED edges ──► PCController
+ *                                               └─► HDD LED levels ──► 1 s ratio
+ *                ──► PCController::update() per channel
+ *                ──► repeat failed relay writes
+ *
+ * Expander channels get the boot learner and power LED classifier like
+ * channel 0. Reachability, the boot timeline, GPIO traces and HDD burst
+ * analytics remain channel 0 only. The HDD ratio of an expander channel
+ * is sampled at each read (time-weighted), not edge-exact.
+ *
+ * THREADING:
+ *   PcChannels_update() runs in the control task. Actions on any channel
+ *   go through CommandQueue.h like those on g_pc.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "PCController.h"
+
+/**
+ * Probe the expander and start channels 1..n. Call after the I2C bus is
+ * up (I2cBus_setup()) and before the power LED interrupts.
+ */
+void PcChannels_setup();
+
+/**
+ * Channels in use: 1 without an expander.
+ */
+size_t PcChannels_count();
+
+/**
+ * Controller of a channel (0 = g_pc), nullptr if `channel` is not in use.
+ */
+PCController *PcChannels_get(size_t channel);
+
+/**
+ * Display name: the configured name or "PC <n>".
+ */
+String PcChannels_name(size_t channel);
+
+/**
+ * Read the expander if due and update channels 1..n. Call from the
+ * control task after g_pc.update().
+ */
+void PcChannels_update();
+
+/**
+ * Fill the per-channel part of the status snapshot (control task, inside
+ * its g_statusSnapshot.update()).
+ */
+void PcChannels_publish(StatusSnapshot &s);
+
+/**
+ * True while an expander channel needs fast control ticks (power LED
+ * debounce, relay write to repeat).
+ */
+bool PcChannels_settling();
+
+/**
+ * Milliseconds until the next expander read is due (UINT32_MAX = none;
+ * INT alone is enough while every expander PC is off).
+ */
+uint32_t PcChannels_msUntilPoll();
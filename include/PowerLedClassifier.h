@@ -0,0 +1,113 @@
+/**
+ * =============================================================================
+ * PowerLedClassifier.h - Power LED Waveform Classifier
+ * =============================================================================
+ *
+ * Many boards blink the power LED while the PC sleeps (S3). A plain
+ * debounced level sees that as the PC turning off and on again. This
+ * class gets every power LED edge with its timestamp and tells apart:
+ *
+ *   OFF / ON       level steady for POWER_LED_BLINK_MAX_PHASE_MS, or a
+ *                  change out of a steady level that lasts longer than
+ *                  POWER_LED_GLITCH_MS (decided after ~20 ms, not 250 ms)
+ *   SLEEP          3+ short phases with a regular period between
+ *                  POWER_LED_SLEEP_MIN_PERIOD_MS and twice the max phase
+ *   UNKNOWN_BLINK  3+ short phases that are too fast or irregular
+ *
+ *   LED  ‾‾‾‾‾‾‾‾‾‾|____|‾‾‾‾|____|‾‾‾‾|____|‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾
+ *        ON        OFF            SLEEP                ON (steady)
+ *
+ * Pulses shorter than POWER_LED_GLITCH_MS are dropped. Until a blink is
+ * recognised the last decision is kept, so entering sleep from ON shows a
+ * short OFF first.
+ *
+ * The class only sees timestamps (no GPIO, no clock), so a recorded trace
+ * can be replayed through it off the device.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Histogram.h"
+
+enum class PowerLedSignal : uint8_t {
+  OFF = 0,
+  ON,
+  SLEEP,
+  UNKNOWN_BLINK,
+};
+
+static constexpr size_t POWER_LED_SIGNAL_COUNT = 4;
+
+/**
+ * Metric label for a signal ("off", "on", "sleep", "unknown_blink").
+ */
+const char *powerLedSignalName(PowerLedSignal signal);
+
+class PowerLedClassifier {
+public:
+  PowerLedClassifier();
+
+  /**
+   * Start over with a steady level (no decision latency recorded).
+   */
+  void reset(bool active, int64_t nowUs);
+
+  /**
+   * Feed one edge. `active` is the level after the edge; an edge that
+   * repeats the current level (opposite edge lost) is ignored.
+   */
+  void onEdge(int64_t tUs, bool active);
+
+  /**
+   * Re-evaluate at `nowUs` (steady levels are only recognised by time
+   * passing). Call after feeding edges and periodically.
+   *
+   * @return Current decision
+   */
+  PowerLedSignal update(int64_t nowUs);
+
+  PowerLedSignal signal() const { return current; }
+
+  /**
+   * LED level of the current phase (glitches removed).
+   */
+  bool level() const { return phases[phaseCount - 1].active; }
+
+  /**
+   * True while a change out of a steady level waits for POWER_LED_GLITCH_MS.
+   */
+  bool pending(int64_t nowUs) const;
+
+  /**
+   * Last measured blink period and on-time share (0 = no blink seen).
+   */
+  uint32_t blinkPeriodMs() const { return lastPeriodMs; }
+  uint16_t blinkDutyPermille() const { return lastDutyPermille; }
+
+  /**
+   * Time from the first edge of a pattern to the decision, per signal (µs).
+   */
+  const LatencyHistogram &latency(PowerLedSignal signal) const;
+
+private:
+  struct Phase {
+    int64_t startUs;
+    bool active;
+  };
+
+  static constexpr uint8_t MAX_PHASES = 6;
+
+  int64_t phaseDurationUs(uint8_t index) const;
+  uint8_t shortPhasesBeforeCurrent() const;
+  PowerLedSignal classifyBlink();
+
+  Phase phases[MAX_PHASES];
+  uint8_t phaseCount = 0;           // Oldest first; last entry is the current phase
+  PowerLedSignal current = PowerLedSignal::OFF;
+  uint32_t lastPeriodMs = 0;
+  uint16_t lastDutyPermille = 0;
+  LatencyHistogram latencies[POWER_LED_SIGNAL_COUNT];
+};
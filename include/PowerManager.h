@@ -0,0 +1,136 @@
+/**
+ * =============================================================================
+ * PowerManager.h - Dynamic Frequency Scaling & Automatic Light Sleep
+ * =============================================================================
+ *
+ * Configures esp_pm so the CPU scales down and enters light sleep whenever
+ * every task is blocked, and holds the CPU at full speed only while there
+ * is latency-sensitive work:
+ *
+ *   Hold     Held while
+ *   ──────   ─────────────────────────────────────────
+ *   relay    a power/reset relay is closed
+ *   http     an HTTP request is being handled
+ *   ota      an OTA check or download is running
+ *
+ * Each hold is reference-counted, so nested or concurrent users are fine.
+ *
+ * WAKE SOURCES:
+ *   The power LED, HDD LED and factory button pins are armed as GPIO
+ *   wake sources. Light sleep only supports level wakeups, so each pin is
+ *   armed for the level opposite to its current one and re-armed in its
+ *   ISR - this acts as an any-edge interrupt that also works in sleep.
+ *   Power LED and button edges release the control task early, so its
+ *   period can be stretched while nothing is pending.
+ *
+ * If the SDK was built without power management (ESP_ERR_NOT_SUPPORTED),
+ * setup falls back to DFS only, then to fixed frequency; holds keep
+ * their statistics but do nothing else.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Histogram.h"
+
+/**
+ * Reasons for holding the CPU at maximum frequency.
+ */
+enum class PowerHold : uint8_t {
+  RELAY = 0,
+  HTTP,
+  OTA,
+  COUNT
+};
+
+constexpr size_t POWER_HOLD_COUNT = static_cast<size_t>(PowerHold::COUNT);
+
+/**
+ * Configure DFS / light sleep and create the PM locks.
+ * Call once in setup(), before any hold is acquired.
+ */
+void PowerManager_setup();
+
+/**
+ * True if dynamic frequency scaling is active.
+ */
+bool PowerManager_dfsEnabled();
+
+/**
+ * True if automatic light sleep is active.
+ */
+bool PowerManager_lightSleepEnabled();
+
+/**
+ * Acquire / release one reference of `hold`. Safe from any task.
+ */
+void PowerManager_acquire(PowerHold hold);
+void PowerManager_release(PowerHold hold);
+
+/**
+ * Name of `hold` (used as Prometheus label).
+ */
+const char *PowerManager_holdName(PowerHold hold);
+
+/**
+ * Current reference count of `hold`.
+ */
+uint32_t PowerManager_holdCount(PowerHold hold);
+
+/**
+ * Total time (µs) `hold` has been held since boot.
+ */
+uint64_t PowerManager_holdUs(PowerHold hold);
+
+/**
+ * Total time (µs) with at least one hold (CPU pinned at max frequency).
+ * The rest of the uptime the CPU was free to scale down or sleep.
+ */
+uint64_t PowerManager_pinnedUs();
+
+/**
+ * Use `pin` as a light-sleep wake source (level opposite to its current
+ * state). The pin's interrupt becomes level-triggered; its ISR must call
+ * PowerManager_rearmWakeFromIsr(). No-op without light sleep.
+ */
+void PowerManager_enableGpioWake(uint8_t pin);
+
+/**
+ * Re-arm `pin` for the opposite level. Call first thing in the ISR of
+ * every pin passed to PowerManager_enableGpioWake().
+ */
+void IRAM_ATTR PowerManager_rearmWakeFromIsr(uint8_t pin);
+
+/**
+ * Timestamp an edge that should wake the control task, for the
+ * wake-latency histogram (only the first edge per tick is kept).
+ */
+void IRAM_ATTR PowerManager_markEdgeFromIsr();
+
+/**
+ * Record the latency from the oldest pending wake edge to now.
+ * Call at the start of the task that handles the edges (control task).
+ */
+void PowerManager_recordWake();
+
+/**
+ * Edge-to-task latency histogram.
+ */
+const LatencyHistogram &PowerManager_wakeLatency();
+
+/**
+ * Holds `hold` for the lifetime of the scope.
+ */
+class PowerHoldGuard {
+public:
+  explicit PowerHoldGuard(PowerHold hold) : hold_(hold) { PowerManager_acquire(hold_); }
+  ~PowerHoldGuard() { PowerManager_release(hold_); }
+
+private:
+  PowerHoldGuard(const PowerHoldGuard &) = delete;
+  PowerHoldGuard &operator=(const PowerHoldGuard &) = delete;
+
+  PowerHold hold_;
+};
@@ -0,0 +1,101 @@
+/**
+ * =============================================================================
+ * Profiler.h - Per-Subsystem Timing Histograms
+ * =============================================================================
+ *
+ * Measures how long each stage of the task ticks and each async web
+ * handler takes, using the esp_timer microsecond clock (the CPU cycle
+ * counter is unusable once DFS changes the clock), and keeps a
+ * fixed-bucket histogram (p50/p99/max, overruns) per stage.
+ *
+ * USAGE:
+ *
+ *   {
+ *     ProfileScope scope(ProfileStage::MQTT);
+ *     MqttHandler_loop();
+ *   }
+ *
+ * Results are served as JSON at GET /api/debug/profile and as Prometheus
+ * histograms on /metrics.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "Histogram.h"
+
+/**
+ * Instrumented stages. Keep in sync with the name/budget table in Profiler.cpp.
+ */
+enum class ProfileStage : uint8_t {
+  // control task
+  FACTORY_RESET = 0,
+  COMMANDS,
+  PC_CONTROL,
+  HDD_SENSE,
+  PC_CHANNELS,
+  // network task
+  NETWORKING,
+  DNS_SERVER,
+  WEB_HOUSEKEEPING,
+  MQTT,
+  STATUS_PUBLISH,
+  REACHABILITY,
+  // telemetry task
+  SENSORS,
+  LOKI,
+  HEALTH,
+  // async web handlers (AsyncTCP task)
+  HTTP_STATUS,
+  HTTP_METRICS,
+  HTTP_CONFIG,
+  WS_EVENT,
+  COUNT
+};
+
+constexpr size_t PROFILE_STAGE_COUNT = static_cast<size_t>(ProfileStage::COUNT);
+
+/**
+ * Apply the per-stage budgets. Call once in setup().
+ */
+void Profiler_setup();
+
+/**
+ * Record one execution of `stage` that took `us` microseconds.
+ */
+void Profiler_recordUs(ProfileStage stage, uint32_t us);
+
+/**
+ * Stage name used in JSON and as Prometheus label.
+ */
+const char *Profiler_stageName(ProfileStage stage);
+
+/**
+ * Histogram for `stage` (read-only).
+ */
+const LatencyHistogram &Profiler_histogram(ProfileStage stage);
+
+/**
+ * Current CPU frequency (MHz); varies when DFS is active.
+ */
+uint32_t Profiler_cpuMHz();
+
+/**
+ * Times the enclosing scope and records it on destruction.
+ */
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfileStage stage)
+      : stage_(stage), startUs_(esp_timer_get_time()) {}
+  ~ProfileScope() { Profiler_recordUs(stage_, static_cast<uint32_t>(esp_timer_get_time() - startUs_)); }
+
+private:
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+  ProfileStage stage_;
+  int64_t startUs_;
+};
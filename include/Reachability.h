@@ -0,0 +1,94 @@
+/**
+ * =============================================================================
+ * Reachability.h - Network Probing of the Managed PC
+ * =============================================================================
+ *
+ * The LEDs can't tell a booted OS from a frozen one: both show RUNNING.
+ * This module probes the PC's IP address with ICMP echo and/or TCP
+ * connects to configured ports and adds a second status dimension:
+ *
+ *   UNKNOWN       not probing (no address, PC off/asleep, WiFi down) or
+ *                 still booting without an answer
+ *   RESPONSIVE    the last probe round got an answer
+ *   UNRESPONSIVE  PROBE_FAIL_THRESHOLD rounds in a row went unanswered
+ *                 while the PC was RUNNING
+ *
+ * A round sends one echo and starts one connect per port at once; the
+ * first answer ends it. A refused connect (RST) counts as an answer: the
+ * PC's network stack is alive. Rounds are scheduled adaptively:
+ *
+ *   BOOTING                  every PROBE_BOOT_INTERVAL_MS
+ *   RUNNING, responsive      every PROBE_STEADY_INTERVAL_MS
+ *   RUNNING, failing         every PROBE_SUSPECT_INTERVAL_MS (confirm fast)
+ *   UNRESPONSIVE             doubling up to PROBE_BACKOFF_MAX_MS
+ *
+ * Sockets are non-blocking and polled from the network task, so a dead
+ * PC never stalls anything. The address must be an IPv4 literal (a DNS
+ * lookup would block).
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Histogram.h"
+
+enum class PcReachability : uint8_t {
+  UNKNOWN = 0,
+  RESPONSIVE,
+  UNRESPONSIVE,
+};
+
+enum class ProbeMethod : uint8_t {
+  ICMP = 0,
+  TCP,
+};
+
+enum class ProbeResult : uint8_t {
+  OK = 0,     // Echo reply, connect or refused connect
+  TIMEOUT,
+  ERROR,      // Socket error (e.g. no route)
+};
+
+static constexpr size_t PROBE_METHOD_COUNT = 2;
+static constexpr size_t PROBE_RESULT_COUNT = 3;
+
+/**
+ * Status / metric names ("UNKNOWN"...; "icmp", "tcp"; "ok", "timeout", "error").
+ */
+const char *Reachability_name(PcReachability reachability);
+const char *Reachability_methodName(ProbeMethod method);
+const char *Reachability_resultName(ProbeResult result);
+
+struct ReachabilityStats {
+  bool enabled;                      // Probe address configured
+  PcReachability reachability;
+  uint8_t failures;                  // Unanswered rounds in a row
+  uint32_t intervalMs;               // Current round interval
+  uint32_t lastRttUs;                // Last answer (0 = none yet)
+  uint32_t lastAnswerMs;             // millis() of the last answer (0 = never)
+  uint32_t rounds;
+  uint32_t unresponsiveTotal;        // Transitions to UNRESPONSIVE
+  uint32_t probes[PROBE_METHOD_COUNT][PROBE_RESULT_COUNT];
+};
+
+/**
+ * Parse the probe settings from g_config. Call once in setup().
+ */
+void Reachability_setup();
+
+/**
+ * Poll sockets of a round in flight. Call from the network task.
+ */
+void Reachability_loop();
+
+/**
+ * Consistent copy of the counters. Safe from any task.
+ */
+ReachabilityStats Reachability_stats();
+
+/**
+ * Round-trip time of answered probes, per method (µs).
+ */
+const LatencyHistogram &Reachability_rtt(ProbeMethod method);
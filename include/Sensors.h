@@ -0,0 +1,125 @@
+/**
+ * =============================================================================
+ * Sensors.h - I2C Sensors (Registry, Scheduler, Publishing)
+ * =============================================================================
+ *
+ * At boot the bus is scanned for every chip in the driver registry
+ * (Sensors.cpp); each one found gets a driver (include/sensors/):
+ *
+ *   TMP112          0x48-0x4B   temperature
+ *   SHT3x           0x44-0x45   temperature, humidity
+ *   INA226, INA219  0x40-0x4F   bus voltage, current, power
+ *
+ * Ranges overlap, so each driver checks an ID register, a CRC or fixed
+ * register bits before it claims an address. The board's own TMP112
+ * (0x48) is always registered, so it is probed again if it did not
+ * answer at boot.
+ *
+ * SCHEDULING:
+ *   Sensors_sample() runs every SENSOR_TICK_MS in the telemetry task. It
+ *   collects every sensor whose own interval (its rate limit, matched to
+ *   the chip's conversion time) has passed and reads them back to back
+ *   under one I2cLock, so a tick costs one bus acquisition however many
+ *   sensors are due.
+ *
+ * ERRORS:
+ *   After I2C_ERROR_LIMIT failed reads of one sensor in a row the bus is
+ *   recovered (at most once per batch) and the sensor reprogrammed. If
+ *   that fails it is offline: its values are NAN and it is probed every
+ *   SENSOR_OFFLINE_RETRY_MS.
+ *
+ * PUBLISHING:
+ *   Every value goes into the status snapshot (/api/status, WebSocket,
+ *   MQTT with Home Assistant discovery) and /metrics without
+ *   per-sensor code. `temperature` is the first temperature sensor.
+ *
+ * PC POWER DRAW:
+ *   The first power monitor found measures the PC's PSU. Its wattage,
+ *   with hysteresis (PC_POWER_ON_WATTS / PC_POWER_OFF_WATTS), is a power
+ *   state signal that does not depend on the power LED; a change that
+ *   disagrees with the LED is logged.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Histogram.h"
+
+enum class SensorQuantity : uint8_t {
+  TEMPERATURE = 0,  // °C
+  HUMIDITY,         // % RH
+  VOLTAGE,          // V
+  CURRENT,          // A
+  POWER,            // W
+  COUNT
+};
+
+constexpr size_t SENSOR_QUANTITY_COUNT = static_cast<size_t>(SensorQuantity::COUNT);
+constexpr size_t SENSOR_VALUES_MAX = 3;
+
+// One sensor as published in the status snapshot
+struct SensorStatus {
+  const char *id = "";            // "tmp112_48" (static for the sensor's lifetime)
+  const char *model = "";
+  uint8_t address = 0;
+  bool online = false;
+  uint8_t valueCount = 0;
+  SensorQuantity quantities[SENSOR_VALUES_MAX] = {};
+  float values[SENSOR_VALUES_MAX] = {NAN, NAN, NAN};  // NAN while offline
+};
+
+struct SensorStats {
+  bool online;
+  uint32_t reads;
+  uint32_t errors;
+};
+
+/**
+ * Scan the bus and program every sensor found. Call once after
+ * I2cBus_setup().
+ */
+void Sensors_setup();
+
+/**
+ * Read the sensors that are due and publish. Call every SENSOR_TICK_MS
+ * from the telemetry task.
+ */
+void Sensors_sample();
+
+size_t Sensors_count();
+
+/**
+ * Latest values of sensor `index` (also in the status snapshot).
+ */
+SensorStatus Sensors_status(size_t index);
+
+SensorStats Sensors_stats(size_t index);
+
+/**
+ * Duration of one read of sensor `index` (µs), all its registers.
+ */
+const LatencyHistogram &Sensors_readLatency(size_t index);
+
+/**
+ * "temperature", "humidity", "voltage", "current", "power" (JSON keys,
+ * Home Assistant device classes).
+ */
+const char *Sensors_quantityName(SensorQuantity quantity);
+
+/**
+ * Prometheus base unit: "celsius", "percent", "volts", "amperes", "watts".
+ */
+const char *Sensors_quantityUnit(SensorQuantity quantity);
+
+/**
+ * Display unit: "°C", "%", "V", "A", "W".
+ */
+const char *Sensors_quantitySymbol(SensorQuantity quantity);
+
+/**
+ * Smallest change worth a status publish.
+ */
+float Sensors_publishDelta(SensorQuantity quantity);
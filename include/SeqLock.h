@@ -0,0 +1,100 @@
+/**
+ * =============================================================================
+ * SeqLock.h - Consistent Snapshots of Plain-Data Structs Across Tasks
+ * =============================================================================
+ *
+ * A sequence lock around one POD value. Writers bump the sequence to an
+ * odd value, copy, and bump it back to even; readers copy without taking
+ * any lock and retry if the sequence was odd or moved during the copy.
+ *
+ *   SeqLock<StatusSnapshot> g_statusSnapshot;
+ *
+ *   // writer (owner task), only the fields it owns
+ *   g_statusSnapshot.update([](StatusSnapshot &s) { s.pcState = ...; });
+ *
+ *   // reader (any task)
+ *   StatusSnapshot s = g_statusSnapshot.read();
+ *
+ * Writers copy inside a short critical section. On the single-core C3
+ * that also means a reader can never preempt a half-finished write, so
+ * a read retries at most when a writer preempted the reader itself.
+ *
+ * T must be trivially copyable (no String) and should stay small; the
+ * whole value is copied on every read and write.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include <type_traits>
+
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a plain-data type");
+
+public:
+  SeqLock() : data_() {}
+
+  /**
+   * Replace the whole value.
+   */
+  void write(const T &value) {
+    portENTER_CRITICAL(&mux_);
+    beginWrite();
+    memcpy(&data_, &value, sizeof(T));
+    endWrite();
+    portEXIT_CRITICAL(&mux_);
+  }
+
+  /**
+   * Modify part of the value in place: fn(T &) runs inside the critical
+   * section, so it must only assign fields (no allocation, no blocking).
+   */
+  template <typename Fn>
+  void update(Fn fn) {
+    portENTER_CRITICAL(&mux_);
+    beginWrite();
+    fn(data_);
+    endWrite();
+    portEXIT_CRITICAL(&mux_);
+  }
+
+  /**
+   * Consistent copy of the value. Never blocks.
+   */
+  T read() const {
+    T copy;
+    uint32_t before;
+    do {
+      before = seq_.load(std::memory_order_acquire);
+      memcpy(&copy, &data_, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((before & 1U) != 0 || before != seq_.load(std::memory_order_relaxed));
+    return copy;
+  }
+
+  /**
+   * Number of completed writes; changes whenever the value may have.
+   */
+  uint32_t version() const {
+    return seq_.load(std::memory_order_acquire) >> 1;
+  }
+
+private:
+  void beginWrite() {
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void endWrite() {
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  std::atomic<uint32_t> seq_{0};
+  T data_;
+  portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+};
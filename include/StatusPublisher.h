@@ -0,0 +1,61 @@
+/**
+ * =============================================================================
+ * StatusPublisher.h - Change-Driven Status Publishing
+ * =============================================================================
+ *
+ * Tracks which parts of RuntimeState changed since the last publish and
+ * pushes status to WebSocket clients and MQTT only when something did.
+ *
+ *   - Changes are coalesced: at most one publish per STATUS_COALESCE_MS
+ *   - A heartbeat republishes everything every STATUS_HEARTBEAT_MS
+ *   - Noisy values (heap, CPU, temperature) use change thresholds
+ *
+ * Field groups match the keys of the status JSON, so consumers can later
+ * serialize only what changed.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * Status field groups (bitmask).
+ */
+namespace StatusField {
+constexpr uint32_t IDENTITY     = 1UL << 0;  // hostname, deviceId, fwVersion
+constexpr uint32_t NETWORK      = 1UL << 1;  // apMode, wifiConnected, ssid, ip, rssi
+constexpr uint32_t PC_STATE     = 1UL << 2;  // pcState, reachability
+constexpr uint32_t RELAYS       = 1UL << 3;  // powerRelayActive, resetRelayActive
+constexpr uint32_t TEMPERATURE  = 1UL << 4;  // temperature
+constexpr uint32_t LED_RAW      = 1UL << 5;  // pwrLedRaw, hddLedRaw
+constexpr uint32_t HDD_ACTIVITY = 1UL << 6;  // hddLastActiveSec, pin4LastChangeSec, hddActivity*
+constexpr uint32_t SYSTEM       = 1UL << 7;  // freeHeap, totalHeap, cpuLoad
+constexpr uint32_t SECURITY     = 1UL << 8;  // csrfToken
+constexpr uint32_t OTA          = 1UL << 9;  // ota object
+constexpr uint32_t SENSORS      = 1UL << 10; // sensors, pcPowerWatts, pcPowerDraw
+constexpr uint32_t ALL          = 0xFFFFFFFFUL;
+}  // namespace StatusField
+
+/**
+ * Take the initial snapshot. Call once in setup() after other modules.
+ */
+void StatusPublisher_setup();
+
+/**
+ * Detect changes and publish if due.
+ * Call from the network task (MQTT publishing is not thread-safe).
+ */
+void StatusPublisher_loop();
+
+/**
+ * Flag fields as changed for state that cannot be diffed from
+ * RuntimeState (e.g. OTA progress). Safe to call from any task.
+ */
+void StatusPublisher_markDirty(uint32_t fields);
+
+/**
+ * Number of publishes since boot (change-driven + heartbeat).
+ */
+uint32_t StatusPublisher_publishCount();
@@ -0,0 +1,104 @@
+/**
+ * =============================================================================
+ * TaskScheduler.h - Prioritized Periodic FreeRTOS Tasks
+ * =============================================================================
+ *
+ * Runs the firmware's periodic work in separate FreeRTOS tasks instead of
+ * one shared Arduino loop(), so a blocking network call can never delay
+ * relay release or LED sensing.
+ *
+ *   Task        Priority   Work
+ *   ─────────   ────────   ──────────────────────────────────────────
+ *   control     highest    PC controller, HDD sensing, factory button
+ *   network     medium     WiFi, web server, MQTT
+ *   telemetry   lowest     Loki, metrics, heap/CPU stats
+ *
+ * Each task has a period and a deadline (both in ms). A tick that finishes
+ * later than release time + deadline is counted as a missed deadline.
+ *
+ * The period can be changed at runtime (e.g. stretched while idle so the
+ * CPU can sleep), and an ISR can release a task early with
+ * TaskScheduler_wakeFromIsr(); an early release counts as release time.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+// Maximum number of tasks the scheduler can manage
+constexpr size_t TASK_SCHEDULER_MAX_TASKS = 4;
+
+/**
+ * Static description of a periodic task.
+ */
+struct SchedulerTaskConfig {
+  const char *name;          // Task name (also used as metrics label)
+  void (*tick)();            // Work function, called once per period
+  uint32_t periodMs;         // Release period
+  uint32_t deadlineMs;       // Relative deadline (from release time)
+  uint32_t stackSize;        // FreeRTOS stack size (bytes)
+  UBaseType_t priority;      // FreeRTOS priority (higher = more urgent)
+};
+
+/**
+ * Runtime statistics for one task (read-only snapshot).
+ */
+struct SchedulerTaskStats {
+  const char *name = "";
+  uint32_t periodMs = 0;
+  uint32_t deadlineMs = 0;
+  uint32_t runs = 0;           // Completed ticks
+  uint32_t missedDeadlines = 0; // Ticks that finished after their deadline
+  uint32_t lastExecUs = 0;     // Execution time of the last tick
+  uint32_t maxExecUs = 0;      // Longest execution time seen
+  uint32_t maxLatenessUs = 0;  // Worst finish time past the deadline
+};
+
+/**
+ * Register a periodic task. Must be called before TaskScheduler_start().
+ *
+ * @return Task index, or -1 if the task table is full
+ */
+int TaskScheduler_addTask(const SchedulerTaskConfig &config);
+
+/**
+ * Create all registered tasks. Each task registers itself with the
+ * task watchdog and feeds it once per tick.
+ */
+void TaskScheduler_start();
+
+/**
+ * Change the release period of task `index`; takes effect from the
+ * next wait. The configured period (stats) is unchanged.
+ */
+void TaskScheduler_setPeriodMs(size_t index, uint32_t periodMs);
+
+/**
+ * Release task `index` immediately (from task context).
+ */
+void TaskScheduler_wake(size_t index);
+
+/**
+ * Release task `index` immediately (from an ISR).
+ */
+void IRAM_ATTR TaskScheduler_wakeFromIsr(size_t index);
+
+/**
+ * Number of registered tasks.
+ */
+size_t TaskScheduler_taskCount();
+
+/**
+ * Copy the statistics of task `index` into `out`.
+ *
+ * @return false if index is out of range
+ */
+bool TaskScheduler_getStats(size_t index, SchedulerTaskStats &out);
+
+/**
+ * Total execution time (µs) of all tasks since the previous call.
+ * Used to derive the CPU load percentage.
+ */
+uint32_t TaskScheduler_takeBusyUs();
@@ -0,0 +1,139 @@
+/**
+ * =============================================================================
+ * TimerService.h - Hierarchical Timing Wheel on a 64-bit Monotonic Clock
+ * =============================================================================
+ *
+ * Replaces hand-rolled "millis() - lastXMs > N" polling with registered
+ * callbacks. Timers are intrusive (the module owns the Timer object, usually
+ * as a static), so arming never allocates.
+ *
+ *   Level   Slot width   Range
+ *   ─────   ──────────   ──────────
+ *   0       1 ms         64 ms
+ *   1       64 ms        4.1 s
+ *   2       4.1 s        4.4 min
+ *   3       4.4 min      4.7 h      (longer timers are re-cascaded)
+ *
+ * Arm and cancel are O(1). advance() processes only slots that can hold
+ * due timers and skips empty stretches in bulk.
+ *
+ * THREADING:
+ *   Each scheduler task owns one wheel (g_controlTimers, g_networkTimers,
+ *   g_telemetryTimers in main.cpp) and calls advance() at the start of its
+ *   tick, so callbacks always run in the owner task. arm()/cancel() are
+ *   safe from any task.
+ *
+ * CLOCK:
+ *   TimerService_nowMs() is 64-bit and derived from esp_timer, so it does
+ *   not wrap like the 32-bit millis() does after 49.7 days.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+/**
+ * Monotonic milliseconds since boot (64-bit, never wraps in practice).
+ */
+inline uint64_t TimerService_nowMs() {
+  return static_cast<uint64_t>(esp_timer_get_time()) / 1000ULL;
+}
+
+typedef void (*TimerCallback)(void *arg);
+
+/**
+ * A timer owned by the caller. Must outlive its arming (use static storage).
+ */
+class Timer {
+public:
+  Timer() {}
+
+  /**
+   * True while the timer is waiting to fire.
+   */
+  bool armed() const { return armed_; }
+
+  /**
+   * Absolute deadline (TimerService_nowMs() time base).
+   */
+  uint64_t deadlineMs() const { return deadlineMs_; }
+
+private:
+  friend class TimerWheel;
+  Timer(const Timer &) = delete;
+  Timer &operator=(const Timer &) = delete;
+
+  TimerCallback callback_ = nullptr;
+  void *arg_ = nullptr;
+  uint64_t deadlineMs_ = 0;
+  uint32_t periodMs_ = 0;     // 0 = one-shot
+  Timer *prev_ = nullptr;
+  Timer *next_ = nullptr;
+  uint8_t level_ = 0;
+  uint8_t slot_ = 0;
+  bool armed_ = false;
+};
+
+class TimerWheel {
+public:
+  static constexpr uint8_t LEVELS = 4;
+  static constexpr uint8_t SLOT_BITS = 6;
+  static constexpr uint8_t SLOTS = 1 << SLOT_BITS;
+
+  /**
+   * Anchor the wheel at the current time. Call once before arming.
+   */
+  void begin();
+
+  /**
+   * Fire `callback(arg)` once after `delayMs`. Re-arming an armed timer
+   * moves its deadline.
+   */
+  void arm(Timer &timer, uint32_t delayMs, TimerCallback callback, void *arg = nullptr);
+
+  /**
+   * Fire `callback(arg)` every `periodMs` (first time after one period).
+   * Periodic timers keep a drift-free schedule unless they fall behind.
+   */
+  void armPeriodic(Timer &timer, uint32_t periodMs, TimerCallback callback, void *arg = nullptr);
+
+  /**
+   * Disarm a timer. No-op if it is not armed.
+   */
+  void cancel(Timer &timer);
+
+  /**
+   * Run the callbacks of all timers that are due. Call from the owner task.
+   *
+   * @return Number of callbacks run
+   */
+  uint32_t advance();
+
+  /**
+   * Milliseconds until the earliest timer may fire (exact on level 0, a
+   * lower bound beyond 64 ms), or UINT32_MAX if nothing is armed.
+   */
+  uint32_t msUntilNext() const;
+
+  /**
+   * Number of armed timers.
+   */
+  uint32_t armedCount() const { return armedCount_; }
+
+private:
+  void armInternal(Timer &timer, uint64_t deadlineMs, uint32_t periodMs,
+                   TimerCallback callback, void *arg);
+  void insertLocked(Timer &timer);
+  void unlinkLocked(Timer &timer);
+  void cascadeLocked(uint8_t level);
+  bool emptyLocked() const;
+
+  Timer *slots_[LEVELS][SLOTS] = {};
+  uint64_t occupied_[LEVELS] = {};   // Bit n set = slot n non-empty
+  uint64_t currentMs_ = 0;           // Last processed tick
+  uint32_t armedCount_ = 0;
+  mutable portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+};
@@ -0,0 +1,135 @@
+/**
+ * =============================================================================
+ * WsClients.h - Per-Client State for /ws
+ * =============================================================================
+ *
+ * AsyncWebSocket only knows a client's id. This registry adds what the
+ * broadcast path needs per client: the encoding negotiated in the
+ * handshake (see WsCodec.h), the topics the client subscribed to, and
+ * whether it may send commands.
+ *
+ *   handshake (subprotocol, Basic auth) ──► WsClients_offer(tcp, encoding, authenticated)
+ *   WS_EVT_CONNECT                      ──► WsClients_add(id, tcp)
+ *   {"type":"auth","password":...}      ──► WsClients_authenticate(id)
+ *   {"type":"subscribe",...}            ──► WsClients_subscribe(id, topics)
+ *   WS_EVT_DISCONNECT                   ──► WsClients_remove(id)
+ *
+ * The handshake and the connect event both see the client's TCP
+ * connection (AsyncClient), which links the two; an offer that is not
+ * picked up within a second is dropped.
+ *
+ * TOPICS:
+ *   The status document is split into topics by key (WsStatusStream.h);
+ *   action logs are one more. A new client is subscribed to everything
+ *   at full rate until it sends a subscribe message, which replaces its
+ *   whole subscription:
+ *
+ *     {"type":"subscribe","topics":{"pc":{"maxRate":1},"logs":{}}}
+ *
+ *   maxRate is in messages per second (absent or 0 = every message). A
+ *   rate-limited client gets the topic's current snapshot when it is due
+ *   instead of each delta; log entries over its rate are dropped.
+ *
+ * THREADING:
+ *   Updated from AsyncTCP callbacks, read by the network task when it
+ *   broadcasts. A spinlock guards the table; readers take copies.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "WsCodec.h"
+
+enum class WsTopic : uint8_t {
+  DEVICE,   // Identity, WiFi, heap/CPU, CSRF token (every key not below)
+  PC,       // pcState, reachability, hang watch, relays, channels
+  HDD,      // HDD LED and activity
+  SENSORS,  // temperature, sensors, PC power
+  OTA,      // ota object
+  LOGS,     // Action log entries
+};
+constexpr size_t WS_TOPIC_COUNT = 6;
+constexpr size_t WS_STATUS_TOPIC_COUNT = 5;  // DEVICE..OTA carry status keys
+
+struct WsSubscription {
+  bool active;
+  uint32_t minIntervalMs;  // 0 = every message
+  uint32_t lastSentMs;     // Rate-limited: last message sent
+  uint32_t seq;            // Rate-limited status topic: sequence number sent
+};
+
+struct WsClientInfo {
+  uint32_t id;
+  WsEncoding encoding;
+  bool authenticated;  // May send commands and read the config
+  WsSubscription topics[WS_TOPIC_COUNT];
+};
+
+const char *WsTopic_name(WsTopic topic);
+
+/**
+ * Topic by name ("device", "pc", "hdd", "sensors", "ota", "logs").
+ *
+ * @return false if unknown
+ */
+bool WsTopic_parse(const char *name, WsTopic *out);
+
+/**
+ * Remember the encoding a connection asked for in its handshake, and
+ * whether the handshake carried valid credentials.
+ */
+void WsClients_offer(const void *tcp, WsEncoding encoding, bool authenticated);
+
+/**
+ * Register a connected client, with the encoding and authentication
+ * offered on `tcp` (JSON, unauthenticated if none), subscribed to every
+ * topic.
+ *
+ * @return false if the table is full (the caller closes the client)
+ */
+bool WsClients_add(uint32_t id, const void *tcp);
+
+void WsClients_remove(uint32_t id);
+
+/**
+ * Mark client `id` authenticated for the rest of its connection.
+ */
+void WsClients_authenticate(uint32_t id);
+
+/**
+ * Replace the subscriptions of client `id` (only `active` and
+ * `minIntervalMs` are used).
+ */
+void WsClients_subscribe(uint32_t id, const WsSubscription topics[WS_TOPIC_COUNT]);
+
+/**
+ * Record that a rate-limited client was sent a message on `topic`.
+ */
+void WsClients_markSent(uint32_t id, WsTopic topic, uint32_t seq, uint32_t nowMs);
+
+/**
+ * Copy of client `id`.
+ *
+ * @return false if unknown
+ */
+bool WsClients_get(uint32_t id, WsClientInfo *out);
+
+/**
+ * Copy up to `max` clients into `out`.
+ *
+ * @return number copied
+ */
+size_t WsClients_list(WsClientInfo *out, size_t max);
+
+/**
+ * Connected clients using `encoding` (metrics).
+ */
+size_t WsClients_count(WsEncoding encoding);
+
+/**
+ * Connected clients subscribed to `topic` (metrics).
+ */
+size_t WsClients_subscribers(WsTopic topic);
@@ -0,0 +1,97 @@
+/**
+ * =============================================================================
+ * WsCodec.h - Binary (MessagePack) Encoding for /ws
+ * =============================================================================
+ *
+ * Clients that offer the WebSocket subprotocol WS_MSGPACK_SUBPROTOCOL in
+ * the handshake get every message as a binary MessagePack frame instead
+ * of JSON text. Clients without it keep getting JSON.
+ *
+ *   new WebSocket("ws://<device>/ws", "restarter.msgpack")
+ *
+ * Object keys are small integers (positive fixint, one byte) indexing a
+ * key table. The table is the first message on a binary connection and
+ * uses plain string keys, so it can be decoded without knowing it:
+ *
+ *   {"type":"keys","keys":["address","apMode",...]}
+ *   {0x..:"status", 0x..:41, ...}          key 0 = "address", 1 = "apMode"
+ *
+ * Keys missing from the table (sensor quantities added later, ...) are
+ * sent as strings; MessagePack maps allow mixed key types. Numbers keep
+ * their native type: integers in the fewest bytes, floats as float32 when
+ * that is exact. NaN and infinity become nil, like null in the JSON.
+ *
+ * Offer only this one subprotocol: the web server echoes the offered
+ * value as is.
+ *
+ * Messages from clients (subscribe, resync, ...) stay JSON text on either encoding.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+
+enum class WsEncoding : uint8_t {
+  JSON,     // Text frames, serializeJson()
+  MSGPACK,  // Binary frames, integer keys (this file)
+};
+constexpr size_t WS_ENCODING_COUNT = 2;
+
+/**
+ * Bit of `encoding` in an encoding mask (see WsStatusStream_publish()).
+ */
+inline uint8_t WsEncoding_bit(WsEncoding encoding) {
+  return static_cast<uint8_t>(1u << static_cast<uint8_t>(encoding));
+}
+
+const char *WsEncoding_name(WsEncoding encoding);
+
+struct WsCodecBenchEntry {
+  uint32_t bytes;   // Per frame
+  uint32_t cycles;  // CPU cycles per encode
+};
+
+struct WsCodecBenchResult {
+  uint32_t iterations;
+  WsCodecBenchEntry json;         // serializeJson()
+  WsCodecBenchEntry msgpack;      // serializeMsgPack(), string keys
+  WsCodecBenchEntry msgpackKeys;  // WsCodec_write(), integer keys
+};
+
+/**
+ * Build the key table frame. Call once in setup(), before the web server
+ * starts.
+ */
+void WsCodec_setup();
+
+/**
+ * Encoding requested by the Sec-WebSocket-Protocol header value.
+ */
+WsEncoding WsCodec_forSubprotocol(const String &offered);
+
+/**
+ * The {"type":"keys",...} frame; send it to a binary client first.
+ */
+AsyncWebSocketSharedBuffer WsCodec_keysFrame();
+
+/**
+ * MessagePack size of `doc` with integer keys.
+ */
+size_t WsCodec_measure(const JsonDocument &doc);
+
+/**
+ * Write `doc` as MessagePack with integer keys.
+ *
+ * @return bytes the encoding needs; nothing past `capacity` is written
+ */
+size_t WsCodec_write(const JsonDocument &doc, uint8_t *out, size_t capacity);
+
+/**
+ * Encode `doc` with each encoder and report bytes and cycles per frame
+ * (GET /api/debug/ws-codec). Takes a few milliseconds.
+ */
+WsCodecBenchResult WsCodec_benchmark(const JsonDocument &doc);
@@ -0,0 +1,71 @@
+/**
+ * =============================================================================
+ * WsFramePool.h - Shared WebSocket Frames (Serialize Once, Send to All)
+ * =============================================================================
+ *
+ * A status or log message is serialized once into a reference-counted
+ * frame; every client's send queue holds a reference to the same bytes
+ * instead of its own copy:
+ *
+ *   buildStatus ──► serialize ──► frame (refs: pool)
+ *                                   │ textAll()
+ *                                   ├──► client 1 queue (ref)
+ *                                   ├──► client 2 queue (ref)
+ *                                   └──► client n queue (ref)
+ *
+ * Status frames come from a pool of WS_FRAME_POOL_SIZE buffers of
+ * WS_FRAME_BYTES, allocated once in setup. A frame is free again when the
+ * pool holds the only reference (every client sent it). Only when all of
+ * them are still queued (slow clients) is a frame allocated from the heap;
+ * it is freed after sending and counted in the statistics.
+ *
+ * Log frames are kept for new clients (history), so their owner holds
+ * them and WsFramePool_serializeInto() reuses the storage in place once
+ * no client references it.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+
+#include "WsCodec.h"
+
+struct WsFramePoolStats {
+  uint32_t pooled;     // Frames served from the pool / reused in place
+  uint32_t allocated;  // Frames that needed a heap allocation
+};
+
+/**
+ * Allocate the pool. Call once in setup(), before the web server starts.
+ */
+void WsFramePool_setup();
+
+/**
+ * One message in each encoding; nullptr for encodings no client uses.
+ */
+struct WsFrames {
+  AsyncWebSocketSharedBuffer frame[WS_ENCODING_COUNT];
+};
+
+/**
+ * Serialize `doc` into a free frame. Safe from any task.
+ *
+ * @return the frame, or nullptr if the heap is exhausted
+ */
+AsyncWebSocketSharedBuffer WsFramePool_serialize(const JsonDocument &doc, WsEncoding encoding = WsEncoding::JSON);
+
+/**
+ * Serialize `doc` into a frame the caller keeps. The storage is reused
+ * when only the caller references it, otherwise `frame` is replaced by a
+ * new one of `capacity` bytes. Caller serializes access to `frame`.
+ *
+ * @return false if the heap is exhausted (`frame` unchanged)
+ */
+bool WsFramePool_serializeInto(AsyncWebSocketSharedBuffer &frame, const JsonDocument &doc, size_t capacity,
+                               WsEncoding encoding = WsEncoding::JSON);
+
+WsFramePoolStats WsFramePool_stats();
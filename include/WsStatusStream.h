@@ -0,0 +1,89 @@
+/**
+ * =============================================================================
+ * WsStatusStream.h - Sequenced Status Snapshots and Deltas for /ws
+ * =============================================================================
+ *
+ * The status document is split by key into topics (WsClients.h): a kiosk
+ * that only shows the PC state subscribes to "pc" and never sees sensor
+ * or heap updates. Each topic is its own stream. After a full snapshot it
+ * only carries the top-level keys whose value changed:
+ *
+ *   connect / resync ──► {"type":"status","topic":"hdd","seq":41, ...every hdd key...}
+ *   broadcast        ──► {"type":"delta","topic":"hdd","seq":42,"set":{"hddLastActiveSec":3}}
+ *                    ──► {"type":"delta","topic":"device","seq":7,"set":{...},"unset":["apPassword"]}
+ *
+ * A key's value is replaced as a whole (objects and arrays included).
+ * Sequence numbers are per topic, shared by all its subscribers, and
+ * increase by one per delta. A client that sees a gap (or a delta before
+ * any snapshot) sends {"type":"resync","topic":"hdd"} and gets the
+ * snapshot at the current sequence number.
+ *
+ * The last broadcast of a topic is kept as the base for the next diff and
+ * serves as its snapshot, so a snapshot is never newer than the deltas
+ * that follow it. It is serialized lazily, once per sequence number and
+ * encoding, when a client needs it. Rate-limited subscribers only ever
+ * get snapshots, so they share these frames too.
+ *
+ * THREADING:
+ *   WsStatusStream_publish() runs in the network task (StatusPublisher);
+ *   snapshots are taken from AsyncTCP callbacks. A mutex guards the base
+ *   documents; callers send the returned frames after it is released.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+
+#include "WsClients.h"
+#include "WsFramePool.h"
+
+struct WsStatusStreamStats {
+  uint32_t fullFrames;    // Snapshots serialized (first broadcast, connect, resync, rate limit)
+  uint32_t deltaFrames;
+  uint32_t fullBytes;
+  uint32_t deltaBytes;
+  uint32_t resyncs;       // Snapshots requested after a gap
+};
+
+/**
+ * Create the mutex. Call once in setup(), before the web server starts.
+ */
+void WsStatusStream_setup();
+
+/**
+ * Diff the keys of `topic` in `status` (a full status document) against
+ * the topic's last broadcast.
+ *
+ * @param encodings  Encodings to serialize (those of the topic's
+ *                   subscribers that get every message)
+ * @return frames for those subscribers: the full snapshot if there is no
+ *         base yet, otherwise a delta; all nullptr if nothing changed
+ */
+WsFrames WsStatusStream_publish(WsTopic topic, const JsonDocument &status, uint8_t encodings);
+
+/**
+ * Snapshot of `topic` at its current sequence number for one client.
+ *
+ * @param resync  Requested by the client after a gap (statistics)
+ * @param seq     If not null, receives the snapshot's sequence number
+ * @return nullptr before the topic's first broadcast
+ */
+AsyncWebSocketSharedBuffer WsStatusStream_snapshot(WsTopic topic, WsEncoding encoding, bool resync,
+                                                   uint32_t *seq = nullptr);
+
+/**
+ * Sequence number of the topic's last broadcast.
+ */
+uint32_t WsStatusStream_seq(WsTopic topic);
+
+/**
+ * Forget the topic's base (no subscribers left): its next broadcast is a
+ * snapshot.
+ */
+void WsStatusStream_reset(WsTopic topic);
+
+WsStatusStreamStats WsStatusStream_stats();
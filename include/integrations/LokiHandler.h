@@ -7,17 +7,12 @@
 #pragma once
 
 /**
- * Initialize Loki handler.
- * Call once in setup().
+ * Initialize Loki handler and arm the periodic push timer
+ * (every 10 seconds on the telemetry timer wheel).
+ * Call once in setup(), after the timer wheels have begun.
  */
 void LokiHandler_setup();
 
-/**
- * Push buffered logs to Loki periodically.
- * Call continuously in loop().
- */
-void LokiHandler_loop();
-
 /**
  * Log a message to Loki (and Serial).
  * @param level Log level: "DEBUG", "INFO", "WARN", "ERROR"
@@ -20,6 +20,7 @@ void MqttHandler_loop();
 
 /**
  * Publish current state to MQTT.
- * Call periodically (e.g., every 1-2 seconds).
+ * Called by StatusPublisher when power state or WiFi status changes,
+ * and on the status heartbeat.
  */
 void MqttHandler_publishState();
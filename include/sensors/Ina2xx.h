@@ -0,0 +1,64 @@
+/**
+ * =============================================================================
+ * Ina2xx.h - INA219/INA226 Current and Power Monitor Driver
+ * =============================================================================
+ *
+ * High-side current monitors at 0x40-0x4F. Wired with a shunt in the
+ * PSU's 12 V feed they measure the PC's power draw:
+ *
+ *   12 V ──► shunt (POWER_SHUNT_OHMS) ──► PC
+ *             IN+   IN-   VBUS = IN-
+ *
+ *           shunt LSB   bus LSB    bus range
+ *   INA226  2.5 µV      1.25 mV    36 V
+ *   INA219  10 µV       4 mV       32 V (±320 mV shunt)
+ *
+ * Both convert continuously with averaging, so a read only fetches the
+ * shunt and bus registers. Current and power are computed here from the
+ * shunt voltage, so no calibration register has to be programmed.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include "sensors/SensorDriver.h"
+
+class Ina2xx : public SensorDriver {
+public:
+  static constexpr uint8_t FIRST_ADDRESS = 0x40;
+  static constexpr uint8_t LAST_ADDRESS = 0x4F;
+
+  enum class Variant : uint8_t { INA219, INA226 };
+
+  /**
+   * INA226: manufacturer ID 0x5449 ("TI") and die ID 0x226x.
+   */
+  static bool detectIna226(uint8_t address);
+
+  /**
+   * INA219 (no ID register): configuration bits 15:14 and bus voltage
+   * bit 2 always read 0. Try it after every chip with a real ID.
+   */
+  static bool detectIna219(uint8_t address);
+
+  Ina2xx(uint8_t address, Variant variant) : SensorDriver(address), _variant(variant) {}
+
+  const char *model() const override { return _variant == Variant::INA226 ? "INA226" : "INA219"; }
+  uint32_t intervalMs() const override { return Config::POWER_SAMPLE_INTERVAL_MS; }
+  uint8_t valueCount() const override { return 3; }
+  SensorQuantity quantity(uint8_t index) const override {
+    return index == 0 ? SensorQuantity::VOLTAGE :
+           index == 1 ? SensorQuantity::CURRENT : SensorQuantity::POWER;
+  }
+
+  bool configure() override;
+
+  /**
+   * values[0] bus voltage (V), values[1] current (A), values[2] power (W).
+   */
+  bool read(float *values) override;
+
+private:
+  Variant _variant;
+};
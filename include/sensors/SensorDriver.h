@@ -0,0 +1,59 @@
+/**
+ * =============================================================================
+ * SensorDriver.h - Interface of an I2C Sensor Driver
+ * =============================================================================
+ *
+ * A driver only knows its chip: how to recognise it, program it and turn
+ * one set of register reads into values. Scheduling, errors, bus
+ * recovery and publishing are handled by Sensors.cpp, which also holds
+ * the registry of drivers tried during the bus scan.
+ *
+ * configure() and read() are called with the bus held (I2cLock).
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "I2cBus.h"
+#include "Sensors.h"
+
+class SensorDriver {
+public:
+  explicit SensorDriver(uint8_t address) : _address(address) {}
+  virtual ~SensorDriver() {}
+
+  uint8_t address() const { return _address; }
+
+  virtual const char *model() const = 0;
+
+  /**
+   * Shortest time between two reads (the chip's conversion time or the
+   * rate it was programmed for).
+   */
+  virtual uint32_t intervalMs() const = 0;
+
+  virtual uint8_t valueCount() const = 0;
+  virtual SensorQuantity quantity(uint8_t index) const = 0;
+
+  /**
+   * Program the chip. Called after detection, after a bus recovery and
+   * when an offline sensor answers again; the next read follows one
+   * intervalMs() later.
+   *
+   * @return true if the chip acknowledged everything
+   */
+  virtual bool configure() = 0;
+
+  /**
+   * Read one measurement.
+   *
+   * @param values  valueCount() values, in quantity() order
+   * @return false on a bus error (values unchanged)
+   */
+  virtual bool read(float *values) = 0;
+
+protected:
+  uint8_t _address;
+};
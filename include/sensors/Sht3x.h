@@ -0,0 +1,47 @@
+/**
+ * =============================================================================
+ * Sht3x.h - SHT30/SHT31/SHT35 Humidity Sensor Driver
+ * =============================================================================
+ *
+ * Temperature (±0.2°C) and relative humidity (±2 %RH), I2C address 0x44
+ * (ADDR low) or 0x45.
+ *
+ * The sensor runs in periodic mode at 1 measurement per second; a read
+ * fetches the latest result, so nothing waits for a conversion. Both
+ * values are protected by a CRC-8, which is also how the chip is told
+ * apart from an INA2xx at the same address.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include "sensors/SensorDriver.h"
+
+class Sht3x : public SensorDriver {
+public:
+  static constexpr uint8_t FIRST_ADDRESS = 0x44;
+  static constexpr uint8_t LAST_ADDRESS = 0x45;
+
+  /**
+   * Stop a periodic measurement left running by the previous boot, then
+   * read the status register and check its CRC.
+   */
+  static bool detect(uint8_t address);
+
+  explicit Sht3x(uint8_t address) : SensorDriver(address) {}
+
+  const char *model() const override { return "SHT3x"; }
+  uint32_t intervalMs() const override { return Config::HUMIDITY_SAMPLE_INTERVAL_MS; }
+  uint8_t valueCount() const override { return 2; }
+  SensorQuantity quantity(uint8_t index) const override {
+    return index == 0 ? SensorQuantity::TEMPERATURE : SensorQuantity::HUMIDITY;
+  }
+
+  bool configure() override;
+
+  /**
+   * Fetch the latest measurement: values[0] °C, values[1] %RH.
+   */
+  bool read(float *values) override;
+};
@@ -0,0 +1,72 @@
+/**
+ * =============================================================================
+ * Tmp112.h - TMP112 Temperature Sensor Driver
+ * =============================================================================
+ *
+ * TMP112 SPECIFICATIONS:
+ *   - Temperature range: -40°C to +125°C
+ *   - Resolution: 0.0625°C (12-bit)
+ *   - Accuracy: ±0.5°C (typical)
+ *   - I2C address: 0x48 (default), can be 0x49, 0x4A, or 0x4B
+ *
+ * WIRING:
+ *   TMP112        ESP32
+ *   ──────        ─────
+ *   VCC    ───→   3.3V
+ *   GND    ───→   GND
+ *   SDA    ───→   GPIO 0 (PIN_I2C_SDA)
+ *   SCL    ───→   GPIO 1 (PIN_I2C_SCL)
+ *   ALERT  ───→   (optional, open drain, active low)
+ *
+ * The board's own TMP112 monitors the ambient temperature near the PC,
+ * which is displayed on the web interface.
+ *
+ * SAMPLING:
+ *   configure() programs the sensor's conversion rate to match
+ *   TEMP_SAMPLE_INTERVAL_MS, so each read picks up exactly one new
+ *   conversion. Samples go through a median-of-3 filter (drops single bad
+ *   reads) and an EWMA.
+ *
+ *   The ALERT thresholds are programmed in comparator mode, so the ALERT
+ *   output follows the temperature if it is wired up.
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include "sensors/SensorDriver.h"
+
+class Tmp112 : public SensorDriver {
+public:
+  static constexpr uint8_t FIRST_ADDRESS = 0x48;
+  static constexpr uint8_t LAST_ADDRESS = 0x4B;
+
+  /**
+   * Recognise a TMP112 by its configuration register: the resolution
+   * bits R1:R0 always read 11 and the low nibble 0000.
+   */
+  static bool detect(uint8_t address);
+
+  explicit Tmp112(uint8_t address) : SensorDriver(address) {}
+
+  const char *model() const override { return "TMP112"; }
+  uint32_t intervalMs() const override { return Config::TEMP_SAMPLE_INTERVAL_MS; }
+  uint8_t valueCount() const override { return 1; }
+  SensorQuantity quantity(uint8_t) const override { return SensorQuantity::TEMPERATURE; }
+
+  bool configure() override;
+
+  /**
+   * Read one conversion; values[0] is the filtered temperature in °C.
+   */
+  bool read(float *values) override;
+
+private:
+  float filter(float celsius);
+
+  float _window[3] = {NAN, NAN, NAN};  // Last raw samples (median filter)
+  uint8_t _windowFill = 0;
+  uint8_t _windowPos = 0;
+  float _filtered = NAN;
+};
@@ -0,0 +1,157 @@
+/**
+ * =============================================================================
+ * BootLearner.cpp - Learned Per-Machine Boot Duration
+ * =============================================================================
+ *
+ * Times are kept relative to the power-on (elapsed ms), so the learned
+ * profile is independent of the device clock.
+ *
+ * =============================================================================
+ */
+
+#include "BootLearner.h"
+#include "Config.h"
+
+const char *bootDecisionName(BootDecision decision) {
+  switch (decision) {
+    case BootDecision::SETTLED: return "settled";
+    case BootDecision::TIMEOUT: return "timeout";
+  }
+  return "unknown";
+}
+
+BootLearner::BootLearner() : detectHistogram(0, LatencyHistogram::outageBoundsUs()) {}
+
+void BootLearner::setProfile(const BootProfile &loaded) {
+  profile = loaded;
+  published.update([this](BootLearnerStatus &s) { s.profile = profile; });
+}
+
+void BootLearner::start(uint64_t nowMs, bool learn) {
+  phase = Phase::BOOTING;
+  learning = learn;
+  startMs = nowMs;
+  sawActivity = false;
+  sawBusy = false;
+  settledSeen = false;
+  firstActivityMs = 0;
+  lastBusyMs = 0;
+  published.update([](BootLearnerStatus &s) { s.booting = true; });
+}
+
+void BootLearner::stop() {
+  if (phase == Phase::IDLE) {
+    return;
+  }
+  phase = Phase::IDLE;
+  published.update([](BootLearnerStatus &s) { s.booting = false; });
+}
+
+// =============================================================================
+// LIMITS
+// =============================================================================
+
+uint32_t BootLearner::ceilingMs(uint32_t fixedGraceMs) const {
+  if (profile.samples == 0) {
+    return fixedGraceMs;
+  }
+  uint32_t ceiling = profile.settleMs * 2;
+  if (ceiling < profile.settleMs + Config::BOOT_CEILING_MARGIN_MS) {
+    ceiling = profile.settleMs + Config::BOOT_CEILING_MARGIN_MS;
+  }
+  return ceiling > Config::BOOT_MAX_MS ? Config::BOOT_MAX_MS : ceiling;
+}
+
+uint32_t BootLearner::minSettleMs() const {
+  // A quiet pause early in POST must not end the boot
+  uint32_t learned = profile.samples > 0 ? profile.settleMs / 2 : 0;
+  return learned > Config::BOOT_MIN_MS ? learned : Config::BOOT_MIN_MS;
+}
+
+// =============================================================================
+// UPDATE
+// =============================================================================
+
+bool BootLearner::update(uint64_t nowMs, uint16_t activityPermille, uint32_t fixedGraceMs) {
+  if (phase == Phase::IDLE) {
+    return false;
+  }
+  uint64_t elapsed64 = nowMs - startMs;
+  uint32_t elapsedMs = elapsed64 > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(elapsed64);
+
+  if (activityPermille > 0 && !sawActivity) {
+    sawActivity = true;
+    firstActivityMs = elapsedMs;
+  }
+  if (activityPermille >= Config::BOOT_BUSY_PERMILLE) {
+    sawBusy = true;
+    lastBusyMs = elapsedMs;
+  }
+
+  bool settled = sawBusy && elapsedMs - lastBusyMs >= Config::BOOT_QUIET_MS && elapsedMs >= minSettleMs();
+  if (settled) {
+    settledSeen = true;
+    if (phase == Phase::BOOTING) {
+      declareRunning(elapsedMs, BootDecision::SETTLED, fixedGraceMs);
+    }
+    if (learning) {
+      learn(elapsedMs);
+    }
+    phase = Phase::IDLE;
+  } else if (phase == Phase::BOOTING && elapsedMs >= ceilingMs(fixedGraceMs)) {
+    declareRunning(elapsedMs, BootDecision::TIMEOUT, fixedGraceMs);
+    phase = Phase::OBSERVING;
+  } else if (phase == Phase::OBSERVING && elapsedMs >= Config::BOOT_MAX_MS) {
+    Serial.println("Boot: HDD activity never settled, nothing learned");
+    phase = Phase::IDLE;
+  }
+  return phase == Phase::BOOTING;
+}
+
+void BootLearner::declareRunning(uint32_t elapsedMs, BootDecision decision, uint32_t fixedGraceMs) {
+  int64_t vsFixed = static_cast<int64_t>(elapsedMs) - static_cast<int64_t>(fixedGraceMs);
+  int32_t vsFixedMs = vsFixed < INT32_MIN ? INT32_MIN : vsFixed > INT32_MAX ? INT32_MAX : static_cast<int32_t>(vsFixed);
+  detectHistogram.record(elapsedMs > UINT32_MAX / 1000 ? UINT32_MAX : elapsedMs * 1000);
+  published.update([elapsedMs, decision, vsFixedMs](BootLearnerStatus &s) {
+    s.booting = false;
+    s.lastDetectMs = elapsedMs;
+    s.lastDetectVsFixedMs = vsFixedMs;
+    s.decisions[static_cast<size_t>(decision)]++;
+  });
+  Serial.printf("Boot: RUNNING after %lu ms (%s, %+ld ms vs fixed grace)\n",
+                static_cast<unsigned long>(elapsedMs), bootDecisionName(decision),
+                static_cast<long>(vsFixedMs));
+}
+
+void BootLearner::learn(uint32_t settleMs) {
+  /**
+   * Rolling estimate: the first boot is taken as is, later ones move the
+   * estimate by BOOT_LEARN_WEIGHT_PCT of the difference.
+   */
+  if (settleMs > Config::BOOT_MAX_MS) {
+    return;
+  }
+  auto blend = [](uint32_t estimate, uint32_t sample) {
+    int64_t diff = static_cast<int64_t>(sample) - static_cast<int64_t>(estimate);
+    return static_cast<uint32_t>(static_cast<int64_t>(estimate) + diff * Config::BOOT_LEARN_WEIGHT_PCT / 100);
+  };
+  if (profile.samples == 0) {
+    profile.firstActivityMs = firstActivityMs;
+    profile.settleMs = settleMs;
+  } else {
+    profile.firstActivityMs = blend(profile.firstActivityMs, firstActivityMs);
+    profile.settleMs = blend(profile.settleMs, settleMs);
+  }
+  if (profile.samples < UINT16_MAX) {
+    profile.samples++;
+  }
+
+  BootProfile learned = profile;
+  published.update([learned](BootLearnerStatus &s) {
+    s.profile = learned;
+    s.revision++;
+  });
+  Serial.printf("Boot: learned settle %lu ms, first activity %lu ms (%u boots)\n",
+                static_cast<unsigned long>(learned.settleMs),
+                static_cast<unsigned long>(learned.firstActivityMs), learned.samples);
+}
@@ -0,0 +1,204 @@
+/**
+ * =============================================================================
+ * BootTimeline.cpp - Boot Latency After a Remote Power/Reset Press
+ * =============================================================================
+ *
+ * One boot in progress plus a ring of finished ones. A finished boot's
+ * phases are recorded into the histograms outside the critical section
+ * (the histograms have their own lock).
+ *
+ * =============================================================================
+ */
+
+#include "BootTimeline.h"
+#include "Config.h"
+
+static BootRecord s_current;
+static uint64_t s_pressMs = 0;
+static bool s_active = false;
+static bool s_expectReachable = false;
+
+static BootRecord s_history[Config::BOOT_HISTORY];
+static size_t s_historyHead = 0;   // Next write position
+static size_t s_historyCount = 0;
+static uint32_t s_counts[BOOT_TRIGGER_COUNT][BOOT_OUTCOME_COUNT] = {};
+static portMUX_TYPE s_timelineMux = portMUX_INITIALIZER_UNLOCKED;
+
+static LatencyHistogram s_phaseTimes[BOOT_TRIGGER_COUNT][BOOT_PHASE_COUNT] = {
+  {LatencyHistogram(0, LatencyHistogram::outageBoundsUs()), LatencyHistogram(0, LatencyHistogram::outageBoundsUs()),
+   LatencyHistogram(0, LatencyHistogram::outageBoundsUs()), LatencyHistogram(0, LatencyHistogram::outageBoundsUs())},
+  {LatencyHistogram(0, LatencyHistogram::outageBoundsUs()), LatencyHistogram(0, LatencyHistogram::outageBoundsUs()),
+   LatencyHistogram(0, LatencyHistogram::outageBoundsUs()), LatencyHistogram(0, LatencyHistogram::outageBoundsUs())},
+};
+
+const char *BootTimeline_triggerName(BootTrigger trigger) {
+  return trigger == BootTrigger::POWER ? "power" : "reset";
+}
+
+const char *BootTimeline_phaseName(BootPhase phase) {
+  switch (phase) {
+    case BootPhase::POWER_LED:      return "power_led";
+    case BootPhase::FIRST_ACTIVITY: return "first_activity";
+    case BootPhase::SETTLED:        return "settled";
+    case BootPhase::REACHABLE:      return "reachable";
+  }
+  return "unknown";
+}
+
+const char *BootTimeline_outcomeName(BootOutcome outcome) {
+  switch (outcome) {
+    case BootOutcome::IN_PROGRESS: return "in_progress";
+    case BootOutcome::COMPLETE:    return "complete";
+    case BootOutcome::INCOMPLETE:  return "incomplete";
+    case BootOutcome::ABORTED:     return "aborted";
+  }
+  return "unknown";
+}
+
+void BootTimeline_setExpectReachable(bool expect) {
+  s_expectReachable = expect;
+}
+
+// =============================================================================
+// RECORDING
+// =============================================================================
+
+static bool reached(const BootRecord &record, BootPhase phase) {
+  return record.phaseMs[static_cast<size_t>(phase)] != BOOT_PHASE_MISSING;
+}
+
+static bool finishLocked(BootOutcome outcome, BootRecord &finished) {
+  /**
+   * Move the boot in progress into the ring. Called with the mux held.
+   *
+   * @return false if no boot was in progress
+   */
+  if (!s_active) {
+    return false;
+  }
+  s_active = false;
+  s_current.outcome = outcome;
+  s_history[s_historyHead] = s_current;
+  s_historyHead = (s_historyHead + 1) % Config::BOOT_HISTORY;
+  if (s_historyCount < Config::BOOT_HISTORY) s_historyCount++;
+  s_counts[static_cast<size_t>(s_current.trigger)][static_cast<size_t>(outcome)]++;
+  finished = s_current;
+  return true;
+}
+
+static void recordPhases(const BootRecord &finished) {
+  for (size_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+    uint32_t ms = finished.phaseMs[i];
+    if (ms == BOOT_PHASE_MISSING) continue;
+    s_phaseTimes[static_cast<size_t>(finished.trigger)][i].record(ms > UINT32_MAX / 1000 ? UINT32_MAX : ms * 1000);
+  }
+}
+
+static void logFinished(const BootRecord &finished) {
+  char line[160];
+  int len = snprintf(line, sizeof(line), "Boot after %s press: %s", BootTimeline_triggerName(finished.trigger),
+                     BootTimeline_outcomeName(finished.outcome));
+  for (size_t i = 0; i < BOOT_PHASE_COUNT && len > 0 && static_cast<size_t>(len) < sizeof(line); i++) {
+    if (finished.phaseMs[i] == BOOT_PHASE_MISSING) continue;
+    len += snprintf(line + len, sizeof(line) - len, ", %s %lu ms", BootTimeline_phaseName(static_cast<BootPhase>(i)),
+                    static_cast<unsigned long>(finished.phaseMs[i]));
+  }
+  Serial.println(line);
+}
+
+void BootTimeline_start(BootTrigger trigger, uint64_t nowMs) {
+  BootRecord aborted;
+  portENTER_CRITICAL(&s_timelineMux);
+  bool hadBoot = finishLocked(BootOutcome::ABORTED, aborted);
+  s_active = true;
+  s_pressMs = nowMs;
+  s_current.pressUptimeSec = static_cast<uint32_t>(nowMs / 1000);
+  s_current.trigger = trigger;
+  s_current.outcome = BootOutcome::IN_PROGRESS;
+  for (size_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+    s_current.phaseMs[i] = BOOT_PHASE_MISSING;
+  }
+  portEXIT_CRITICAL(&s_timelineMux);
+
+  if (hadBoot) {
+    recordPhases(aborted);
+    logFinished(aborted);
+  }
+}
+
+void BootTimeline_mark(BootPhase phase, uint64_t nowMs) {
+  BootRecord finished;
+  bool done = false;
+  portENTER_CRITICAL(&s_timelineMux);
+  size_t index = static_cast<size_t>(phase);
+  if (s_active && s_current.phaseMs[index] == BOOT_PHASE_MISSING) {
+    uint64_t elapsed = nowMs > s_pressMs ? nowMs - s_pressMs : 0;
+    s_current.phaseMs[index] = elapsed >= BOOT_PHASE_MISSING ? BOOT_PHASE_MISSING - 1 : static_cast<uint32_t>(elapsed);
+    if (reached(s_current, BootPhase::SETTLED) && (!s_expectReachable || reached(s_current, BootPhase::REACHABLE))) {
+      done = finishLocked(BootOutcome::COMPLETE, finished);
+    }
+  }
+  portEXIT_CRITICAL(&s_timelineMux);
+
+  if (done) {
+    recordPhases(finished);
+    logFinished(finished);
+  }
+}
+
+void BootTimeline_update(uint64_t nowMs, bool powerOn) {
+  /**
+   * A power press waits for the LED; after that (and always after a
+   * reset) the PC going off ends the boot.
+   */
+  BootRecord finished;
+  bool done = false;
+  portENTER_CRITICAL(&s_timelineMux);
+  if (s_active) {
+    bool ledExpected = s_current.trigger == BootTrigger::RESET || reached(s_current, BootPhase::POWER_LED);
+    if (ledExpected && !powerOn) {
+      done = finishLocked(BootOutcome::ABORTED, finished);
+    } else if (nowMs - s_pressMs >= Config::BOOT_MAX_MS) {
+      done = finishLocked(BootOutcome::INCOMPLETE, finished);
+    }
+  }
+  portEXIT_CRITICAL(&s_timelineMux);
+
+  if (done) {
+    recordPhases(finished);
+    logFinished(finished);
+  }
+}
+
+// =============================================================================
+// QUERIES
+// =============================================================================
+
+bool BootTimeline_current(BootRecord &out) {
+  portENTER_CRITICAL(&s_timelineMux);
+  bool active = s_active;
+  if (active) out = s_current;
+  portEXIT_CRITICAL(&s_timelineMux);
+  return active;
+}
+
+size_t BootTimeline_history(BootRecord *out, size_t max) {
+  portENTER_CRITICAL(&s_timelineMux);
+  size_t count = s_historyCount < max ? s_historyCount : max;
+  for (size_t i = 0; i < count; i++) {
+    out[i] = s_history[(s_historyHead + Config::BOOT_HISTORY - 1 - i) % Config::BOOT_HISTORY];
+  }
+  portEXIT_CRITICAL(&s_timelineMux);
+  return count;
+}
+
+uint32_t BootTimeline_count(BootTrigger trigger, BootOutcome outcome) {
+  portENTER_CRITICAL(&s_timelineMux);
+  uint32_t count = s_counts[static_cast<size_t>(trigger)][static_cast<size_t>(outcome)];
+  portEXIT_CRITICAL(&s_timelineMux);
+  return count;
+}
+
+const LatencyHistogram &BootTimeline_phaseTime(BootTrigger trigger, BootPhase phase) {
+  return s_phaseTimes[static_cast<size_t>(trigger)][static_cast<size_t>(phase)];
+}
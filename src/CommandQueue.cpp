@@ -0,0 +1,203 @@
+/**
+ * =============================================================================
+ * CommandQueue.cpp - PC Action Queue (REST / MQTT / WebSocket → Control Task)
+ * =============================================================================
+ *
+ * The queue itself is a FreeRTOS queue (copies, bounded, safe for several
+ * producers). Completion is signalled with one event-group bit per result
+ * slot: submit clears the bit of the slot it claims, the control task
+ * sets it after execution, and any number of waiters can block on it.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/event_groups.h>
+
+#include "CommandQueue.h"
+#include "PcChannels.h"
+#include "TaskScheduler.h"
+
+// =============================================================================
+// STATE
+// =============================================================================
+
+static constexpr size_t QUEUE_DEPTH = 8;
+static constexpr size_t RESULT_SLOTS = 16;   // >= 2x depth; one event bit each (max 24)
+
+struct QueuedCommand {
+  uint32_t seq;
+  int64_t enqueuedUs;
+  PcCommand command;
+  CommandSource source;
+  uint8_t channel;
+};
+
+static QueueHandle_t s_queue = nullptr;
+static EventGroupHandle_t s_doneBits = nullptr;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static CommandResult s_results[RESULT_SLOTS] = {};
+static uint32_t s_nextSeq = 1;
+static int s_consumerTask = -1;
+
+static const char *const kSourceNames[COMMAND_SOURCE_COUNT] = {"rest", "mqtt", "websocket", "watchdog"};
+static uint32_t s_counts[COMMAND_SOURCE_COUNT][static_cast<size_t>(CommandStatus::UNKNOWN)] = {};
+static LatencyHistogram s_latency[COMMAND_SOURCE_COUNT];
+static uint32_t s_maxDepth = 0;
+
+static CommandResult &slotFor(uint32_t seq) {
+  return s_results[seq % RESULT_SLOTS];
+}
+
+static EventBits_t bitFor(uint32_t seq) {
+  return static_cast<EventBits_t>(1UL << (seq % RESULT_SLOTS));
+}
+
+static void countLocked(CommandSource source, CommandStatus status) {
+  size_t src = static_cast<size_t>(source);
+  if (src < COMMAND_SOURCE_COUNT) {
+    s_counts[src][static_cast<size_t>(status)]++;
+  }
+}
+
+// =============================================================================
+// PRODUCERS (any task)
+// =============================================================================
+
+void CommandQueue_setup() {
+  if (!s_queue) {
+    s_queue = xQueueCreate(QUEUE_DEPTH, sizeof(QueuedCommand));
+    s_doneBits = xEventGroupCreate();
+  }
+}
+
+void CommandQueue_setConsumerTask(int taskIndex) {
+  s_consumerTask = taskIndex;
+}
+
+uint32_t CommandQueue_submit(PcCommand command, CommandSource source, uint8_t channel) {
+  if (!s_queue || !s_doneBits) return 0;
+
+  QueuedCommand queued;
+  queued.command = command;
+  queued.source = source;
+  queued.channel = channel;
+
+  portENTER_CRITICAL(&s_mux);
+  queued.seq = s_nextSeq++;
+  if (s_nextSeq == 0) s_nextSeq = 1;
+  CommandResult &slot = slotFor(queued.seq);
+  slot.seq = queued.seq;
+  slot.command = command;
+  slot.source = source;
+  slot.channel = channel;
+  slot.status = CommandStatus::PENDING;
+  slot.latencyUs = 0;
+  portEXIT_CRITICAL(&s_mux);
+
+  xEventGroupClearBits(s_doneBits, bitFor(queued.seq));
+  queued.enqueuedUs = esp_timer_get_time();
+
+  if (xQueueSend(s_queue, &queued, 0) != pdTRUE) {
+    portENTER_CRITICAL(&s_mux);
+    if (slot.seq == queued.seq) slot.status = CommandStatus::DROPPED;
+    countLocked(source, CommandStatus::DROPPED);
+    portEXIT_CRITICAL(&s_mux);
+    xEventGroupSetBits(s_doneBits, bitFor(queued.seq));
+    return 0;
+  }
+
+  uint32_t depth = uxQueueMessagesWaiting(s_queue);
+  if (depth > s_maxDepth) s_maxDepth = depth;
+
+  // Don't wait for the control task's (possibly stretched) period
+  if (s_consumerTask >= 0) {
+    TaskScheduler_wake(static_cast<size_t>(s_consumerTask));
+  }
+  return queued.seq;
+}
+
+CommandStatus CommandQueue_wait(uint32_t seq, uint32_t timeoutMs, CommandResult *out) {
+  if (seq == 0) return CommandStatus::DROPPED;
+  if (!s_doneBits) return CommandStatus::UNKNOWN;
+
+  // Bit stays set until the slot is reused, so several waiters are fine
+  xEventGroupWaitBits(s_doneBits, bitFor(seq), pdFALSE, pdTRUE, pdMS_TO_TICKS(timeoutMs));
+
+  portENTER_CRITICAL(&s_mux);
+  CommandResult result = slotFor(seq);
+  portEXIT_CRITICAL(&s_mux);
+
+  if (result.seq != seq) return CommandStatus::UNKNOWN;
+  if (out) *out = result;
+  return result.status;
+}
+
+// =============================================================================
+// CONSUMER (control task)
+// =============================================================================
+
+size_t CommandQueue_drain() {
+  if (!s_queue) return 0;
+
+  size_t executed = 0;
+  QueuedCommand queued;
+  while (xQueueReceive(s_queue, &queued, 0) == pdTRUE) {
+    bool accepted = false;
+    PCController *pc = PcChannels_get(queued.channel);
+    if (pc) {
+      switch (queued.command) {
+        case PcCommand::POWER_PULSE: accepted = pc->pulsePower(); break;
+        case PcCommand::RESET_PULSE: accepted = pc->pulseReset(); break;
+        case PcCommand::FORCE_POWER: accepted = pc->forcePower(); break;
+      }
+    }
+
+    int64_t latencyUs = esp_timer_get_time() - queued.enqueuedUs;
+    uint32_t latency = latencyUs > 0 ? static_cast<uint32_t>(latencyUs) : 0;
+    CommandStatus status = accepted ? CommandStatus::DONE : CommandStatus::REJECTED;
+    size_t src = static_cast<size_t>(queued.source);
+    if (accepted && src < COMMAND_SOURCE_COUNT) {
+      s_latency[src].record(latency);
+    }
+
+    portENTER_CRITICAL(&s_mux);
+    CommandResult &slot = slotFor(queued.seq);
+    if (slot.seq == queued.seq) {
+      slot.status = status;
+      slot.latencyUs = latency;
+    }
+    countLocked(queued.source, status);
+    portEXIT_CRITICAL(&s_mux);
+
+    xEventGroupSetBits(s_doneBits, bitFor(queued.seq));
+    executed++;
+  }
+  return executed;
+}
+
+// =============================================================================
+// STATISTICS
+// =============================================================================
+
+const char *CommandQueue_sourceName(CommandSource source) {
+  size_t src = static_cast<size_t>(source);
+  return src < COMMAND_SOURCE_COUNT ? kSourceNames[src] : "unknown";
+}
+
+uint32_t CommandQueue_count(CommandSource source, CommandStatus status) {
+  size_t src = static_cast<size_t>(source);
+  size_t st = static_cast<size_t>(status);
+  if (src >= COMMAND_SOURCE_COUNT || st >= static_cast<size_t>(CommandStatus::UNKNOWN)) return 0;
+  return s_counts[src][st];
+}
+
+const LatencyHistogram &CommandQueue_latency(CommandSource source) {
+  size_t src = static_cast<size_t>(source);
+  return s_latency[src < COMMAND_SOURCE_COUNT ? src : 0];
+}
+
+uint32_t CommandQueue_maxDepth() {
+  return s_maxDepth;
+}
@@ -11,78 +11,94 @@
 
 #include "FactoryReset.h"
 #include "Config.h"
+#include "Constants.h"
+#include "FastGpio.h"
+#include "TimerService.h"
 #include <esp_task_wdt.h>
 
 // External function from Networking.cpp
 extern bool Networking_clearConfig();
 
+extern TimerWheel g_controlTimers;
+
 // =============================================================================
 // BUTTON STATE TRACKING
 // =============================================================================
 
-static uint32_t s_resetButtonPressedMs = 0;  // When button was first pressed
+static uint64_t s_resetButtonPressedMs = 0;  // When button was first pressed
 static bool s_resetButtonWasPressed = false; // Was button pressed last loop?
-static uint32_t s_lastResetLedToggleMs = 0;  // Last LED toggle timestamp
 static bool s_resetLedState = false;         // Current LED state
+static Timer s_holdTimer;                    // Fires after FACTORY_RESET_HOLD_MS
+static Timer s_blinkTimer;                   // Progress blink (re-armed each toggle)
+
+// =============================================================================
+// TIMER CALLBACKS (control task)
+// =============================================================================
+
+static uint32_t blinkIntervalMs() {
+  /**
+   * Blink faster as the hold progresses: 500ms at start -> 50ms at the end.
+   */
+  uint64_t holdDuration = TimerService_nowMs() - s_resetButtonPressedMs;
+  uint32_t progress = (uint32_t)((holdDuration * 100) / Config::FACTORY_RESET_HOLD_MS);
+  if (progress > 100) progress = 100;
+  uint32_t blinkInterval = 500 - (progress * 45 / 10);
+  return blinkInterval < 50 ? 50 : blinkInterval;
+}
+
+static void onBlink(void *) {
+  s_resetLedState = !s_resetLedState;
+  digitalWrite(Config::PIN_WIFI_ERROR_LED, s_resetLedState ? HIGH : LOW);
+  g_controlTimers.arm(s_blinkTimer, blinkIntervalMs(), onBlink);
+}
+
+static void onHoldComplete(void *) {
+  // Button held long enough - perform factory reset!
+  g_controlTimers.cancel(s_blinkTimer);
+  digitalWrite(Config::PIN_WIFI_ERROR_LED, HIGH);  // Solid LED
+  Serial.println("!!! FACTORY RESET TRIGGERED !!!");
+  Networking_clearConfig();  // Erase WiFi, MQTT, and timing settings
+  // GPIO 9 is ESP32-C3 strapping pin (LOW = download mode). Wait for
+  // button release so we don't enter bootloader on restart.
+  Serial.println("Release button to restart...");
+  while (FactoryButtonPin::active()) {
+    esp_task_wdt_reset();
+    delay(50);
+  }
+  delay(200);
+  ESP.restart();             // Reboot into AP mode
+}
 
 // =============================================================================
 // SETUP
 // =============================================================================
 void FactoryReset_setup() {
-  pinMode(Config::PIN_FACTORY_RESET, INPUT_PULLUP);  // Reset button (active low)
+  FactoryButtonPin::begin();  // Reset button (active low, pull-up)
 }
 
 // =============================================================================
-// LOOP - Check button state each iteration
+// LOOP - Check button edges each iteration; timing runs on the control wheel
 // =============================================================================
 void FactoryReset_loop() {
-  bool resetButtonPressed = (digitalRead(Config::PIN_FACTORY_RESET) == LOW);
-  
+  bool resetButtonPressed = FactoryButtonPin::active();
+  if (resetButtonPressed == s_resetButtonWasPressed) {
+    return;
+  }
+  s_resetButtonWasPressed = resetButtonPressed;
+
   if (resetButtonPressed) {
-    if (!s_resetButtonWasPressed) {
-      // Button just pressed - start the timer
-      s_resetButtonPressedMs = millis();
-      s_resetButtonWasPressed = true;
-      s_lastResetLedToggleMs = millis();
-      s_resetLedState = true;
-      digitalWrite(Config::PIN_WIFI_ERROR_LED, HIGH);
-    } else {
-      // Button is being held - check duration
-      uint32_t holdDuration = millis() - s_resetButtonPressedMs;
-      
-      if (holdDuration >= Config::FACTORY_RESET_HOLD_MS) {
-        // Button held long enough - perform factory reset!
-        digitalWrite(Config::PIN_WIFI_ERROR_LED, HIGH);  // Solid LED
-        Serial.println("!!! FACTORY RESET TRIGGERED !!!");
-        Networking_clearConfig();  // Erase WiFi, MQTT, and timing settings
-        // GPIO 9 is ESP32-C3 strapping pin (LOW = download mode). Wait for
-        // button release so we don't enter bootloader on restart.
-        Serial.println("Release button to restart...");
-        while (digitalRead(Config::PIN_FACTORY_RESET) == LOW) {
-          esp_task_wdt_reset();
-          delay(50);
-        }
-        delay(200);
-        ESP.restart();             // Reboot into AP mode
-      } else {
-        // Still holding - blink LED faster as progress increases
-        // Blink interval: 500ms at start → 50ms at end
-        uint32_t progress = (holdDuration * 100) / Config::FACTORY_RESET_HOLD_MS;
-        uint32_t blinkInterval = 500 - (progress * 45 / 10);
-        if (blinkInterval < 50) blinkInterval = 50;
-        
-        if (millis() - s_lastResetLedToggleMs >= blinkInterval) {
-          s_lastResetLedToggleMs = millis();
-          s_resetLedState = !s_resetLedState;
-          digitalWrite(Config::PIN_WIFI_ERROR_LED, s_resetLedState ? HIGH : LOW);
-        }
-      }
-    }
+    // Button just pressed - start the hold and blink timers
+    s_resetButtonPressedMs = TimerService_nowMs();
+    s_resetLedState = true;
+    digitalWrite(Config::PIN_WIFI_ERROR_LED, HIGH);
+    g_controlTimers.arm(s_holdTimer, Config::FACTORY_RESET_HOLD_MS, onHoldComplete);
+    g_controlTimers.arm(s_blinkTimer, blinkIntervalMs(), onBlink);
   } else {
-    // Button released (or not pressed)
-    if (s_resetButtonWasPressed) {
-      s_resetButtonWasPressed = false;
-      // LED control returns to Networking_loop()
-    }
+    // Button released early - stop feedback and hand the LED back to
+    // Networking (STA: on = disconnected; AP: its blink timer takes over)
+    g_controlTimers.cancel(s_holdTimer);
+    g_controlTimers.cancel(s_blinkTimer);
+    digitalWrite(Config::PIN_WIFI_ERROR_LED,
+                 (g_state.apMode || g_state.wifiConnected) ? LOW : HIGH);
   }
 }
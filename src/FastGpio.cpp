@@ -0,0 +1,89 @@
+/**
+ * =============================================================================
+ * FastGpio.cpp - GPIO Path Benchmark
+ * =============================================================================
+ *
+ * Counts CPU cycles (ESP.getCycleCount()) around a loop of calls. Cycles
+ * do not depend on the current DFS clock. Each loop runs inside a critical
+ * section, so neither an interrupt nor the relay pulse timer lands in the
+ * middle of a measurement, and the relay cannot be closed by another task
+ * while the write loops re-apply its inactive level.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+
+#include "FastGpio.h"
+#include "PCController.h"
+
+extern PCController g_pc;
+
+static constexpr uint32_t BENCH_ITERATIONS = 256;
+static portMUX_TYPE s_benchMux = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile uint32_t s_sink = 0;  // Keeps read loops from being optimized out
+
+static uint32_t perCall(uint32_t cycles, uint32_t overhead) {
+  return cycles > overhead ? (cycles - overhead) / BENCH_ITERATIONS : 0;
+}
+
+GpioBenchResult FastGpio_benchmark() {
+  GpioBenchResult result = {};
+  result.iterations = BENCH_ITERATIONS;
+  uint32_t start;
+  uint32_t overhead;
+  uint32_t cycles;
+
+  portENTER_CRITICAL(&s_benchMux);
+  start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    s_sink = s_sink + i;
+  }
+  overhead = ESP.getCycleCount() - start;
+  portEXIT_CRITICAL(&s_benchMux);
+
+  // Reads: power LED input
+  portENTER_CRITICAL(&s_benchMux);
+  start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    s_sink = s_sink + digitalRead(PowerLedPin::pin);
+  }
+  cycles = ESP.getCycleCount() - start;
+  portEXIT_CRITICAL(&s_benchMux);
+  result.digitalReadCycles = perCall(cycles, overhead);
+
+  portENTER_CRITICAL(&s_benchMux);
+  start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    s_sink = s_sink + PowerLedPin::level();
+  }
+  cycles = ESP.getCycleCount() - start;
+  portEXIT_CRITICAL(&s_benchMux);
+  result.fastReadCycles = perCall(cycles, overhead);
+
+  // Writes: power relay, inactive level only (physically a no-op)
+  static const uint8_t kInactiveLevel = Config::POWER_RELAY_ACTIVE_HIGH ? LOW : HIGH;
+  portENTER_CRITICAL(&s_benchMux);
+  result.writesMeasured = !g_pc.powerRelayActive();
+  if (result.writesMeasured) {
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+      digitalWrite(PowerRelayPin::pin, kInactiveLevel);
+      s_sink = s_sink + i;
+    }
+    cycles = ESP.getCycleCount() - start;
+    result.digitalWriteCycles = perCall(cycles, overhead);
+
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+      PowerRelayPin::setActive(false);
+      s_sink = s_sink + i;
+    }
+    cycles = ESP.getCycleCount() - start;
+    result.fastWriteCycles = perCall(cycles, overhead);
+  }
+  portEXIT_CRITICAL(&s_benchMux);
+
+  return result;
+}
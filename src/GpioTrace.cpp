@@ -0,0 +1,181 @@
+/**
+ * =============================================================================
+ * GpioTrace.cpp - Front Panel GPIO Edge Capture
+ * =============================================================================
+ *
+ * Producers are the LED interrupts, the control task and the esp_timer
+ * task (relay release), so appends take a short critical section; the
+ * timestamp is read inside it to keep records in time order.
+ *
+ * =============================================================================
+ */
+
+#include <esp_timer.h>
+
+#include "Config.h"
+#include "Constants.h"
+#include "FastGpio.h"
+#include "GpioTrace.h"
+#include "PCController.h"
+
+extern PCController g_pc;
+extern StoredConfig g_config;
+
+static GpioTraceRecord *s_ring = nullptr;
+static uint32_t s_head = 0;         // Next write position
+static uint32_t s_count = 0;
+static uint32_t s_overwritten = 0;
+static volatile bool s_capturing = false;
+static bool s_recordHdd = true;
+static uint8_t s_baseLevels = 0;
+static int64_t s_baseUs = 0;
+static portMUX_TYPE s_traceMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t applyRecord(uint8_t levels, const GpioTraceRecord &record) {
+  uint8_t bit = static_cast<uint8_t>(1u << record.channel);
+  return record.level ? (levels | bit) : (levels & ~bit);
+}
+
+static int64_t recordTimeUs(const GpioTraceRecord &record) {
+  return static_cast<int64_t>((static_cast<uint64_t>(record.timeHi) << 32) | record.timeLo);
+}
+
+const char *GpioTrace_channelName(GpioTraceChannel channel) {
+  switch (channel) {
+    case GpioTraceChannel::POWER_LED:   return "power_led";
+    case GpioTraceChannel::HDD_LED:     return "hdd_led";
+    case GpioTraceChannel::POWER_RELAY: return "power_relay";
+    case GpioTraceChannel::RESET_RELAY: return "reset_relay";
+  }
+  return "unknown";
+}
+
+// =============================================================================
+// CONTROL
+// =============================================================================
+
+bool GpioTrace_start(bool hdd) {
+  if (!s_ring) {
+    s_ring = static_cast<GpioTraceRecord *>(malloc(Config::GPIO_TRACE_RECORDS * sizeof(GpioTraceRecord)));
+    if (!s_ring) {
+      Serial.println("GpioTrace: not enough memory for the trace ring");
+      return false;
+    }
+  }
+
+  uint8_t levels = 0;
+  if (PowerLedPin::active()) levels |= 1u << static_cast<uint8_t>(GpioTraceChannel::POWER_LED);
+  if (HddLedPin::active()) levels |= 1u << static_cast<uint8_t>(GpioTraceChannel::HDD_LED);
+  if (g_pc.powerRelayActive()) levels |= 1u << static_cast<uint8_t>(GpioTraceChannel::POWER_RELAY);
+  if (g_pc.resetRelayActive()) levels |= 1u << static_cast<uint8_t>(GpioTraceChannel::RESET_RELAY);
+
+  portENTER_CRITICAL(&s_traceMux);
+  s_head = 0;
+  s_count = 0;
+  s_overwritten = 0;
+  s_recordHdd = hdd;
+  s_baseLevels = levels;
+  s_baseUs = esp_timer_get_time();
+  s_capturing = true;
+  portEXIT_CRITICAL(&s_traceMux);
+
+  Serial.printf("GpioTrace: capturing (%u records%s)\n",
+                static_cast<unsigned>(Config::GPIO_TRACE_RECORDS), hdd ? "" : ", no HDD LED");
+  return true;
+}
+
+void GpioTrace_stop() {
+  portENTER_CRITICAL(&s_traceMux);
+  bool wasCapturing = s_capturing;
+  s_capturing = false;
+  portEXIT_CRITICAL(&s_traceMux);
+  if (wasCapturing) {
+    Serial.printf("GpioTrace: stopped, %u records\n", static_cast<unsigned>(s_count));
+  }
+}
+
+// =============================================================================
+// RECORDING
+// =============================================================================
+
+void IRAM_ATTR GpioTrace_record(GpioTraceChannel channel, bool active) {
+  if (!s_capturing) {
+    return;
+  }
+  if (channel == GpioTraceChannel::HDD_LED && !s_recordHdd) {
+    return;
+  }
+
+  portENTER_CRITICAL_SAFE(&s_traceMux);
+  if (s_capturing) {
+    GpioTraceRecord &slot = s_ring[s_head];
+    if (s_count == Config::GPIO_TRACE_RECORDS) {
+      // Oldest record leaves the ring: fold it into the base state
+      s_baseLevels = applyRecord(s_baseLevels, slot);
+      s_baseUs = recordTimeUs(slot);
+      s_overwritten++;
+    } else {
+      s_count++;
+    }
+    uint64_t nowUs = static_cast<uint64_t>(esp_timer_get_time());
+    slot.timeLo = static_cast<uint32_t>(nowUs);
+    slot.timeHi = static_cast<uint16_t>(nowUs >> 32);
+    slot.channel = static_cast<uint8_t>(channel);
+    slot.level = active ? 1 : 0;
+    s_head = (s_head + 1) % Config::GPIO_TRACE_RECORDS;
+  }
+  portEXIT_CRITICAL_SAFE(&s_traceMux);
+}
+
+// =============================================================================
+// EXPORT
+// =============================================================================
+
+GpioTraceStatus GpioTrace_status() {
+  GpioTraceStatus status = {};
+  portENTER_CRITICAL(&s_traceMux);
+  status.allocated = s_ring != nullptr;
+  status.capturing = s_capturing;
+  status.hdd = s_recordHdd;
+  status.records = s_count;
+  status.overwritten = s_overwritten;
+  portEXIT_CRITICAL(&s_traceMux);
+  status.capacity = Config::GPIO_TRACE_RECORDS;
+  return status;
+}
+
+bool GpioTrace_export(std::vector<uint8_t> &out) {
+  /**
+   * Allocate for a full ring first, then copy inside one critical section
+   * (a 16 KB memcpy, tens of µs) so header and records match.
+   */
+  if (!s_ring) {
+    return false;
+  }
+  out.resize(sizeof(GpioTraceHeader) + Config::GPIO_TRACE_RECORDS * sizeof(GpioTraceRecord));
+
+  GpioTraceHeader header = {};
+  memcpy(header.magic, "RTRC", 4);
+  header.version = GPIO_TRACE_VERSION;
+  header.recordSize = sizeof(GpioTraceRecord);
+  header.bootGraceMs = g_config.channels[0].bootGraceMs;
+
+  uint8_t *records = out.data() + sizeof(GpioTraceHeader);
+  portENTER_CRITICAL(&s_traceMux);
+  header.baseLevels = s_baseLevels;
+  header.flags = (s_capturing ? GPIO_TRACE_FLAG_CAPTURING : 0) | (s_recordHdd ? 0 : GPIO_TRACE_FLAG_NO_HDD);
+  header.recordCount = s_count;
+  header.overwritten = s_overwritten;
+  header.baseUs = static_cast<uint64_t>(s_baseUs);
+  header.endUs = static_cast<uint64_t>(esp_timer_get_time());
+  uint32_t oldest = (s_head + Config::GPIO_TRACE_RECORDS - s_count) % Config::GPIO_TRACE_RECORDS;
+  uint32_t firstRun = Config::GPIO_TRACE_RECORDS - oldest;
+  if (firstRun > s_count) firstRun = s_count;
+  memcpy(records, &s_ring[oldest], firstRun * sizeof(GpioTraceRecord));
+  memcpy(records + firstRun * sizeof(GpioTraceRecord), s_ring, (s_count - firstRun) * sizeof(GpioTraceRecord));
+  portEXIT_CRITICAL(&s_traceMux);
+
+  memcpy(out.data(), &header, sizeof(header));
+  out.resize(sizeof(GpioTraceHeader) + header.recordCount * sizeof(GpioTraceRecord));
+  return true;
+}
@@ -0,0 +1,323 @@
+/**
+ * =============================================================================
+ * HangRecovery.cpp - Heartbeat Watch and Hang Recovery (Channel 0)
+ * =============================================================================
+ *
+ * check() runs on g_controlTimers and reads the PC state straight from
+ * the channel 0 controller (the control task owns it). A press is
+ * submitted once; its result is polled on the next checks without
+ * blocking (the control task itself executes it), and a rejected or
+ * dropped press is submitted again.
+ *
+ * "Alive again" means a heartbeat newer than the last press, so a
+ * heartbeat that was already late cannot end an episode.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#include "CommandQueue.h"
+#include "Config.h"
+#include "Constants.h"
+#include "HangRecovery.h"
+#include "HddActivity.h"
+#include "Heartbeat.h"
+#include "PcChannels.h"
+#include "SeqLock.h"
+#include "TimerService.h"
+
+extern StoredConfig g_config;
+extern SeqLock<StatusSnapshot> g_statusSnapshot;
+extern TimerWheel g_controlTimers;
+
+// Settings (read once from g_config)
+static bool s_recover = false;
+static bool s_requireHddIdle = true;
+static int64_t s_timeoutUs = 0;
+
+static Timer s_checkTimer;
+static HangState s_state = HangState::OFF;
+static int64_t s_stateSinceUs = 0;
+static int64_t s_detectedUs = 0;
+static int64_t s_offSinceUs = 0;        // FORCING_OFF: LED off and relay released since
+
+// Press in flight
+static PcCommand s_command = PcCommand::RESET_PULSE;
+static uint32_t s_commandSeq = 0;
+static bool s_commandDone = false;
+static int64_t s_commandUs = 0;
+
+// Start times of the last episodes (limit per window)
+static int64_t s_episodeUs[Config::HANG_RECOVERY_MAX_EPISODES] = {};
+static uint8_t s_episodeNext = 0;
+static uint8_t s_episodeCount = 0;
+
+static SeqLock<HangRecoveryStats> s_stats;
+static LatencyHistogram s_timeToRecovery(0, LatencyHistogram::outageBoundsUs());
+
+const char *HangRecovery_stateName(HangState state) {
+  switch (state) {
+    case HangState::OFF:         return "OFF";
+    case HangState::IDLE:        return "IDLE";
+    case HangState::WATCHING:    return "WATCHING";
+    case HangState::HUNG:        return "HUNG";
+    case HangState::RESETTING:   return "RESETTING";
+    case HangState::FORCING_OFF: return "FORCING_OFF";
+    case HangState::POWERING_ON: return "POWERING_ON";
+    case HangState::COOLDOWN:    return "COOLDOWN";
+    case HangState::GAVE_UP:     return "GAVE_UP";
+  }
+  return "OFF";
+}
+
+const char *HangRecovery_actionName(HangAction action) {
+  switch (action) {
+    case HangAction::RESET:     return "reset";
+    case HangAction::FORCE_OFF: return "force_off";
+    case HangAction::POWER_ON:  return "power_on";
+  }
+  return "unknown";
+}
+
+const char *HangRecovery_outcomeName(HangOutcome outcome) {
+  switch (outcome) {
+    case HangOutcome::RESET:       return "reset";
+    case HangOutcome::POWER_CYCLE: return "power_cycle";
+    case HangOutcome::FAILED:      return "failed";
+    case HangOutcome::ABORTED:     return "aborted";
+  }
+  return "unknown";
+}
+
+// =============================================================================
+// STATE
+// =============================================================================
+
+static void setState(HangState next, int64_t nowUs) {
+  if (next == s_state) {
+    return;
+  }
+  s_state = next;
+  s_stateSinceUs = nowUs;
+  s_stats.update([next](HangRecoveryStats &s) { s.state = next; });
+  g_statusSnapshot.update([next](StatusSnapshot &s) { s.hangState = next; });
+  Serial.printf("Hang watch: %s\n", HangRecovery_stateName(next));
+}
+
+static bool elapsed(int64_t sinceUs, int64_t nowUs, uint32_t ms) {
+  return nowUs - sinceUs >= static_cast<int64_t>(ms) * 1000;
+}
+
+static bool hddIdle(int64_t timeoutUs) {
+  if (!s_requireHddIdle) {
+    return true;
+  }
+  HddActivityStats hdd = HddActivity_stats();
+  return !hdd.active &&
+         (hdd.lastActiveMs == 0 || static_cast<int64_t>(millis() - hdd.lastActiveMs) * 1000 >= timeoutUs);
+}
+
+static bool episodeAllowed(int64_t nowUs) {
+  if (s_episodeCount < Config::HANG_RECOVERY_MAX_EPISODES) {
+    return true;
+  }
+  // s_episodeNext is the oldest of the last MAX_EPISODES
+  return elapsed(s_episodeUs[s_episodeNext], nowUs, Config::HANG_RECOVERY_WINDOW_MS);
+}
+
+static void recordEpisode(int64_t nowUs) {
+  s_episodeUs[s_episodeNext] = nowUs;
+  s_episodeNext = (s_episodeNext + 1) % Config::HANG_RECOVERY_MAX_EPISODES;
+  if (s_episodeCount < Config::HANG_RECOVERY_MAX_EPISODES) s_episodeCount++;
+}
+
+// =============================================================================
+// PRESSES
+// =============================================================================
+
+static void submit(PcCommand command, int64_t nowUs) {
+  s_command = command;
+  s_commandSeq = CommandQueue_submit(command, CommandSource::WATCHDOG, 0);
+  s_commandDone = false;
+  s_commandUs = nowUs;
+}
+
+static void press(HangAction action, int64_t nowUs) {
+  PcCommand command = action == HangAction::RESET ? PcCommand::RESET_PULSE
+                    : action == HangAction::FORCE_OFF ? PcCommand::FORCE_POWER : PcCommand::POWER_PULSE;
+  submit(command, nowUs);
+  s_stats.update([action](HangRecoveryStats &s) { s.actions[static_cast<size_t>(action)]++; });
+  Serial.printf("Hang recovery: %s\n", HangRecovery_actionName(action));
+}
+
+static void pollPress(int64_t nowUs) {
+  /**
+   * The power relay may be held by a manual force shutdown, or the queue
+   * full: try again on the next check. The press timestamp moves with the
+   * retry.
+   */
+  if (s_commandDone) {
+    return;
+  }
+  CommandStatus status = CommandQueue_wait(s_commandSeq, 0);
+  if (status == CommandStatus::DONE) {
+    s_commandDone = true;
+  } else if (status != CommandStatus::PENDING) {
+    submit(s_command, nowUs);
+  }
+}
+
+static bool aliveSincePress(int64_t lastHeartbeatUs) {
+  return s_commandDone && lastHeartbeatUs > s_commandUs;
+}
+
+static void finish(HangOutcome outcome, int64_t lastHeartbeatUs, int64_t nowUs) {
+  bool recovered = outcome == HangOutcome::RESET || outcome == HangOutcome::POWER_CYCLE;
+  if (recovered) {
+    int64_t recoveryUs = lastHeartbeatUs - s_detectedUs;
+    s_timeToRecovery.record(recoveryUs > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(recoveryUs));
+    Serial.printf("Hang recovery: heartbeats back after %lu s\n", static_cast<unsigned long>(recoveryUs / 1000000));
+  }
+  s_stats.update([outcome](HangRecoveryStats &s) { s.outcomes[static_cast<size_t>(outcome)]++; });
+  setState(recovered ? HangState::COOLDOWN
+           : outcome == HangOutcome::FAILED ? HangState::GAVE_UP : HangState::IDLE, nowUs);
+}
+
+static void detectHang(int64_t nowUs) {
+  s_detectedUs = nowUs;
+  bool allowed = s_recover && episodeAllowed(nowUs);
+  bool suppressed = s_recover && !allowed;
+  s_stats.update([suppressed](HangRecoveryStats &s) {
+    s.hangsTotal++;
+    if (suppressed) s.suppressedTotal++;
+  });
+  Serial.printf("Hang watch: no heartbeat for %lu s while RUNNING%s\n",
+                static_cast<unsigned long>(s_timeoutUs / 1000000),
+                suppressed ? " (recovery limit reached)" : "");
+  if (!allowed) {
+    setState(HangState::HUNG, nowUs);
+    return;
+  }
+  recordEpisode(nowUs);
+  press(HangAction::RESET, nowUs);
+  setState(HangState::RESETTING, nowUs);
+}
+
+// =============================================================================
+// CHECK (control task)
+// =============================================================================
+
+static void check(void *) {
+  PCController *pc = PcChannels_get(0);
+  if (!pc) {
+    return;
+  }
+  PCState pcState = pc->state();
+  int64_t nowUs = esp_timer_get_time();
+  int64_t lastUs = Heartbeat_lastUs();
+  bool fresh = lastUs > 0 && nowUs - lastUs < s_timeoutUs;
+
+  switch (s_state) {
+    case HangState::OFF:
+      break;
+
+    case HangState::IDLE:
+      if (pcState == PCState::RUNNING && fresh) setState(HangState::WATCHING, nowUs);
+      break;
+
+    case HangState::WATCHING:
+      if (pcState != PCState::RUNNING) {
+        setState(HangState::IDLE, nowUs);
+      } else if (!fresh && hddIdle(s_timeoutUs)) {
+        detectHang(nowUs);
+      }
+      break;
+
+    case HangState::HUNG:
+      if (fresh) {
+        setState(HangState::WATCHING, nowUs);
+      } else if (pcState != PCState::RUNNING) {
+        setState(HangState::IDLE, nowUs);
+      }
+      break;
+
+    case HangState::RESETTING:
+      pollPress(nowUs);
+      if (aliveSincePress(lastUs)) {
+        finish(HangOutcome::RESET, lastUs, nowUs);
+      } else if (pcState == PCState::OFF && s_commandDone) {
+        finish(HangOutcome::ABORTED, lastUs, nowUs);
+      } else if (elapsed(s_commandUs, nowUs, Config::HANG_RECOVERY_WAIT_MS)) {
+        s_offSinceUs = 0;
+        press(HangAction::FORCE_OFF, nowUs);
+        setState(HangState::FORCING_OFF, nowUs);
+      }
+      break;
+
+    case HangState::FORCING_OFF:
+      pollPress(nowUs);
+      if (s_commandDone && pcState == PCState::OFF && !pc->powerRelayActive()) {
+        if (s_offSinceUs == 0) s_offSinceUs = nowUs;
+        if (elapsed(s_offSinceUs, nowUs, Config::HANG_POWER_OFF_DWELL_MS)) {
+          press(HangAction::POWER_ON, nowUs);
+          setState(HangState::POWERING_ON, nowUs);
+        }
+      } else if (elapsed(s_commandUs, nowUs, Config::HANG_FORCE_OFF_WAIT_MS)) {
+        finish(HangOutcome::FAILED, lastUs, nowUs);
+      }
+      break;
+
+    case HangState::POWERING_ON:
+      pollPress(nowUs);
+      if (aliveSincePress(lastUs)) {
+        finish(HangOutcome::POWER_CYCLE, lastUs, nowUs);
+      } else if (elapsed(s_commandUs, nowUs, Config::HANG_RECOVERY_WAIT_MS)) {
+        finish(HangOutcome::FAILED, lastUs, nowUs);
+      }
+      break;
+
+    case HangState::COOLDOWN:
+      if (elapsed(s_stateSinceUs, nowUs, Config::HANG_RECOVERY_COOLDOWN_MS)) {
+        setState(HangState::IDLE, nowUs);
+      }
+      break;
+
+    case HangState::GAVE_UP:
+      if (fresh) setState(HangState::IDLE, nowUs);
+      break;
+  }
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+void HangRecovery_setup() {
+  if (g_config.heartbeatPort == 0) {
+    return;
+  }
+  uint32_t timeoutS = g_config.heartbeatTimeoutS > 0 ? g_config.heartbeatTimeoutS : Config::HEARTBEAT_DEFAULT_TIMEOUT_S;
+  s_timeoutUs = static_cast<int64_t>(timeoutS) * 1000000;
+  s_recover = g_config.hangRecovery;
+  s_requireHddIdle = g_config.hangRequireHddIdle;
+
+  bool recover = s_recover;
+  s_stats.update([recover](HangRecoveryStats &s) {
+    s.enabled = true;
+    s.recover = recover;
+  });
+  setState(HangState::IDLE, esp_timer_get_time());
+  Serial.printf("Hang watch: %lu s heartbeat timeout%s, %s\n", static_cast<unsigned long>(timeoutS),
+                s_requireHddIdle ? " + HDD idle" : "", s_recover ? "recovery on" : "report only");
+  g_controlTimers.armPeriodic(s_checkTimer, Config::HANG_CHECK_INTERVAL_MS, check);
+}
+
+HangRecoveryStats HangRecovery_stats() {
+  return s_stats.read();
+}
+
+const LatencyHistogram &HangRecovery_timeToRecovery() {
+  return s_timeToRecovery;
+}
@@ -0,0 +1,249 @@
+/**
+ * =============================================================================
+ * HddActivity.cpp - HDD LED Edge Capture & Activity Analytics
+ * =============================================================================
+ *
+ * EDGE RING:
+ *   Each entry is the low 32 bits of esp_timer_get_time() with bit 0
+ *   replaced by the LED level after the edge (1 µs of resolution is given
+ *   up). The consumer rebuilds the 64-bit time from its distance to "now",
+ *   which is exact as long as the ring is drained within ~71 minutes.
+ *
+ *   The ISR only writes head, the control task only writes tail, so no
+ *   lock is needed; on overflow the newest edge is dropped and counted.
+ *
+ * MISSED EDGES:
+ *   A pulse shorter than the interrupt latency can deliver two edges that
+ *   both read the same level. Such an entry is treated as a zero-width
+ *   pulse (two transitions at the same time). After a ring overflow the
+ *   polled level resynchronises the tracker.
+ *
+ * =============================================================================
+ */
+
+#include <esp_timer.h>
+
+#include "Config.h"
+#include "HddActivity.h"
+
+static constexpr uint32_t RING_SIZE = 256;  // Power of two
+static constexpr uint32_t RING_MASK = RING_SIZE - 1;
+static constexpr int64_t WINDOW_US = 1000000;
+static constexpr uint8_t HISTORY_WINDOWS = 60;
+static constexpr int64_t BURST_GAP_US = static_cast<int64_t>(Config::HDD_BURST_GAP_MS) * 1000;
+
+// Producer: ISR. Consumer: control task.
+static volatile uint32_t s_ring[RING_SIZE];
+static volatile uint32_t s_head = 0;
+static volatile uint32_t s_tail = 0;
+static volatile uint32_t s_overflows = 0;
+
+// Tracker state (control task only)
+static bool s_level = false;
+static int64_t s_levelSinceUs = 0;       // Last point accounted into the window
+static int64_t s_windowStartUs = 0;
+static uint32_t s_windowActiveUs = 0;
+static uint16_t s_windowEdges = 0;
+static uint16_t s_history[HISTORY_WINDOWS] = {};  // Permille per window
+static uint8_t s_historyPos = 0;
+static uint8_t s_historyFill = 0;
+static uint32_t s_historySum = 0;
+static bool s_inBurst = false;
+static int64_t s_burstStartUs = 0;
+static int64_t s_lastOffUs = 0;          // LED last went dark
+static int64_t s_lastBurstEndUs = -1;    // -1 = no burst finished yet
+static uint32_t s_seenOverflows = 0;
+
+static HddActivityStats s_stats = {};
+static portMUX_TYPE s_statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static LatencyHistogram s_burstDurations(0, LatencyHistogram::activityBoundsUs());
+static LatencyHistogram s_idleGaps(0, LatencyHistogram::activityBoundsUs());
+
+static uint32_t clampUs(int64_t us) {
+  return us > static_cast<int64_t>(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(us);
+}
+
+// =============================================================================
+// PRODUCER (ISR)
+// =============================================================================
+
+void IRAM_ATTR HddActivity_recordEdgeFromIsr(bool active) {
+  uint32_t head = s_head;
+  if (head - s_tail >= RING_SIZE) {
+    s_overflows = s_overflows + 1;
+    return;
+  }
+  uint32_t stamp = static_cast<uint32_t>(esp_timer_get_time());
+  s_ring[head & RING_MASK] = (stamp & ~1u) | (active ? 1u : 0u);
+  s_head = head + 1;  // Publish after the slot is written
+}
+
+// =============================================================================
+// WINDOWS
+// =============================================================================
+
+static void closeWindow() {
+  uint16_t permille = static_cast<uint16_t>(s_windowActiveUs / 1000);
+  if (permille > 1000) permille = 1000;
+
+  s_historySum -= s_history[s_historyPos];
+  s_history[s_historyPos] = permille;
+  s_historySum += permille;
+  s_historyPos = (s_historyPos + 1) % HISTORY_WINDOWS;
+  if (s_historyFill < HISTORY_WINDOWS) s_historyFill++;
+
+  portENTER_CRITICAL(&s_statsMux);
+  s_stats.ratioPermille = permille;
+  s_stats.ratio60sPermille = static_cast<uint16_t>(s_historySum / s_historyFill);
+  s_stats.edgesPerSecond = s_windowEdges;
+  portEXIT_CRITICAL(&s_statsMux);
+
+  s_windowActiveUs = 0;
+  s_windowEdges = 0;
+}
+
+static void accountUntil(int64_t tUs) {
+  /**
+   * Add the time since the last call to the current window, closing every
+   * window that ended on the way. After a long quiet stretch at most one
+   * history's worth of windows is replayed.
+   */
+  if (tUs <= s_levelSinceUs) {
+    return;
+  }
+  int64_t windowEndUs = s_windowStartUs + WINDOW_US;
+  if (tUs >= windowEndUs) {
+    int64_t skipped = (tUs - windowEndUs) / WINDOW_US;
+    if (skipped > HISTORY_WINDOWS) {
+      int64_t jumpUs = (skipped - HISTORY_WINDOWS) * WINDOW_US;
+      // Finish the open window, then drop the windows nobody will see
+      if (s_level) s_windowActiveUs += static_cast<uint32_t>(windowEndUs - s_levelSinceUs);
+      closeWindow();
+      s_windowStartUs = windowEndUs + jumpUs;
+      s_levelSinceUs = s_windowStartUs;
+      windowEndUs = s_windowStartUs + WINDOW_US;
+    }
+  }
+  while (tUs >= windowEndUs) {
+    if (s_level) s_windowActiveUs += static_cast<uint32_t>(windowEndUs - s_levelSinceUs);
+    closeWindow();
+    s_windowStartUs = windowEndUs;
+    s_levelSinceUs = windowEndUs;
+    windowEndUs += WINDOW_US;
+  }
+  if (s_level) s_windowActiveUs += static_cast<uint32_t>(tUs - s_levelSinceUs);
+  s_levelSinceUs = tUs;
+}
+
+// =============================================================================
+// BURSTS
+// =============================================================================
+
+static void closeBurstIfIdle(int64_t tUs) {
+  if (!s_inBurst || s_level || tUs - s_lastOffUs < BURST_GAP_US) {
+    return;
+  }
+  s_inBurst = false;
+  s_lastBurstEndUs = s_lastOffUs;
+  s_burstDurations.record(clampUs(s_lastOffUs - s_burstStartUs));
+  portENTER_CRITICAL(&s_statsMux);
+  s_stats.burstsTotal++;
+  portEXIT_CRITICAL(&s_statsMux);
+}
+
+static void applyTransition(int64_t tUs, bool active) {
+  accountUntil(tUs);
+  if (active) {
+    closeBurstIfIdle(tUs);
+    if (!s_inBurst) {
+      s_inBurst = true;
+      s_burstStartUs = tUs;
+      if (s_lastBurstEndUs >= 0) {
+        s_idleGaps.record(clampUs(tUs - s_lastBurstEndUs));
+      }
+    }
+  } else {
+    s_lastOffUs = tUs;
+  }
+  s_level = active;
+  if (s_windowEdges < UINT16_MAX) s_windowEdges++;
+
+  uint32_t tMs = static_cast<uint32_t>(tUs / 1000);
+  portENTER_CRITICAL(&s_statsMux);
+  s_stats.edgesTotal++;
+  s_stats.lastChangeMs = tMs;
+  s_stats.lastActiveMs = tMs;  // Lit up to (or from) this instant
+  portEXIT_CRITICAL(&s_statsMux);
+}
+
+// =============================================================================
+// CONSUMER (CONTROL TASK)
+// =============================================================================
+
+void HddActivity_setup(bool activeNow) {
+  int64_t nowUs = esp_timer_get_time();
+  s_level = activeNow;
+  s_levelSinceUs = nowUs;
+  s_windowStartUs = nowUs;
+  s_lastOffUs = nowUs;
+  s_inBurst = activeNow;
+  s_burstStartUs = nowUs;
+  s_stats.active = activeNow;
+  s_stats.lastActiveMs = activeNow ? static_cast<uint32_t>(nowUs / 1000) : 0;
+}
+
+void HddActivity_process(bool activeNow) {
+  /**
+   * Entries up to `head` were stamped before `nowUs` is read, so their age
+   * is never negative.
+   */
+  uint32_t head = s_head;
+  int64_t nowUs = esp_timer_get_time();
+  uint32_t nowLow = static_cast<uint32_t>(nowUs);
+
+  for (uint32_t tail = s_tail; tail != head; tail++) {
+    uint32_t entry = s_ring[tail & RING_MASK];
+    bool active = (entry & 1u) != 0;
+    int64_t tUs = nowUs - static_cast<int64_t>(nowLow - (entry & ~1u));
+    if (tUs < s_levelSinceUs) tUs = s_levelSinceUs;  // Stamp rounding
+
+    if (active == s_level) {
+      applyTransition(tUs, !active);  // Edge lost to interrupt latency
+    }
+    applyTransition(tUs, active);
+    s_tail = tail + 1;
+  }
+
+  uint32_t overflows = s_overflows;
+  if (overflows != s_seenOverflows) {
+    s_seenOverflows = overflows;
+    if (activeNow != s_level) {
+      applyTransition(nowUs, activeNow);
+    }
+  }
+
+  accountUntil(nowUs);
+  closeBurstIfIdle(nowUs);
+
+  portENTER_CRITICAL(&s_statsMux);
+  s_stats.active = s_level;
+  if (s_level) s_stats.lastActiveMs = static_cast<uint32_t>(nowUs / 1000);
+  s_stats.ringOverflows = overflows;
+  portEXIT_CRITICAL(&s_statsMux);
+}
+
+HddActivityStats HddActivity_stats() {
+  portENTER_CRITICAL(&s_statsMux);
+  HddActivityStats stats = s_stats;
+  portEXIT_CRITICAL(&s_statsMux);
+  return stats;
+}
+
+const LatencyHistogram &HddActivity_burstDurations() {
+  return s_burstDurations;
+}
+
+const LatencyHistogram &HddActivity_idleGaps() {
+  return s_idleGaps;
+}
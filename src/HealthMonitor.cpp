@@ -0,0 +1,213 @@
+/**
+ * =============================================================================
+ * HealthMonitor.cpp - Subsystem Heartbeats & Targeted Recovery
+ * =============================================================================
+ *
+ * Heartbeats only store a timestamp, so they are cheap enough to call on
+ * every loop pass. The check runs once per HEALTH_CHECK_INTERVAL_MS in the
+ * control task, which never blocks on the network and therefore still
+ * runs while a network or telemetry call is hung.
+ *
+ * A stall lasts from the last heartbeat before the timeout to the next
+ * heartbeat (or stop); that span is what the duration histogram records.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+
+#include "Config.h"
+#include "HealthMonitor.h"
+#include "TimerService.h"
+
+extern TimerWheel g_controlTimers;
+
+// =============================================================================
+// STATE
+// =============================================================================
+
+struct SubsystemInfo {
+  const char *name;
+  uint32_t stallTimeoutMs;
+  SubsystemAbortFn abortFn;
+  bool watched;
+  bool stalled;
+  bool recoveryPending;
+  uint64_t lastBeatMs;     // Last heartbeat (stall start once stalled)
+  uint64_t checkFromMs;    // Timeout runs from here: last beat or recovery request
+  uint32_t stalls;
+  uint32_t recoveries;
+};
+
+static SubsystemInfo s_subsystems[SUBSYSTEM_COUNT] = {
+  {"wifi",      0, nullptr, false, false, false, 0, 0, 0, 0},
+  {"mqtt",      0, nullptr, false, false, false, 0, 0, 0, 0},
+  {"loki",      0, nullptr, false, false, false, 0, 0, 0, 0},
+  {"ota",       0, nullptr, false, false, false, 0, 0, 0, 0},
+  {"websocket", 0, nullptr, false, false, false, 0, 0, 0, 0},
+};
+
+static LatencyHistogram s_stallDurations[SUBSYSTEM_COUNT];
+static portMUX_TYPE s_healthMux = portMUX_INITIALIZER_UNLOCKED;
+static Timer s_checkTimer;
+
+static SubsystemInfo *lookup(Subsystem sub) {
+  size_t idx = static_cast<size_t>(sub);
+  return idx < SUBSYSTEM_COUNT ? &s_subsystems[idx] : nullptr;
+}
+
+/**
+ * Clear the stall of subsystem `idx` and record its duration (caller
+ * holds s_healthMux, so the histogram has a single writer at a time).
+ * @return stall duration in µs
+ */
+static uint32_t endStallLocked(size_t idx, uint64_t nowMs) {
+  SubsystemInfo &info = s_subsystems[idx];
+  info.stalled = false;
+  info.recoveryPending = false;
+  uint64_t us = (nowMs - info.lastBeatMs) * 1000ULL;
+  uint32_t stallUs = us > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(us);
+  s_stallDurations[idx].record(stallUs);
+  return stallUs;
+}
+
+// =============================================================================
+// STALL CHECK (control task)
+// =============================================================================
+
+static void checkSubsystems(void *) {
+  uint64_t nowMs = TimerService_nowMs();
+
+  for (size_t i = 0; i < SUBSYSTEM_COUNT; i++) {
+    SubsystemInfo &info = s_subsystems[i];
+    bool newStall = false;
+    SubsystemAbortFn abortFn = nullptr;
+
+    portENTER_CRITICAL(&s_healthMux);
+    bool due = info.watched && info.stallTimeoutMs > 0 &&
+               nowMs - info.checkFromMs >= info.stallTimeoutMs;
+    if (due) {
+      newStall = !info.stalled;
+      if (newStall) {
+        info.stalled = true;
+        info.stalls++;
+      }
+      info.recoveryPending = true;
+      info.recoveries++;
+      info.checkFromMs = nowMs;
+      abortFn = info.abortFn;
+    }
+    portEXIT_CRITICAL(&s_healthMux);
+
+    if (!due) continue;
+    Serial.printf("Health: %s %s (no progress for %llu ms) - recovering\n",
+                  info.name, newStall ? "stalled" : "still stalled",
+                  (unsigned long long)(nowMs - info.lastBeatMs));
+    if (abortFn) {
+      abortFn();
+    }
+  }
+}
+
+void HealthMonitor_setup() {
+  for (size_t i = 0; i < SUBSYSTEM_COUNT; i++) {
+    s_stallDurations[i] = LatencyHistogram(0, LatencyHistogram::outageBoundsUs());
+  }
+  g_controlTimers.armPeriodic(s_checkTimer, Config::HEALTH_CHECK_INTERVAL_MS, checkSubsystems);
+}
+
+// =============================================================================
+// REGISTRATION & HEARTBEATS
+// =============================================================================
+
+void HealthMonitor_configure(Subsystem sub, uint32_t stallTimeoutMs, SubsystemAbortFn abortFn) {
+  SubsystemInfo *info = lookup(sub);
+  if (!info) return;
+  portENTER_CRITICAL(&s_healthMux);
+  info->stallTimeoutMs = stallTimeoutMs;
+  info->abortFn = abortFn;
+  portEXIT_CRITICAL(&s_healthMux);
+}
+
+void HealthMonitor_start(Subsystem sub) {
+  SubsystemInfo *info = lookup(sub);
+  if (!info) return;
+  uint64_t nowMs = TimerService_nowMs();
+  portENTER_CRITICAL(&s_healthMux);
+  if (!info->watched) {
+    info->watched = true;
+    info->lastBeatMs = nowMs;
+    info->checkFromMs = nowMs;
+  }
+  portEXIT_CRITICAL(&s_healthMux);
+}
+
+void HealthMonitor_stop(Subsystem sub) {
+  SubsystemInfo *info = lookup(sub);
+  if (!info) return;
+  uint64_t nowMs = TimerService_nowMs();
+  portENTER_CRITICAL(&s_healthMux);
+  info->watched = false;
+  if (info->stalled) {
+    endStallLocked(static_cast<size_t>(sub), nowMs);
+  }
+  portEXIT_CRITICAL(&s_healthMux);
+}
+
+void HealthMonitor_beat(Subsystem sub) {
+  SubsystemInfo *info = lookup(sub);
+  if (!info) return;
+  uint64_t nowMs = TimerService_nowMs();
+  uint32_t stallUs = 0;
+  bool ended = false;
+  portENTER_CRITICAL(&s_healthMux);
+  if (info->stalled) {
+    stallUs = endStallLocked(static_cast<size_t>(sub), nowMs);
+    ended = true;
+  }
+  info->lastBeatMs = nowMs;
+  info->checkFromMs = nowMs;
+  portEXIT_CRITICAL(&s_healthMux);
+  if (ended) {
+    Serial.printf("Health: %s recovered after %u ms\n", info->name, stallUs / 1000);
+  }
+}
+
+bool HealthMonitor_takeRecovery(Subsystem sub) {
+  SubsystemInfo *info = lookup(sub);
+  if (!info) return false;
+  portENTER_CRITICAL(&s_healthMux);
+  bool pending = info->recoveryPending;
+  info->recoveryPending = false;
+  portEXIT_CRITICAL(&s_healthMux);
+  return pending;
+}
+
+// =============================================================================
+// STATISTICS
+// =============================================================================
+
+const char *HealthMonitor_name(Subsystem sub) {
+  SubsystemInfo *info = lookup(sub);
+  return info ? info->name : "unknown";
+}
+
+bool HealthMonitor_healthy(Subsystem sub) {
+  SubsystemInfo *info = lookup(sub);
+  return !info || !info->stalled;
+}
+
+uint32_t HealthMonitor_stallCount(Subsystem sub) {
+  SubsystemInfo *info = lookup(sub);
+  return info ? info->stalls : 0;
+}
+
+uint32_t HealthMonitor_recoveryCount(Subsystem sub) {
+  SubsystemInfo *info = lookup(sub);
+  return info ? info->recoveries : 0;
+}
+
+const LatencyHistogram &HealthMonitor_stallDurations(Subsystem sub) {
+  size_t idx = static_cast<size_t>(sub);
+  return s_stallDurations[idx < SUBSYSTEM_COUNT ? idx : 0];
+}
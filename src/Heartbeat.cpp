@@ -0,0 +1,109 @@
+/**
+ * =============================================================================
+ * Heartbeat.cpp - UDP Heartbeats from an Agent on the PC
+ * =============================================================================
+ *
+ *   agent ──UDP──► lwIP ──► onDatagram() (tcpip thread)
+ *                              │  source check, timestamp, count
+ *                              └─ pbuf_free()
+ *
+ *   HangRecovery (control task) ──► Heartbeat_lastUs()
+ *
+ * The PCB is created and bound inside the tcpip thread (tcpip_callback),
+ * as the raw API requires.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <lwip/tcpip.h>
+#include <lwip/udp.h>
+
+#include "Config.h"
+#include "Constants.h"
+#include "Heartbeat.h"
+
+extern StoredConfig g_config;
+
+static struct udp_pcb *s_pcb = nullptr;
+static uint32_t s_source = 0;  // Probe address (network order), 0 = any sender
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static HeartbeatStats s_stats = {};
+
+// =============================================================================
+// RECEIVE (tcpip thread)
+// =============================================================================
+
+static void onDatagram(void *, struct udp_pcb *, struct pbuf *p, const ip_addr_t *addr, u16_t) {
+  bool accepted = s_source == 0 || (IP_IS_V4(addr) && ip4_addr_get_u32(ip_2_ip4(addr)) == s_source);
+  int64_t nowUs = esp_timer_get_time();
+  portENTER_CRITICAL(&s_mux);
+  if (accepted) {
+    s_stats.accepted++;
+    s_stats.lastUs = nowUs;
+  } else {
+    s_stats.rejected++;
+  }
+  portEXIT_CRITICAL(&s_mux);
+  pbuf_free(p);
+}
+
+static void bindPcb(void *ctx) {
+  uint16_t port = static_cast<uint16_t>(reinterpret_cast<uintptr_t>(ctx));
+  s_pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+  if (!s_pcb) {
+    Serial.println("Heartbeat: no UDP PCB");
+    return;
+  }
+  if (udp_bind(s_pcb, IP_ANY_TYPE, port) != ERR_OK) {
+    Serial.printf("Heartbeat: UDP port %u in use\n", port);
+    udp_remove(s_pcb);
+    s_pcb = nullptr;
+    return;
+  }
+  udp_recv(s_pcb, onDatagram, nullptr);
+  portENTER_CRITICAL(&s_mux);
+  s_stats.enabled = true;
+  s_stats.port = port;
+  portEXIT_CRITICAL(&s_mux);
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+void Heartbeat_setup() {
+  uint16_t port = g_config.heartbeatPort;
+  if (port == 0) {
+    return;
+  }
+
+  IPAddress source;
+  if (g_config.probeHost.length() > 0 && source.fromString(g_config.probeHost)) {
+    s_source = static_cast<uint32_t>(source);
+  }
+
+  if (tcpip_callback(bindPcb, reinterpret_cast<void *>(static_cast<uintptr_t>(port))) != ERR_OK) {
+    Serial.println("Heartbeat: tcpip thread not running, listener disabled");
+    return;
+  }
+  Serial.printf("Heartbeat: listening on UDP %u (%s)\n", port,
+                s_source != 0 ? g_config.probeHost.c_str() : "any sender");
+}
+
+HeartbeatStats Heartbeat_stats() {
+  portENTER_CRITICAL(&s_mux);
+  HeartbeatStats stats = s_stats;
+  portEXIT_CRITICAL(&s_mux);
+  return stats;
+}
+
+int64_t Heartbeat_lastUs() {
+  portENTER_CRITICAL(&s_mux);
+  int64_t lastUs = s_stats.lastUs;
+  portEXIT_CRITICAL(&s_mux);
+  return lastUs;
+}
@@ -0,0 +1,161 @@
+/**
+ * =============================================================================
+ * I2cBus.cpp - Shared I2C Bus
+ * =============================================================================
+ *
+ * Wire has its own lock per call, but a register read is two calls (write
+ * pointer, repeated-start read) and a sensor batch many more. The
+ * recursive mutex here spans those, and keeps I2cBus_recover() (which
+ * stops the driver) away from every other user.
+ *
+ * =============================================================================
+ */
+
+#include <Wire.h>
+#include <freertos/semphr.h>
+
+#include "Config.h"
+#include "I2cBus.h"
+
+static SemaphoreHandle_t s_lock = nullptr;
+static I2cBusStats s_stats = {};
+static portMUX_TYPE s_statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool count(bool ok) {
+  portENTER_CRITICAL(&s_statsMux);
+  s_stats.transfers++;
+  if (!ok) {
+    s_stats.errors++;
+  }
+  portEXIT_CRITICAL(&s_statsMux);
+  return ok;
+}
+
+// =============================================================================
+// BUS RECOVERY
+// =============================================================================
+
+static void restartBus() {
+  /**
+   * Release a bus held by a slave that lost sync (SDA stuck low).
+   *
+   * Up to 9 clock pulses on SCL let the slave shift out the rest of its
+   * byte; then a STOP (SDA rising while SCL is high) resets its state
+   * machine. The I2C driver is restarted afterwards.
+   */
+  const uint8_t sda = Config::PIN_I2C_SDA;
+  const uint8_t scl = Config::PIN_I2C_SCL;
+  Wire.end();
+
+  pinMode(sda, INPUT_PULLUP);
+  pinMode(scl, OUTPUT_OPEN_DRAIN);
+  digitalWrite(scl, HIGH);
+  delayMicroseconds(5);
+
+  for (int i = 0; i < 9 && digitalRead(sda) == LOW; i++) {
+    digitalWrite(scl, LOW);
+    delayMicroseconds(5);
+    digitalWrite(scl, HIGH);
+    delayMicroseconds(5);
+  }
+
+  pinMode(sda, OUTPUT_OPEN_DRAIN);
+  digitalWrite(sda, LOW);
+  delayMicroseconds(5);
+  digitalWrite(sda, HIGH);  // STOP
+  delayMicroseconds(5);
+
+  Wire.begin(sda, scl, Config::I2C_CLOCK_HZ);
+  Wire.setTimeOut(Config::I2C_TIMEOUT_MS);
+}
+
+// =============================================================================
+// SETUP & LOCKING
+// =============================================================================
+
+void I2cBus_setup() {
+  if (!s_lock) {
+    s_lock = xSemaphoreCreateRecursiveMutex();
+  }
+  restartBus();
+  Serial.printf("I2cBus: SDA %u, SCL %u at %u kHz\n", Config::PIN_I2C_SDA, Config::PIN_I2C_SCL,
+                static_cast<unsigned>(Config::I2C_CLOCK_HZ / 1000));
+}
+
+I2cLock::I2cLock(uint32_t timeoutMs) {
+  _held = s_lock && xSemaphoreTakeRecursive(s_lock, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+  if (!_held) {
+    portENTER_CRITICAL(&s_statsMux);
+    s_stats.lockTimeouts++;
+    portEXIT_CRITICAL(&s_statsMux);
+  }
+}
+
+I2cLock::~I2cLock() {
+  if (_held) {
+    xSemaphoreGiveRecursive(s_lock);
+  }
+}
+
+// =============================================================================
+// TRANSFERS
+// =============================================================================
+
+bool I2cBus_probe(uint8_t address) {
+  // Not counted: a NACK is the expected answer from an empty address
+  Wire.beginTransmission(address);
+  return Wire.endTransmission() == 0;
+}
+
+bool I2cBus_write(uint8_t address, const uint8_t *data, size_t length) {
+  Wire.beginTransmission(address);
+  Wire.write(data, length);
+  return count(Wire.endTransmission() == 0);
+}
+
+bool I2cBus_read(uint8_t address, uint8_t *data, size_t length) {
+  if (Wire.requestFrom(address, static_cast<uint8_t>(length)) != length) {
+    return count(false);
+  }
+  for (size_t i = 0; i < length; i++) {
+    data[i] = Wire.read();
+  }
+  return count(true);
+}
+
+bool I2cBus_readRegister(uint8_t address, uint8_t reg, uint8_t *data, size_t length) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0) {  // Repeated start
+    return count(false);
+  }
+  return I2cBus_read(address, data, length);
+}
+
+bool I2cBus_writeRegister16(uint8_t address, uint8_t reg, uint16_t value) {
+  uint8_t data[3] = {reg, static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value & 0xFF)};
+  return I2cBus_write(address, data, sizeof(data));
+}
+
+bool I2cBus_readRegister16(uint8_t address, uint8_t reg, uint16_t &value) {
+  uint8_t data[2];
+  if (!I2cBus_readRegister(address, reg, data, sizeof(data))) {
+    return false;
+  }
+  value = static_cast<uint16_t>((data[0] << 8) | data[1]);
+  return true;
+}
+
+void I2cBus_recover() {
+  restartBus();
+  portENTER_CRITICAL(&s_statsMux);
+  s_stats.recoveries++;
+  portEXIT_CRITICAL(&s_statsMux);
+}
+
+I2cBusStats I2cBus_stats() {
+  portENTER_CRITICAL(&s_statsMux);
+  I2cBusStats stats = s_stats;
+  portEXIT_CRITICAL(&s_statsMux);
+  return stats;
+}
@@ -0,0 +1,293 @@
+/**
+ * =============================================================================
+ * IoExpander.cpp - I2C GPIO Expander for Extra PC Channels
+ * =============================================================================
+ *
+ * MCP23017 (IOCON.BANK = 0, so A/B registers are adjacent and one
+ * transfer covers both ports):
+ *   0x00 IODIR  0x04 GPINTEN  0x08 INTCON  0x0A IOCON
+ *   0x0C GPPU   0x12 GPIO     0x14 OLAT
+ *   INTA/INTB are mirrored and open drain; reading GPIO clears INT.
+ *
+ * PCF8574: no registers. A write sets the latch (inputs must be written
+ * high), a one-byte read returns the pins and clears INT.
+ *
+ * =============================================================================
+ */
+
+#include <esp_timer.h>
+
+#include "I2cBus.h"
+#include "IoExpander.h"
+
+static constexpr bool IS_MCP23017 = Config::EXPANDER_PINS == 16;
+
+static constexpr uint8_t REG_IODIR = 0x00;
+static constexpr uint8_t REG_GPINTEN = 0x04;
+static constexpr uint8_t REG_INTCON = 0x08;
+static constexpr uint8_t REG_IOCON = 0x0A;
+static constexpr uint8_t REG_GPPU = 0x0C;
+static constexpr uint8_t REG_GPIO = 0x12;
+static constexpr uint8_t REG_OLAT = 0x14;
+static constexpr uint8_t IOCON_MIRROR_ODR = 0x44;  // INTA = INTB, open drain
+
+static bool s_present = false;
+static uint16_t s_outputMask = 0;     // Relay pins
+static uint16_t s_levels = 0;         // Last read (control task)
+
+// Output latch: changed under s_latchMux, written to the chip holding the bus
+static uint16_t s_latch = 0;
+static bool s_dirty = false;
+static uint16_t s_written = 0;        // Latch on the chip (last good write)
+static int64_t s_pinWrittenUs[16] = {};  // Per pin: when its level last changed on the chip
+static portMUX_TYPE s_latchMux = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile bool s_interrupt = false;
+static volatile int64_t s_interruptUs = 0;
+
+static IoExpanderStats s_stats = {};
+static LatencyHistogram s_readLatency;
+
+// =============================================================================
+// PIN MASKS
+// =============================================================================
+
+static uint16_t channelMask(ChannelPin pin) {
+  uint16_t mask = 0;
+  for (size_t channel = 1; channel <= EXPANDER_CHANNELS; channel++) {
+    mask |= 1u << IoExpander_pin(channel, pin);
+  }
+  return mask;
+}
+
+static uint16_t inactiveRelayLevels() {
+  uint16_t levels = 0;
+  if (!Config::POWER_RELAY_ACTIVE_HIGH) levels |= channelMask(ChannelPin::POWER_RELAY);
+  if (!Config::RESET_RELAY_ACTIVE_HIGH) levels |= channelMask(ChannelPin::RESET_RELAY);
+  return levels;
+}
+
+static uint16_t pullupMask() {
+  uint16_t mask = 0;
+  if (Config::PWR_LED_PIN_MODE == INPUT_PULLUP) mask |= channelMask(ChannelPin::POWER_LED);
+  if (Config::HDD_LED_PIN_MODE == INPUT_PULLUP) mask |= channelMask(ChannelPin::HDD_LED);
+  return mask;
+}
+
+// =============================================================================
+// BUS ACCESS
+// =============================================================================
+
+static bool writeRegister16(uint8_t reg, uint16_t value) {
+  uint8_t data[3] = {reg,
+                     static_cast<uint8_t>(value & 0xFF),  // Port A
+                     static_cast<uint8_t>(value >> 8)};   // Port B
+  return I2cBus_write(Config::EXPANDER_ADDRESS, data, sizeof(data));
+}
+
+static bool writeLatch(uint16_t latch) {
+  if (IS_MCP23017) {
+    return writeRegister16(REG_OLAT, latch);
+  }
+  // PCF8574: inputs are written high (weak pull-up) so they can be read
+  uint8_t data = static_cast<uint8_t>(latch | ~s_outputMask);
+  return I2cBus_write(Config::EXPANDER_ADDRESS, &data, 1);
+}
+
+static bool readInputs(uint16_t &levels) {
+  uint8_t data[2] = {};
+  if (IS_MCP23017) {
+    if (!I2cBus_readRegister(Config::EXPANDER_ADDRESS, REG_GPIO, data, 2)) {
+      return false;
+    }
+  } else if (!I2cBus_read(Config::EXPANDER_ADDRESS, data, 1)) {
+    return false;
+  }
+  levels = static_cast<uint16_t>(data[0] | (data[1] << 8));
+  return true;
+}
+
+static bool writePendingLatch(uint32_t waitMs) {
+  /**
+   * Write the latest latch if it changed since the last good write. The
+   * value is taken while holding the bus, so concurrent writers can only
+   * end with the newest latch on the chip.
+   */
+  I2cLock lock(waitMs);
+  if (!lock.held()) {
+    return false;
+  }
+  portENTER_CRITICAL(&s_latchMux);
+  bool dirty = s_dirty;
+  uint16_t latch = s_latch;
+  s_dirty = false;
+  portEXIT_CRITICAL(&s_latchMux);
+
+  bool ok = !dirty || writeLatch(latch);
+  if (dirty) {
+    int64_t writtenUs = esp_timer_get_time();
+    portENTER_CRITICAL(&s_latchMux);
+    s_stats.writes++;
+    if (!ok) {
+      s_stats.writeErrors++;
+      s_dirty = true;
+    } else {
+      uint16_t changed = s_written ^ latch;
+      for (uint8_t pin = 0; pin < Config::EXPANDER_PINS; pin++) {
+        if (changed & (1u << pin)) {
+          s_pinWrittenUs[pin] = writtenUs;
+        }
+      }
+      s_written = latch;
+    }
+    portEXIT_CRITICAL(&s_latchMux);
+  }
+  return ok;
+}
+
+// =============================================================================
+// SETUP
+// =============================================================================
+
+bool IoExpander_setup() {
+  /**
+   * Relays are written inactive before their pins become outputs, so no
+   * relay closes while the chip is programmed.
+   */
+  if (EXPANDER_CHANNELS == 0) {
+    return false;
+  }
+  s_outputMask = channelMask(ChannelPin::POWER_RELAY) | channelMask(ChannelPin::RESET_RELAY);
+  s_latch = inactiveRelayLevels();
+  s_dirty = false;
+  s_written = s_latch;
+
+  I2cLock lock(Config::I2C_LOCK_TIMEOUT_MS);
+  bool ok = lock.held();
+  if (ok && IS_MCP23017) {
+    const uint8_t iocon[2] = {REG_IOCON, IOCON_MIRROR_ODR};
+    ok = I2cBus_write(Config::EXPANDER_ADDRESS, iocon, sizeof(iocon)) &&
+         writeRegister16(REG_OLAT, s_latch) &&
+         writeRegister16(REG_IODIR, static_cast<uint16_t>(~s_outputMask)) &&
+         writeRegister16(REG_GPPU, pullupMask()) &&
+         writeRegister16(REG_INTCON, 0) &&  // Interrupt on any change
+         writeRegister16(REG_GPINTEN, channelMask(ChannelPin::POWER_LED));
+  } else if (ok) {
+    ok = writeLatch(s_latch);
+  }
+
+  uint16_t levels = 0;
+  s_present = ok && readInputs(levels);
+  s_stats.present = s_present;
+  if (!s_present) {
+    Serial.printf("IoExpander: no %s at 0x%02X - extra PC channels off\n",
+                  IS_MCP23017 ? "MCP23017" : "PCF8574", Config::EXPANDER_ADDRESS);
+    return false;
+  }
+  s_levels = levels;
+  Serial.printf("IoExpander: %s at 0x%02X, %u PC channels\n",
+                IS_MCP23017 ? "MCP23017" : "PCF8574", Config::EXPANDER_ADDRESS,
+                static_cast<unsigned>(EXPANDER_CHANNELS));
+  return true;
+}
+
+bool IoExpander_present() {
+  return s_present;
+}
+
+// =============================================================================
+// INPUTS
+// =============================================================================
+
+void IRAM_ATTR IoExpander_markInterruptFromIsr() {
+  if (!s_interrupt) {
+    s_interruptUs = esp_timer_get_time();
+    s_interrupt = true;
+  }
+  s_stats.interrupts++;
+}
+
+bool IoExpander_takeInterrupt(int64_t &atUs) {
+  if (!s_interrupt) {
+    return false;
+  }
+  atUs = s_interruptUs;
+  s_interrupt = false;
+  return true;
+}
+
+bool IoExpander_read(uint16_t &levels) {
+  if (!s_present) {
+    return false;
+  }
+  I2cLock lock(Config::EXPANDER_LOCK_TIMEOUT_MS);
+  if (!lock.held()) {
+    return false;  // Bus busy with a sensor batch; INT stays pending
+  }
+  int64_t startUs = esp_timer_get_time();
+  bool ok = readInputs(levels);
+  s_readLatency.record(static_cast<uint32_t>(esp_timer_get_time() - startUs));
+  s_stats.reads++;
+  if (!ok) {
+    s_stats.readErrors++;
+    return false;
+  }
+  s_levels = levels;
+  return true;
+}
+
+uint16_t IoExpander_levels() {
+  return s_levels;
+}
+
+// =============================================================================
+// OUTPUTS
+// =============================================================================
+
+bool IoExpander_setOutput(uint8_t pin, bool high) {
+  if (!s_present) {
+    return false;
+  }
+  uint16_t bit = static_cast<uint16_t>(1u << pin);
+  portENTER_CRITICAL(&s_latchMux);
+  s_latch = high ? (s_latch | bit) : (s_latch & ~bit);
+  s_dirty = true;
+  portEXIT_CRITICAL(&s_latchMux);
+  return writePendingLatch(Config::EXPANDER_LOCK_TIMEOUT_MS);
+}
+
+bool IoExpander_outputWritten(uint8_t pin, bool high, int64_t &atUs) {
+  portENTER_CRITICAL(&s_latchMux);
+  bool written = ((s_written >> pin) & 1u) == (high ? 1u : 0u);
+  atUs = s_pinWrittenUs[pin];
+  portEXIT_CRITICAL(&s_latchMux);
+  return written;
+}
+
+void IoExpander_flush() {
+  if (IoExpander_outputsPending()) {
+    writePendingLatch(0);
+  }
+}
+
+bool IoExpander_outputsPending() {
+  portENTER_CRITICAL(&s_latchMux);
+  bool dirty = s_dirty;
+  portEXIT_CRITICAL(&s_latchMux);
+  return dirty;
+}
+
+// =============================================================================
+// STATISTICS
+// =============================================================================
+
+IoExpanderStats IoExpander_stats() {
+  portENTER_CRITICAL(&s_latchMux);
+  IoExpanderStats stats = s_stats;
+  portEXIT_CRITICAL(&s_latchMux);
+  return stats;
+}
+
+const LatencyHistogram &IoExpander_readLatency() {
+  return s_readLatency;
+}
@@ -30,12 +30,18 @@
 #include <LittleFS.h>
 #include <Preferences.h>
 
+#include "BootLearner.h"
 #include "Config.h"
 #include "Constants.h"
+#include "HealthMonitor.h"
+#include "Profiler.h"
+#include "TimerService.h"
 
 // Global configuration and state
 extern StoredConfig g_config;
 extern RuntimeState g_state;
+extern SeqLock<StatusSnapshot> g_statusSnapshot;
+extern TimerWheel g_networkTimers;
 
 // =============================================================================
 // LOCAL OBJECTS
@@ -44,6 +50,13 @@ extern RuntimeState g_state;
 static DNSServer g_dnsServer;  // DNS server for captive portal (redirects all domains)
 static Preferences g_prefs;     // ESP32 NVS (Non-Volatile Storage) for config
 
+// Timers on the network task's wheel
+static Timer g_apBlinkTimer;     // AP mode LED blink
+static Timer g_apIdleTimer;      // AP mode: retry STA when a config exists
+static Timer g_reconnectTimer;   // STA reconnect back-off
+static bool g_apLedState = false;
+static bool g_linkUp = false;    // Last link state seen by Networking_loop (LED/timer transitions)
+
 // =============================================================================
 // PASSWORD OBFUSCATION
 // =============================================================================
@@ -187,6 +200,28 @@ static void loadIdentity() {
 // Unlike LittleFS, NVS data survives firmware and filesystem uploads.
 // Only a factory reset or flash erase clears NVS data.
 
+static const char *channelKey(char *buf, size_t size, size_t channel, const char *field) {
+  /**
+   * NVS key of a PC channel setting ("ch2PwrMs"). Channel 0 keeps the
+   * keys from before channels existed, so its timing survives updates.
+   */
+  if (channel == 0) {
+    if (strcmp(field, "PwrMs") == 0) return "powerPulseMs";
+    if (strcmp(field, "RstMs") == 0) return "resetPulseMs";
+    if (strcmp(field, "GraceMs") == 0) return "bootGraceMs";
+  }
+  snprintf(buf, size, "ch%u%s", static_cast<unsigned>(channel), field);
+  return buf;
+}
+
+static const char *bootProfileNamespace(char *buf, size_t size, size_t channel) {
+  if (channel == 0) {
+    return "bootprof";
+  }
+  snprintf(buf, size, "bootprof%u", static_cast<unsigned>(channel));
+  return buf;
+}
+
 bool Networking_hasConfig() {
   /**
    * Check if WiFi has been configured.
@@ -230,10 +265,26 @@ bool Networking_loadConfig() {
   // Prometheus Integration
   g_config.prometheusEnabled = g_prefs.getBool("promEnabled", true);
   
-  // Timing settings
-  g_config.powerPulseMs = g_prefs.getULong("powerPulseMs", 500);
-  g_config.resetPulseMs = g_prefs.getULong("resetPulseMs", 500);
-  g_config.bootGraceMs = g_prefs.getULong("bootGraceMs", 60000);
+  // Timing settings, per PC channel
+  for (size_t channel = 0; channel < Config::PC_CHANNELS_MAX; channel++) {
+    ChannelConfig &ch = g_config.channels[channel];
+    char key[16];
+    ch.name = g_prefs.getString(channelKey(key, sizeof(key), channel, "Name"), "");
+    ch.powerPulseMs = g_prefs.getULong(channelKey(key, sizeof(key), channel, "PwrMs"), 500);
+    ch.resetPulseMs = g_prefs.getULong(channelKey(key, sizeof(key), channel, "RstMs"), 500);
+    ch.bootGraceMs = g_prefs.getULong(channelKey(key, sizeof(key), channel, "GraceMs"), 60000);
+  }
+
+  // Reachability probe
+  g_config.probeHost = g_prefs.getString("probeHost", "");
+  g_config.probePorts = g_prefs.getString("probePorts", "");
+  g_config.probeIcmp = g_prefs.getBool("probeIcmp", true);
+
+  // Heartbeats and hang recovery
+  g_config.heartbeatPort = g_prefs.getUShort("hbPort", 0);
+  g_config.heartbeatTimeoutS = g_prefs.getULong("hbTimeoutS", Config::HEARTBEAT_DEFAULT_TIMEOUT_S);
+  g_config.hangRecovery = g_prefs.getBool("hangRecover", false);
+  g_config.hangRequireHddIdle = g_prefs.getBool("hangHddIdle", true);
   
   // Security settings (admin password is also obfuscated)
   String storedAdminPass = g_prefs.getString("adminPassObf", "");
@@ -296,10 +347,26 @@ bool Networking_saveConfig(const StoredConfig &cfg) {
   // Prometheus Integration
   g_prefs.putBool("promEnabled", cfg.prometheusEnabled);
   
-  // Timing settings
-  g_prefs.putULong("powerPulseMs", cfg.powerPulseMs);
-  g_prefs.putULong("resetPulseMs", cfg.resetPulseMs);
-  g_prefs.putULong("bootGraceMs", cfg.bootGraceMs);
+  // Timing settings, per PC channel
+  for (size_t channel = 0; channel < Config::PC_CHANNELS_MAX; channel++) {
+    const ChannelConfig &ch = cfg.channels[channel];
+    char key[16];
+    g_prefs.putString(channelKey(key, sizeof(key), channel, "Name"), ch.name);
+    g_prefs.putULong(channelKey(key, sizeof(key), channel, "PwrMs"), ch.powerPulseMs);
+    g_prefs.putULong(channelKey(key, sizeof(key), channel, "RstMs"), ch.resetPulseMs);
+    g_prefs.putULong(channelKey(key, sizeof(key), channel, "GraceMs"), ch.bootGraceMs);
+  }
+
+  // Reachability probe
+  g_prefs.putString("probeHost", cfg.probeHost);
+  g_prefs.putString("probePorts", cfg.probePorts);
+  g_prefs.putBool("probeIcmp", cfg.probeIcmp);
+
+  // Heartbeats and hang recovery
+  g_prefs.putUShort("hbPort", cfg.heartbeatPort);
+  g_prefs.putULong("hbTimeoutS", cfg.heartbeatTimeoutS);
+  g_prefs.putBool("hangRecover", cfg.hangRecovery);
+  g_prefs.putBool("hangHddIdle", cfg.hangRequireHddIdle);
   
   // Security settings (admin password obfuscated)
   g_prefs.putString("adminPassObf", obfuscatePassword(cfg.adminPassword, key));
@@ -326,6 +393,14 @@ bool Networking_clearConfig() {
   g_prefs.begin("restarter", false);  // Open in read-write mode
   g_prefs.clear();                     // Erase all keys in namespace
   g_prefs.end();
+
+  for (size_t channel = 0; channel < Config::PC_CHANNELS_MAX; channel++) {
+    Preferences bootPrefs;             // Learned boot profiles too
+    char name[16];
+    bootPrefs.begin(bootProfileNamespace(name, sizeof(name), channel), false);
+    bootPrefs.clear();
+    bootPrefs.end();
+  }
   
   // Reset in-memory config to defaults
   g_config = StoredConfig();
@@ -334,10 +409,79 @@ bool Networking_clearConfig() {
   return true;
 }
 
+// Learned boot profile (see BootLearner.h). Own namespace per PC channel
+// and own Preferences object: it is saved from the telemetry task, the
+// config from the network task.
+
+bool Networking_loadBootProfile(size_t channel, BootProfile &profile) {
+  /**
+   * @return false if no boot has been learned yet
+   */
+  Preferences prefs;
+  char name[16];
+  prefs.begin(bootProfileNamespace(name, sizeof(name), channel), true);
+  profile.samples = prefs.getUShort("samples", 0);
+  profile.firstActivityMs = prefs.getULong("firstActMs", 0);
+  profile.settleMs = prefs.getULong("settleMs", 0);
+  prefs.end();
+
+  if (profile.samples == 0) {
+    return false;
+  }
+  Serial.printf("Loaded boot profile (channel %u): settle %lu ms, first activity %lu ms (%u boots)\n",
+                static_cast<unsigned>(channel), static_cast<unsigned long>(profile.settleMs),
+                static_cast<unsigned long>(profile.firstActivityMs), profile.samples);
+  return true;
+}
+
+bool Networking_saveBootProfile(size_t channel, const BootProfile &profile) {
+  /**
+   * Called once per learned boot, so flash wear is negligible.
+   */
+  Preferences prefs;
+  char name[16];
+  if (!prefs.begin(bootProfileNamespace(name, sizeof(name), channel), false)) {
+    return false;
+  }
+  prefs.putUShort("samples", profile.samples);
+  prefs.putULong("firstActMs", profile.firstActivityMs);
+  prefs.putULong("settleMs", profile.settleMs);
+  prefs.end();
+  return true;
+}
+
 // =============================================================================
 // WIFI CONNECTION
 // =============================================================================
 
+static void publishNetworkSnapshot() {
+  /**
+   * Publish the network task's part of the status snapshot.
+   * Called on every mode/link change, never per loop pass.
+   */
+  String ssid;
+  IPAddress ip;
+  if (g_state.apMode) {
+    ssid = String(Config::AP_SSID_PREFIX) + g_state.deviceId.substring(6);
+    ip = WiFi.softAPIP();
+  } else if (g_state.wifiConnected) {
+    ssid = WiFi.SSID();
+    ip = WiFi.localIP();
+  } else {
+    ssid = g_config.wifiSsid;
+  }
+
+  bool apMode = g_state.apMode;
+  bool connected = g_state.wifiConnected;
+  uint32_t addr = static_cast<uint32_t>(ip);
+  g_statusSnapshot.update([&](StatusSnapshot &s) {
+    s.apMode = apMode;
+    s.wifiConnected = connected;
+    s.ip = addr;
+    strlcpy(s.ssid, ssid.c_str(), sizeof(s.ssid));
+  });
+}
+
 static bool connectSta() {
   /**
    * Connect to a WiFi router using saved credentials.
@@ -369,6 +513,7 @@ static bool connectSta() {
   Serial.println();
   
   g_state.wifiConnected = (WiFi.status() == WL_CONNECTED);
+  publishNetworkSnapshot();
   
   if (g_state.wifiConnected) {
     Serial.print("Connected! IP: ");
@@ -380,6 +525,57 @@ static bool connectSta() {
   return g_state.wifiConnected;
 }
 
+static void onApBlink(void *) {
+  // Blink LED slowly to indicate AP mode (1s on, 1s off)
+  g_apLedState = !g_apLedState;
+  digitalWrite(Config::PIN_WIFI_ERROR_LED, g_apLedState ? HIGH : LOW);
+}
+
+static void startAp();
+
+static void onApIdleTimeout(void *) {
+  /**
+   * If we have a saved config but are in AP mode (e.g., after failed connect),
+   * leave AP mode after the idle timeout and try the router again.
+   * Falls back to AP mode (re-arming this timer) if that fails.
+   */
+  if (!Networking_hasConfig()) {
+    return;
+  }
+  Serial.println("AP idle timeout - retrying WiFi connection");
+  g_networkTimers.cancel(g_apBlinkTimer);
+  g_dnsServer.stop();
+  WiFi.softAPdisconnect(true);
+  g_state.apMode = false;
+
+  if (connectSta()) {
+    HealthMonitor_start(Subsystem::WIFI);
+  } else {
+    startAp();
+  }
+}
+
+static void onReconnect(void *) {
+  if (WiFi.status() == WL_CONNECTED) {
+    return;
+  }
+  Serial.println("WiFi disconnected - attempting reconnection...");
+  connectSta();
+}
+
+static void restartWifiDriver() {
+  /**
+   * Stall recovery: no link for WIFI_STALL_MS despite reconnect attempts.
+   * Cycle the WiFi driver instead of rebooting; relays and timers are
+   * untouched. Blocks up to WIFI_CONNECT_TIMEOUT_MS like connectSta().
+   */
+  Serial.println("WiFi stalled - restarting WiFi driver");
+  g_networkTimers.cancel(g_reconnectTimer);
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+  connectSta();
+}
+
 static void startAp() {
   /**
    * Start Access Point mode for initial setup.
@@ -399,6 +595,12 @@ static void startAp() {
   
   g_state.apMode = true;
   g_state.wifiConnected = false;
+  g_linkUp = false;
+  HealthMonitor_stop(Subsystem::WIFI);
+  publishNetworkSnapshot();
+
+  g_networkTimers.armPeriodic(g_apBlinkTimer, 1000, onApBlink);
+  g_networkTimers.arm(g_apIdleTimer, Config::AP_IDLE_TIMEOUT_MS, onApIdleTimeout);
   
   Serial.println("=== ACCESS POINT MODE ===");
   Serial.print("SSID: ");
@@ -446,6 +648,7 @@ void Networking_setup() {
   
   // Load saved configuration
   Networking_loadConfig();
+  HealthMonitor_configure(Subsystem::WIFI, Config::WIFI_STALL_MS);
 
   // Decide: connect to WiFi or start setup AP?
   if (!Networking_hasConfig()) {
@@ -454,6 +657,7 @@ void Networking_setup() {
   } else {
     // WiFi configured - try to connect
     g_state.apMode = false;
+    HealthMonitor_start(Subsystem::WIFI);
     if (!connectSta()) {
       // Connection failed - turn on error LED
       digitalWrite(Config::PIN_WIFI_ERROR_LED, HIGH);
@@ -472,39 +676,22 @@ void Networking_loop() {
    * 
    * In AP mode:
    *   - Process DNS requests (for captive portal)
-   *   - Blink LED slowly (1 second on/off)
-   *   - Restart after timeout if config exists
+   *   - LED blink and idle STA retry run as timers (see startAp)
    * 
    * In STA mode:
-   *   - Monitor connection status
-   *   - Reconnect if disconnected
+   *   - Monitor connection status (heartbeat while connected)
+   *   - Restart the WiFi driver if the health monitor reports a stall
+   *   - Arm the reconnect timer if disconnected
    *   - Update LED status
    */
-  static uint32_t lastAttemptMs = 0;
-  static uint32_t apStartMs = millis();
 
   // -------------------------------------------------------------------------
   // Access Point Mode
   // -------------------------------------------------------------------------
   if (g_state.apMode) {
     // Process captive portal DNS requests
+    ProfileScope scope(ProfileStage::DNS_SERVER);
     g_dnsServer.processNextRequest();
-    
-    // Blink LED slowly to indicate AP mode (1s on, 1s off)
-    static uint32_t lastBlinkMs = 0;
-    static bool ledState = false;
-    if (millis() - lastBlinkMs > 1000) {
-      lastBlinkMs = millis();
-      ledState = !ledState;
-      digitalWrite(Config::PIN_WIFI_ERROR_LED, ledState ? HIGH : LOW);
-    }
-    
-    // If we have a saved config but are in AP mode (e.g., after failed connect),
-    // restart after the idle timeout to try connecting again
-    if (millis() - apStartMs > Config::AP_IDLE_TIMEOUT_MS && Networking_hasConfig()) {
-      Serial.println("AP idle timeout - restarting to retry WiFi connection");
-      ESP.restart();
-    }
     return;
   }
 
@@ -512,21 +699,29 @@ void Networking_loop() {
   // Station Mode
   // -------------------------------------------------------------------------
   
-  // Check if we're connected
-  if (WiFi.status() == WL_CONNECTED) {
-    g_state.wifiConnected = true;
+  // Check if we're connected (LED is only written on transitions)
+  bool connected = (WiFi.status() == WL_CONNECTED);
+  if (connected) {
+    HealthMonitor_beat(Subsystem::WIFI);
+  } else if (HealthMonitor_takeRecovery(Subsystem::WIFI)) {
+    restartWifiDriver();
+    connected = (WiFi.status() == WL_CONNECTED);
+  }
+  g_state.wifiConnected = connected;
+
+  if (connected == g_linkUp && (connected || g_reconnectTimer.armed())) {
+    return;
+  }
+  g_linkUp = connected;
+  publishNetworkSnapshot();
+
+  if (connected) {
+    g_networkTimers.cancel(g_reconnectTimer);
     digitalWrite(Config::PIN_WIFI_ERROR_LED, LOW);  // LED off = connected
     return;
   }
   
-  // Not connected - update state and LED
-  g_state.wifiConnected = false;
-  digitalWrite(Config::PIN_WIFI_ERROR_LED, HIGH);  // LED on = error
-  
-  // Try to reconnect periodically
-  if (millis() - lastAttemptMs > Config::WIFI_CONNECT_TIMEOUT_MS) {
-    lastAttemptMs = millis();
-    Serial.println("WiFi disconnected - attempting reconnection...");
-    connectSta();
-  }
+  // Not connected - LED on = error, retry periodically
+  digitalWrite(Config::PIN_WIFI_ERROR_LED, HIGH);
+  g_networkTimers.armPeriodic(g_reconnectTimer, Config::WIFI_CONNECT_TIMEOUT_MS, onReconnect);
 }
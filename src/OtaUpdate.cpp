@@ -8,8 +8,12 @@
 #include <esp_partition.h>
 
 #include "Config.h"
+#include "HealthMonitor.h"
 #include "OtaUpdate.h"
 #include "OtaUpdateUtils.h"
+#include "PowerManager.h"
+#include "SeqLock.h"
+#include "StatusPublisher.h"
 
 namespace {
 
@@ -36,6 +40,7 @@ struct OtaTaskParams {
 
 SemaphoreHandle_t g_otaMutex = nullptr;
 OtaState g_ota;
+SeqLock<OtaStatus> g_otaStatus;  // Lock-free copy of g_ota for readers
 bool g_otaHasFilesystemStage = false;
 
 constexpr char kLittleFsPartitionLabel[] = "littlefs";
@@ -63,6 +68,41 @@ class OtaLock {
   bool locked_;
 };
 
+void copyText(char *dst, size_t size, const String &src) {
+  static const char kEllipsis[] = "\xE2\x80\xA6";  // "…", marks a cut
+  size_t len = src.length();
+  bool cut = len >= size;
+  if (cut) {
+    len = size - sizeof(kEllipsis);
+    // Don't cut a multi-byte UTF-8 sequence in half
+    while (len > 0 && (static_cast<uint8_t>(src[len]) & 0xC0) == 0x80) {
+      len--;
+    }
+  }
+  memcpy(dst, src.c_str(), len);
+  if (cut) {
+    memcpy(dst + len, kEllipsis, sizeof(kEllipsis) - 1);
+    len += sizeof(kEllipsis) - 1;
+  }
+  dst[len] = '\0';
+}
+
+void publishStatus() {
+  // Caller holds the OTA mutex; readers take the snapshot without it
+  OtaStatus status;
+  status.checking = g_ota.checking;
+  status.updateInProgress = g_ota.updateInProgress;
+  status.available = g_ota.updateAvailable;
+  status.lastCheckOk = g_ota.lastCheckOk;
+  status.rebootRequired = g_ota.rebootRequired;
+  status.progress = g_ota.progress;
+  status.lastCheckMs = g_ota.lastCheckMs;
+  copyText(status.remoteVersion, sizeof(status.remoteVersion), g_ota.remoteVersion);
+  copyText(status.error, sizeof(status.error), g_ota.error);
+  g_otaStatus.write(status);
+  StatusPublisher_markDirty(StatusField::OTA);
+}
+
 void clearReleaseFields() {
   g_ota.updateAvailable = false;
   g_ota.remoteVersion = "";
@@ -72,6 +112,12 @@ void clearReleaseFields() {
 }
 
 void updateProgress(size_t written, size_t total) {
+  // Progress is the heartbeat; a stall reported meanwhile aborts the update
+  HealthMonitor_beat(Subsystem::OTA);
+  if (HealthMonitor_takeRecovery(Subsystem::OTA)) {
+    Update.abort();
+  }
+
   OtaLock lock;
   if (!lock.locked()) return;
   if (total > 0) {
@@ -80,7 +126,10 @@ void updateProgress(size_t written, size_t total) {
     if (g_otaHasFilesystemStage) {
       pct /= 2U;  // 0..50 for firmware, 50..100 for LittleFS
     }
-    g_ota.progress = static_cast<uint8_t>(pct);
+    if (g_ota.progress != pct) {
+      g_ota.progress = static_cast<uint8_t>(pct);
+      publishStatus();
+    }
   }
 }
 
@@ -88,6 +137,7 @@ void setProgressPercent(uint8_t pct) {
   OtaLock lock;
   if (!lock.locked()) return;
   g_ota.progress = pct;
+  publishStatus();
 }
 
 void setTaskError(const String &error) {
@@ -96,6 +146,7 @@ void setTaskError(const String &error) {
   g_ota.error = error;
   g_ota.updateInProgress = false;
   g_ota.rebootRequired = false;
+  publishStatus();
 }
 
 bool flashLittleFsImage(const String &url, String &errorOut) {
@@ -173,6 +224,12 @@ bool flashLittleFsImage(const String &url, String &errorOut) {
       }
 
       written += static_cast<size_t>(bytes);
+      HealthMonitor_beat(Subsystem::OTA);
+      if (HealthMonitor_takeRecovery(Subsystem::OTA)) {
+        https.end();
+        errorOut = "LittleFS download stalled";
+        return false;
+      }
       uint32_t stage = static_cast<uint32_t>((written * 50U) / imageSize);
       if (stage > 50U) stage = 50U;
       setProgressPercent(static_cast<uint8_t>(50U + stage));
@@ -192,6 +249,10 @@ void otaTask(void *param) {
   String filesystemUrl = taskParams->filesystemUrl;
   delete taskParams;
 
+  // Full clock for the download; released in failTask (success reboots)
+  PowerManager_acquire(PowerHold::OTA);
+  HealthMonitor_start(Subsystem::OTA);
+
   WiFiClientSecure client;
   OtaUpdateUtils::configureSecureClient(client, Config::OTA_DOWNLOAD_TIMEOUT_MS);
 
@@ -199,6 +260,8 @@ void otaTask(void *param) {
   OtaUpdateUtils::configureHttpsClient(https, Config::OTA_DOWNLOAD_TIMEOUT_MS);
   auto failTask = [](const String &err) {
     setTaskError(err);
+    HealthMonitor_stop(Subsystem::OTA);
+    PowerManager_release(PowerHold::OTA);
     vTaskDelete(nullptr);
   };
   if (!https.begin(client, firmwareUrl)) {
@@ -259,9 +322,11 @@ void otaTask(void *param) {
       g_ota.updateInProgress = false;
       g_ota.rebootRequired = true;
       g_ota.error = "";
+      publishStatus();
     }
   }
 
+  HealthMonitor_stop(Subsystem::OTA);
   Serial.println("OTA update successful. Rebooting...");
   delay(1000);
   ESP.restart();
@@ -274,6 +339,7 @@ void OtaUpdate_setup() {
   if (!g_otaMutex) {
     g_otaMutex = xSemaphoreCreateMutex();
   }
+  HealthMonitor_configure(Subsystem::OTA, Config::OTA_STALL_MS);
 
   OtaLock lock;
   if (!lock.locked()) return;
@@ -294,6 +360,7 @@ void OtaUpdate_setup() {
 }
 
 bool OtaUpdate_checkVersion() {
+  PowerHoldGuard powerHold(PowerHold::OTA);
   {
     OtaLock lock;
     if (!lock.locked()) return false;
@@ -303,6 +370,7 @@ bool OtaUpdate_checkVersion() {
     g_ota.checking = true;
     g_ota.lastCheckOk = false;
     g_ota.error = "";
+    publishStatus();
   }
 
   String responseBody;
@@ -358,6 +426,7 @@ bool OtaUpdate_checkVersion() {
     g_ota.lastCheckOk = false;
     clearReleaseFields();
     g_ota.error = fetchError;
+    publishStatus();
     return false;
   }
 
@@ -368,6 +437,7 @@ bool OtaUpdate_checkVersion() {
   g_ota.notes = notes;
   g_ota.updateAvailable = (OtaUpdateUtils::compareVersions(g_ota.currentVersion, remoteVersion) < 0);
   g_ota.error = "";
+  publishStatus();
   return true;
 }
 
@@ -378,10 +448,12 @@ bool OtaUpdate_startUpdate() {
   if (g_ota.updateInProgress || g_ota.checking) return false;
   if (!WiFi.isConnected()) {
     g_ota.error = "WiFi not connected";
+    publishStatus();
     return false;
   }
   if (!g_ota.updateAvailable || g_ota.firmwareUrl.length() == 0) {
     g_ota.error = "No update available";
+    publishStatus();
     return false;
   }
 
@@ -389,6 +461,7 @@ bool OtaUpdate_startUpdate() {
   g_ota.rebootRequired = false;
   g_ota.progress = 0;
   g_ota.error = "";
+  publishStatus();
 
   OtaTaskParams *taskParams = new OtaTaskParams{g_ota.firmwareUrl, g_ota.filesystemUrl};
   BaseType_t taskOk = xTaskCreate(otaTask, "ota_task", 12288, taskParams, 1, nullptr);
@@ -397,35 +470,42 @@ bool OtaUpdate_startUpdate() {
     delete taskParams;
     g_ota.updateInProgress = false;
     g_ota.error = "Failed to start OTA task";
+    publishStatus();
     return false;
   }
   return true;
 }
 
 bool OtaUpdate_isBusy() {
+  OtaStatus status = g_otaStatus.read();
+  return status.checking || status.updateInProgress;
+}
+
+OtaStatus OtaUpdate_status() {
+  return g_otaStatus.read();
+}
+
+String OtaUpdate_notes() {
   OtaLock lock;
-  if (!lock.locked()) return false;
-  return g_ota.checking || g_ota.updateInProgress;
+  if (!lock.locked()) return String();
+  return g_ota.notes;
 }
 
 String OtaUpdate_getStatusJson() {
-  OtaLock lock;
-  StaticJsonDocument<512> doc;
-  if (lock.locked()) {
-    doc["checking"] = g_ota.checking;
-    doc["updateInProgress"] = g_ota.updateInProgress;
-    doc["available"] = g_ota.updateAvailable;
-    doc["lastCheckOk"] = g_ota.lastCheckOk;
-    doc["rebootRequired"] = g_ota.rebootRequired;
-    doc["progress"] = g_ota.progress;
-    doc["lastCheckMs"] = g_ota.lastCheckMs;
-    doc["currentVersion"] = g_ota.currentVersion;
-    doc["remoteVersion"] = g_ota.remoteVersion;
-    doc["notes"] = g_ota.notes;
-    doc["error"] = g_ota.error;
-  } else {
-    doc["error"] = "OTA status unavailable";
-  }
+  // From the snapshot: never waits on a running check or download
+  OtaStatus status = g_otaStatus.read();
+  StaticJsonDocument<768> doc;
+  doc["checking"] = status.checking;
+  doc["updateInProgress"] = status.updateInProgress;
+  doc["available"] = status.available;
+  doc["lastCheckOk"] = status.lastCheckOk;
+  doc["rebootRequired"] = status.rebootRequired;
+  doc["progress"] = status.progress;
+  doc["lastCheckMs"] = status.lastCheckMs;
+  doc["currentVersion"] = Config::FW_VERSION;
+  doc["remoteVersion"] = status.remoteVersion;
+  doc["notes"] = OtaUpdate_notes();
+  doc["error"] = status.error;
 
   String out;
   serializeJson(doc, out);
@@ -11,9 +11,22 @@
  * HOW THE STATE MACHINE WORKS:
  * 
  *   1. When power LED turns ON, we transition to BOOTING
- *   2. After bootGraceMs (default 60s), we transition to RUNNING
+ *   2. When the boot's HDD activity settles, we transition to RUNNING
+ *      (BootLearner.h; bootGraceMs is the ceiling until a boot is learned)
  *   3. When power LED turns OFF, we transition to OFF
  *   4. When a relay is active, we show RESTARTING
+ *   5. When the power LED blinks, we show SLEEP or UNKNOWN_BLINK
+ *      (waking from SLEEP goes straight back to RUNNING)
+ * 
+ * RELAY TIMING:
+ * 
+ *   pulse ──► relay closed ──► esp_timer one-shot ──► relay opened
+ *             (control task)                         (esp_timer task)
+ * 
+ *   update() only logs releases; it releases a relay itself only if the
+ *   one-shot could not be armed. Expander relays are opened by update()
+ *   itself: their one-shot only wakes the control task (no I2C in the
+ *   esp_timer task).
  * 
  * =============================================================================
  */
@@ -21,91 +34,247 @@
 #include <Arduino.h>
 #include "PCController.h"
 #include "Constants.h"
+#include "TaskScheduler.h"
+#include "TimerService.h"
 
 // Access the global configuration for timing values
 extern StoredConfig g_config;
 
+// Woken by expander pulse timers (see setControlTask())
+static int s_controlTask = -1;
+
 // =============================================================================
 // INITIALIZATION
 // =============================================================================
 
-void PCController::begin() {
-  // Configure GPIO pins for inputs and outputs
-  
-  // LED inputs (from PC via optocouplers)
-  pinMode(Config::PIN_PWR_LED, Config::PWR_LED_PIN_MODE);
-  pinMode(Config::PIN_HDD_LED, Config::HDD_LED_PIN_MODE);
-  
-  // Relay outputs (active high by default)
-  pinMode(Config::PIN_RELAY_POWER, OUTPUT);
-  pinMode(Config::PIN_RELAY_RESET, OUTPUT);
+void PCController::begin(uint8_t channel) {
+  channelIndex = channel;
+  if (primary()) {
+    // Configure GPIO pins for inputs and outputs
+
+    // LED inputs (from PC via optocouplers)
+    PowerLedPin::begin();
+    HddLedPin::begin();
+
+    // Relay outputs (polarity from Config.h, see FastGpio.h)
+    PowerRelayPin::begin();
+    ResetRelayPin::begin();
+    logTag[0] = '\0';
+  } else {
+    // Expander pins are programmed by IoExpander_setup()
+    powerPulse.expanderPin = static_cast<int8_t>(IoExpander_pin(channel, ChannelPin::POWER_RELAY));
+    powerPulse.activeHigh = Config::POWER_RELAY_ACTIVE_HIGH;
+    resetPulse.expanderPin = static_cast<int8_t>(IoExpander_pin(channel, ChannelPin::RESET_RELAY));
+    resetPulse.activeHigh = Config::RESET_RELAY_ACTIVE_HIGH;
+    snprintf(logTag, sizeof(logTag), "[ch%u] ", channel);
+  }
+
+  // One-shot release timers (dispatched from the esp_timer task)
+  RelayPulse *pulses[] = {&powerPulse, &resetPulse};
+  for (RelayPulse *pulse : pulses) {
+    if (pulse->timer) continue;
+    esp_timer_create_args_t args = {};
+    args.callback = &PCController::onPulseTimer;
+    args.arg = pulse;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "relay_pulse";
+    if (esp_timer_create(&args, &pulse->timer) != ESP_OK) {
+      pulse->timer = nullptr;
+      Serial.printf("%s relay: no release timer, falling back to polling\n", pulse->name);
+    }
+  }
   
   // Ensure relays are OFF at startup (fail-safe)
   setOutputsInactive();
 
   // Initialize state tracking
-  lastPowerOnMs = 0;
-  rawPowerSignal = readActive(Config::PIN_PWR_LED, Config::PWR_LED_ACTIVE_HIGH);
-  currentPowerSignal = rawPowerSignal;
-  lastPowerSignalChangeMs = millis();
+  powerEdgeTail = powerEdgeHead;
+  powerLevelMismatch = false;
+  powerLedClassifier.reset(powerLedActive(), esp_timer_get_time());
+  powerSignal = powerLedClassifier.signal();
+  if (powerSignal == PowerLedSignal::ON) {
+    // PC was already on: it may still be booting, but we missed the start
+    bootLearner.start(TimerService_nowMs(), false);
+  } else {
+    bootLearner.stop();
+  }
+  booting = bootLearner.booting();
   currentState = PCState::OFF;
 }
 
+void PCController::setControlTask(int taskIndex) {
+  s_controlTask = taskIndex;
+}
+
+const ChannelConfig &PCController::settings() const {
+  return g_config.channels[channelIndex];
+}
+
 // =============================================================================
 // RELAY CONTROL
 // =============================================================================
 
-void PCController::setRelay(uint8_t pin, bool active, bool activeHigh) {
+void PCController::setOutputsInactive() {
   /**
-   * Set a relay to active or inactive state.
+   * Turn off both relays immediately.
    * 
-   * This handles the polarity conversion:
-   *   - If relay is "active high": HIGH = relay ON, LOW = relay OFF
-   *   - If relay is "active low":  LOW = relay ON, HIGH = relay OFF
+   * This is a fail-safe function called:
+   *   - At startup (to ensure safe initial state)
+   *   - In case of any error condition
    * 
-   * @param pin       GPIO pin number
-   * @param active    True to activate relay, false to deactivate
-   * @param activeHigh True if relay triggers on HIGH signal
+   * Pulses cut short here are not recorded as pulse measurements.
    */
-  bool level = activeHigh ? active : !active;
-  digitalWrite(pin, level ? HIGH : LOW);
+  RelayPulse *pulses[] = {&powerPulse, &resetPulse};
+  for (RelayPulse *pulse : pulses) {
+    if (pulse->timer) {
+      esp_timer_stop(pulse->timer);  // Not running is fine
+    }
+    pulse->drive(false);
+    pulse->timed = false;
+    pulse->closeWritten = false;
+    pulse->releasing = false;
+    pulse->active = false;
+    pulse->released = false;
+  }
+  powerRelayLatched = false;
 }
 
-bool PCController::readActive(uint8_t pin, bool activeHigh) const {
+// =============================================================================
+// PULSE TIMING
+// =============================================================================
+
+void PCController::startPulse(RelayPulse &pulse, uint32_t durationMs) {
   /**
-   * Read an input and determine if it's "active".
+   * Close the relay and arm its release.
    * 
-   * This handles polarity conversion for optocouplers:
-   *   - Active HIGH: signal is active when GPIO reads HIGH
-   *   - Active LOW:  signal is active when GPIO reads LOW
-   *     (Most optocouplers pull the GPIO LOW when the LED is on)
+   * The running one-shot is stopped first. On channel 0 its callback
+   * never blocks and the esp_timer task outranks this one (single core),
+   * so once esp_timer_stop() returns the callback cannot be running, and
+   * the fields below are not shared with the esp_timer task until the new
+   * one-shot is armed. An expander one-shot only wakes the control task,
+   * so a stale one costs a tick at most. A press while the relay is
+   * already closed keeps it closed and moves the release to
+   * now + durationMs, like the old deadline-based timing.
    */
-  bool level = digitalRead(pin) == HIGH;
-  return activeHigh ? level : !level;
+  if (pulse.timer) {
+    esp_timer_stop(pulse.timer);
+  }
+  pulse.released = false;
+
+  int64_t nowUs = esp_timer_get_time();
+  if (pulse.releasing) {
+    // Expander: a release that already reached the chip ends the old pulse
+    int64_t writtenUs = 0;
+    if (IoExpander_outputWritten(static_cast<uint8_t>(pulse.expanderPin), !pulse.activeHigh, writtenUs)) {
+      pulse.releasing = false;
+      if (pulse.closeWritten) {
+        finishPulse(pulse, writtenUs);
+      } else {
+        pulse.active = false;
+      }
+    }
+  }
+  if (!pulse.active) {
+    pulse.drive(true);
+    pulse.startUs = esp_timer_get_time();
+    pulse.closeWritten = false;
+    pulse.active = true;
+  } else if (pulse.releasing) {
+    // Expander release still in the latch only: the relay never opened
+    pulse.drive(true);
+    pulse.releasing = false;
+  }
+  pulse.deadlineUs = nowUs + static_cast<int64_t>(durationMs) * 1000;
+
+  int64_t delayUs = pulse.deadlineUs - esp_timer_get_time();
+  pulse.timed = pulse.timer &&
+                esp_timer_start_once(pulse.timer, delayUs > 0 ? static_cast<uint64_t>(delayUs) : 0) == ESP_OK;
 }
 
-void PCController::setOutputsInactive() {
-  /**
-   * Turn off both relays immediately.
-   * 
-   * This is a fail-safe function called:
-   *   - At startup (to ensure safe initial state)
-   *   - After pulse durations expire
-   *   - In case of any error condition
-   */
-  setRelay(Config::PIN_RELAY_POWER, false, Config::POWER_RELAY_ACTIVE_HIGH);
-  setRelay(Config::PIN_RELAY_RESET, false, Config::RESET_RELAY_ACTIVE_HIGH);
-  powerPulseUntilMs = 0;
-  resetPulseUntilMs = 0;
-  powerRelayLatched = false;
-  resetRelayLatched = false;
+void PCController::releasePulse(RelayPulse &pulse) {
+  pulse.drive(false);
+  finishPulse(pulse, esp_timer_get_time());
+}
+
+void PCController::finishPulse(RelayPulse &pulse, int64_t endUs) {
+  int64_t widthUs = endUs - pulse.startUs;
+  int64_t errorUs = widthUs - (pulse.deadlineUs - pulse.startUs);
+  if (errorUs < 0) errorUs = -errorUs;
+  pulse.lastWidthUs = widthUs > 0 ? static_cast<uint32_t>(widthUs) : 0;
+  pulse.error.record(errorUs > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(errorUs));
+
+  pulse.active = false;
+  pulse.released = true;
+}
+
+void PCController::onPulseTimer(void *arg) {
+  RelayPulse *pulse = static_cast<RelayPulse *>(arg);
+  if (pulse->expanderPin >= 0) {
+    // Never wait for the I2C bus here; the control task releases it
+    if (s_controlTask >= 0) {
+      TaskScheduler_wake(static_cast<size_t>(s_controlTask));
+    }
+    return;
+  }
+  if (pulse->active) {
+    releasePulse(*pulse);
+  }
+}
+
+bool PCController::serviceExpanderPulse(RelayPulse &pulse, int64_t nowUs) {
+  if (!pulse.active) {
+    return true;
+  }
+  uint8_t pin = static_cast<uint8_t>(pulse.expanderPin);
+  int64_t writtenUs = 0;
+  if (!pulse.closeWritten && !pulse.releasing &&
+      IoExpander_outputWritten(pin, pulse.activeHigh, writtenUs)) {
+    pulse.startUs = writtenUs;
+    pulse.closeWritten = true;
+  }
+  if (!pulse.releasing) {
+    if (nowUs < pulse.deadlineUs) {
+      return true;
+    }
+    pulse.releasing = true;
+    pulse.drive(false);  // On a bus timeout IoExpander_flush() repeats it
+  }
+  if (!IoExpander_outputWritten(pin, !pulse.activeHigh, writtenUs)) {
+    return true;  // Relay still closed
+  }
+  pulse.releasing = false;
+  if (!pulse.closeWritten) {
+    // Bus busy for the whole pulse: the relay never closed
+    pulse.active = false;
+    Serial.printf("%s%s relay: pulse dropped, expander busy\n", logTag, pulse.name);
+    return false;
+  }
+  finishPulse(pulse, writtenUs);
+  return true;
+}
+
+bool PCController::servicePulse(RelayPulse &pulse, int64_t nowUs) {
+  if (pulse.expanderPin >= 0) {
+    if (!serviceExpanderPulse(pulse, nowUs)) {
+      return false;
+    }
+  } else if (pulse.active && !pulse.timed && nowUs >= pulse.deadlineUs) {
+    releasePulse(pulse);
+  }
+  if (!pulse.released) {
+    return false;
+  }
+  pulse.released = false;
+  Serial.printf("%s%s relay: released after %lu ms\n", logTag, pulse.name,
+                static_cast<unsigned long>(pulse.lastWidthUs / 1000));
+  return true;
 }
 
 // =============================================================================
 // BUTTON ACTIONS
 // =============================================================================
 
-void PCController::pulsePower() {
+bool PCController::pulsePower() {
   /**
    * Simulate a short power button press.
    * 
@@ -113,25 +282,32 @@ void PCController::pulsePower() {
    * (default 500ms = half a second), then automatically releases.
    * 
    * This is equivalent to pressing and releasing the power button.
+   * Pressed while the PC is off, it starts a boot timeline (channel 0).
    */
-  if (powerRelayLatched) return;
-  powerPulseUntilMs = millis() + g_config.powerPulseMs;
-  setRelay(Config::PIN_RELAY_POWER, true, Config::POWER_RELAY_ACTIVE_HIGH);
+  if (powerRelayForced()) return false;
+  if (primary() && powerSignal == PowerLedSignal::OFF) {
+    BootTimeline_start(BootTrigger::POWER, TimerService_nowMs());
+  }
+  startPulse(powerPulse, settings().powerPulseMs);
+  return true;
 }
 
-void PCController::pulseReset() {
+bool PCController::pulseReset() {
   /**
    * Simulate a short reset button press.
    * 
    * Same as pulsePower() but for the reset button.
    * Duration is controlled by resetPulseMs (default 500ms).
+   * Pressed while the PC is on, it starts a boot timeline (channel 0).
    */
-  if (resetRelayLatched) return;
-  resetPulseUntilMs = millis() + g_config.resetPulseMs;
-  setRelay(Config::PIN_RELAY_RESET, true, Config::RESET_RELAY_ACTIVE_HIGH);
+  if (primary() && powerSignal == PowerLedSignal::ON) {
+    BootTimeline_start(BootTrigger::RESET, TimerService_nowMs());
+  }
+  startPulse(resetPulse, settings().resetPulseMs);
+  return true;
 }
 
-void PCController::forcePower() {
+bool PCController::forcePower() {
   /**
    * Force shutdown by holding power button for 11 seconds.
    * 
@@ -141,86 +317,195 @@ void PCController::forcePower() {
    * 
    * WARNING: This is like pulling the power cord - it may cause
    * data loss or filesystem corruption!
+   *
+   * The power relay is latched for the hold: a power press meanwhile
+   * would move the release to 500 ms from then and turn the forced
+   * shutdown into a normal press.
    */
-  if (powerRelayLatched) return;
-  powerPulseUntilMs = millis() + Config::FORCE_SHUTDOWN_PULSE_MS;
-  setRelay(Config::PIN_RELAY_POWER, true, Config::POWER_RELAY_ACTIVE_HIGH);
+  if (powerRelayForced()) return false;
+  startPulse(powerPulse, Config::FORCE_SHUTDOWN_PULSE_MS);
+  powerRelayLatched = true;
+  return true;
+}
+
+bool PCController::powerRelayForced() {
+  if (powerRelayLatched && !powerPulse.active) {
+    powerRelayLatched = false;  // Hold over (released by its timer)
+  }
+  return powerRelayLatched;
 }
 
 // =============================================================================
 // MAIN UPDATE LOOP
 // =============================================================================
 
-void PCController::update() {
+void PCController::update(uint16_t hddActivityPermille) {
   /**
    * Main periodic handler - call this frequently in loop().
    * 
    * This function:
    *   1. Reads the power LED input
    *   2. Detects power-on events (LED turning on)
-   *   3. Manages relay pulse timing (auto-release after duration)
-   *   4. Updates the PC state machine
+   *   3. Logs relay releases (done by the pulse timers)
+   *   4. Feeds the HDD activity to the boot learner
+   *   5. Updates the PC state machine
    */
-  uint32_t nowMs = millis();
+  uint64_t nowMs = TimerService_nowMs();
+
+  int64_t nowUs = esp_timer_get_time();
 
   // -------------------------------------------------------------------------
-  // Step 1: Read power LED state
+  // Step 1-2: Power LED edges -> classifier decision
   // -------------------------------------------------------------------------
-  bool nextRawPowerSignal = readActive(Config::PIN_PWR_LED, Config::PWR_LED_ACTIVE_HIGH);
-  if (nextRawPowerSignal != rawPowerSignal) {
-    rawPowerSignal = nextRawPowerSignal;
-    lastPowerSignalChangeMs = nowMs;
-  }
+  updatePowerSignal(nowMs, nowUs);
 
-  // Ignore very short glitches on the power LED line so they don't keep the
-  // controller stuck in BOOTING by repeatedly restarting the grace timer.
-  if (currentPowerSignal != rawPowerSignal &&
-      (nowMs - lastPowerSignalChangeMs) >= Config::POWER_SIGNAL_DEBOUNCE_MS) {
-    currentPowerSignal = rawPowerSignal;
-    if (currentPowerSignal) {
-      lastPowerOnMs = nowMs;
-      Serial.println("PC Power LED: ON (boot detected)");
-    } else {
-      Serial.println("PC Power LED: OFF");
-    }
+  // -------------------------------------------------------------------------
+  // Step 3: Relay pulses (released by their one-shot timers)
+  // -------------------------------------------------------------------------
+  servicePulse(powerPulse, nowUs);
+  if (servicePulse(resetPulse, nowUs) && powerSignal == PowerLedSignal::ON) {
+    bootLearner.start(nowMs, false);  // The PC boots again from here
   }
 
   // -------------------------------------------------------------------------
-  // Step 3: Manage relay pulse timing
+  // Step 4: Boot learner (activity of the last full second)
   // -------------------------------------------------------------------------
-  // Check if power relay pulse should end
-  if (!powerRelayLatched && powerPulseUntilMs > 0 && nowMs >= powerPulseUntilMs) {
-    setRelay(Config::PIN_RELAY_POWER, false, Config::POWER_RELAY_ACTIVE_HIGH);
-    powerPulseUntilMs = 0;
-    Serial.println("Power relay: released");
-  }
-  
-  // Check if reset relay pulse should end
-  if (!resetRelayLatched && resetPulseUntilMs > 0 && nowMs >= resetPulseUntilMs) {
-    setRelay(Config::PIN_RELAY_RESET, false, Config::RESET_RELAY_ACTIVE_HIGH);
-    resetPulseUntilMs = 0;
-    Serial.println("Reset relay: released");
+  booting = bootLearner.update(nowMs, hddActivityPermille, settings().bootGraceMs);
+  if (primary()) {
+    updateBootTimeline(nowMs);
   }
 
   // -------------------------------------------------------------------------
-  // Step 4: Update state machine
+  // Step 5: Update state machine
   // -------------------------------------------------------------------------
-  updateState(nowMs);
+  updateState();
+}
+
+// =============================================================================
+// POWER LED
+// =============================================================================
+
+void IRAM_ATTR PCController::recordPowerEdgeFromIsr(bool active) {
+  pushPowerEdge(active, esp_timer_get_time());
+}
+
+void PCController::recordPowerEdge(bool active, int64_t atUs) {
+  pushPowerEdge(active, atUs);
+}
+
+void IRAM_ATTR PCController::pushPowerEdge(bool active, int64_t atUs) {
+  uint32_t head = powerEdgeHead;
+  if (head - powerEdgeTail >= POWER_EDGE_RING_SIZE) {
+    return;  // Full: update() resynchronises from the polled level
+  }
+  uint32_t stamp = static_cast<uint32_t>(atUs);
+  powerEdges[head & (POWER_EDGE_RING_SIZE - 1)] = (stamp & ~1u) | (active ? 1u : 0u);
+  powerEdgeHead = head + 1;
+}
+
+bool PCController::powerLedActive() const {
+  if (primary()) {
+    return PowerLedPin::active();
+  }
+  bool high = (IoExpander_levels() >> IoExpander_pin(channelIndex, ChannelPin::POWER_LED)) & 1u;
+  return high == Config::PWR_LED_ACTIVE_HIGH;
+}
+
+void PCController::updatePowerSignal(uint64_t nowMs, int64_t nowUs) {
+  /**
+   * Drain the edge ring into the classifier, then act on its decision.
+   *
+   * Entries up to `head` were stamped before `nowUs`, so their age is
+   * never negative. If the polled level disagrees with the classifier on
+   * two updates in a row (edges lost), the polled level is fed as an edge.
+   */
+  uint32_t head = powerEdgeHead;
+  uint32_t nowLow = static_cast<uint32_t>(nowUs);
+  for (uint32_t tail = powerEdgeTail; tail != head; tail++) {
+    uint32_t entry = powerEdges[tail & (POWER_EDGE_RING_SIZE - 1)];
+    int64_t tUs = nowUs - static_cast<int64_t>(nowLow - (entry & ~1u));
+    powerLedClassifier.onEdge(tUs, (entry & 1u) != 0);
+    powerEdgeTail = tail + 1;
+  }
+
+  bool polled = powerLedActive();
+  if (polled != powerLedClassifier.level()) {
+    if (powerLevelMismatch) {
+      powerLedClassifier.onEdge(nowUs, polled);
+    }
+    powerLevelMismatch = true;
+  } else {
+    powerLevelMismatch = false;
+  }
+
+  PowerLedSignal next = powerLedClassifier.update(nowUs);
+  if (next == powerSignal) {
+    return;
+  }
+  bool wasOn = powerSignal == PowerLedSignal::ON || powerSignal == PowerLedSignal::SLEEP;
+  powerSignal = next;
+  switch (next) {
+    case PowerLedSignal::ON:
+      if (!wasOn) {
+        bootLearner.start(nowMs, true);
+        if (primary()) {
+          BootTimeline_mark(BootPhase::POWER_LED, nowMs);
+        }
+        Serial.printf("%sPC Power LED: ON (boot detected)\n", logTag);
+      } else {
+        Serial.printf("%sPC Power LED: ON (resumed)\n", logTag);
+      }
+      break;
+    case PowerLedSignal::OFF:
+      bootLearner.stop();
+      Serial.printf("%sPC Power LED: OFF\n", logTag);
+      break;
+    case PowerLedSignal::SLEEP:
+    case PowerLedSignal::UNKNOWN_BLINK:
+      bootLearner.stop();
+      Serial.printf("%sPC Power LED: blinking (%s, period %lu ms, duty %u%%)\n",
+                    logTag, powerLedSignalName(next),
+                    static_cast<unsigned long>(powerLedClassifier.blinkPeriodMs()),
+                    powerLedClassifier.blinkDutyPermille() / 10);
+      break;
+  }
+}
+
+void PCController::updateBootTimeline(uint64_t nowMs) {
+  /**
+   * The learner's flags restart with each boot; mark each rising edge
+   * once. BootTimeline ignores marks while no press started a boot.
+   */
+  bool activitySeen = bootLearner.activitySeen();
+  if (activitySeen && !bootActivitySeen) {
+    BootTimeline_mark(BootPhase::FIRST_ACTIVITY, nowMs);
+  }
+  bootActivitySeen = activitySeen;
+
+  bool settled = bootLearner.settled();
+  if (settled && !bootSettled) {
+    BootTimeline_mark(BootPhase::SETTLED, nowMs);
+  }
+  bootSettled = settled;
+
+  BootTimeline_update(nowMs, powerSignal != PowerLedSignal::OFF);
 }
 
 // =============================================================================
 // STATE MACHINE
 // =============================================================================
 
-void PCController::updateState(uint32_t nowMs) {
+void PCController::updateState() {
   /**
    * Update the PC state based on inputs and timing.
    * 
    * States:
    *   - OFF:        Power LED is off
-   *   - BOOTING:    Power LED on, but within boot grace period
-   *   - RUNNING:    Power LED on, past boot grace period
+   *   - BOOTING:    Power LED on, boot not yet settled (BootLearner)
+   *   - RUNNING:    Power LED on, boot settled or ceiling reached
    *   - RESTARTING: A relay is currently active (action in progress)
+   *   - SLEEP:      Power LED blinking like a sleeping PC
+   *   - UNKNOWN_BLINK: Power LED blinking in some other pattern
    */
   
   // Check if any action is in progress
@@ -229,14 +514,18 @@ void PCController::updateState(uint32_t nowMs) {
   if (actionActive) {
     // While pressing a button, show RESTARTING
     currentState = PCState::RESTARTING;
-  } else if (!currentPowerSignal) {
+  } else if (powerSignal == PowerLedSignal::SLEEP) {
+    currentState = PCState::SLEEP;
+  } else if (powerSignal == PowerLedSignal::UNKNOWN_BLINK) {
+    currentState = PCState::UNKNOWN_BLINK;
+  } else if (powerSignal == PowerLedSignal::OFF) {
     // Power LED is off = PC is off
     currentState = PCState::OFF;
-  } else if ((nowMs - lastPowerOnMs) < g_config.bootGraceMs) {
-    // Power LED is on, but we're still within boot grace period
+  } else if (booting) {
+    // Power LED is on, but the boot's disk activity hasn't settled yet
     currentState = PCState::BOOTING;
   } else {
-    // Power LED is on and boot grace period has passed
+    // Power LED is on and the boot is over
     currentState = PCState::RUNNING;
   }
 }
@@ -250,9 +539,29 @@ PCState PCController::state() const {
 }
 
 bool PCController::powerRelayActive() const {
-  return powerRelayLatched || powerPulseUntilMs > 0;
+  return powerPulse.active;  // A latch only lasts as long as its pulse
 }
 
 bool PCController::resetRelayActive() const {
-  return resetRelayLatched || resetPulseUntilMs > 0;
+  return resetPulse.active;
+}
+
+bool PCController::powerSignalSettling() const {
+  return powerLevelMismatch || powerLedClassifier.pending(esp_timer_get_time());
+}
+
+const LatencyHistogram &PCController::powerPulseError() const {
+  return powerPulse.error;
+}
+
+const LatencyHistogram &PCController::resetPulseError() const {
+  return resetPulse.error;
+}
+
+uint32_t PCController::lastPowerPulseUs() const {
+  return powerPulse.lastWidthUs;
+}
+
+uint32_t PCController::lastResetPulseUs() const {
+  return resetPulse.lastWidthUs;
 }
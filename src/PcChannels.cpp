@@ -0,0 +1,215 @@
+/**
+ * =============================================================================
+ * PcChannels.cpp - One Board, Several PCs
+ * =============================================================================
+ *
+ * The expander is read in the control task only: when its INT fired (a
+ * power LED changed), while a failed read must be repeated, or every
+ * EXPANDER_POLL_MS while an expander PC is on (HDD LEDs don't raise INT
+ * on the MCP23017). Without an INT pin it is polled all the time.
+ *
+ * The HDD ratio adds up the time each LED was lit between reads and is
+ * closed like HddActivity's windows, once per second.
+ *
+ * =============================================================================
+ */
+
+#include <esp_timer.h>
+
+#include "PcChannels.h"
+#include "Config.h"
+#include "HddActivity.h"
+#include "IoExpander.h"
+#include "TimerService.h"
+
+extern StoredConfig g_config;
+extern PCController g_pc;
+
+static constexpr int64_t HDD_WINDOW_US = 1000000;
+
+/**
+ * Time-weighted HDD LED level of one expander channel.
+ */
+struct HddWindow {
+  bool lit = false;
+  int64_t lastUs = 0;         // Last read
+  int64_t windowStartUs = 0;
+  int64_t litUs = 0;          // Lit time in the current window
+  uint16_t ratioPermille = 0; // Last full window
+};
+
+static PCController s_expanderChannels[Config::PC_CHANNELS_MAX - 1];
+static HddWindow s_hdd[Config::PC_CHANNELS_MAX - 1];
+static size_t s_count = 1;
+static uint16_t s_levels = 0;       // Levels of the last good read
+static bool s_readPending = false;  // INT still asserted after a failed read
+static uint64_t s_lastReadMs = 0;
+
+// =============================================================================
+// SETUP
+// =============================================================================
+
+static bool pinLevel(uint16_t levels, size_t channel, ChannelPin pin) {
+  return (levels >> IoExpander_pin(channel, pin)) & 1u;
+}
+
+static bool hddLit(uint16_t levels, size_t channel) {
+  return pinLevel(levels, channel, ChannelPin::HDD_LED) == Config::HDD_LED_ACTIVE_HIGH;
+}
+
+void PcChannels_setup() {
+  s_count = 1;
+  if (!IoExpander_setup()) {
+    return;
+  }
+  s_levels = IoExpander_levels();
+  int64_t nowUs = esp_timer_get_time();
+  for (size_t channel = 1; channel <= EXPANDER_CHANNELS; channel++) {
+    s_expanderChannels[channel - 1].begin(static_cast<uint8_t>(channel));
+    HddWindow &hdd = s_hdd[channel - 1];
+    hdd.lit = hddLit(s_levels, channel);
+    hdd.lastUs = nowUs;
+    hdd.windowStartUs = nowUs;
+  }
+  s_count = 1 + EXPANDER_CHANNELS;
+  s_lastReadMs = TimerService_nowMs();
+}
+
+size_t PcChannels_count() {
+  return s_count;
+}
+
+PCController *PcChannels_get(size_t channel) {
+  if (channel == 0) {
+    return &g_pc;
+  }
+  return channel < s_count ? &s_expanderChannels[channel - 1] : nullptr;
+}
+
+String PcChannels_name(size_t channel) {
+  if (channel < Config::PC_CHANNELS_MAX && g_config.channels[channel].name.length() > 0) {
+    return g_config.channels[channel].name;
+  }
+  return "PC " + String(static_cast<unsigned>(channel));
+}
+
+// =============================================================================
+// UPDATE
+// =============================================================================
+
+static bool expanderPcOn() {
+  for (size_t channel = 1; channel < s_count; channel++) {
+    if (s_expanderChannels[channel - 1].state() != PCState::OFF) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool pollNeeded() {
+  return Config::PIN_EXPANDER_INT < 0 || expanderPcOn();
+}
+
+static void accumulateHdd(HddWindow &hdd, int64_t nowUs) {
+  if (hdd.lit) {
+    hdd.litUs += nowUs - hdd.lastUs;
+  }
+  hdd.lastUs = nowUs;
+  int64_t windowUs = nowUs - hdd.windowStartUs;
+  if (windowUs >= HDD_WINDOW_US) {
+    int64_t ratio = hdd.litUs * 1000 / windowUs;
+    hdd.ratioPermille = static_cast<uint16_t>(ratio > 1000 ? 1000 : ratio);
+    hdd.litUs = 0;
+    hdd.windowStartUs = nowUs;
+  }
+}
+
+static void readExpander(uint64_t nowMs) {
+  /**
+   * One transfer for all channels. A changed power LED is timestamped
+   * with the interrupt if one fired, otherwise with the read.
+   */
+  int64_t interruptUs = 0;
+  bool interrupted = IoExpander_takeInterrupt(interruptUs);
+  bool due = interrupted || s_readPending ||
+             (pollNeeded() && nowMs - s_lastReadMs >= Config::EXPANDER_POLL_MS);
+  if (!due) {
+    return;
+  }
+  s_lastReadMs = nowMs;
+
+  uint16_t levels = 0;
+  if (!IoExpander_read(levels)) {
+    s_readPending = interrupted || s_readPending;
+    return;
+  }
+  s_readPending = false;
+
+  int64_t nowUs = esp_timer_get_time();
+  int64_t edgeUs = interrupted ? interruptUs : nowUs;
+  for (size_t channel = 1; channel < s_count; channel++) {
+    bool power = pinLevel(levels, channel, ChannelPin::POWER_LED);
+    if (power != pinLevel(s_levels, channel, ChannelPin::POWER_LED)) {
+      s_expanderChannels[channel - 1].recordPowerEdge(power == Config::PWR_LED_ACTIVE_HIGH, edgeUs);
+    }
+    HddWindow &hdd = s_hdd[channel - 1];
+    accumulateHdd(hdd, nowUs);
+    hdd.lit = hddLit(levels, channel);
+  }
+  s_levels = levels;
+}
+
+void PcChannels_update() {
+  if (s_count <= 1) {
+    return;
+  }
+  uint64_t nowMs = TimerService_nowMs();
+  readExpander(nowMs);
+
+  int64_t nowUs = esp_timer_get_time();
+  for (size_t channel = 1; channel < s_count; channel++) {
+    HddWindow &hdd = s_hdd[channel - 1];
+    accumulateHdd(hdd, nowUs);
+    s_expanderChannels[channel - 1].update(hdd.ratioPermille);
+  }
+  IoExpander_flush();
+}
+
+void PcChannels_publish(StatusSnapshot &s) {
+  s.channelCount = static_cast<uint8_t>(s_count);
+  for (size_t channel = 0; channel < s_count; channel++) {
+    const PCController &pc = *PcChannels_get(channel);
+    PcChannelStatus &out = s.channels[channel];
+    out.pcState = pc.state();
+    out.powerRelayActive = pc.powerRelayActive();
+    out.resetRelayActive = pc.resetRelayActive();
+    out.hddActivityPermille = channel == 0 ? HddActivity_stats().ratioPermille : s_hdd[channel - 1].ratioPermille;
+  }
+}
+
+// =============================================================================
+// SCHEDULING
+// =============================================================================
+
+bool PcChannels_settling() {
+  if (s_count <= 1) {
+    return false;
+  }
+  if (s_readPending || IoExpander_outputsPending()) {
+    return true;
+  }
+  for (size_t channel = 1; channel < s_count; channel++) {
+    if (s_expanderChannels[channel - 1].powerSignalSettling()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t PcChannels_msUntilPoll() {
+  if (s_count <= 1 || !pollNeeded()) {
+    return UINT32_MAX;
+  }
+  uint64_t elapsedMs = TimerService_nowMs() - s_lastReadMs;
+  return elapsedMs >= Config::EXPANDER_POLL_MS ? 0 : static_cast<uint32_t>(Config::EXPANDER_POLL_MS - elapsedMs);
+}
@@ -0,0 +1,151 @@
+/**
+ * =============================================================================
+ * PowerLedClassifier.cpp - Power LED Waveform Classifier
+ * =============================================================================
+ *
+ * The last few phases (level + start time) are kept; a phase's duration
+ * is the distance to the next one's start. Blink period is measured over
+ * overlapping pairs of phases (off+on, then on+off), so three short phases
+ * already give two periods to compare.
+ *
+ * =============================================================================
+ */
+
+#include "Config.h"
+#include "PowerLedClassifier.h"
+
+static constexpr int64_t GLITCH_US = static_cast<int64_t>(Config::POWER_LED_GLITCH_MS) * 1000;
+static constexpr int64_t MAX_PHASE_US = static_cast<int64_t>(Config::POWER_LED_BLINK_MAX_PHASE_MS) * 1000;
+static constexpr uint8_t BLINK_MIN_PHASES = 3;
+
+const char *powerLedSignalName(PowerLedSignal signal) {
+  switch (signal) {
+    case PowerLedSignal::OFF:           return "off";
+    case PowerLedSignal::ON:            return "on";
+    case PowerLedSignal::SLEEP:         return "sleep";
+    case PowerLedSignal::UNKNOWN_BLINK: return "unknown_blink";
+  }
+  return "unknown";
+}
+
+PowerLedClassifier::PowerLedClassifier()
+    : latencies{LatencyHistogram(0, LatencyHistogram::activityBoundsUs()),
+                LatencyHistogram(0, LatencyHistogram::activityBoundsUs()),
+                LatencyHistogram(0, LatencyHistogram::activityBoundsUs()),
+                LatencyHistogram(0, LatencyHistogram::activityBoundsUs())} {
+  reset(false, 0);
+}
+
+void PowerLedClassifier::reset(bool active, int64_t nowUs) {
+  // Back-date the phase so the level counts as steady right away
+  phases[0].startUs = nowUs - MAX_PHASE_US;
+  phases[0].active = active;
+  phaseCount = 1;
+  current = active ? PowerLedSignal::ON : PowerLedSignal::OFF;
+  lastPeriodMs = 0;
+  lastDutyPermille = 0;
+}
+
+// =============================================================================
+// EDGES
+// =============================================================================
+
+void PowerLedClassifier::onEdge(int64_t tUs, bool active) {
+  /**
+   * Start a new phase, or drop the current one if it was a glitch (the
+   * LED returns to the previous level within POWER_LED_GLITCH_MS).
+   */
+  Phase &cur = phases[phaseCount - 1];
+  if (active == cur.active) {
+    return;
+  }
+  if (tUs < cur.startUs) {
+    tUs = cur.startUs;
+  }
+  if (phaseCount > 1 && tUs - cur.startUs < GLITCH_US) {
+    phaseCount--;  // Previous phase continues
+    return;
+  }
+  if (phaseCount == MAX_PHASES) {
+    for (uint8_t i = 1; i < MAX_PHASES; i++) {
+      phases[i - 1] = phases[i];
+    }
+    phaseCount--;
+  }
+  phases[phaseCount].startUs = tUs;
+  phases[phaseCount].active = active;
+  phaseCount++;
+}
+
+// =============================================================================
+// CLASSIFICATION
+// =============================================================================
+
+int64_t PowerLedClassifier::phaseDurationUs(uint8_t index) const {
+  return phases[index + 1].startUs - phases[index].startUs;
+}
+
+uint8_t PowerLedClassifier::shortPhasesBeforeCurrent() const {
+  uint8_t count = 0;
+  for (int i = phaseCount - 2; i >= 0 && phaseDurationUs(static_cast<uint8_t>(i)) < MAX_PHASE_US; i--) {
+    count++;
+  }
+  return count;
+}
+
+PowerLedSignal PowerLedClassifier::classifyBlink() {
+  /**
+   * Compare the two most recent overlapping periods. Regular and slow
+   * enough is SLEEP; anything else that keeps blinking is UNKNOWN_BLINK.
+   */
+  uint8_t last = phaseCount - 2;  // Newest complete phase
+  int64_t periodA = phaseDurationUs(last - 2) + phaseDurationUs(last - 1);
+  int64_t periodB = phaseDurationUs(last - 1) + phaseDurationUs(last);
+  int64_t onUs = phases[last].active ? phaseDurationUs(last) : phaseDurationUs(last - 1);
+
+  lastPeriodMs = static_cast<uint32_t>(periodB / 1000);
+  lastDutyPermille = periodB > 0 ? static_cast<uint16_t>(onUs * 1000 / periodB) : 0;
+
+  int64_t diff = periodA > periodB ? periodA - periodB : periodB - periodA;
+  int64_t longer = periodA > periodB ? periodA : periodB;
+  bool regular = diff * 100 <= longer * Config::POWER_LED_PERIOD_TOLERANCE_PCT;
+  bool slow = lastPeriodMs >= Config::POWER_LED_SLEEP_MIN_PERIOD_MS;
+  return (regular && slow) ? PowerLedSignal::SLEEP : PowerLedSignal::UNKNOWN_BLINK;
+}
+
+PowerLedSignal PowerLedClassifier::update(int64_t nowUs) {
+  const Phase &cur = phases[phaseCount - 1];
+  int64_t ageUs = nowUs - cur.startUs;
+  uint8_t shortPhases = shortPhasesBeforeCurrent();
+
+  PowerLedSignal next = current;
+  int64_t patternStartUs = cur.startUs;
+  if (ageUs >= MAX_PHASE_US) {
+    next = cur.active ? PowerLedSignal::ON : PowerLedSignal::OFF;
+  } else if (shortPhases >= BLINK_MIN_PHASES) {
+    next = classifyBlink();
+    patternStartUs = phases[phaseCount - 1 - shortPhases].startUs;
+  } else if (shortPhases == 0 && ageUs >= GLITCH_US) {
+    // Left a steady level and stayed there past the glitch filter
+    next = cur.active ? PowerLedSignal::ON : PowerLedSignal::OFF;
+  }
+
+  if (next != current) {
+    int64_t latencyUs = nowUs - patternStartUs;
+    latencies[static_cast<size_t>(next)].record(
+        latencyUs > static_cast<int64_t>(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(latencyUs));
+    current = next;
+  }
+  return current;
+}
+
+bool PowerLedClassifier::pending(int64_t nowUs) const {
+  const Phase &cur = phases[phaseCount - 1];
+  bool decided = (current == PowerLedSignal::ON) == cur.active &&
+                 (current == PowerLedSignal::ON || current == PowerLedSignal::OFF);
+  return !decided && shortPhasesBeforeCurrent() == 0 && nowUs - cur.startUs < GLITCH_US;
+}
+
+const LatencyHistogram &PowerLedClassifier::latency(PowerLedSignal signal) const {
+  return latencies[static_cast<size_t>(signal)];
+}
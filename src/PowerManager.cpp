@@ -0,0 +1,225 @@
+/**
+ * =============================================================================
+ * PowerManager.cpp - Dynamic Frequency Scaling & Automatic Light Sleep
+ * =============================================================================
+ *
+ * Every hold maps to one ESP_PM_CPU_FREQ_MAX lock. esp_pm locks are
+ * themselves counted; the counters kept here are for statistics (time
+ * held per reason, time with any hold).
+ *
+ * Wake edges: the ISR stores the time of the first edge since the last
+ * control tick; the control task records "now - edge" when it runs. This
+ * covers light-sleep exit, clock ramp-up and task scheduling.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <soc/gpio_struct.h>
+
+#include "Config.h"
+#include "PowerManager.h"
+
+// =============================================================================
+// STATE
+// =============================================================================
+
+struct HoldInfo {
+  const char *name;
+  esp_pm_lock_handle_t lock;
+  uint32_t count;
+  int64_t heldSinceUs;
+  uint64_t totalUs;
+};
+
+static HoldInfo s_holds[POWER_HOLD_COUNT] = {
+  {"relay", nullptr, 0, 0, 0},
+  {"http",  nullptr, 0, 0, 0},
+  {"ota",   nullptr, 0, 0, 0},
+};
+
+static portMUX_TYPE s_holdMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_activeHolds = 0;     // Holds with count > 0
+static int64_t s_pinnedSinceUs = 0;
+static uint64_t s_pinnedUs = 0;
+
+static bool s_dfsEnabled = false;
+static bool s_lightSleepEnabled = false;
+
+static volatile int64_t s_pendingEdgeUs = 0;   // 0 = no edge since last tick
+static LatencyHistogram s_wakeLatency;
+
+// =============================================================================
+// SETUP
+// =============================================================================
+
+static esp_err_t configurePm(bool lightSleep) {
+  esp_pm_config_esp32c3_t pm = {};
+  pm.max_freq_mhz = Config::PM_MAX_FREQ_MHZ;
+  pm.min_freq_mhz = Config::PM_MIN_FREQ_MHZ;
+  pm.light_sleep_enable = lightSleep;
+  return esp_pm_configure(&pm);
+}
+
+void PowerManager_setup() {
+  /**
+   * Try DFS + light sleep, then DFS only. Light sleep needs tickless
+   * idle in the SDK config; DFS needs CONFIG_PM_ENABLE.
+   */
+  esp_err_t err = configurePm(true);
+  if (err == ESP_OK) {
+    s_dfsEnabled = true;
+    s_lightSleepEnabled = true;
+    esp_sleep_enable_gpio_wakeup();
+  } else if (configurePm(false) == ESP_OK) {
+    s_dfsEnabled = true;
+  }
+
+  if (s_dfsEnabled) {
+    for (size_t i = 0; i < POWER_HOLD_COUNT; i++) {
+      if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, s_holds[i].name, &s_holds[i].lock) != ESP_OK) {
+        s_holds[i].lock = nullptr;
+      }
+    }
+  }
+
+  Serial.printf("Power: DFS %s (%u-%u MHz), light sleep %s\n",
+                s_dfsEnabled ? "on" : "off",
+                Config::PM_MIN_FREQ_MHZ, Config::PM_MAX_FREQ_MHZ,
+                s_lightSleepEnabled ? "on" : "off");
+}
+
+bool PowerManager_dfsEnabled() {
+  return s_dfsEnabled;
+}
+
+bool PowerManager_lightSleepEnabled() {
+  return s_lightSleepEnabled;
+}
+
+// =============================================================================
+// HOLDS
+// =============================================================================
+
+void PowerManager_acquire(PowerHold hold) {
+  size_t idx = static_cast<size_t>(hold);
+  if (idx >= POWER_HOLD_COUNT) return;
+  HoldInfo &h = s_holds[idx];
+
+  // Raise the clock before the work starts
+  if (h.lock) {
+    esp_pm_lock_acquire(h.lock);
+  }
+
+  int64_t nowUs = esp_timer_get_time();
+  portENTER_CRITICAL(&s_holdMux);
+  if (h.count++ == 0) {
+    h.heldSinceUs = nowUs;
+    if (s_activeHolds++ == 0) {
+      s_pinnedSinceUs = nowUs;
+    }
+  }
+  portEXIT_CRITICAL(&s_holdMux);
+}
+
+void PowerManager_release(PowerHold hold) {
+  size_t idx = static_cast<size_t>(hold);
+  if (idx >= POWER_HOLD_COUNT) return;
+  HoldInfo &h = s_holds[idx];
+
+  int64_t nowUs = esp_timer_get_time();
+  bool released = false;
+  portENTER_CRITICAL(&s_holdMux);
+  if (h.count > 0) {
+    released = true;
+    if (--h.count == 0) {
+      h.totalUs += nowUs - h.heldSinceUs;
+      if (--s_activeHolds == 0) {
+        s_pinnedUs += nowUs - s_pinnedSinceUs;
+      }
+    }
+  }
+  portEXIT_CRITICAL(&s_holdMux);
+
+  if (released && h.lock) {
+    esp_pm_lock_release(h.lock);
+  }
+}
+
+const char *PowerManager_holdName(PowerHold hold) {
+  size_t idx = static_cast<size_t>(hold);
+  return idx < POWER_HOLD_COUNT ? s_holds[idx].name : "unknown";
+}
+
+uint32_t PowerManager_holdCount(PowerHold hold) {
+  size_t idx = static_cast<size_t>(hold);
+  return idx < POWER_HOLD_COUNT ? s_holds[idx].count : 0;
+}
+
+uint64_t PowerManager_holdUs(PowerHold hold) {
+  size_t idx = static_cast<size_t>(hold);
+  if (idx >= POWER_HOLD_COUNT) return 0;
+  int64_t nowUs = esp_timer_get_time();
+  portENTER_CRITICAL(&s_holdMux);
+  const HoldInfo &h = s_holds[idx];
+  uint64_t total = h.totalUs + (h.count > 0 ? nowUs - h.heldSinceUs : 0);
+  portEXIT_CRITICAL(&s_holdMux);
+  return total;
+}
+
+uint64_t PowerManager_pinnedUs() {
+  int64_t nowUs = esp_timer_get_time();
+  portENTER_CRITICAL(&s_holdMux);
+  uint64_t total = s_pinnedUs + (s_activeHolds > 0 ? nowUs - s_pinnedSinceUs : 0);
+  portEXIT_CRITICAL(&s_holdMux);
+  return total;
+}
+
+// =============================================================================
+// GPIO WAKE
+// =============================================================================
+
+FORCE_INLINE_ATTR gpio_int_type_t oppositeLevel(int level) {
+  return level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL;
+}
+
+void PowerManager_enableGpioWake(uint8_t pin) {
+  if (!s_lightSleepEnabled) return;
+  gpio_num_t gpio = static_cast<gpio_num_t>(pin);
+  gpio_wakeup_enable(gpio, oppositeLevel(gpio_get_level(gpio)));
+}
+
+void IRAM_ATTR PowerManager_rearmWakeFromIsr(uint8_t pin) {
+  if (!s_lightSleepEnabled) return;
+  // Inline HAL calls only: the GPIO ISR service runs from IRAM
+  gpio_num_t gpio = static_cast<gpio_num_t>(pin);
+  gpio_ll_wakeup_enable(&GPIO, gpio, oppositeLevel(gpio_ll_get_level(&GPIO, gpio)));
+}
+
+void IRAM_ATTR PowerManager_markEdgeFromIsr() {
+  if (s_pendingEdgeUs == 0) {
+    s_pendingEdgeUs = esp_timer_get_time();
+  }
+}
+
+void PowerManager_recordWake() {
+  portENTER_CRITICAL(&s_holdMux);
+  int64_t edgeUs = s_pendingEdgeUs;
+  s_pendingEdgeUs = 0;
+  portEXIT_CRITICAL(&s_holdMux);
+
+  if (edgeUs != 0) {
+    int64_t latencyUs = esp_timer_get_time() - edgeUs;
+    s_wakeLatency.record(latencyUs > 0 ? static_cast<uint32_t>(latencyUs) : 0);
+  }
+}
+
+const LatencyHistogram &PowerManager_wakeLatency() {
+  return s_wakeLatency;
+}
@@ -0,0 +1,80 @@
+/**
+ * =============================================================================
+ * Profiler.cpp - Per-Subsystem Timing Histograms
+ * =============================================================================
+ *
+ * Each stage has a name (JSON key / Prometheus label) and a time budget.
+ * Samples above the budget are counted as overruns; budgets are chosen so
+ * an overrun means "this stage noticeably delays its task".
+ *
+ * Durations come from esp_timer, which keeps counting at a fixed rate
+ * while the power manager scales the CPU clock.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+
+#include "Profiler.h"
+
+// =============================================================================
+// STAGE TABLE
+// =============================================================================
+
+struct StageInfo {
+  const char *name;
+  uint32_t budgetUs;
+};
+
+static const StageInfo kStages[PROFILE_STAGE_COUNT] = {
+  {"factory_reset",    100},
+  {"commands",         200},
+  {"pc_control",       200},
+  {"hdd_sense",        100},
+  {"pc_channels",      1000},
+  {"networking",       5000},
+  {"dns_server",       2000},
+  {"web_housekeeping", 2000},
+  {"mqtt",             10000},
+  {"status_publish",   10000},
+  {"reachability",     2000},
+  {"sensors",          5000},
+  {"loki",             100000},
+  {"health",           1000},
+  {"http_status",      10000},
+  {"http_metrics",     50000},
+  {"http_config",      10000},
+  {"ws_event",         10000},
+};
+
+static LatencyHistogram s_histograms[PROFILE_STAGE_COUNT];
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+void Profiler_setup() {
+  for (size_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    s_histograms[i] = LatencyHistogram(kStages[i].budgetUs);
+  }
+}
+
+void Profiler_recordUs(ProfileStage stage, uint32_t us) {
+  size_t idx = static_cast<size_t>(stage);
+  if (idx >= PROFILE_STAGE_COUNT) return;
+  s_histograms[idx].record(us);
+}
+
+const char *Profiler_stageName(ProfileStage stage) {
+  size_t idx = static_cast<size_t>(stage);
+  return idx < PROFILE_STAGE_COUNT ? kStages[idx].name : "unknown";
+}
+
+const LatencyHistogram &Profiler_histogram(ProfileStage stage) {
+  size_t idx = static_cast<size_t>(stage);
+  return s_histograms[idx < PROFILE_STAGE_COUNT ? idx : 0];
+}
+
+uint32_t Profiler_cpuMHz() {
+  return ESP.getCpuFreqMHz();
+}
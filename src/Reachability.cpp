@@ -0,0 +1,418 @@
+/**
+ * =============================================================================
+ * Reachability.cpp - Network Probing of the Managed PC
+ * =============================================================================
+ *
+ * One round at a time:
+ *
+ *   startRound (timer) ──► echo sent, connects in progress
+ *          │
+ *   Reachability_loop() polls every network tick (10 ms):
+ *          │  echo reply / connect done  ──► finishRound(answered)
+ *          │  PROBE_TIMEOUT_MS passed    ──► finishRound(timeout)
+ *          ▼
+ *   next round armed on g_networkTimers (adaptive interval)
+ *
+ * The ICMP socket is raw and stays open; TCP sockets live for one round.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <errno.h>
+#include <esp_timer.h>
+#include <lwip/icmp.h>
+#include <lwip/inet_chksum.h>
+#include <lwip/sockets.h>
+
+#include "BootTimeline.h"
+#include "Config.h"
+#include "Constants.h"
+#include "Reachability.h"
+#include "SeqLock.h"
+#include "TimerService.h"
+
+extern StoredConfig g_config;
+extern SeqLock<StatusSnapshot> g_statusSnapshot;
+extern TimerWheel g_networkTimers;
+
+static constexpr uint16_t ICMP_ID = 0x5253;  // "RS"
+
+// Settings (parsed once from g_config)
+static bool s_enabled = false;
+static in_addr_t s_target = 0;
+static bool s_icmp = false;
+static uint16_t s_ports[Config::PROBE_MAX_PORTS];
+static uint8_t s_portCount = 0;
+
+// Round in flight (network task only)
+struct ProbeRound {
+  bool active = false;
+  int64_t startUs = 0;
+  bool icmpPending = false;
+  uint16_t icmpSeq = 0;
+  int tcpSockets[Config::PROBE_MAX_PORTS];
+  uint8_t tcpPending = 0;
+  bool answered = false;
+};
+
+static ProbeRound s_round;
+static int s_icmpSocket = -1;
+static uint16_t s_icmpSeq = 0;
+static Timer s_roundTimer;
+
+static PcReachability s_reachability = PcReachability::UNKNOWN;
+static uint8_t s_failures = 0;
+static uint32_t s_backoffMs = 0;
+
+static SeqLock<ReachabilityStats> s_stats;
+static LatencyHistogram s_rtt[PROBE_METHOD_COUNT];
+
+const char *Reachability_name(PcReachability reachability) {
+  switch (reachability) {
+    case PcReachability::UNKNOWN:      return "UNKNOWN";
+    case PcReachability::RESPONSIVE:   return "RESPONSIVE";
+    case PcReachability::UNRESPONSIVE: return "UNRESPONSIVE";
+  }
+  return "UNKNOWN";
+}
+
+const char *Reachability_methodName(ProbeMethod method) {
+  return method == ProbeMethod::ICMP ? "icmp" : "tcp";
+}
+
+const char *Reachability_resultName(ProbeResult result) {
+  switch (result) {
+    case ProbeResult::OK:      return "ok";
+    case ProbeResult::TIMEOUT: return "timeout";
+    case ProbeResult::ERROR:   return "error";
+  }
+  return "unknown";
+}
+
+// =============================================================================
+// STATE
+// =============================================================================
+
+static void countProbe(ProbeMethod method, ProbeResult result) {
+  s_stats.update([method, result](ReachabilityStats &s) {
+    s.probes[static_cast<size_t>(method)][static_cast<size_t>(result)]++;
+  });
+}
+
+static void recordAnswer(ProbeMethod method, int64_t rttUs) {
+  uint32_t rtt = rttUs > 0 ? static_cast<uint32_t>(rttUs) : 1;
+  s_rtt[static_cast<size_t>(method)].record(rtt);
+  countProbe(method, ProbeResult::OK);
+  uint32_t nowMs = millis();
+  s_stats.update([rtt, nowMs](ReachabilityStats &s) {
+    s.lastRttUs = rtt;
+    s.lastAnswerMs = nowMs;
+  });
+}
+
+static void setReachability(PcReachability next) {
+  if (next == s_reachability) {
+    return;
+  }
+  s_reachability = next;
+  bool unresponsive = next == PcReachability::UNRESPONSIVE;
+  s_stats.update([next, unresponsive](ReachabilityStats &s) {
+    s.reachability = next;
+    if (unresponsive) s.unresponsiveTotal++;
+  });
+  g_statusSnapshot.update([next](StatusSnapshot &s) { s.reachability = next; });
+  Serial.printf("PC network: %s\n", Reachability_name(next));
+}
+
+// =============================================================================
+// SOCKETS
+// =============================================================================
+
+static void openIcmpSocket() {
+  s_icmpSocket = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+  if (s_icmpSocket < 0) {
+    Serial.println("Reachability: no raw socket, ICMP disabled");
+    return;
+  }
+  fcntl(s_icmpSocket, F_SETFL, O_NONBLOCK);
+}
+
+static bool sendEcho(uint16_t seq) {
+  struct icmp_echo_hdr echo = {};
+  ICMPH_TYPE_SET(&echo, ICMP_ECHO);
+  ICMPH_CODE_SET(&echo, 0);
+  echo.id = lwip_htons(ICMP_ID);
+  echo.seqno = lwip_htons(seq);
+  echo.chksum = inet_chksum(&echo, sizeof(echo));
+
+  struct sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_addr.s_addr = s_target;
+  return sendto(s_icmpSocket, &echo, sizeof(echo), 0, reinterpret_cast<struct sockaddr *>(&to), sizeof(to)) ==
+         static_cast<int>(sizeof(echo));
+}
+
+static bool pollEcho(uint16_t seq) {
+  /**
+   * Drain the raw socket; replies are IP header + ICMP header. Replies
+   * from other hosts or to older rounds are dropped.
+   */
+  uint8_t buf[64];
+  struct sockaddr_in from;
+  socklen_t fromLen = sizeof(from);
+  int len;
+  while ((len = recvfrom(s_icmpSocket, buf, sizeof(buf), MSG_DONTWAIT,
+                         reinterpret_cast<struct sockaddr *>(&from), &fromLen)) > 0) {
+    size_t ipHeaderLen = (buf[0] & 0x0F) * 4;
+    if (from.sin_addr.s_addr != s_target || static_cast<size_t>(len) < ipHeaderLen + sizeof(icmp_echo_hdr)) {
+      continue;
+    }
+    const icmp_echo_hdr *reply = reinterpret_cast<const icmp_echo_hdr *>(buf + ipHeaderLen);
+    if (ICMPH_TYPE(reply) == ICMP_ER && lwip_ntohs(reply->id) == ICMP_ID && lwip_ntohs(reply->seqno) == seq) {
+      return true;
+    }
+    fromLen = sizeof(from);
+  }
+  return false;
+}
+
+static int startConnect(uint16_t port) {
+  int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (sock < 0) {
+    return -1;
+  }
+  fcntl(sock, F_SETFL, O_NONBLOCK);
+  struct sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(port);
+  to.sin_addr.s_addr = s_target;
+  if (connect(sock, reinterpret_cast<struct sockaddr *>(&to), sizeof(to)) < 0 && errno != EINPROGRESS) {
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+/**
+ * @return OK when connected or refused, ERROR on other failures,
+ *         TIMEOUT while still in progress
+ */
+static ProbeResult pollConnect(int sock) {
+  fd_set writable;
+  FD_ZERO(&writable);
+  FD_SET(sock, &writable);
+  struct timeval zero = {0, 0};
+  if (select(sock + 1, nullptr, &writable, nullptr, &zero) <= 0) {
+    return ProbeResult::TIMEOUT;
+  }
+  int err = 0;
+  socklen_t errLen = sizeof(err);
+  getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &errLen);
+  return (err == 0 || err == ECONNREFUSED) ? ProbeResult::OK : ProbeResult::ERROR;
+}
+
+static void closeTcpSockets() {
+  for (uint8_t i = 0; i < s_portCount; i++) {
+    if (s_round.tcpSockets[i] >= 0) {
+      close(s_round.tcpSockets[i]);
+      s_round.tcpSockets[i] = -1;
+    }
+  }
+  s_round.tcpPending = 0;
+}
+
+// =============================================================================
+// SCHEDULING
+// =============================================================================
+
+static void startRound(void *);
+
+static bool probingWanted(PCState state) {
+  return state == PCState::BOOTING || state == PCState::RUNNING;
+}
+
+static uint32_t nextIntervalMs(PCState state) {
+  if (state == PCState::BOOTING) {
+    return Config::PROBE_BOOT_INTERVAL_MS;
+  }
+  if (s_reachability == PcReachability::UNRESPONSIVE) {
+    // Back off while the PC stays silent
+    s_backoffMs = s_backoffMs == 0 ? Config::PROBE_SUSPECT_INTERVAL_MS * 2 : s_backoffMs * 2;
+    if (s_backoffMs > Config::PROBE_BACKOFF_MAX_MS) s_backoffMs = Config::PROBE_BACKOFF_MAX_MS;
+    return s_backoffMs;
+  }
+  s_backoffMs = 0;
+  return s_failures > 0 ? Config::PROBE_SUSPECT_INTERVAL_MS : Config::PROBE_STEADY_INTERVAL_MS;
+}
+
+static void scheduleNext(PCState state) {
+  uint32_t intervalMs = probingWanted(state) ? nextIntervalMs(state) : Config::PROBE_IDLE_CHECK_MS;
+  s_stats.update([intervalMs](ReachabilityStats &s) { s.intervalMs = intervalMs; });
+  g_networkTimers.arm(s_roundTimer, intervalMs, startRound);
+}
+
+static void finishRound() {
+  /**
+   * A round is answered if any method answered. Unanswered rounds only
+   * count towards UNRESPONSIVE while RUNNING; a booting PC is expected
+   * to be silent.
+   */
+  closeTcpSockets();
+  s_round.active = false;
+  PCState state = g_statusSnapshot.read().pcState;
+
+  if (s_round.answered) {
+    s_failures = 0;
+    setReachability(PcReachability::RESPONSIVE);
+    BootTimeline_mark(BootPhase::REACHABLE, TimerService_nowMs());
+  } else if (state == PCState::RUNNING) {
+    if (s_failures < UINT8_MAX) s_failures++;
+    if (s_failures >= Config::PROBE_FAIL_THRESHOLD) {
+      setReachability(PcReachability::UNRESPONSIVE);
+    }
+  }
+  uint8_t failures = s_failures;
+  s_stats.update([failures](ReachabilityStats &s) {
+    s.failures = failures;
+    s.rounds++;
+  });
+  scheduleNext(state);
+}
+
+static void startRound(void *) {
+  StatusSnapshot snapshot = g_statusSnapshot.read();
+  if (!probingWanted(snapshot.pcState) || !snapshot.wifiConnected) {
+    s_failures = 0;
+    setReachability(PcReachability::UNKNOWN);
+    scheduleNext(snapshot.pcState);
+    return;
+  }
+
+  s_round.active = true;
+  s_round.startUs = esp_timer_get_time();
+  s_round.answered = false;
+
+  s_round.icmpPending = false;
+  if (s_icmp && s_icmpSocket >= 0) {
+    s_round.icmpSeq = ++s_icmpSeq;
+    pollEcho(s_round.icmpSeq);  // Drop late replies to earlier rounds
+    s_round.icmpPending = sendEcho(s_round.icmpSeq);
+    if (!s_round.icmpPending) countProbe(ProbeMethod::ICMP, ProbeResult::ERROR);
+  }
+
+  s_round.tcpPending = 0;
+  for (uint8_t i = 0; i < s_portCount; i++) {
+    s_round.tcpSockets[i] = startConnect(s_ports[i]);
+    if (s_round.tcpSockets[i] >= 0) {
+      s_round.tcpPending++;
+    } else {
+      countProbe(ProbeMethod::TCP, ProbeResult::ERROR);
+    }
+  }
+
+  if (!s_round.icmpPending && s_round.tcpPending == 0) {
+    finishRound();
+  }
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+void Reachability_setup() {
+  /**
+   * Settings: probe address (IPv4 literal), ICMP on/off and up to
+   * PROBE_MAX_PORTS comma-separated TCP ports. No address, no probing.
+   */
+  for (uint8_t i = 0; i < Config::PROBE_MAX_PORTS; i++) {
+    s_round.tcpSockets[i] = -1;
+  }
+
+  IPAddress target;
+  if (g_config.probeHost.length() == 0) {
+    return;
+  }
+  if (!target.fromString(g_config.probeHost)) {
+    Serial.printf("Reachability: '%s' is not an IPv4 address, probing disabled\n", g_config.probeHost.c_str());
+    return;
+  }
+  s_target = static_cast<uint32_t>(target);
+
+  String ports = g_config.probePorts;
+  int start = 0;
+  while (start < static_cast<int>(ports.length()) && s_portCount < Config::PROBE_MAX_PORTS) {
+    int comma = ports.indexOf(',', start);
+    if (comma < 0) comma = ports.length();
+    long port = ports.substring(start, comma).toInt();
+    if (port > 0 && port <= 65535) {
+      s_ports[s_portCount++] = static_cast<uint16_t>(port);
+    }
+    start = comma + 1;
+  }
+
+  s_icmp = g_config.probeIcmp;
+  if (s_icmp) {
+    openIcmpSocket();
+  }
+  s_enabled = (s_icmp && s_icmpSocket >= 0) || s_portCount > 0;
+  BootTimeline_setExpectReachable(s_enabled);
+  if (!s_enabled) {
+    Serial.println("Reachability: no probe method configured");
+    return;
+  }
+
+  s_stats.update([](ReachabilityStats &s) { s.enabled = true; });
+  Serial.printf("Reachability: probing %s (%s%u TCP ports)\n", g_config.probeHost.c_str(),
+                s_icmp ? "ICMP + " : "", s_portCount);
+  g_networkTimers.arm(s_roundTimer, Config::PROBE_BOOT_INTERVAL_MS, startRound);
+}
+
+void Reachability_loop() {
+  if (!s_round.active) {
+    return;
+  }
+  int64_t nowUs = esp_timer_get_time();
+  int64_t elapsedUs = nowUs - s_round.startUs;
+
+  if (s_round.icmpPending && pollEcho(s_round.icmpSeq)) {
+    s_round.icmpPending = false;
+    s_round.answered = true;
+    recordAnswer(ProbeMethod::ICMP, elapsedUs);
+  }
+  for (uint8_t i = 0; i < s_portCount && s_round.tcpPending > 0; i++) {
+    int sock = s_round.tcpSockets[i];
+    if (sock < 0) continue;
+    ProbeResult result = pollConnect(sock);
+    if (result == ProbeResult::TIMEOUT) continue;
+    close(sock);
+    s_round.tcpSockets[i] = -1;
+    s_round.tcpPending--;
+    if (result == ProbeResult::OK) {
+      s_round.answered = true;
+      recordAnswer(ProbeMethod::TCP, elapsedUs);
+    } else {
+      countProbe(ProbeMethod::TCP, ProbeResult::ERROR);
+    }
+  }
+
+  bool done = s_round.answered || (!s_round.icmpPending && s_round.tcpPending == 0);
+  if (!done && elapsedUs < static_cast<int64_t>(Config::PROBE_TIMEOUT_MS) * 1000) {
+    return;
+  }
+  // Whatever is still pending timed out (or lost the race to an answer)
+  if (!s_round.answered) {
+    if (s_round.icmpPending) countProbe(ProbeMethod::ICMP, ProbeResult::TIMEOUT);
+    for (uint8_t i = 0; i < s_round.tcpPending; i++) countProbe(ProbeMethod::TCP, ProbeResult::TIMEOUT);
+  }
+  finishRound();
+}
+
+ReachabilityStats Reachability_stats() {
+  return s_stats.read();
+}
+
+const LatencyHistogram &Reachability_rtt(ProbeMethod method) {
+  return s_rtt[static_cast<size_t>(method)];
+}
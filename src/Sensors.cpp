@@ -0,0 +1,349 @@
+/**
+ * =============================================================================
+ * Sensors.cpp - I2C Sensor Registry and Scheduler
+ * =============================================================================
+ *
+ * Drivers are created once, at the bus scan, and never freed. Each slot
+ * keeps the scheduling and error state of one sensor; the values are
+ * copied into the status snapshot after every batch, so readers in other
+ * tasks never touch a slot's values.
+ *
+ * =============================================================================
+ */
+
+#include <esp_timer.h>
+
+#include "Config.h"
+#include "Constants.h"
+#include "I2cBus.h"
+#include "Sensors.h"
+#include "TimerService.h"
+#include "sensors/Ina2xx.h"
+#include "sensors/Sht3x.h"
+#include "sensors/Tmp112.h"
+
+extern SeqLock<StatusSnapshot> g_statusSnapshot;
+
+static constexpr uint8_t ON_BOARD_TMP112 = 0x48;
+
+// =============================================================================
+// DRIVER REGISTRY
+// =============================================================================
+
+struct SensorType {
+  uint8_t firstAddress;
+  uint8_t lastAddress;
+  bool (*detect)(uint8_t address);
+  SensorDriver *(*create)(uint8_t address);
+};
+
+// Tried in this order at every address of its range that no earlier entry
+// claimed. Chips with fixed bits or a CRC go before the INA219, which has
+// the weakest check.
+static const SensorType kSensorTypes[] = {
+  {Tmp112::FIRST_ADDRESS, Tmp112::LAST_ADDRESS, Tmp112::detect,
+   [](uint8_t address) -> SensorDriver * { return new Tmp112(address); }},
+  {Sht3x::FIRST_ADDRESS, Sht3x::LAST_ADDRESS, Sht3x::detect,
+   [](uint8_t address) -> SensorDriver * { return new Sht3x(address); }},
+  {Ina2xx::FIRST_ADDRESS, Ina2xx::LAST_ADDRESS, Ina2xx::detectIna226,
+   [](uint8_t address) -> SensorDriver * { return new Ina2xx(address, Ina2xx::Variant::INA226); }},
+  {Ina2xx::FIRST_ADDRESS, Ina2xx::LAST_ADDRESS, Ina2xx::detectIna219,
+   [](uint8_t address) -> SensorDriver * { return new Ina2xx(address, Ina2xx::Variant::INA219); }},
+};
+
+struct QuantityInfo {
+  const char *name;
+  const char *unit;
+  const char *symbol;
+  float publishDelta;
+};
+
+static const QuantityInfo kQuantities[SENSOR_QUANTITY_COUNT] = {
+  {"temperature", "celsius", "°C", 0.2f},
+  {"humidity",    "percent", "%",  1.0f},
+  {"voltage",     "volts",   "V",  0.1f},
+  {"current",     "amperes", "A",  0.1f},
+  {"power",       "watts",   "W",  2.0f},
+};
+
+// =============================================================================
+// SLOTS
+// =============================================================================
+
+struct SensorSlot {
+  SensorDriver *driver = nullptr;
+  char id[12] = {};               // "<model>_<address>", lower case
+  bool online = false;
+  uint8_t consecutiveErrors = 0;
+  uint64_t dueMs = 0;             // Next read, or next probe while offline
+  float values[SENSOR_VALUES_MAX] = {NAN, NAN, NAN};
+  uint32_t reads = 0;
+  uint32_t errors = 0;
+  LatencyHistogram readLatency;
+};
+
+static SensorSlot s_slots[Config::SENSORS_MAX];
+static size_t s_count = 0;
+static int s_powerSlot = -1;      // PSU power monitor (first INA2xx)
+static uint8_t s_powerIndex = 0;  // Its POWER value
+static int8_t s_powerDraw = -1;   // 1 = on, 0 = off/standby, -1 = unknown
+
+static bool claimed(uint8_t address) {
+  for (size_t i = 0; i < s_count; i++) {
+    if (s_slots[i].driver->address() == address) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void addSensor(SensorDriver *driver, uint64_t nowMs) {
+  SensorSlot &slot = s_slots[s_count++];
+  slot.driver = driver;
+  snprintf(slot.id, sizeof(slot.id), "%s_%02x", driver->model(), driver->address());
+  for (char *c = slot.id; *c; c++) {
+    *c = static_cast<char>(tolower(*c));
+  }
+  slot.online = driver->configure();
+  slot.dueMs = nowMs + (slot.online ? driver->intervalMs() : Config::SENSOR_OFFLINE_RETRY_MS);
+  Serial.printf("Sensors: %s at 0x%02X%s\n", driver->model(), driver->address(),
+                slot.online ? "" : " not responding - will keep probing");
+
+  for (uint8_t i = 0; i < driver->valueCount() && s_powerSlot < 0; i++) {
+    if (driver->quantity(i) == SensorQuantity::POWER) {
+      s_powerSlot = static_cast<int>(s_count - 1);
+      s_powerIndex = i;
+    }
+  }
+}
+
+// =============================================================================
+// SETUP (BUS SCAN)
+// =============================================================================
+
+void Sensors_setup() {
+  I2cLock lock(Config::I2C_LOCK_TIMEOUT_MS);
+  if (!lock.held()) {
+    return;
+  }
+  uint64_t nowMs = TimerService_nowMs();
+  for (const SensorType &type : kSensorTypes) {
+    for (unsigned address = type.firstAddress; address <= type.lastAddress; address++) {
+      if (s_count >= Config::SENSORS_MAX) {
+        break;
+      }
+      uint8_t addr = static_cast<uint8_t>(address);
+      if (!claimed(addr) && I2cBus_probe(addr) && type.detect(addr)) {
+        addSensor(type.create(addr), nowMs);
+      }
+    }
+  }
+  if (!claimed(ON_BOARD_TMP112) && s_count < Config::SENSORS_MAX) {
+    addSensor(new Tmp112(ON_BOARD_TMP112), nowMs);
+  }
+}
+
+// =============================================================================
+// SAMPLING
+// =============================================================================
+
+static void handleError(SensorSlot &slot, bool &busRecovered, uint64_t nowMs) {
+  slot.errors++;
+  if (++slot.consecutiveErrors < Config::I2C_ERROR_LIMIT) {
+    return;
+  }
+  slot.consecutiveErrors = 0;
+  if (!busRecovered) {
+    Serial.printf("Sensors: %u failed reads of %s - recovering I2C bus\n",
+                  Config::I2C_ERROR_LIMIT, slot.id);
+    I2cBus_recover();
+    busRecovered = true;
+  }
+  if (!slot.driver->configure()) {
+    Serial.printf("Sensors: %s not responding after bus recovery - offline\n", slot.id);
+    slot.online = false;
+    for (float &value : slot.values) {
+      value = NAN;
+    }
+    slot.dueMs = nowMs + Config::SENSOR_OFFLINE_RETRY_MS;
+  }
+}
+
+static void sampleSlot(SensorSlot &slot, bool &busRecovered, uint64_t nowMs) {
+  /**
+   * While offline, only a probe is sent, and only every
+   * SENSOR_OFFLINE_RETRY_MS. Online, reads keep their cadence unless the
+   * batch fell behind by a whole interval.
+   */
+  SensorDriver &driver = *slot.driver;
+  if (!slot.online) {
+    slot.dueMs = nowMs + Config::SENSOR_OFFLINE_RETRY_MS;
+    if (I2cBus_probe(driver.address()) && driver.configure()) {
+      Serial.printf("Sensors: %s back online\n", slot.id);
+      slot.online = true;
+      slot.consecutiveErrors = 0;
+      slot.dueMs = nowMs + driver.intervalMs();  // First conversion at the new settings
+    }
+    return;
+  }
+
+  slot.dueMs += driver.intervalMs();
+  if (slot.dueMs <= nowMs) {
+    slot.dueMs = nowMs + driver.intervalMs();
+  }
+
+  float values[SENSOR_VALUES_MAX];
+  int64_t startUs = esp_timer_get_time();
+  bool ok = driver.read(values);
+  slot.readLatency.record(static_cast<uint32_t>(esp_timer_get_time() - startUs));
+  slot.reads++;
+  if (!ok) {
+    handleError(slot, busRecovered, nowMs);
+    return;
+  }
+  slot.consecutiveErrors = 0;
+  for (uint8_t i = 0; i < driver.valueCount(); i++) {
+    slot.values[i] = values[i];
+  }
+}
+
+static void updatePowerDraw(float watts) {
+  /**
+   * Hysteresis between PC_POWER_OFF_WATTS and PC_POWER_ON_WATTS; in
+   * between, the previous state holds (off right after boot).
+   */
+  int8_t draw = s_powerDraw;
+  if (isnan(watts)) {
+    draw = -1;
+  } else if (watts >= Config::PC_POWER_ON_WATTS) {
+    draw = 1;
+  } else if (watts <= Config::PC_POWER_OFF_WATTS || draw < 0) {
+    draw = 0;
+  }
+  if (draw == s_powerDraw) {
+    return;
+  }
+  s_powerDraw = draw;
+  if (draw < 0) {
+    Serial.println("Sensors: PSU power monitor offline - PC power draw unknown");
+    return;
+  }
+  PCState ledState = g_statusSnapshot.read().pcState;
+  bool ledOn = ledState != PCState::OFF && ledState != PCState::SLEEP;
+  Serial.printf("Sensors: PSU draw %.1f W - PC %s%s\n", watts, draw ? "on" : "off",
+                (draw == 1) != ledOn ? " (power LED disagrees)" : "");
+}
+
+static void publish() {
+  SensorStatus sensors[Config::SENSORS_MAX];
+  float temperature = NAN;
+  for (size_t i = 0; i < s_count; i++) {
+    sensors[i] = Sensors_status(i);
+    for (uint8_t v = 0; v < sensors[i].valueCount && isnan(temperature); v++) {
+      if (sensors[i].quantities[v] == SensorQuantity::TEMPERATURE) {
+        temperature = sensors[i].values[v];
+      }
+    }
+  }
+  float watts = s_powerSlot >= 0 ? s_slots[s_powerSlot].values[s_powerIndex] : NAN;
+  updatePowerDraw(watts);
+
+  int8_t draw = s_powerDraw;
+  size_t count = s_count;
+  g_statusSnapshot.update([&](StatusSnapshot &s) {
+    s.temperature = temperature;
+    s.sensorCount = static_cast<uint8_t>(count);
+    for (size_t i = 0; i < count; i++) {
+      s.sensors[i] = sensors[i];
+    }
+    s.pcPowerWatts = watts;
+    s.pcPowerDraw = draw;
+  });
+}
+
+void Sensors_sample() {
+  /**
+   * One batch: every due sensor, one bus acquisition. If the bus is busy
+   * past I2C_LOCK_TIMEOUT_MS the sensors stay due for the next tick.
+   */
+  uint64_t nowMs = TimerService_nowMs();
+  bool due = false;
+  for (size_t i = 0; i < s_count && !due; i++) {
+    due = nowMs >= s_slots[i].dueMs;
+  }
+  if (!due) {
+    return;
+  }
+
+  {
+    I2cLock lock(Config::I2C_LOCK_TIMEOUT_MS);
+    if (!lock.held()) {
+      return;
+    }
+    bool busRecovered = false;
+    for (size_t i = 0; i < s_count; i++) {
+      if (nowMs >= s_slots[i].dueMs) {
+        sampleSlot(s_slots[i], busRecovered, nowMs);
+      }
+    }
+  }
+  publish();
+}
+
+// =============================================================================
+// QUERIES
+// =============================================================================
+
+size_t Sensors_count() {
+  return s_count;
+}
+
+SensorStatus Sensors_status(size_t index) {
+  SensorStatus status;
+  if (index >= s_count) {
+    return status;
+  }
+  const SensorSlot &slot = s_slots[index];
+  status.id = slot.id;
+  status.model = slot.driver->model();
+  status.address = slot.driver->address();
+  status.online = slot.online;
+  status.valueCount = slot.driver->valueCount();
+  for (uint8_t i = 0; i < status.valueCount; i++) {
+    status.quantities[i] = slot.driver->quantity(i);
+    status.values[i] = slot.online ? slot.values[i] : NAN;
+  }
+  return status;
+}
+
+SensorStats Sensors_stats(size_t index) {
+  if (index >= s_count) {
+    return SensorStats{false, 0, 0};
+  }
+  const SensorSlot &slot = s_slots[index];
+  return SensorStats{slot.online, slot.reads, slot.errors};
+}
+
+const LatencyHistogram &Sensors_readLatency(size_t index) {
+  return s_slots[index < s_count ? index : 0].readLatency;
+}
+
+const char *Sensors_quantityName(SensorQuantity quantity) {
+  size_t i = static_cast<size_t>(quantity);
+  return i < SENSOR_QUANTITY_COUNT ? kQuantities[i].name : "unknown";
+}
+
+const char *Sensors_quantityUnit(SensorQuantity quantity) {
+  size_t i = static_cast<size_t>(quantity);
+  return i < SENSOR_QUANTITY_COUNT ? kQuantities[i].unit : "";
+}
+
+const char *Sensors_quantitySymbol(SensorQuantity quantity) {
+  size_t i = static_cast<size_t>(quantity);
+  return i < SENSOR_QUANTITY_COUNT ? kQuantities[i].symbol : "";
+}
+
+float Sensors_publishDelta(SensorQuantity quantity) {
+  size_t i = static_cast<size_t>(quantity);
+  return i < SENSOR_QUANTITY_COUNT ? kQuantities[i].publishDelta : 0.0f;
+}
@@ -0,0 +1,274 @@
+/**
+ * =============================================================================
+ * StatusPublisher.cpp - Change-Driven Status Publishing
+ * =============================================================================
+ *
+ * Each call to StatusPublisher_loop():
+ *
+ *   1. Compares the status snapshot against the values from the last publish
+ *      and ORs the changed field groups into a pending mask
+ *   2. Publishes when something is pending and the coalescing window
+ *      since the previous publish has passed
+ *
+ * A periodic heartbeat timer marks everything dirty so subscribers that
+ * missed an update resynchronise.
+ *
+ * An isolated change (e.g. PC turning off) goes out immediately; a burst
+ * of changes (HDD LED flicker) is folded into one publish per window.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+
+#include "Config.h"
+#include "Constants.h"
+#include "StatusPublisher.h"
+#include "TimerService.h"
+#include "integrations/MqttHandler.h"
+
+extern SeqLock<StatusSnapshot> g_statusSnapshot;
+extern TimerWheel g_networkTimers;
+
+// External function from WebInterface.cpp
+void WebInterface_broadcastStatus();
+
+// =============================================================================
+// CHANGE THRESHOLDS
+// =============================================================================
+
+constexpr float TEMPERATURE_DELTA_C = 0.1f;   // UI shows one decimal
+constexpr uint32_t HEAP_DELTA_BYTES = 1024;   // UI shows KB
+constexpr uint8_t CPU_DELTA_PERCENT = 5;
+constexpr uint32_t HDD_RECENT_MS = 5000;      // UI shows "Active" below 5s
+constexpr uint16_t HDD_ACTIVITY_DELTA_PERMILLE = 50;  // UI shows whole percent; 5% is visible
+
+// =============================================================================
+// LAST PUBLISHED VALUES
+// =============================================================================
+
+struct PublishedState {
+  bool apMode = false;
+  bool wifiConnected = false;
+  PCState pcState = PCState::OFF;
+  PcReachability reachability = PcReachability::UNKNOWN;
+  HangState hangState = HangState::OFF;
+  bool powerRelayActive = false;
+  bool resetRelayActive = false;
+  float temperature = 0.0f;
+  uint8_t pwrLedRaw = 0;
+  uint8_t hddLedRaw = 0;
+  bool hddRecentlyActive = false;
+  uint32_t lastHddChangeMs = 0;
+  uint16_t hddActivityPermille = 0;
+  uint16_t hddActivity60sPermille = 0;
+  uint32_t freeHeap = 0;
+  uint8_t cpuLoad = 0;
+  uint8_t channelCount = 1;
+  PcChannelStatus channels[Config::PC_CHANNELS_MAX];
+  uint8_t sensorCount = 0;
+  SensorStatus sensors[Config::SENSORS_MAX];
+  float pcPowerWatts = NAN;
+  int8_t pcPowerDraw = -1;
+};
+
+static PublishedState s_published;
+static uint32_t s_pendingFields = 0;
+static portMUX_TYPE s_pendingMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_lastPublishMs = 0;
+static Timer s_heartbeatTimer;
+static uint32_t s_publishCount = 0;
+
+// =============================================================================
+// CHANGE DETECTION
+// =============================================================================
+
+static bool hddRecentlyActive(const StatusSnapshot &s, uint32_t nowMs) {
+  return s.lastHddActiveMs > 0 && (nowMs - s.lastHddActiveMs) < HDD_RECENT_MS;
+}
+
+static uint16_t permilleDelta(uint16_t a, uint16_t b) {
+  return a > b ? a - b : b - a;
+}
+
+static bool valueChanged(float now, float was, float delta) {
+  return fabsf(now - was) >= delta || isnan(now) != isnan(was);
+}
+
+static bool sensorChanged(const SensorStatus &now, const SensorStatus &was) {
+  if (now.online != was.online) {
+    return true;
+  }
+  for (uint8_t i = 0; i < now.valueCount; i++) {
+    if (valueChanged(now.values[i], was.values[i], Sensors_publishDelta(now.quantities[i]))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static uint32_t diffState(const StatusSnapshot &s, uint32_t nowMs) {
+  /**
+   * Compare a status snapshot with the last published values.
+   * @return Bitmask of StatusField groups that changed
+   */
+  uint32_t changed = 0;
+  const PublishedState &p = s_published;
+
+  if (s.apMode != p.apMode || s.wifiConnected != p.wifiConnected) {
+    changed |= StatusField::NETWORK;
+  }
+  if (s.pcState != p.pcState || s.reachability != p.reachability || s.hangState != p.hangState) {
+    changed |= StatusField::PC_STATE;
+  }
+  if (s.powerRelayActive != p.powerRelayActive ||
+      s.resetRelayActive != p.resetRelayActive) {
+    changed |= StatusField::RELAYS;
+  }
+  if (fabsf(s.temperature - p.temperature) >= TEMPERATURE_DELTA_C ||
+      (isnan(s.temperature) != isnan(p.temperature))) {
+    changed |= StatusField::TEMPERATURE;
+  }
+  if (s.pwrLedRaw != p.pwrLedRaw || s.hddLedRaw != p.hddLedRaw) {
+    changed |= StatusField::LED_RAW;
+  }
+  if (hddRecentlyActive(s, nowMs) != p.hddRecentlyActive ||
+      (s.lastHddChangeMs != p.lastHddChangeMs && p.lastHddChangeMs == 0) ||
+      permilleDelta(s.hddActivityPermille, p.hddActivityPermille) >= HDD_ACTIVITY_DELTA_PERMILLE ||
+      permilleDelta(s.hddActivity60sPermille, p.hddActivity60sPermille) >= HDD_ACTIVITY_DELTA_PERMILLE) {
+    changed |= StatusField::HDD_ACTIVITY;
+  }
+  // Expander PC channels ([0] is covered by the fields above)
+  if (s.channelCount != p.channelCount) {
+    changed |= StatusField::PC_STATE;
+  }
+  for (size_t i = 1; i < s.channelCount; i++) {
+    const PcChannelStatus &now = s.channels[i];
+    const PcChannelStatus &was = p.channels[i];
+    if (now.pcState != was.pcState) {
+      changed |= StatusField::PC_STATE;
+    }
+    if (now.powerRelayActive != was.powerRelayActive || now.resetRelayActive != was.resetRelayActive) {
+      changed |= StatusField::RELAYS;
+    }
+    if (permilleDelta(now.hddActivityPermille, was.hddActivityPermille) >= HDD_ACTIVITY_DELTA_PERMILLE) {
+      changed |= StatusField::HDD_ACTIVITY;
+    }
+  }
+  // I2C sensors; the power draw signal counts as PC state (MQTT)
+  if (s.sensorCount != p.sensorCount ||
+      valueChanged(s.pcPowerWatts, p.pcPowerWatts, Sensors_publishDelta(SensorQuantity::POWER))) {
+    changed |= StatusField::SENSORS;
+  }
+  for (size_t i = 0; i < s.sensorCount && i < p.sensorCount; i++) {
+    if (sensorChanged(s.sensors[i], p.sensors[i])) {
+      changed |= StatusField::SENSORS;
+    }
+  }
+  if (s.pcPowerDraw != p.pcPowerDraw) {
+    changed |= StatusField::SENSORS | StatusField::PC_STATE;
+  }
+  uint32_t heapDelta = s.freeHeap > p.freeHeap ? s.freeHeap - p.freeHeap
+                                                     : p.freeHeap - s.freeHeap;
+  uint8_t cpuDelta = s.cpuLoad > p.cpuLoad ? s.cpuLoad - p.cpuLoad
+                                                 : p.cpuLoad - s.cpuLoad;
+  if (heapDelta >= HEAP_DELTA_BYTES || cpuDelta >= CPU_DELTA_PERCENT) {
+    changed |= StatusField::SYSTEM;
+  }
+  return changed;
+}
+
+static void rememberState(const StatusSnapshot &s, uint32_t nowMs) {
+  PublishedState &p = s_published;
+  p.apMode = s.apMode;
+  p.wifiConnected = s.wifiConnected;
+  p.pcState = s.pcState;
+  p.reachability = s.reachability;
+  p.hangState = s.hangState;
+  p.powerRelayActive = s.powerRelayActive;
+  p.resetRelayActive = s.resetRelayActive;
+  p.temperature = s.temperature;
+  p.pwrLedRaw = s.pwrLedRaw;
+  p.hddLedRaw = s.hddLedRaw;
+  p.hddRecentlyActive = hddRecentlyActive(s, nowMs);
+  p.lastHddChangeMs = s.lastHddChangeMs;
+  p.hddActivityPermille = s.hddActivityPermille;
+  p.hddActivity60sPermille = s.hddActivity60sPermille;
+  p.freeHeap = s.freeHeap;
+  p.cpuLoad = s.cpuLoad;
+  p.channelCount = s.channelCount;
+  for (size_t i = 0; i < s.channelCount; i++) {
+    p.channels[i] = s.channels[i];
+  }
+  p.sensorCount = s.sensorCount;
+  for (size_t i = 0; i < s.sensorCount; i++) {
+    p.sensors[i] = s.sensors[i];
+  }
+  p.pcPowerWatts = s.pcPowerWatts;
+  p.pcPowerDraw = s.pcPowerDraw;
+}
+
+// =============================================================================
+// PUBLISHING
+// =============================================================================
+
+static void publish(const StatusSnapshot &snapshot, uint32_t fields, uint32_t nowMs) {
+  /**
+   * Remember the snapshot that was diffed, not a fresh read: the control
+   * task may change state while the broadcasts run, and that change must
+   * still show up in the next diff.
+   */
+  WebInterface_broadcastStatus();
+
+  // MQTT only carries power state, WiFi status and sensor readings
+  if (fields & (StatusField::PC_STATE | StatusField::NETWORK | StatusField::SENSORS)) {
+    MqttHandler_publishState();
+  }
+
+  rememberState(snapshot, nowMs);
+  s_lastPublishMs = nowMs;
+  s_publishCount++;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+static void onHeartbeat(void *) {
+  StatusPublisher_markDirty(StatusField::ALL);
+}
+
+void StatusPublisher_setup() {
+  rememberState(g_statusSnapshot.read(), millis());
+  StatusPublisher_markDirty(StatusField::ALL);
+  g_networkTimers.armPeriodic(s_heartbeatTimer, Config::STATUS_HEARTBEAT_MS, onHeartbeat);
+}
+
+void StatusPublisher_markDirty(uint32_t fields) {
+  portENTER_CRITICAL(&s_pendingMux);
+  s_pendingFields |= fields;
+  portEXIT_CRITICAL(&s_pendingMux);
+}
+
+void StatusPublisher_loop() {
+  uint32_t nowMs = millis();
+  StatusSnapshot snapshot = g_statusSnapshot.read();
+  StatusPublisher_markDirty(diffState(snapshot, nowMs));
+
+  if (nowMs - s_lastPublishMs < Config::STATUS_COALESCE_MS) {
+    return;
+  }
+
+  portENTER_CRITICAL(&s_pendingMux);
+  uint32_t fields = s_pendingFields;
+  s_pendingFields = 0;
+  portEXIT_CRITICAL(&s_pendingMux);
+
+  if (fields != 0) {
+    publish(snapshot, fields, nowMs);
+  }
+}
+
+uint32_t StatusPublisher_publishCount() {
+  return s_publishCount;
+}
@@ -0,0 +1,174 @@
+/**
+ * =============================================================================
+ * TaskScheduler.cpp - Prioritized Periodic FreeRTOS Tasks
+ * =============================================================================
+ *
+ * Every registered task runs the same wrapper:
+ *
+ *   1. Wait until the next release time, or until an ISR notifies the
+ *      task (ulTaskNotifyTake with the remaining time as timeout)
+ *   2. Feed the task watchdog
+ *   3. Run the tick function and measure its execution time
+ *   4. Compare the finish time against release time + deadline
+ *
+ * If a tick overruns a whole period, the release time is re-anchored to
+ * "now" instead of firing a burst of catch-up ticks.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+#include <esp_task_wdt.h>
+
+#include "TaskScheduler.h"
+
+// =============================================================================
+// TASK TABLE
+// =============================================================================
+
+struct SchedulerTask {
+  SchedulerTaskConfig config;
+  SchedulerTaskStats stats;
+  TaskHandle_t handle = nullptr;
+  volatile uint32_t currentPeriodMs = 0;
+};
+
+static SchedulerTask s_tasks[TASK_SCHEDULER_MAX_TASKS];
+static size_t s_taskCount = 0;
+
+static portMUX_TYPE s_busyMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_busyUs = 0;
+
+// =============================================================================
+// TASK WRAPPER
+// =============================================================================
+
+static TickType_t periodTicks(const SchedulerTask *task) {
+  TickType_t ticks = pdMS_TO_TICKS(task->currentPeriodMs);
+  return ticks > 0 ? ticks : 1;
+}
+
+static void schedulerTaskMain(void *param) {
+  SchedulerTask *task = static_cast<SchedulerTask *>(param);
+  const uint32_t deadlineUs = task->config.deadlineMs * 1000UL;
+
+  esp_task_wdt_add(nullptr);
+
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    // Sleep until the next release; a notification releases us early
+    TickType_t period = periodTicks(task);
+    TickType_t elapsed = xTaskGetTickCount() - lastWake;
+    if (elapsed < period && ulTaskNotifyTake(pdTRUE, period - elapsed) > 0) {
+      lastWake = xTaskGetTickCount();
+    } else {
+      lastWake += period;
+    }
+    esp_task_wdt_reset();
+
+    // lastWake is the release tick we were scheduled for; any difference to
+    // the current tick is time we spent waiting for the CPU
+    const uint32_t wakeLagUs = (uint32_t)(xTaskGetTickCount() - lastWake) * portTICK_PERIOD_MS * 1000UL;
+    const uint32_t startUs = micros();
+    task->config.tick();
+    const uint32_t execUs = micros() - startUs;
+    const uint32_t responseUs = wakeLagUs + execUs;
+
+    SchedulerTaskStats &stats = task->stats;
+    stats.runs++;
+    stats.lastExecUs = execUs;
+    if (execUs > stats.maxExecUs) {
+      stats.maxExecUs = execUs;
+    }
+    if (responseUs > deadlineUs) {
+      stats.missedDeadlines++;
+      if (responseUs - deadlineUs > stats.maxLatenessUs) {
+        stats.maxLatenessUs = responseUs - deadlineUs;
+      }
+    }
+
+    portENTER_CRITICAL(&s_busyMux);
+    s_busyUs += execUs;
+    portEXIT_CRITICAL(&s_busyMux);
+
+    // Overran a full period: skip the missed releases instead of bursting
+    if ((TickType_t)(xTaskGetTickCount() - lastWake) >= periodTicks(task)) {
+      lastWake = xTaskGetTickCount();
+    }
+  }
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+int TaskScheduler_addTask(const SchedulerTaskConfig &config) {
+  if (s_taskCount >= TASK_SCHEDULER_MAX_TASKS) {
+    return -1;
+  }
+  SchedulerTask &task = s_tasks[s_taskCount];
+  task.config = config;
+  task.currentPeriodMs = config.periodMs;
+  task.stats.name = config.name;
+  task.stats.periodMs = config.periodMs;
+  task.stats.deadlineMs = config.deadlineMs;
+  return static_cast<int>(s_taskCount++);
+}
+
+void TaskScheduler_start() {
+  for (size_t i = 0; i < s_taskCount; i++) {
+    SchedulerTask &task = s_tasks[i];
+    BaseType_t ok = xTaskCreate(schedulerTaskMain, task.config.name, task.config.stackSize,
+                                &task, task.config.priority, &task.handle);
+    if (ok != pdPASS) {
+      Serial.printf("Scheduler: failed to create task '%s'\n", task.config.name);
+    } else {
+      Serial.printf("Scheduler: task '%s' (prio %u, %u ms period, %u ms deadline)\n",
+                    task.config.name, (unsigned)task.config.priority,
+                    task.config.periodMs, task.config.deadlineMs);
+    }
+  }
+}
+
+void TaskScheduler_setPeriodMs(size_t index, uint32_t periodMs) {
+  if (index < s_taskCount) {
+    s_tasks[index].currentPeriodMs = periodMs;
+  }
+}
+
+void TaskScheduler_wake(size_t index) {
+  if (index < s_taskCount && s_tasks[index].handle) {
+    xTaskNotifyGive(s_tasks[index].handle);
+  }
+}
+
+void IRAM_ATTR TaskScheduler_wakeFromIsr(size_t index) {
+  if (index >= s_taskCount || !s_tasks[index].handle) {
+    return;
+  }
+  BaseType_t higherPriorityWoken = pdFALSE;
+  vTaskNotifyGiveFromISR(s_tasks[index].handle, &higherPriorityWoken);
+  if (higherPriorityWoken) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+size_t TaskScheduler_taskCount() {
+  return s_taskCount;
+}
+
+bool TaskScheduler_getStats(size_t index, SchedulerTaskStats &out) {
+  if (index >= s_taskCount) {
+    return false;
+  }
+  out = s_tasks[index].stats;
+  return true;
+}
+
+uint32_t TaskScheduler_takeBusyUs() {
+  portENTER_CRITICAL(&s_busyMux);
+  uint32_t busy = s_busyUs;
+  s_busyUs = 0;
+  portEXIT_CRITICAL(&s_busyMux);
+  return busy;
+}
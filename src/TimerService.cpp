@@ -0,0 +1,238 @@
+/**
+ * =============================================================================
+ * TimerService.cpp - Hierarchical Timing Wheel
+ * =============================================================================
+ *
+ * Placement: a timer with deadline D goes to the lowest level whose range
+ * covers D - now, in slot (D >> (6 * level)) & 63. When the level-0 index
+ * wraps to 0, the current slot of level 1 is emptied and its timers are
+ * re-inserted (they now land on level 0), and so on upwards.
+ *
+ * Callbacks run without the lock held, so they may arm or cancel any
+ * timer, including their own.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+
+#include "TimerService.h"
+
+// Deadlines further out than this are parked on the top level and
+// re-placed when they cascade down.
+static constexpr uint64_t WHEEL_SPAN_MS =
+    1ULL << (TimerWheel::SLOT_BITS * TimerWheel::LEVELS);
+
+// =============================================================================
+// LIST & PLACEMENT (call with mux_ held)
+// =============================================================================
+
+void TimerWheel::insertLocked(Timer &timer) {
+  uint64_t deadline = timer.deadlineMs_;
+  if (deadline <= currentMs_) {
+    deadline = currentMs_ + 1;   // Overdue: fire on the next tick
+  }
+  uint64_t delta = deadline - currentMs_;
+  if (delta >= WHEEL_SPAN_MS) {
+    deadline = currentMs_ + WHEEL_SPAN_MS - 1;
+    delta = WHEEL_SPAN_MS - 1;
+  }
+
+  uint8_t level = 0;
+  while (level < LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * (level + 1)))) {
+    level++;
+  }
+  uint8_t slot = (deadline >> (SLOT_BITS * level)) & (SLOTS - 1);
+
+  timer.level_ = level;
+  timer.slot_ = slot;
+  timer.prev_ = nullptr;
+  timer.next_ = slots_[level][slot];
+  if (timer.next_) {
+    timer.next_->prev_ = &timer;
+  }
+  slots_[level][slot] = &timer;
+  occupied_[level] |= (1ULL << slot);
+}
+
+void TimerWheel::unlinkLocked(Timer &timer) {
+  if (timer.prev_) {
+    timer.prev_->next_ = timer.next_;
+  } else {
+    slots_[timer.level_][timer.slot_] = timer.next_;
+  }
+  if (timer.next_) {
+    timer.next_->prev_ = timer.prev_;
+  }
+  if (!slots_[timer.level_][timer.slot_]) {
+    occupied_[timer.level_] &= ~(1ULL << timer.slot_);
+  }
+  timer.prev_ = nullptr;
+  timer.next_ = nullptr;
+}
+
+void TimerWheel::cascadeLocked(uint8_t level) {
+  /**
+   * Move every timer of the current slot on `level` one level down.
+   */
+  uint8_t slot = (currentMs_ >> (SLOT_BITS * level)) & (SLOTS - 1);
+  Timer *t = slots_[level][slot];
+  slots_[level][slot] = nullptr;
+  occupied_[level] &= ~(1ULL << slot);
+  while (t) {
+    Timer *next = t->next_;
+    insertLocked(*t);
+    t = next;
+  }
+}
+
+bool TimerWheel::emptyLocked() const {
+  for (uint8_t level = 0; level < LEVELS; level++) {
+    if (occupied_[level]) return false;
+  }
+  return true;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+void TimerWheel::begin() {
+  portENTER_CRITICAL(&mux_);
+  currentMs_ = TimerService_nowMs();
+  portEXIT_CRITICAL(&mux_);
+}
+
+void TimerWheel::armInternal(Timer &timer, uint64_t deadlineMs, uint32_t periodMs,
+                             TimerCallback callback, void *arg) {
+  portENTER_CRITICAL(&mux_);
+  if (timer.armed_) {
+    unlinkLocked(timer);
+  } else {
+    armedCount_++;
+  }
+  timer.callback_ = callback;
+  timer.arg_ = arg;
+  timer.deadlineMs_ = deadlineMs;
+  timer.periodMs_ = periodMs;
+  timer.armed_ = true;
+  insertLocked(timer);
+  portEXIT_CRITICAL(&mux_);
+}
+
+void TimerWheel::arm(Timer &timer, uint32_t delayMs, TimerCallback callback, void *arg) {
+  armInternal(timer, TimerService_nowMs() + delayMs, 0, callback, arg);
+}
+
+void TimerWheel::armPeriodic(Timer &timer, uint32_t periodMs, TimerCallback callback, void *arg) {
+  if (periodMs == 0) periodMs = 1;
+  armInternal(timer, TimerService_nowMs() + periodMs, periodMs, callback, arg);
+}
+
+void TimerWheel::cancel(Timer &timer) {
+  portENTER_CRITICAL(&mux_);
+  if (timer.armed_) {
+    unlinkLocked(timer);
+    timer.armed_ = false;
+    armedCount_--;
+  }
+  portEXIT_CRITICAL(&mux_);
+}
+
+uint32_t TimerWheel::advance() {
+  /**
+   * Step currentMs_ up to now, cascading at level boundaries and firing
+   * level-0 slots on the way. Empty stretches are skipped: with nothing
+   * armed we jump straight to now, and with an empty level 0 we jump to
+   * the next cascade boundary.
+   */
+  const uint64_t nowMs = TimerService_nowMs();
+  uint32_t fired = 0;
+
+  portENTER_CRITICAL(&mux_);
+  while (currentMs_ < nowMs) {
+    if (emptyLocked()) {
+      currentMs_ = nowMs;
+      break;
+    }
+    if (occupied_[0] == 0) {
+      uint64_t lastBeforeBoundary = currentMs_ | (SLOTS - 1);
+      if (lastBeforeBoundary >= nowMs) {
+        currentMs_ = nowMs;
+        break;
+      }
+      currentMs_ = lastBeforeBoundary;
+    }
+
+    currentMs_++;
+
+    // Cascade higher levels whose index just wrapped
+    for (uint8_t level = 1; level < LEVELS; level++) {
+      if ((currentMs_ & ((1ULL << (SLOT_BITS * level)) - 1)) != 0) break;
+      cascadeLocked(level);
+    }
+
+    // Fire everything in the current level-0 slot
+    uint8_t slot = currentMs_ & (SLOTS - 1);
+    Timer *t;
+    while ((t = slots_[0][slot]) != nullptr) {
+      unlinkLocked(*t);
+      if (t->deadlineMs_ > currentMs_) {
+        insertLocked(*t);   // Clamped far-future timer, not due yet
+        continue;
+      }
+
+      TimerCallback callback = t->callback_;
+      void *arg = t->arg_;
+      if (t->periodMs_ > 0) {
+        t->deadlineMs_ += t->periodMs_;
+        if (t->deadlineMs_ <= currentMs_) {
+          t->deadlineMs_ = currentMs_ + t->periodMs_;   // Fell behind: skip missed runs
+        }
+        insertLocked(*t);
+      } else {
+        t->armed_ = false;
+        armedCount_--;
+      }
+
+      portEXIT_CRITICAL(&mux_);
+      callback(arg);
+      fired++;
+      portENTER_CRITICAL(&mux_);
+    }
+  }
+  portEXIT_CRITICAL(&mux_);
+
+  return fired;
+}
+
+uint32_t TimerWheel::msUntilNext() const {
+  portENTER_CRITICAL(&mux_);
+  uint64_t result = UINT64_MAX;
+  for (uint8_t level = 0; level < LEVELS && result == UINT64_MAX; level++) {
+    uint64_t bits = occupied_[level];
+    if (!bits) continue;
+
+    // First occupied slot at or after the current index (circular)
+    uint8_t shift = SLOT_BITS * level;
+    uint8_t current = (currentMs_ >> shift) & (SLOTS - 1);
+    uint64_t rotated = (bits >> current) | (current ? (bits << (SLOTS - current)) : 0);
+    if (level == 0) {
+      result = __builtin_ctzll(rotated);
+    } else {
+      // The current index of an upper level was already cascaded, so a
+      // timer there belongs to the next lap. Lower bound: slot start.
+      uint64_t ahead = rotated & ~1ULL;
+      uint8_t distance = ahead ? __builtin_ctzll(ahead) : SLOTS;
+      uint64_t slotStart = ((currentMs_ >> shift) + distance) << shift;
+      result = slotStart - currentMs_;
+    }
+  }
+  uint64_t nowMs = TimerService_nowMs();
+  uint64_t elapsed = nowMs > currentMs_ ? nowMs - currentMs_ : 0;
+  portEXIT_CRITICAL(&mux_);
+
+  if (result == UINT64_MAX) return UINT32_MAX;
+  result = result > elapsed ? result - elapsed : 0;
+  return result > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(result);
+}
@@ -18,9 +18,22 @@
  *   POST /api/action/force-power - Force shutdown (11s hold)
  *   GET  /api/wifi/scan     - Scan for WiFi networks
  *   POST /api/factory-reset - Clear all settings, restart in AP mode
+ *   GET  /api/boots         - Boot phase timings after power/reset presses
+ *   GET  /api/debug/profile - Per-stage timing histograms and task stats
+ *   GET  /api/debug/gpio    - Cycle cost of digitalRead/Write vs FastGpio
+ *   GET  /api/debug/ws-codec - Bytes and cycles per status frame, JSON vs MessagePack
  * 
  * WEBSOCKET:
- *   /ws - Real-time status updates and action logs
+ *   /ws - Real-time status updates and action logs; each message is
+ *         serialized once and shared by all clients (WsFramePool.h).
+ *         Status topics are a snapshot on connect, then sequenced deltas
+ *         (WsStatusStream.h); {"type":"resync"} requests new snapshots.
+ *         Clients offering the "restarter.msgpack" subprotocol get binary
+ *         MessagePack frames instead of JSON (WsCodec.h).
+ *         {"type":"subscribe",...} selects topics and max rates
+ *         (WsClients.h); by default a client gets everything.
+ *         Authenticated clients can also send PC actions and read the
+ *         config as request/response messages ("WEBSOCKET COMMANDS").
  * 
  * =============================================================================
  */
@@ -31,20 +44,41 @@
 #include <AsyncJson.h>
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include <esp_timer.h>
+#include <memory>
 
+#include "BootTimeline.h"
+#include "CommandQueue.h"
 #include "Config.h"
 #include "Constants.h"
+#include "FastGpio.h"
+#include "GpioTrace.h"
+#include "HangRecovery.h"
+#include "HealthMonitor.h"
+#include "Heartbeat.h"
 #include "OtaUpdate.h"
-#include "PCController.h"
+#include "PcChannels.h"
+#include "PowerManager.h"
+#include "Profiler.h"
+#include "Sensors.h"
+#include "StatusPublisher.h"
+#include "TaskScheduler.h"
+#include "TimerService.h"
+#include "WsClients.h"
+#include "WsCodec.h"
+#include "WsFramePool.h"
+#include "WsStatusStream.h"
 
 // Global objects defined in main.cpp
 extern AsyncWebServer g_server;
 extern AsyncWebSocket g_ws;
-extern PCController g_pc;
 extern StoredConfig g_config;
 extern RuntimeState g_state;
-extern bool g_restartPending;
-extern uint32_t g_restartAtMs;
+extern SeqLock<StatusSnapshot> g_statusSnapshot;
+extern TimerWheel g_networkTimers;
+
+// External function from main.cpp
+void scheduleRestart(uint32_t delayMs);
 
 // External functions from Networking.cpp
 bool Networking_saveConfig(const StoredConfig &cfg);
@@ -57,16 +91,18 @@ bool Networking_clearConfig();
 // CSRF token expires after 1 hour
 constexpr uint32_t CSRF_TOKEN_VALIDITY_MS = 3600000;
 
-static String g_csrfToken;
-static uint32_t g_csrfTokenCreatedMs = 0;
+// Written only by rotateCsrfToken(); readers take a copy under g_csrfMux
+static char g_csrfToken[17] = "";
+static portMUX_TYPE g_csrfMux = portMUX_INITIALIZER_UNLOCKED;
+static Timer g_csrfRotateTimer;
 
-static String generateCsrfToken() {
+static void generateCsrfToken(char (&token)[17]) {
   /**
    * Generate a new CSRF token.
    * Uses device ID + timestamp + random for uniqueness.
    */
   uint32_t rnd = esp_random();
-  uint32_t time = millis();
+  uint32_t time = (uint32_t)TimerService_nowMs();
   
   // Simple hash combining device ID, time, and random
   uint32_t hash = 0x1F3E5D7C;
@@ -78,26 +114,43 @@ static String generateCsrfToken() {
   hash = ((hash << 13) | (hash >> 19)) ^ (rnd >> 7);
   
   // Convert to hex string
-  char token[17];
   snprintf(token, sizeof(token), "%08X%08X", hash, rnd);
-  return String(token);
+}
+
+static void rotateCsrfToken(void *) {
+  /**
+   * Replace the CSRF token. Called once from WebInterface_setup() and then
+   * by the periodic rotation timer in the network task, so there is only
+   * ever one writer; the new token is built locally and swapped in under
+   * the lock.
+   */
+  char token[17];
+  generateCsrfToken(token);
+
+  portENTER_CRITICAL(&g_csrfMux);
+  memcpy(g_csrfToken, token, sizeof(g_csrfToken));
+  portEXIT_CRITICAL(&g_csrfMux);
+
+  Serial.println("CSRF: Generated new token");
 }
 
 static String getCsrfToken() {
   /**
-   * Get current CSRF token, generating a new one if expired or missing.
+   * Get a copy of the current CSRF token. Safe from any task (network
+   * task status broadcasts, AsyncTCP request handlers).
    */
-  uint32_t now = millis();
-  
-  // Generate new token if missing or expired
-  if (g_csrfToken.length() == 0 || 
-      (now - g_csrfTokenCreatedMs) > CSRF_TOKEN_VALIDITY_MS) {
-    g_csrfToken = generateCsrfToken();
-    g_csrfTokenCreatedMs = now;
-    Serial.println("CSRF: Generated new token");
-  }
+  char token[17];
+  portENTER_CRITICAL(&g_csrfMux);
+  memcpy(token, g_csrfToken, sizeof(token));
+  portEXIT_CRITICAL(&g_csrfMux);
   
-  return g_csrfToken;
+  return String(token);
+}
+
+static bool isCsrfToken(const String &candidate) {
+  // An empty token (before the first rotation) never matches
+  String token = getCsrfToken();
+  return token.length() > 0 && candidate == token;
 }
 
 static bool validateCsrfToken(AsyncWebServerRequest *request) {
@@ -117,16 +170,14 @@ static bool validateCsrfToken(AsyncWebServerRequest *request) {
   
   // Check header first
   if (request->hasHeader("X-CSRF-Token")) {
-    String token = request->header("X-CSRF-Token");
-    if (token == g_csrfToken) {
+    if (isCsrfToken(request->header("X-CSRF-Token"))) {
       return true;
     }
   }
   
   // Check query parameter
   if (request->hasParam("csrf_token")) {
-    String token = request->getParam("csrf_token")->value();
-    if (token == g_csrfToken) {
+    if (isCsrfToken(request->getParam("csrf_token")->value())) {
       return true;
     }
   }
@@ -150,18 +201,19 @@ constexpr uint32_t AUTH_LOCKOUT_MS = 300000;   // 5 minute lockout
 #endif
 constexpr uint32_t AUTH_FAILURE_DECAY_MS = 60000; // Failures decay after 1 minute
 
-static uint32_t g_lastAuthFailMs = 0;
+static uint64_t g_lastAuthFailMs = 0;
 
 static bool isRateLimited() {
   /**
    * Check if authentication is currently rate-limited.
    * Returns true if too many failed attempts recently.
    */
-  if (g_state.authBlockedUntilMs > 0 && millis() < g_state.authBlockedUntilMs) {
+  uint64_t nowMs = TimerService_nowMs();
+  if (g_state.authBlockedUntilMs > 0 && nowMs < g_state.authBlockedUntilMs) {
     return true;
   }
   // Reset block if time has passed
-  if (g_state.authBlockedUntilMs > 0 && millis() >= g_state.authBlockedUntilMs) {
+  if (g_state.authBlockedUntilMs > 0) {
     g_state.authBlockedUntilMs = 0;
     g_state.authFailCount = 0;
   }
@@ -173,36 +225,49 @@ static void recordAuthFailure() {
    * Record a failed authentication attempt.
    * Triggers lockout after MAX_AUTH_FAILURES.
    */
+  uint64_t nowMs = TimerService_nowMs();
+
   // Decay old failures
-  if (millis() - g_lastAuthFailMs > AUTH_FAILURE_DECAY_MS) {
+  if (nowMs - g_lastAuthFailMs > AUTH_FAILURE_DECAY_MS) {
     g_state.authFailCount = 0;
   }
   
-  g_lastAuthFailMs = millis();
+  g_lastAuthFailMs = nowMs;
   g_state.authFailCount++;
   
   if (g_state.authFailCount >= MAX_AUTH_FAILURES) {
-    g_state.authBlockedUntilMs = millis() + AUTH_LOCKOUT_MS;
+    g_state.authBlockedUntilMs = nowMs + AUTH_LOCKOUT_MS;
     Serial.printf("AUTH: Too many failures, locked out for %d seconds\n", AUTH_LOCKOUT_MS / 1000);
   }
 }
 
-static bool checkAuth(AsyncWebServerRequest *request) {
+static bool authRequired() {
   /**
-   * Verify HTTP Basic Auth credentials.
-   * In AP mode (setup), authentication is not required.
-   * 
-   * @return true if authenticated or in AP mode
+   * Whether protected endpoints (and WebSocket commands) need credentials.
    */
   // AP mode doesn't require auth (user already knows AP password)
   if (g_state.apMode) {
-    return true;
+    return false;
   }
 
 #ifdef RESTARTER_DEV_AP_PASSWORD
   // Dev mode: skip auth to avoid browser dialog loop (credentials often rejected)
+  return false;
+#else
   return true;
 #endif
+}
+
+static bool checkAuth(AsyncWebServerRequest *request) {
+  /**
+   * Verify HTTP Basic Auth credentials.
+   * In AP mode (setup), authentication is not required.
+   * 
+   * @return true if authenticated or in AP mode
+   */
+  if (!authRequired()) {
+    return true;
+  }
   
   // Check rate limiting
   if (isRateLimited()) {
@@ -222,6 +287,60 @@ static bool checkAuth(AsyncWebServerRequest *request) {
   return true;
 }
 
+static bool equalsSecret(const String &secret, const char *candidate) {
+  /**
+   * Compare a candidate against a secret in constant time: every byte of
+   * the candidate is compared whether or not an earlier one differed, so
+   * the time taken depends on the candidate's length only, not on how
+   * much of the secret it matches.
+   */
+  size_t secretLen = secret.length();
+  size_t candidateLen = strlen(candidate);
+  uint8_t diff = secretLen != candidateLen;
+  for (size_t i = 0; i < candidateLen; i++) {
+    uint8_t expected = secretLen > 0 ? static_cast<uint8_t>(secret[i % secretLen]) : 0;
+    diff |= expected ^ static_cast<uint8_t>(candidate[i]);
+  }
+  return diff == 0;
+}
+
+static bool isSameOrigin(AsyncWebServerRequest *request) {
+  /**
+   * Whether a request comes from a page served by this device. Browsers
+   * always send Origin on WebSocket handshakes; clients that are not
+   * browsers usually send none and cannot be driven by another site.
+   */
+  if (!request->hasHeader("Origin")) {
+    return true;
+  }
+  String origin = request->header("Origin");
+  String host = request->header("Host");
+  return origin == "http://" + host || origin == "https://" + host;
+}
+
+static bool checkWsHandshakeAuth(AsyncWebServerRequest *request) {
+  /**
+   * Whether a /ws connection may send commands without an auth message.
+   * Never for cross-site handshakes, even where no credentials are
+   * required (AP mode, dev builds): any page the user visits can open
+   * the socket, and the browser attaches the device's Basic Auth
+   * credentials to it. Otherwise the handshake must carry valid Basic
+   * Auth credentials (the browser sends the ones it has for the page).
+   * Never challenges or counts failures; a client without credentials
+   * can still connect and authenticate with a message.
+   */
+  if (!isSameOrigin(request)) {
+    return false;
+  }
+  if (!authRequired()) {
+    return true;
+  }
+  if (isRateLimited()) {
+    return false;
+  }
+  return request->authenticate("admin", g_config.adminPassword.c_str());
+}
+
 // =============================================================================
 // HELPER FUNCTIONS
 // =============================================================================
@@ -236,18 +355,25 @@ static const char *pcStateToString(PCState state) {
     case PCState::BOOTING:    return "BOOTING";
     case PCState::RUNNING:    return "RUNNING";
     case PCState::RESTARTING: return "RESTARTING";
+    case PCState::SLEEP:      return "SLEEP";
+    case PCState::UNKNOWN_BLINK: return "UNKNOWN_BLINK";
     default:                  return "UNKNOWN";
   }
 }
 
-static String buildStatusJson() {
+static void buildStatusDoc(JsonDocument &doc) {
   /**
-   * Build a JSON object containing all current status information.
+   * Fill a JSON object containing all current status information.
    * This is sent to:
    *   - GET /api/status endpoint
    *   - WebSocket clients on connect and periodically
+   *
+   * Runs in the AsyncTCP or network task, so runtime values come from the
+   * status snapshots (one consistent copy each) rather than g_state/g_ota.
    */
-  StaticJsonDocument<1024> doc;
+  StatusSnapshot s = g_statusSnapshot.read();
+  OtaStatus otaStatus = OtaUpdate_status();
+  uint32_t nowMs = millis();
   
   // Message type (helps UI distinguish status from logs)
   doc["type"] = "status";
@@ -258,148 +384,1033 @@ static String buildStatusJson() {
   doc["fwVersion"] = Config::FW_VERSION;
   
   // Network status
-  doc["apMode"] = g_state.apMode;
-  doc["wifiConnected"] = g_state.wifiConnected;
+  doc["apMode"] = s.apMode;
+  doc["wifiConnected"] = s.wifiConnected;
   doc["hasConfig"] = g_config.wifiSsid.length() > 0;
   
   // PC status
-  doc["pcState"] = pcStateToString(g_state.pcState);
-  doc["powerRelayActive"] = g_state.powerRelayActive;
-  doc["resetRelayActive"] = g_state.resetRelayActive;
-  doc["temperature"] = g_state.temperature;
-  doc["pwrLedRaw"] = g_state.pwrLedRaw;
-  doc["hddLedRaw"] = g_state.hddLedRaw;
-  doc["pin4LastChangeSec"] = g_state.lastHddChangeMs > 0
-                               ? static_cast<int32_t>((millis() - g_state.lastHddChangeMs) / 1000)
+  doc["pcState"] = pcStateToString(s.pcState);
+  doc["reachability"] = Reachability_name(s.reachability);
+  doc["hangState"] = HangRecovery_stateName(s.hangState);
+  int64_t heartbeatUs = Heartbeat_lastUs();
+  doc["heartbeatAgeSec"] = heartbeatUs > 0
+                             ? static_cast<int32_t>((esp_timer_get_time() - heartbeatUs) / 1000000)
+                             : -1;
+  doc["powerRelayActive"] = s.powerRelayActive;
+  doc["resetRelayActive"] = s.resetRelayActive;
+  doc["temperature"] = s.temperature;
+  doc["pwrLedRaw"] = s.pwrLedRaw;
+  doc["hddLedRaw"] = s.hddLedRaw;
+  doc["pin4LastChangeSec"] = s.lastHddChangeMs > 0
+                               ? static_cast<int32_t>((nowMs - s.lastHddChangeMs) / 1000)
                                : -1;
   
   // HDD activity (seconds since last activity, -1 if never seen)
-  if (g_state.lastHddActiveMs > 0) {
-    doc["hddLastActiveSec"] = (millis() - g_state.lastHddActiveMs) / 1000;
+  if (s.lastHddActiveMs > 0) {
+    doc["hddLastActiveSec"] = (nowMs - s.lastHddActiveMs) / 1000;
   } else {
     doc["hddLastActiveSec"] = -1;
   }
+  doc["hddActivity"] = s.hddActivityPermille / 1000.0f;
+  doc["hddActivity60s"] = s.hddActivity60sPermille / 1000.0f;
+  doc["hddEdgeRate"] = s.hddEdgeRate;
+
+  // Every PC channel, [0] = the fields above (see PcChannels.h)
+  JsonArray channels = doc.createNestedArray("channels");
+  for (size_t i = 0; i < s.channelCount; i++) {
+    const PcChannelStatus &ch = s.channels[i];
+    JsonObject out = channels.createNestedObject();
+    out["channel"] = i;
+    out["name"] = PcChannels_name(i);
+    out["pcState"] = pcStateToString(ch.pcState);
+    out["powerRelayActive"] = ch.powerRelayActive;
+    out["resetRelayActive"] = ch.resetRelayActive;
+    out["hddActivity"] = ch.hddActivityPermille / 1000.0f;
+  }
   
+  // I2C sensors (see Sensors.h); NaN values serialize as null
+  JsonArray sensors = doc.createNestedArray("sensors");
+  for (size_t i = 0; i < s.sensorCount; i++) {
+    const SensorStatus &sensor = s.sensors[i];
+    JsonObject out = sensors.createNestedObject();
+    out["id"] = sensor.id;
+    out["model"] = sensor.model;
+    out["address"] = sensor.address;
+    out["online"] = sensor.online;
+    JsonObject values = out.createNestedObject("values");
+    for (uint8_t v = 0; v < sensor.valueCount; v++) {
+      values[Sensors_quantityName(sensor.quantities[v])] = sensor.values[v];
+    }
+  }
+  doc["pcPowerWatts"] = s.pcPowerWatts;
+  if (s.pcPowerDraw >= 0) {
+    doc["pcPowerDraw"] = s.pcPowerDraw == 1;
+  } else {
+    doc["pcPowerDraw"] = nullptr;
+  }
+
   // ESP32 system stats
-  doc["freeHeap"] = g_state.freeHeap;
-  doc["totalHeap"] = g_state.totalHeap;
-  doc["cpuLoad"] = g_state.cpuLoad;
+  doc["freeHeap"] = s.freeHeap;
+  doc["totalHeap"] = s.totalHeap;
+  doc["cpuLoad"] = s.cpuLoad;
   
-  // WiFi details (different in AP vs STA mode)
-  if (g_state.apMode) {
-    doc["ssid"] = String(Config::AP_SSID_PREFIX) + g_state.deviceId.substring(6);
+  // WiFi details (the network task fills ssid/ip for the current mode)
+  doc["ssid"] = s.ssid;
+  doc["ip"] = s.ip != 0 ? IPAddress(s.ip).toString() : String();
+  doc["rssi"] = s.rssi;
+  if (s.apMode) {
     doc["apPassword"] = g_state.apPassword;
-    doc["ip"] = WiFi.softAPIP().toString();
-    doc["rssi"] = 0;
-  } else if (g_state.wifiConnected) {
-    doc["ssid"] = WiFi.SSID();
-    doc["ip"] = WiFi.localIP().toString();
-    doc["rssi"] = WiFi.RSSI();
-  } else {
-    doc["ssid"] = g_config.wifiSsid;
-    doc["ip"] = "";
-    doc["rssi"] = 0;
   }
   
   // CSRF token for API requests (only in STA mode)
-  if (!g_state.apMode) {
+  if (!s.apMode) {
     doc["csrfToken"] = getCsrfToken();
   }
 
   // OTA status (for frontend update UI)
-  StaticJsonDocument<512> otaDoc;
-  if (deserializeJson(otaDoc, OtaUpdate_getStatusJson()) == DeserializationError::Ok) {
-    JsonObject ota = doc.createNestedObject("ota");
-    ota["checking"] = otaDoc["checking"] | false;
-    ota["updateInProgress"] = otaDoc["updateInProgress"] | false;
-    ota["available"] = otaDoc["available"] | false;
-    ota["progress"] = otaDoc["progress"] | 0;
-    ota["currentVersion"] = otaDoc["currentVersion"] | Config::FW_VERSION;
-    ota["remoteVersion"] = otaDoc["remoteVersion"] | "";
-    ota["notes"] = otaDoc["notes"] | "";
-    ota["error"] = otaDoc["error"] | "";
-    ota["lastCheckOk"] = otaDoc["lastCheckOk"] | false;
-    ota["lastCheckMs"] = otaDoc["lastCheckMs"] | 0;
+  JsonObject ota = doc.createNestedObject("ota");
+  ota["checking"] = otaStatus.checking;
+  ota["updateInProgress"] = otaStatus.updateInProgress;
+  ota["available"] = otaStatus.available;
+  ota["progress"] = otaStatus.progress;
+  ota["currentVersion"] = Config::FW_VERSION;
+  ota["remoteVersion"] = otaStatus.remoteVersion;
+  ota["notes"] = OtaUpdate_notes();
+  ota["error"] = otaStatus.error;
+  ota["lastCheckOk"] = otaStatus.lastCheckOk;
+  ota["lastCheckMs"] = otaStatus.lastCheckMs;
+}
+
+static String buildStatusJson() {
+  StaticJsonDocument<3072> doc;
+  buildStatusDoc(doc);
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
+static void buildConfigJson(JsonObject doc) {
+  /**
+   * Configuration without passwords, for GET /api/config and the
+   * WebSocket getConfig request.
+   */
+  // WiFi (password hidden)
+  doc["wifiSsid"] = g_config.wifiSsid;
+  doc["hasWifiPass"] = g_config.wifiPass.length() > 0;
+  
+  // MQTT Integration (password hidden)
+  JsonObject mqtt = doc.createNestedObject("mqtt");
+  mqtt["host"] = g_config.mqttHost;
+  mqtt["port"] = g_config.mqttPort;
+  mqtt["user"] = g_config.mqttUser;
+  mqtt["hasPass"] = g_config.mqttPass.length() > 0;
+  mqtt["tls"] = g_config.mqttTls;
+  mqtt["enabled"] = g_config.mqttHost.length() > 0;
+  
+  // Loki Integration (password hidden)
+  JsonObject loki = doc.createNestedObject("loki");
+  loki["host"] = g_config.lokiHost;
+  loki["user"] = g_config.lokiUser;
+  loki["hasPass"] = g_config.lokiPass.length() > 0;
+  loki["enabled"] = g_config.lokiHost.length() > 0;
+  
+  // Prometheus Integration
+  JsonObject prometheus = doc.createNestedObject("prometheus");
+  prometheus["enabled"] = g_config.prometheusEnabled;
+  prometheus["endpoint"] = "/metrics";
+  
+  // Timing settings (top level = channel 0, all channels below)
+  doc["powerPulseMs"] = g_config.channels[0].powerPulseMs;
+  doc["resetPulseMs"] = g_config.channels[0].resetPulseMs;
+  doc["bootGraceMs"] = g_config.channels[0].bootGraceMs;
+  JsonArray channels = doc.createNestedArray("channels");
+  for (size_t i = 0; i < PcChannels_count(); i++) {
+    const ChannelConfig &ch = g_config.channels[i];
+    JsonObject out = channels.createNestedObject();
+    out["name"] = ch.name;
+    out["powerPulseMs"] = ch.powerPulseMs;
+    out["resetPulseMs"] = ch.resetPulseMs;
+    out["bootGraceMs"] = ch.bootGraceMs;
   }
+
+  // Reachability probe
+  JsonObject probe = doc.createNestedObject("probe");
+  probe["host"] = g_config.probeHost;
+  probe["ports"] = g_config.probePorts;
+  probe["icmp"] = g_config.probeIcmp;
+
+  // Heartbeats and hang recovery
+  JsonObject heartbeat = doc.createNestedObject("heartbeat");
+  heartbeat["port"] = g_config.heartbeatPort;
+  heartbeat["timeoutSec"] = g_config.heartbeatTimeoutS;
+  heartbeat["recover"] = g_config.hangRecovery;
+  heartbeat["requireHddIdle"] = g_config.hangRequireHddIdle;
   
+  // Security (show if using default or custom password)
+  doc["hasCustomAdminPass"] = g_config.adminPassword != g_state.defaultAdminPassword;
+}
+
+static void addBootJson(JsonObject out, const BootRecord &record) {
+  out["trigger"] = BootTimeline_triggerName(record.trigger);
+  out["outcome"] = BootTimeline_outcomeName(record.outcome);
+  out["pressUptimeSec"] = record.pressUptimeSec;
+  JsonObject phases = out.createNestedObject("phasesMs");
+  for (size_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+    const char *name = BootTimeline_phaseName(static_cast<BootPhase>(i));
+    if (record.phaseMs[i] == BOOT_PHASE_MISSING) {
+      phases[name] = nullptr;
+    } else {
+      phases[name] = record.phaseMs[i];
+    }
+  }
+}
+
+static String buildBootsJson() {
+  /**
+   * Build the /api/boots response: the boot in progress, the last
+   * BOOT_HISTORY boots (newest first) and per-phase summaries of all
+   * boots since the device started.
+   */
+  BootRecord history[Config::BOOT_HISTORY];
+  size_t count = BootTimeline_history(history, Config::BOOT_HISTORY);
+  BootRecord current;
+  bool inProgress = BootTimeline_current(current);
+
+  DynamicJsonDocument doc(6144);
+  doc["uptimeSec"] = millis() / 1000;
+  if (inProgress) {
+    addBootJson(doc.createNestedObject("current"), current);
+  } else {
+    doc["current"] = nullptr;
+  }
+
+  JsonArray boots = doc.createNestedArray("boots");
+  for (size_t i = 0; i < count; i++) {
+    addBootJson(boots.createNestedObject(), history[i]);
+  }
+
+  JsonObject summary = doc.createNestedObject("summary");
+  for (size_t t = 0; t < BOOT_TRIGGER_COUNT; t++) {
+    BootTrigger trigger = static_cast<BootTrigger>(t);
+    JsonObject perTrigger = summary.createNestedObject(BootTimeline_triggerName(trigger));
+    for (size_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+      BootPhase phase = static_cast<BootPhase>(i);
+      const LatencyHistogram &h = BootTimeline_phaseTime(trigger, phase);
+      JsonObject p = perTrigger.createNestedObject(BootTimeline_phaseName(phase));
+      p["count"] = h.count();
+      p["meanMs"] = h.meanUs() / 1000;
+      p["p95Ms"] = h.percentileUs(95) / 1000;
+      p["maxMs"] = h.maxUs() / 1000;
+    }
+  }
+
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
+static String buildProfileJson() {
+  /**
+   * Build the /api/debug/profile response: one entry per instrumented
+   * stage (histogram summary) and one per scheduler task.
+   */
+  DynamicJsonDocument doc(4096);
+  doc["cpuMHz"] = Profiler_cpuMHz();
+  doc["uptimeMs"] = millis();
+
+  JsonArray stages = doc.createNestedArray("stages");
+  for (size_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    ProfileStage stage = static_cast<ProfileStage>(i);
+    const LatencyHistogram &h = Profiler_histogram(stage);
+    JsonObject s = stages.createNestedObject();
+    s["name"] = Profiler_stageName(stage);
+    s["count"] = h.count();
+    s["p50Us"] = h.percentileUs(50);
+    s["p99Us"] = h.percentileUs(99);
+    s["maxUs"] = h.maxUs();
+    s["meanUs"] = h.meanUs();
+    s["budgetUs"] = h.budgetUs();
+    s["overruns"] = h.overruns();
+  }
+
+  JsonArray tasks = doc.createNestedArray("tasks");
+  for (size_t i = 0; i < TaskScheduler_taskCount(); i++) {
+    SchedulerTaskStats stats;
+    if (!TaskScheduler_getStats(i, stats)) continue;
+    JsonObject t = tasks.createNestedObject();
+    t["name"] = stats.name;
+    t["periodMs"] = stats.periodMs;
+    t["deadlineMs"] = stats.deadlineMs;
+    t["runs"] = stats.runs;
+    t["missedDeadlines"] = stats.missedDeadlines;
+    t["lastExecUs"] = stats.lastExecUs;
+    t["maxExecUs"] = stats.maxExecUs;
+    t["maxLatenessUs"] = stats.maxLatenessUs;
+  }
+
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
+static String buildGpioBenchJson() {
+  /**
+   * Build the /api/debug/gpio response (cycles per call, both GPIO paths).
+   */
+  GpioBenchResult bench = FastGpio_benchmark();
+  StaticJsonDocument<384> doc;
+  doc["cpuMHz"] = Profiler_cpuMHz();
+  doc["iterations"] = bench.iterations;
+
+  JsonObject read = doc.createNestedObject("read");
+  read["digitalReadCycles"] = bench.digitalReadCycles;
+  read["fastGpioCycles"] = bench.fastReadCycles;
+
+  JsonObject write = doc.createNestedObject("write");
+  write["measured"] = bench.writesMeasured;
+  if (bench.writesMeasured) {
+    write["digitalWriteCycles"] = bench.digitalWriteCycles;
+    write["fastGpioCycles"] = bench.fastWriteCycles;
+  }
+
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
+static void addCodecBenchJson(JsonObject out, const WsCodecBenchEntry &entry) {
+  out["bytes"] = entry.bytes;
+  out["cycles"] = entry.cycles;
+}
+
+static String buildWsCodecBenchJson() {
+  /**
+   * Build the /api/debug/ws-codec response: the current status document
+   * encoded with each /ws encoder (bytes and cycles per frame).
+   */
+  StaticJsonDocument<3072> status;
+  buildStatusDoc(status);
+  WsCodecBenchResult bench = WsCodec_benchmark(status);
+
+  StaticJsonDocument<384> doc;
+  doc["cpuMHz"] = Profiler_cpuMHz();
+  doc["iterations"] = bench.iterations;
+  addCodecBenchJson(doc.createNestedObject("json"), bench.json);
+  addCodecBenchJson(doc.createNestedObject("msgpack"), bench.msgpack);
+  addCodecBenchJson(doc.createNestedObject("msgpackIntKeys"), bench.msgpackKeys);
+
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
+static String buildTraceStatusJson() {
+  /**
+   * Build the /api/debug/trace/start|stop response.
+   */
+  GpioTraceStatus status = GpioTrace_status();
+  StaticJsonDocument<192> doc;
+  doc["capturing"] = status.capturing;
+  doc["hdd"] = status.hdd;
+  doc["records"] = status.records;
+  doc["overwritten"] = status.overwritten;
+  doc["capacity"] = status.capacity;
+
   String out;
   serializeJson(doc, out);
   return out;
 }
 
+// =============================================================================
+// WEBSOCKET SENDING - Per encoding and subscription (see WsClients.h)
+// =============================================================================
+
+static void sendFrame(AsyncWebSocketClient *client, WsEncoding encoding, const AsyncWebSocketSharedBuffer &frame) {
+  if (encoding == WsEncoding::MSGPACK) {
+    client->binary(frame);
+  } else {
+    client->text(frame);
+  }
+}
+
+static void sendFrames(const WsFrames &frames, const WsClientInfo *clients, const bool *eligible, size_t count) {
+  /**
+   * Send each eligible client the frame in its encoding. While every
+   * client is eligible and uses the same encoding, textAll()/binaryAll()
+   * send under the WebSocket's own lock; otherwise one by one.
+   */
+  bool all = true;
+  uint8_t encodings = 0;
+  for (size_t i = 0; i < count; i++) {
+    all = all && eligible[i];
+    if (eligible[i]) {
+      encodings |= WsEncoding_bit(clients[i].encoding);
+    }
+  }
+  const AsyncWebSocketSharedBuffer &json = frames.frame[static_cast<size_t>(WsEncoding::JSON)];
+  const AsyncWebSocketSharedBuffer &msgpack = frames.frame[static_cast<size_t>(WsEncoding::MSGPACK)];
+  if (all && encodings == WsEncoding_bit(WsEncoding::JSON)) {
+    if (json) g_ws.textAll(json);
+    return;
+  }
+  if (all && encodings == WsEncoding_bit(WsEncoding::MSGPACK)) {
+    if (msgpack) g_ws.binaryAll(msgpack);
+    return;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    const AsyncWebSocketSharedBuffer &frame = frames.frame[static_cast<size_t>(clients[i].encoding)];
+    AsyncWebSocketClient *client = eligible[i] && frame ? g_ws.client(clients[i].id) : nullptr;
+    if (client) {
+      sendFrame(client, clients[i].encoding, frame);
+    }
+  }
+}
+
+static void flushRateLimited() {
+  /**
+   * Rate-limited subscribers get a topic's current snapshot once their
+   * interval has passed and the topic changed since their last one.
+   * Runs after every broadcast and on g_wsFlushTimer.
+   */
+  WsClientInfo clients[Config::WS_MAX_CLIENTS];
+  size_t count = WsClients_list(clients, Config::WS_MAX_CLIENTS);
+  uint32_t nowMs = millis();
+  for (size_t t = 0; t < WS_STATUS_TOPIC_COUNT; t++) {
+    WsTopic topic = static_cast<WsTopic>(t);
+    uint32_t seq = 0;
+    for (size_t i = 0; i < count; i++) {
+      const WsSubscription &sub = clients[i].topics[t];
+      if (!sub.active || sub.minIntervalMs == 0 || nowMs - sub.lastSentMs < sub.minIntervalMs) {
+        continue;
+      }
+      if (seq == 0) {
+        seq = WsStatusStream_seq(topic);
+      }
+      if (seq == 0 || sub.seq == seq) {
+        continue;  // No broadcast yet, or nothing new
+      }
+      uint32_t snapshotSeq = 0;
+      AsyncWebSocketSharedBuffer frame = WsStatusStream_snapshot(topic, clients[i].encoding, false, &snapshotSeq);
+      AsyncWebSocketClient *client = frame ? g_ws.client(clients[i].id) : nullptr;
+      if (client) {
+        sendFrame(client, clients[i].encoding, frame);
+        WsClients_markSent(clients[i].id, topic, snapshotSeq, nowMs);
+      }
+    }
+  }
+}
+
 // =============================================================================
 // ACTION LOG (circular buffer)
 // =============================================================================
 // Keeps recent action logs in memory so new WebSocket clients can see history.
+// An entry's frames are serialized on first use per encoding (broadcast or
+// history) and shared with the clients' send queues (see WsFramePool.h).
+// Logged from the AsyncTCP and network tasks, so the ring is guarded by
+// g_logMutex.
+
+struct LogEntry {
+  String message;
+  uint32_t timestampMs;
+  uint8_t encodings;  // Frames serialized for this entry (WsEncoding_bit)
+  WsFrames frames;    // Storage kept across entries and reused in place
+};
 
-static String g_logBuffer[20];          // Circular buffer of log messages
+static LogEntry g_logBuffer[20];        // Circular buffer of log entries
 static size_t g_logCount = 0;           // Number of logs stored
 static size_t g_logIndex = 0;           // Next write position
 static constexpr size_t kLogBufferSize = sizeof(g_logBuffer) / sizeof(g_logBuffer[0]);
+static SemaphoreHandle_t g_logMutex = nullptr;
+
+static AsyncWebSocketSharedBuffer logFrameLocked(LogEntry &entry, WsEncoding encoding) {
+  AsyncWebSocketSharedBuffer &frame = entry.frames.frame[static_cast<size_t>(encoding)];
+  if (!(entry.encodings & WsEncoding_bit(encoding))) {
+    StaticJsonDocument<192> doc;
+    doc["type"] = "log";
+    doc["message"] = entry.message;
+    doc["timestampMs"] = entry.timestampMs;
+    if (!WsFramePool_serializeInto(frame, doc, Config::WS_LOG_FRAME_BYTES, encoding)) {
+      return nullptr;
+    }
+    entry.encodings |= WsEncoding_bit(encoding);
+  }
+  return frame;
+}
+
+static void sendLogHistory(AsyncWebSocketClient *client, WsEncoding encoding) {
+  // Copy references under the mutex, send outside it
+  AsyncWebSocketSharedBuffer history[kLogBufferSize];
+  size_t count = 0;
+  if (xSemaphoreTake(g_logMutex, portMAX_DELAY) == pdTRUE) {
+    size_t start = (g_logIndex + kLogBufferSize - g_logCount) % kLogBufferSize;
+    for (; count < g_logCount; count++) {
+      history[count] = logFrameLocked(g_logBuffer[(start + count) % kLogBufferSize], encoding);
+    }
+    xSemaphoreGive(g_logMutex);
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (history[i]) {
+      sendFrame(client, encoding, history[i]);
+    }
+  }
+}
 
 void WebInterface_logAction(const char *message) {
   /**
-   * Log an action and broadcast to all connected WebSocket clients.
+   * Log an action and broadcast to the WebSocket clients subscribed to
+   * logs (rate-limited ones only while under their rate).
    * 
    * @param message  Human-readable description of the action
    */
   Serial.print("ACTION: ");
   Serial.println(message);
+
+  WsClientInfo clients[Config::WS_MAX_CLIENTS];
+  bool eligible[Config::WS_MAX_CLIENTS];
+  size_t count = WsClients_list(clients, Config::WS_MAX_CLIENTS);
+  uint32_t nowMs = millis();
+  uint8_t encodings = 0;
+  for (size_t i = 0; i < count; i++) {
+    const WsSubscription &sub = clients[i].topics[static_cast<size_t>(WsTopic::LOGS)];
+    eligible[i] = sub.active && (sub.minIntervalMs == 0 || nowMs - sub.lastSentMs >= sub.minIntervalMs);
+    if (eligible[i]) {
+      encodings |= WsEncoding_bit(clients[i].encoding);
+    }
+  }
   
-  // Build JSON log message
-  StaticJsonDocument<192> doc;
-  doc["type"] = "log";
-  doc["message"] = message;
-  doc["timestampMs"] = millis();
-  
-  String out;
-  serializeJson(doc, out);
-  
-  // Broadcast to all WebSocket clients
-  g_ws.textAll(out);
+  if (!g_logMutex || xSemaphoreTake(g_logMutex, portMAX_DELAY) != pdTRUE) {
+    return;
+  }
 
-  // Store in circular buffer for new clients
-  g_logBuffer[g_logIndex] = out;
+  // Store the entry; serialize only the encodings listeners use now (the
+  // history serializes others on demand). Send outside the mutex, as
+  // sending takes the WebSocket's own lock.
+  LogEntry &entry = g_logBuffer[g_logIndex];
+  entry.message = message;
+  entry.timestampMs = nowMs;
+  entry.encodings = 0;
   g_logIndex = (g_logIndex + 1) % kLogBufferSize;
   if (g_logCount < kLogBufferSize) {
     g_logCount++;
   }
+  WsFrames frames;
+  for (size_t e = 0; e < WS_ENCODING_COUNT; e++) {
+    if (encodings & WsEncoding_bit(static_cast<WsEncoding>(e))) {
+      frames.frame[e] = logFrameLocked(entry, static_cast<WsEncoding>(e));
+    }
+  }
+  xSemaphoreGive(g_logMutex);
+
+  if (encodings == 0) {
+    return;  // No listeners - nothing serialized
+  }
+  sendFrames(frames, clients, eligible, count);
+  for (size_t i = 0; i < count; i++) {
+    if (eligible[i] && clients[i].topics[static_cast<size_t>(WsTopic::LOGS)].minIntervalMs > 0) {
+      WsClients_markSent(clients[i].id, WsTopic::LOGS, 0, nowMs);
+    }
+  }
 }
 
 void WebInterface_broadcastStatus() {
   /**
-   * Send current status to all connected WebSocket clients.
-   * Called periodically (every STATUS_BROADCAST_MS) from main loop.
+   * Send changed status topics to their WebSocket subscribers.
+   * Called by StatusPublisher when fields changed or on heartbeat.
+   */
+  WsClientInfo clients[Config::WS_MAX_CLIENTS];
+  size_t count = g_ws.count() > 0 ? WsClients_list(clients, Config::WS_MAX_CLIENTS) : 0;
+
+  StaticJsonDocument<3072> doc;
+  bool built = false;
+  for (size_t t = 0; t < WS_STATUS_TOPIC_COUNT; t++) {
+    WsTopic topic = static_cast<WsTopic>(t);
+    bool subscribed = false;
+    bool eligible[Config::WS_MAX_CLIENTS];
+    uint8_t encodings = 0;  // Of subscribers that get every delta
+    for (size_t i = 0; i < count; i++) {
+      const WsSubscription &sub = clients[i].topics[t];
+      subscribed = subscribed || sub.active;
+      eligible[i] = sub.active && sub.minIntervalMs == 0;
+      if (eligible[i]) {
+        encodings |= WsEncoding_bit(clients[i].encoding);
+      }
+    }
+    if (!subscribed) {
+      WsStatusStream_reset(topic);  // Next subscriber starts from a fresh snapshot
+      continue;                     // Nobody listening - skip serialization entirely
+    }
+    if (!built) {
+      buildStatusDoc(doc);
+      built = true;
+    }
+    sendFrames(WsStatusStream_publish(topic, doc, encodings), clients, eligible, count);
+  }
+
+  if (built) {
+    flushRateLimited();
+  }
+}
+
+static void sendTopics(AsyncWebSocketClient *client, const WsClientInfo &info, const bool *topics) {
+  /**
+   * Send a (newly) subscribed client where each topic stands: status
+   * snapshots the deltas continue from, and the log history. A topic
+   * without a snapshot yet gets one from the network task shortly.
+   */
+  for (size_t t = 0; t < WS_STATUS_TOPIC_COUNT; t++) {
+    if (!topics[t] || !info.topics[t].active) {
+      continue;
+    }
+    WsTopic topic = static_cast<WsTopic>(t);
+    uint32_t seq = 0;
+    AsyncWebSocketSharedBuffer status = WsStatusStream_snapshot(topic, info.encoding, false, &seq);
+    if (status) {
+      sendFrame(client, info.encoding, status);
+      if (info.topics[t].minIntervalMs > 0) {
+        WsClients_markSent(info.id, topic, seq, millis());
+      }
+    } else {
+      StatusPublisher_markDirty(StatusField::ALL);
+    }
+  }
+  if (topics[static_cast<size_t>(WsTopic::LOGS)] && info.topics[static_cast<size_t>(WsTopic::LOGS)].active) {
+    sendLogHistory(client, info.encoding);
+  }
+}
+
+static void handleSubscribe(AsyncWebSocketClient *client, JsonVariantConst request) {
+  /**
+   * {"type":"subscribe","topics":{"pc":{"maxRate":1},"logs":{}}} or
+   * {"type":"subscribe","topics":["pc","logs"]} (every message). Replaces
+   * the client's subscriptions; acknowledged with the topics accepted.
    */
-  g_ws.textAll(buildStatusJson());
+  WsClientInfo before;
+  if (!WsClients_get(client->id(), &before)) {
+    return;
+  }
+  WsSubscription topics[WS_TOPIC_COUNT] = {};
+  JsonVariantConst requested = request["topics"];
+  if (requested.is<JsonArrayConst>()) {
+    for (JsonVariantConst name : requested.as<JsonArrayConst>()) {
+      WsTopic topic;
+      if (WsTopic_parse(name | "", &topic)) {
+        topics[static_cast<size_t>(topic)].active = true;
+      }
+    }
+  } else {
+    for (JsonPairConst kv : requested.as<JsonObjectConst>()) {
+      WsTopic topic;
+      if (!WsTopic_parse(kv.key().c_str(), &topic)) {
+        continue;
+      }
+      WsSubscription &sub = topics[static_cast<size_t>(topic)];
+      float maxRate = kv.value()["maxRate"] | 0.0f;
+      sub.active = true;
+      if (maxRate > 0) {
+        maxRate = maxRate < 1.0f / 3600 ? 1.0f / 3600 : maxRate;  // At least hourly
+        sub.minIntervalMs = static_cast<uint32_t>(ceilf(1000.0f / maxRate));
+      }
+    }
+  }
+  WsClients_subscribe(client->id(), topics);
+
+  StaticJsonDocument<256> ack;
+  ack["type"] = "subscribed";
+  JsonArray accepted = ack.createNestedArray("topics");
+  bool added[WS_TOPIC_COUNT];
+  for (size_t t = 0; t < WS_TOPIC_COUNT; t++) {
+    added[t] = topics[t].active && !before.topics[t].active;
+    if (topics[t].active) {
+      accepted.add(WsTopic_name(static_cast<WsTopic>(t)));
+    }
+  }
+  AsyncWebSocketSharedBuffer frame = WsFramePool_serialize(ack, before.encoding);
+  if (frame) {
+    sendFrame(client, before.encoding, frame);
+  }
+
+  WsClientInfo after;
+  if (WsClients_get(client->id(), &after)) {
+    sendTopics(client, after, added);
+  }
+}
+
+static void handleResync(AsyncWebSocketClient *client, JsonVariantConst request) {
+  // {"type":"resync","topic":"pc"}; without a topic, every subscribed one
+  WsClientInfo info;
+  if (!WsClients_get(client->id(), &info)) {
+    return;
+  }
+  WsTopic only;
+  bool one = WsTopic_parse(request["topic"] | "", &only);
+  for (size_t t = 0; t < WS_STATUS_TOPIC_COUNT; t++) {
+    WsTopic topic = static_cast<WsTopic>(t);
+    if (!info.topics[t].active || (one && topic != only)) {
+      continue;
+    }
+    AsyncWebSocketSharedBuffer status = WsStatusStream_snapshot(topic, info.encoding, true);
+    if (status) {
+      sendFrame(client, info.encoding, status);
+    }
+  }
+}
+
+// =============================================================================
+// PC ACTIONS - Queued to the control task
+// =============================================================================
+
+static CommandStatus executePcAction(PcCommand command, CommandSource source, uint8_t channel,
+                                     const char *logMessage, uint32_t *seq, CommandResult *result) {
+  /**
+   * Queue a PC action and wait for the control task to execute it.
+   * The wait is short: submitting wakes the control task, which runs at
+   * a higher priority than the AsyncTCP task. Logged unless rejected.
+   *
+   * @param seq  Sequence ID (command ID), 0 if the queue was full
+   * @return DONE, PENDING (not executed within COMMAND_ACK_TIMEOUT_MS),
+   *         REJECTED (power relay held by a force shutdown) or DROPPED
+   *         (queue full)
+   */
+  *seq = CommandQueue_submit(command, source, channel);
+  if (*seq == 0) {
+    return CommandStatus::DROPPED;
+  }
+
+  CommandStatus status = CommandQueue_wait(*seq, Config::COMMAND_ACK_TIMEOUT_MS, result);
+  if (status == CommandStatus::REJECTED) {
+    return status;
+  }
+
+  if (channel == 0) {
+    WebInterface_logAction(logMessage);
+  } else {
+    WebInterface_logAction((String("[") + PcChannels_name(channel) + "] " + logMessage).c_str());
+  }
+  return status;
+}
+
+static void runPcAction(AsyncWebServerRequest *request, PcCommand command, const char *logMessage) {
+  /**
+   * Queue a PC action and answer once the control task executed it.
+   *
+   * ?channel=N picks the PC (default 0, see PcChannels.h).
+   *
+   *   200  executed (seq, latencyUs)
+   *   202  queued, not executed within COMMAND_ACK_TIMEOUT_MS
+   *   400  no such channel
+   *   409  power relay held by a running force shutdown (power actions)
+   *   503  queue full
+   */
+  long channel = 0;
+  if (request->hasParam("channel")) {
+    channel = request->getParam("channel")->value().toInt();
+  }
+  if (channel < 0 || static_cast<size_t>(channel) >= PcChannels_count()) {
+    request->send(400, "application/json", "{\"error\":\"unknown channel\"}");
+    return;
+  }
+
+  uint32_t seq = 0;
+  CommandResult result;
+  CommandStatus status = executePcAction(command, CommandSource::REST, static_cast<uint8_t>(channel),
+                                         logMessage, &seq, &result);
+  if (status == CommandStatus::DROPPED) {
+    request->send(503, "application/json", "{\"error\":\"command queue full\"}");
+  } else if (status == CommandStatus::REJECTED) {
+    request->send(409, "application/json", "{\"error\":\"relay busy\"}");
+  } else if (status == CommandStatus::DONE) {
+    request->send(200, "application/json",
+                  String("{\"ok\":true,\"seq\":") + String(seq) +
+                  ",\"latencyUs\":" + String(result.latencyUs) + "}");
+  } else {
+    request->send(202, "application/json",
+                  String("{\"ok\":true,\"seq\":") + String(seq) + ",\"pending\":true}");
+  }
+}
+
+// =============================================================================
+// WEBSOCKET COMMANDS - Request/response on /ws
+// =============================================================================
+// Every request may carry an "id"; its reply echoes it:
+//
+//   {"type":"auth","id":1,"password":"..."}          → {"type":"ack","id":1,"ok":true}
+//   {"type":"command","id":2,"command":"power","channel":0}
+//                                                    → {"type":"ack","id":2,"ok":true,"seq":57,"latencyUs":840}
+//   {"type":"getConfig","id":3}                      → {"type":"ack","id":3,"ok":true,"config":{...}}
+//
+// A connection authenticates once: by Basic Auth on a same-origin handshake
+// (see checkWsHandshakeAuth()) or with the admin password in an auth message,
+// which counts towards the same lockout as HTTP. An auth message without a
+// password just reports the connection's state. No CSRF token is needed: a
+// cross-site page can open the socket, and the browser even attaches the
+// page's Basic Auth credentials, but such a handshake never authenticates
+// the connection, so that page would need the admin password itself.
+// Commands wait for the control task like POST /api/action/* (within
+// COMMAND_ACK_TIMEOUT_MS), then answer pending.
+
+struct WsCommandName {
+  const char *name;
+  PcCommand command;
+  const char *logMessage;
+};
+
+static const WsCommandName kWsCommands[] = {
+  {"power",      PcCommand::POWER_PULSE, "Power pulse requested (WebSocket)"},
+  {"reset",      PcCommand::RESET_PULSE, "Reset pulse requested (WebSocket)"},
+  {"forcePower", PcCommand::FORCE_POWER, "Force shutdown requested (WebSocket, 11s hold)"},
+};
+
+static void beginAck(JsonDocument &ack, JsonVariantConst request, bool ok) {
+  ack["type"] = "ack";
+  if (!request["id"].isNull()) {
+    ack["id"] = request["id"];
+  }
+  ack["ok"] = ok;
+}
+
+static void sendAck(AsyncWebSocketClient *client, WsEncoding encoding, const JsonDocument &ack) {
+  AsyncWebSocketSharedBuffer frame = WsFramePool_serialize(ack, encoding);
+  if (frame) {
+    sendFrame(client, encoding, frame);
+  }
+}
+
+static void sendAckError(AsyncWebSocketClient *client, WsEncoding encoding, JsonVariantConst request,
+                         const char *error) {
+  StaticJsonDocument<128> ack;
+  beginAck(ack, request, false);
+  ack["error"] = error;
+  sendAck(client, encoding, ack);
+}
+
+static void handleAuth(AsyncWebSocketClient *client, const WsClientInfo &info, JsonVariantConst request) {
+  if (!info.authenticated) {
+    const char *password = request["password"] | static_cast<const char *>(nullptr);
+    if (!password) {
+      sendAckError(client, info.encoding, request, "unauthorized");
+      return;
+    }
+    if (isRateLimited()) {
+      sendAckError(client, info.encoding, request, "too many attempts");
+      return;
+    }
+    if (!equalsSecret(g_config.adminPassword, password)) {
+      recordAuthFailure();
+      sendAckError(client, info.encoding, request, "invalid password");
+      return;
+    }
+    g_state.authFailCount = 0;
+    WsClients_authenticate(info.id);
+    Serial.printf("WebSocket client #%u authenticated\n", info.id);
+  }
+
+  StaticJsonDocument<64> ack;
+  beginAck(ack, request, true);
+  sendAck(client, info.encoding, ack);
+}
+
+static void handleCommand(AsyncWebSocketClient *client, const WsClientInfo &info, JsonVariantConst request) {
+  if (!info.authenticated) {
+    sendAckError(client, info.encoding, request, "unauthorized");
+    return;
+  }
+  const char *name = request["command"] | "";
+  const WsCommandName *entry = nullptr;
+  for (const WsCommandName &candidate : kWsCommands) {
+    if (strcmp(name, candidate.name) == 0) {
+      entry = &candidate;
+      break;
+    }
+  }
+  if (!entry) {
+    sendAckError(client, info.encoding, request, "unknown command");
+    return;
+  }
+  long channel = request["channel"] | 0L;
+  if (channel < 0 || static_cast<size_t>(channel) >= PcChannels_count()) {
+    sendAckError(client, info.encoding, request, "unknown channel");
+    return;
+  }
+
+  uint32_t seq = 0;
+  CommandResult result;
+  CommandStatus status = executePcAction(entry->command, CommandSource::WEBSOCKET, static_cast<uint8_t>(channel),
+                                         entry->logMessage, &seq, &result);
+  if (status == CommandStatus::DROPPED) {
+    sendAckError(client, info.encoding, request, "command queue full");
+    return;
+  }
+
+  StaticJsonDocument<128> ack;
+  beginAck(ack, request, status != CommandStatus::REJECTED);
+  ack["seq"] = seq;
+  if (status == CommandStatus::REJECTED) {
+    ack["error"] = "relay busy";
+  } else if (status == CommandStatus::DONE) {
+    ack["latencyUs"] = result.latencyUs;
+  } else {
+    ack["pending"] = true;
+  }
+  sendAck(client, info.encoding, ack);
+}
+
+static void handleGetConfig(AsyncWebSocketClient *client, const WsClientInfo &info, JsonVariantConst request) {
+  if (!info.authenticated) {
+    sendAckError(client, info.encoding, request, "unauthorized");
+    return;
+  }
+  StaticJsonDocument<2304> ack;
+  beginAck(ack, request, true);
+  buildConfigJson(ack.createNestedObject("config"));
+  sendAck(client, info.encoding, ack);
 }
 
 // =============================================================================
 // SETUP - Register all endpoints
 // =============================================================================
 
+// =============================================================================
+// HOUSEKEEPING - Periodic maintenance (network timer wheel)
+// =============================================================================
+
+constexpr uint32_t WS_CLEANUP_INTERVAL_MS = 1000;
+constexpr uint32_t WS_FLUSH_INTERVAL_MS = 100;  // Rate-limited subscribers, when idle
+
+static Timer g_housekeepingTimer;
+static Timer g_wsFlushTimer;
+
+static void flushWebSocket(void *) {
+  // Snapshots held back by a client's max rate, if no broadcast sent them
+  if (g_ws.count() > 0) {
+    flushRateLimited();
+  }
+}
+
+static void housekeeping(void *) {
+  ProfileScope scope(ProfileStage::WEB_HOUSEKEEPING);
+
+  // Clean up disconnected WebSocket clients
+  g_ws.cleanupClients();
+
+  // WebSocket health: watched while clients are connected, heartbeat
+  // while every send queue has room. A client whose queue stays full for
+  // WS_STALL_MS (e.g. half-open TCP) would hold buffers forever; close
+  // the clients and let them reconnect instead.
+  if (g_ws.count() == 0) {
+    HealthMonitor_stop(Subsystem::WEBSOCKET);
+    return;
+  }
+  HealthMonitor_start(Subsystem::WEBSOCKET);
+  if (HealthMonitor_takeRecovery(Subsystem::WEBSOCKET)) {
+    Serial.println("WebSocket send queue stalled - closing clients");
+    g_ws.closeAll(1013);  // "Try again later"
+    return;
+  }
+  if (g_ws.availableForWriteAll()) {
+    HealthMonitor_beat(Subsystem::WEBSOCKET);
+  }
+}
+
 void WebInterface_setup() {
   /**
    * Initialize the web server with all endpoints.
    * Called once during setup().
    */
   
+  // -------------------------------------------------------------------------
+  // Power Hold for In-Flight Requests
+  // -------------------------------------------------------------------------
+  // A request object lives until its connection closes, so the hold is
+  // released from onDisconnect. The WebSocket upgrade is skipped because
+  // that connection stays open for the lifetime of the client.
+  g_server.addMiddleware([](AsyncWebServerRequest *request, ArMiddlewareNext next) {
+    if (request->url() == "/ws") {
+      next();
+      return;
+    }
+    PowerManager_acquire(PowerHold::HTTP);
+    request->onDisconnect([]() { PowerManager_release(PowerHold::HTTP); });
+    next();
+  });
+
   // -------------------------------------------------------------------------
   // WebSocket Handler
   // -------------------------------------------------------------------------
+  WsFramePool_setup();
+  WsCodec_setup();
+  WsStatusStream_setup();
+  if (!g_logMutex) {
+    g_logMutex = xSemaphoreCreateMutex();
+  }
+  g_ws.handleHandshake([](AsyncWebServerRequest *request) {
+    // Encoding from the subprotocol (the server echoes the header as is),
+    // commands allowed if the handshake carries credentials
+    WsEncoding encoding = WsEncoding::JSON;
+    if (request->hasHeader("Sec-WebSocket-Protocol")) {
+      encoding = WsCodec_forSubprotocol(request->header("Sec-WebSocket-Protocol"));
+    }
+    WsClients_offer(request->client(), encoding, checkWsHandshakeAuth(request));
+    return true;
+  });
   g_ws.onEvent([](AsyncWebSocket *server, AsyncWebSocketClient *client,
                   AwsEventType type, void *arg, uint8_t *data, size_t len) {
+    ProfileScope scope(ProfileStage::WS_EVENT);
     if (type == WS_EVT_CONNECT) {
-      Serial.printf("WebSocket client #%u connected\n", client->id());
-      
-      // Send current status immediately on connect
-      client->text(buildStatusJson());
-      
-      // Send recent log history
-      size_t start = (g_logIndex + kLogBufferSize - g_logCount) % kLogBufferSize;
-      for (size_t i = 0; i < g_logCount; i++) {
-        size_t idx = (start + i) % kLogBufferSize;
-        client->text(g_logBuffer[idx]);
+      if (!WsClients_add(client->id(), client->client())) {
+        client->close(1013);  // "Try again later"
+        return;
+      }
+      WsClientInfo info;
+      if (!WsClients_get(client->id(), &info)) {
+        return;
+      }
+      Serial.printf("WebSocket client #%u connected (%s%s)\n", client->id(), WsEncoding_name(info.encoding),
+                    info.authenticated ? ", authenticated" : "");
+
+      // Binary clients first get the key table (see WsCodec.h)
+      if (info.encoding == WsEncoding::MSGPACK) {
+        AsyncWebSocketSharedBuffer keys = WsCodec_keysFrame();
+        if (keys) {
+          client->binary(keys);
+        }
+      }
+
+      // Subscribed to everything until the client says otherwise
+      bool all[WS_TOPIC_COUNT];
+      for (size_t t = 0; t < WS_TOPIC_COUNT; t++) {
+        all[t] = true;
+      }
+      sendTopics(client, info, all);
+    } else if (type == WS_EVT_DISCONNECT) {
+      WsClients_remove(client->id());
+    } else if (type == WS_EVT_DATA) {
+      // Subscriptions, resyncs and commands, one JSON text frame each
+      AwsFrameInfo *info = static_cast<AwsFrameInfo *>(arg);
+      if (!info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT) {
+        return;
+      }
+      StaticJsonDocument<512> msg;
+      if (deserializeJson(msg, reinterpret_cast<const char *>(data), len)) {
+        return;
+      }
+      const char *msgType = msg["type"] | "";
+      if (strcmp(msgType, "subscribe") == 0) {
+        handleSubscribe(client, msg.as<JsonVariantConst>());
+      } else if (strcmp(msgType, "resync") == 0) {
+        handleResync(client, msg.as<JsonVariantConst>());
+      } else {
+        WsClientInfo sender;
+        if (!WsClients_get(client->id(), &sender)) {
+          return;
+        }
+        if (strcmp(msgType, "auth") == 0) {
+          handleAuth(client, sender, msg.as<JsonVariantConst>());
+        } else if (strcmp(msgType, "command") == 0) {
+          handleCommand(client, sender, msg.as<JsonVariantConst>());
+        } else if (strcmp(msgType, "getConfig") == 0) {
+          handleGetConfig(client, sender, msg.as<JsonVariantConst>());
+        }
       }
     }
   });
@@ -432,9 +1443,98 @@ void WebInterface_setup() {
   // -------------------------------------------------------------------------
   // Returns current device status as JSON
   g_server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ProfileScope scope(ProfileStage::HTTP_STATUS);
     request->send(200, "application/json", buildStatusJson());
   });
 
+  // -------------------------------------------------------------------------
+  // API: GET /api/boots (PROTECTED)
+  // -------------------------------------------------------------------------
+  // Boot phase timings after remote power/reset presses (BootTimeline.h)
+  g_server.on("/api/boots", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) return;
+    request->send(200, "application/json", buildBootsJson());
+  });
+
+  // -------------------------------------------------------------------------
+  // API: GET /api/debug/profile (PROTECTED)
+  // -------------------------------------------------------------------------
+  // Per-stage timing histograms and scheduler task statistics
+  g_server.on("/api/debug/profile", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) return;
+    request->send(200, "application/json", buildProfileJson());
+  });
+
+  // -------------------------------------------------------------------------
+  // API: GET /api/debug/gpio (PROTECTED)
+  // -------------------------------------------------------------------------
+  // On-device benchmark: CPU cycles per GPIO call, Arduino vs FastGpio
+  g_server.on("/api/debug/gpio", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) return;
+    request->send(200, "application/json", buildGpioBenchJson());
+  });
+
+  // -------------------------------------------------------------------------
+  // API: GET /api/debug/ws-codec (PROTECTED)
+  // -------------------------------------------------------------------------
+  // On-device benchmark: the status frame as JSON vs MessagePack
+  g_server.on("/api/debug/ws-codec", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) return;
+    request->send(200, "application/json", buildWsCodecBenchJson());
+  });
+
+  // -------------------------------------------------------------------------
+  // API: GET /api/debug/trace (PROTECTED)
+  // -------------------------------------------------------------------------
+  // Binary GPIO edge trace (format in GpioTrace.h), for tools/trace_replay
+  g_server.on("/api/debug/trace", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) return;
+
+    std::shared_ptr<std::vector<uint8_t>> trace = std::make_shared<std::vector<uint8_t>>();
+    if (!GpioTrace_export(*trace)) {
+      request->send(404, "application/json", "{\"error\":\"No trace captured\"}");
+      return;
+    }
+    AsyncWebServerResponse *response = request->beginResponse(
+        "application/octet-stream", trace->size(),
+        [trace](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          size_t len = trace->size() - index;
+          if (len > maxLen) len = maxLen;
+          memcpy(buffer, trace->data() + index, len);
+          return len;
+        });
+    response->addHeader("Content-Disposition", "attachment; filename=\"restarter-trace.bin\"");
+    request->send(response);
+  });
+
+  // -------------------------------------------------------------------------
+  // API: POST /api/debug/trace/start (PROTECTED + CSRF)
+  // -------------------------------------------------------------------------
+  // Clear and start the GPIO trace; hdd=0 leaves out the HDD LED
+  g_server.on("/api/debug/trace/start", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) return;
+    if (!validateCsrfToken(request)) return;
+
+    bool hdd = !(request->hasParam("hdd") && request->getParam("hdd")->value() == "0");
+    if (!GpioTrace_start(hdd)) {
+      request->send(507, "application/json", "{\"error\":\"Not enough memory\"}");
+      return;
+    }
+    WebInterface_logAction("GPIO trace started");
+    request->send(200, "application/json", buildTraceStatusJson());
+  });
+
+  // -------------------------------------------------------------------------
+  // API: POST /api/debug/trace/stop (PROTECTED + CSRF)
+  // -------------------------------------------------------------------------
+  g_server.on("/api/debug/trace/stop", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (!checkAuth(request)) return;
+    if (!validateCsrfToken(request)) return;
+
+    GpioTrace_stop();
+    request->send(200, "application/json", buildTraceStatusJson());
+  });
+
   // -------------------------------------------------------------------------
   // API: GET /api/ota/check (PROTECTED)
   // -------------------------------------------------------------------------
@@ -475,41 +1575,10 @@ void WebInterface_setup() {
   // Returns current configuration (passwords are hidden)
   g_server.on("/api/config", HTTP_GET, [](AsyncWebServerRequest *request) {
     if (!checkAuth(request)) return;
+    ProfileScope scope(ProfileStage::HTTP_CONFIG);
     
-    StaticJsonDocument<768> doc;
-    
-    // WiFi (password hidden)
-    doc["wifiSsid"] = g_config.wifiSsid;
-    doc["hasWifiPass"] = g_config.wifiPass.length() > 0;
-    
-    // MQTT Integration (password hidden)
-    JsonObject mqtt = doc.createNestedObject("mqtt");
-    mqtt["host"] = g_config.mqttHost;
-    mqtt["port"] = g_config.mqttPort;
-    mqtt["user"] = g_config.mqttUser;
-    mqtt["hasPass"] = g_config.mqttPass.length() > 0;
-    mqtt["tls"] = g_config.mqttTls;
-    mqtt["enabled"] = g_config.mqttHost.length() > 0;
-    
-    // Loki Integration (password hidden)
-    JsonObject loki = doc.createNestedObject("loki");
-    loki["host"] = g_config.lokiHost;
-    loki["user"] = g_config.lokiUser;
-    loki["hasPass"] = g_config.lokiPass.length() > 0;
-    loki["enabled"] = g_config.lokiHost.length() > 0;
-    
-    // Prometheus Integration
-    JsonObject prometheus = doc.createNestedObject("prometheus");
-    prometheus["enabled"] = g_config.prometheusEnabled;
-    prometheus["endpoint"] = "/metrics";
-    
-    // Timing settings
-    doc["powerPulseMs"] = g_config.powerPulseMs;
-    doc["resetPulseMs"] = g_config.resetPulseMs;
-    doc["bootGraceMs"] = g_config.bootGraceMs;
-    
-    // Security (show if using default or custom password)
-    doc["hasCustomAdminPass"] = g_config.adminPassword != g_state.defaultAdminPassword;
+    StaticJsonDocument<2048> doc;
+    buildConfigJson(doc.to<JsonObject>());
     
     String out;
     serializeJson(doc, out);
@@ -531,8 +1600,8 @@ void WebInterface_setup() {
         if (!g_state.apMode) {
           String csrfFromBody = obj["csrfToken"] | "";
           bool headerValid = request->hasHeader("X-CSRF-Token") && 
-                            request->header("X-CSRF-Token") == g_csrfToken;
-          bool bodyValid = csrfFromBody == g_csrfToken;
+                            isCsrfToken(request->header("X-CSRF-Token"));
+          bool bodyValid = isCsrfToken(csrfFromBody);
           
           if (!headerValid && !bodyValid) {
             Serial.println("CSRF: Token validation failed (config)");
@@ -594,10 +1663,51 @@ void WebInterface_setup() {
           cfg.prometheusEnabled = obj["prometheusEnabled"] | true;
         }
         
-        // Timing settings
-        cfg.powerPulseMs = obj["powerPulseMs"] | 500;
-        cfg.resetPulseMs = obj["resetPulseMs"] | 500;
-        cfg.bootGraceMs = obj["bootGraceMs"] | 60000;
+        // Timing settings: top level = channel 0; `channels` (optional)
+        // sets names and the expander channels, else they are kept
+        for (size_t i = 0; i < Config::PC_CHANNELS_MAX; i++) {
+          cfg.channels[i] = g_config.channels[i];
+        }
+        cfg.channels[0].powerPulseMs = obj["powerPulseMs"] | 500;
+        cfg.channels[0].resetPulseMs = obj["resetPulseMs"] | 500;
+        cfg.channels[0].bootGraceMs = obj["bootGraceMs"] | 60000;
+        JsonArray channels = obj["channels"];
+        for (size_t i = 0; channels && i < channels.size() && i < Config::PC_CHANNELS_MAX; i++) {
+          JsonObject in = channels[i];
+          ChannelConfig &ch = cfg.channels[i];
+          ch.name = in["name"] | ch.name;
+          if (i == 0) continue;  // Timing from the top-level fields
+          ch.powerPulseMs = in["powerPulseMs"] | ch.powerPulseMs;
+          ch.resetPulseMs = in["resetPulseMs"] | ch.resetPulseMs;
+          ch.bootGraceMs = in["bootGraceMs"] | ch.bootGraceMs;
+        }
+
+        // Reachability probe: keep the current settings if not sent
+        JsonObject probe = obj["probe"];
+        if (probe) {
+          cfg.probeHost = probe["host"] | "";
+          cfg.probePorts = probe["ports"] | "";
+          cfg.probeIcmp = probe["icmp"] | true;
+        } else {
+          cfg.probeHost = g_config.probeHost;
+          cfg.probePorts = g_config.probePorts;
+          cfg.probeIcmp = g_config.probeIcmp;
+        }
+
+        // Heartbeats and hang recovery: keep the current settings if not sent
+        JsonObject heartbeat = obj["heartbeat"];
+        if (heartbeat) {
+          cfg.heartbeatPort = heartbeat["port"] | 0;
+          cfg.heartbeatTimeoutS = heartbeat["timeoutSec"] | Config::HEARTBEAT_DEFAULT_TIMEOUT_S;
+          cfg.hangRecovery = heartbeat["recover"] | false;
+          cfg.hangRequireHddIdle = heartbeat["requireHddIdle"] | true;
+          if (cfg.heartbeatTimeoutS < 10) cfg.heartbeatTimeoutS = 10;
+        } else {
+          cfg.heartbeatPort = g_config.heartbeatPort;
+          cfg.heartbeatTimeoutS = g_config.heartbeatTimeoutS;
+          cfg.hangRecovery = g_config.hangRecovery;
+          cfg.hangRequireHddIdle = g_config.hangRequireHddIdle;
+        }
         
         // Admin password: preserve existing if not provided
         String newAdminPass = obj["adminPassword"] | "";
@@ -610,8 +1720,7 @@ void WebInterface_setup() {
         }
 
         // Schedule restart to apply new settings
-        g_restartPending = true;
-        g_restartAtMs = millis() + 1000;
+        scheduleRestart(1000);
         request->send(200, "application/json", "{\"ok\":true}");
       });
   g_server.addHandler(jsonHandler);
@@ -623,9 +1732,7 @@ void WebInterface_setup() {
   g_server.on("/api/action/power", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (!checkAuth(request)) return;
     if (!validateCsrfToken(request)) return;
-    g_pc.pulsePower();
-    WebInterface_logAction("Power pulse requested (API)");
-    request->send(200, "application/json", "{\"ok\":true}");
+    runPcAction(request, PcCommand::POWER_PULSE, "Power pulse requested (API)");
   });
 
   // -------------------------------------------------------------------------
@@ -635,9 +1742,7 @@ void WebInterface_setup() {
   g_server.on("/api/action/reset", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (!checkAuth(request)) return;
     if (!validateCsrfToken(request)) return;
-    g_pc.pulseReset();
-    WebInterface_logAction("Reset pulse requested (API)");
-    request->send(200, "application/json", "{\"ok\":true}");
+    runPcAction(request, PcCommand::RESET_PULSE, "Reset pulse requested (API)");
   });
 
   // -------------------------------------------------------------------------
@@ -647,9 +1752,7 @@ void WebInterface_setup() {
   g_server.on("/api/action/force-power", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (!checkAuth(request)) return;
     if (!validateCsrfToken(request)) return;
-    g_pc.forcePower();
-    WebInterface_logAction("Force shutdown requested (11s hold)");
-    request->send(200, "application/json", "{\"ok\":true}");
+    runPcAction(request, PcCommand::FORCE_POWER, "Force shutdown requested (11s hold)");
   });
 
   // -------------------------------------------------------------------------
@@ -698,8 +1801,7 @@ void WebInterface_setup() {
     if (!validateCsrfToken(request)) return;
     WebInterface_logAction("Factory reset initiated");
     Networking_clearConfig();
-    g_restartPending = true;
-    g_restartAtMs = millis() + 500;
+    scheduleRestart(500);
     request->send(200, "application/json", "{\"ok\":true}");
   });
 
@@ -779,18 +1881,10 @@ void WebInterface_setup() {
   // Start the server!
   g_server.begin();
   Serial.println("Web server started on port 80");
-}
-
-// =============================================================================
-// LOOP - Periodic maintenance
-// =============================================================================
 
-void WebInterface_loop() {
-  /**
-   * Handle ongoing web server tasks.
-   * Called continuously in main loop().
-   */
-  
-  // Clean up disconnected WebSocket clients
-  g_ws.cleanupClients();
+  HealthMonitor_configure(Subsystem::WEBSOCKET, Config::WS_STALL_MS);
+  rotateCsrfToken(nullptr);
+  g_networkTimers.armPeriodic(g_csrfRotateTimer, CSRF_TOKEN_VALIDITY_MS, rotateCsrfToken);
+  g_networkTimers.armPeriodic(g_housekeepingTimer, WS_CLEANUP_INTERVAL_MS, housekeeping);
+  g_networkTimers.armPeriodic(g_wsFlushTimer, WS_FLUSH_INTERVAL_MS, flushWebSocket);
 }
@@ -0,0 +1,203 @@
+/**
+ * =============================================================================
+ * WsClients.cpp - Per-Client State for /ws
+ * =============================================================================
+ *
+ * Two small fixed tables of Config::WS_MAX_CLIENTS entries: connected
+ * clients by id, and handshake offers by TCP connection. id 0 / tcp null
+ * marks a free entry (AsyncWebSocket ids start at 1).
+ *
+ * Subscribing resets the rate-limit bookkeeping, so the next broadcast
+ * (or flush) sends each newly subscribed topic right away.
+ *
+ * =============================================================================
+ */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "Config.h"
+#include "WsClients.h"
+
+static constexpr uint32_t OFFER_TIMEOUT_MS = 1000;
+
+struct Offer {
+  const void *tcp;
+  WsEncoding encoding;
+  bool authenticated;
+  uint32_t atMs;
+};
+
+static const char *const kTopicNames[WS_TOPIC_COUNT] = {
+  "device", "pc", "hdd", "sensors", "ota", "logs",
+};
+
+static WsClientInfo s_clients[Config::WS_MAX_CLIENTS] = {};
+static Offer s_offers[Config::WS_MAX_CLIENTS] = {};
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static WsClientInfo *findLocked(uint32_t id) {
+  for (size_t i = 0; i < Config::WS_MAX_CLIENTS; i++) {
+    if (s_clients[i].id == id) {
+      return &s_clients[i];
+    }
+  }
+  return nullptr;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+const char *WsTopic_name(WsTopic topic) {
+  size_t i = static_cast<size_t>(topic);
+  return i < WS_TOPIC_COUNT ? kTopicNames[i] : "unknown";
+}
+
+bool WsTopic_parse(const char *name, WsTopic *out) {
+  for (size_t i = 0; i < WS_TOPIC_COUNT; i++) {
+    if (strcmp(name, kTopicNames[i]) == 0) {
+      *out = static_cast<WsTopic>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WsClients_offer(const void *tcp, WsEncoding encoding, bool authenticated) {
+  uint32_t nowMs = millis();
+  portENTER_CRITICAL(&s_mux);
+  // Free, expired or same connection; otherwise replace the oldest
+  size_t slot = 0;
+  uint32_t oldestAgeMs = 0;
+  for (size_t i = 0; i < Config::WS_MAX_CLIENTS; i++) {
+    uint32_t ageMs = nowMs - s_offers[i].atMs;
+    if (!s_offers[i].tcp || s_offers[i].tcp == tcp || ageMs > OFFER_TIMEOUT_MS) {
+      slot = i;
+      break;
+    }
+    if (ageMs >= oldestAgeMs) {
+      oldestAgeMs = ageMs;
+      slot = i;
+    }
+  }
+  s_offers[slot] = {tcp, encoding, authenticated, nowMs};
+  portEXIT_CRITICAL(&s_mux);
+}
+
+bool WsClients_add(uint32_t id, const void *tcp) {
+  uint32_t nowMs = millis();
+  WsEncoding encoding = WsEncoding::JSON;
+  bool authenticated = false;
+  bool added = false;
+  portENTER_CRITICAL(&s_mux);
+  for (size_t i = 0; i < Config::WS_MAX_CLIENTS; i++) {
+    if (s_offers[i].tcp == tcp) {
+      if (nowMs - s_offers[i].atMs <= OFFER_TIMEOUT_MS) {
+        encoding = s_offers[i].encoding;
+        authenticated = s_offers[i].authenticated;
+      }
+      s_offers[i].tcp = nullptr;
+    }
+  }
+  WsClientInfo *client = findLocked(0);
+  if (client) {
+    *client = {};
+    client->id = id;
+    client->encoding = encoding;
+    client->authenticated = authenticated;
+    for (size_t t = 0; t < WS_TOPIC_COUNT; t++) {
+      client->topics[t].active = true;
+    }
+    added = true;
+  }
+  portEXIT_CRITICAL(&s_mux);
+  return added;
+}
+
+void WsClients_remove(uint32_t id) {
+  portENTER_CRITICAL(&s_mux);
+  for (size_t i = 0; i < Config::WS_MAX_CLIENTS; i++) {
+    if (s_clients[i].id == id) {
+      s_clients[i].id = 0;
+    }
+  }
+  portEXIT_CRITICAL(&s_mux);
+}
+
+void WsClients_authenticate(uint32_t id) {
+  portENTER_CRITICAL(&s_mux);
+  WsClientInfo *client = findLocked(id);
+  if (client) {
+    client->authenticated = true;
+  }
+  portEXIT_CRITICAL(&s_mux);
+}
+
+void WsClients_subscribe(uint32_t id, const WsSubscription topics[WS_TOPIC_COUNT]) {
+  portENTER_CRITICAL(&s_mux);
+  WsClientInfo *client = findLocked(id);
+  if (client) {
+    for (size_t t = 0; t < WS_TOPIC_COUNT; t++) {
+      client->topics[t] = {topics[t].active, topics[t].minIntervalMs, 0, 0};
+    }
+  }
+  portEXIT_CRITICAL(&s_mux);
+}
+
+void WsClients_markSent(uint32_t id, WsTopic topic, uint32_t seq, uint32_t nowMs) {
+  portENTER_CRITICAL(&s_mux);
+  WsClientInfo *client = findLocked(id);
+  if (client) {
+    WsSubscription &sub = client->topics[static_cast<size_t>(topic)];
+    sub.lastSentMs = nowMs;
+    sub.seq = seq;
+  }
+  portEXIT_CRITICAL(&s_mux);
+}
+
+bool WsClients_get(uint32_t id, WsClientInfo *out) {
+  portENTER_CRITICAL(&s_mux);
+  WsClientInfo *client = findLocked(id);
+  if (client) {
+    *out = *client;
+  }
+  portEXIT_CRITICAL(&s_mux);
+  return client != nullptr;
+}
+
+size_t WsClients_list(WsClientInfo *out, size_t max) {
+  size_t count = 0;
+  portENTER_CRITICAL(&s_mux);
+  for (size_t i = 0; i < Config::WS_MAX_CLIENTS && count < max; i++) {
+    if (s_clients[i].id != 0) {
+      out[count++] = s_clients[i];
+    }
+  }
+  portEXIT_CRITICAL(&s_mux);
+  return count;
+}
+
+size_t WsClients_subscribers(WsTopic topic) {
+  size_t count = 0;
+  portENTER_CRITICAL(&s_mux);
+  for (size_t i = 0; i < Config::WS_MAX_CLIENTS; i++) {
+    if (s_clients[i].id != 0 && s_clients[i].topics[static_cast<size_t>(topic)].active) {
+      count++;
+    }
+  }
+  portEXIT_CRITICAL(&s_mux);
+  return count;
+}
+
+size_t WsClients_count(WsEncoding encoding) {
+  size_t count = 0;
+  portENTER_CRITICAL(&s_mux);
+  for (size_t i = 0; i < Config::WS_MAX_CLIENTS; i++) {
+    if (s_clients[i].id != 0 && s_clients[i].encoding == encoding) {
+      count++;
+    }
+  }
+  portEXIT_CRITICAL(&s_mux);
+  return count;
+}
@@ -0,0 +1,315 @@
+/**
+ * =============================================================================
+ * WsCodec.cpp - MessagePack with Integer Keys
+ * =============================================================================
+ *
+ * Walks the same JsonDocument the JSON path serializes, so status, delta
+ * and log messages need no second builder:
+ *
+ *   doc ──► writeValue() ──► measure pass (no output) ──► write pass
+ *
+ * Keys are looked up by binary search in kKeys, which must stay sorted
+ * (strcmp order). A key's number is its index, so adding a key renumbers
+ * the ones after it; clients read the table from each connection's first
+ * frame and never hard-code numbers.
+ *
+ * The benchmark counts CPU cycles like FastGpio_benchmark(), but without a
+ * critical section (an encode takes hundreds of microseconds), so single
+ * readings include interrupts.
+ *
+ * =============================================================================
+ */
+
+#include <math.h>
+#include <string.h>
+#include <new>
+#include <vector>
+
+#include "Config.h"
+#include "WsCodec.h"
+
+static constexpr uint32_t BENCH_ITERATIONS = 16;
+
+// Every key the firmware sends on /ws (status, logs, acks, config), sorted
+static const char *const kKeys[] = {
+  "address", "apMode", "apPassword", "available", "bootGraceMs",
+  "channel", "channels", "checking", "config", "cpuLoad", "csrfToken",
+  "current", "currentVersion", "deviceId", "enabled", "endpoint",
+  "error", "freeHeap", "fwVersion", "hangState", "hasConfig",
+  "hasCustomAdminPass", "hasPass", "hasWifiPass", "hddActivity",
+  "hddActivity60s", "hddEdgeRate", "hddLastActiveSec", "hddLedRaw",
+  "heartbeat", "heartbeatAgeSec", "host", "hostname", "humidity", "icmp",
+  "id", "ip", "lastCheckMs", "lastCheckOk", "latencyUs", "loki",
+  "message", "model", "mqtt", "name", "notes", "ok", "online", "ota",
+  "pcPowerDraw", "pcPowerWatts", "pcState", "pending",
+  "pin4LastChangeSec", "port", "ports", "power", "powerPulseMs",
+  "powerRelayActive", "probe", "progress", "prometheus", "pwrLedRaw",
+  "reachability", "recover", "remoteVersion", "requireHddIdle",
+  "resetPulseMs", "resetRelayActive", "rssi", "sensors", "seq", "set",
+  "ssid", "temperature", "timeoutSec", "timestampMs", "tls", "topic",
+  "topics", "totalHeap", "type", "unset", "updateInProgress", "user",
+  "values", "voltage", "wifiConnected", "wifiSsid",
+};
+static constexpr size_t kKeyCount = sizeof(kKeys) / sizeof(kKeys[0]);
+static_assert(kKeyCount < 128, "key numbers must stay one-byte fixints");
+
+static AsyncWebSocketSharedBuffer s_keysFrame;
+static volatile uint32_t s_sink = 0;  // Keeps benchmark loops from being optimized out
+
+static int keyId(const char *key) {
+  size_t lo = 0;
+  size_t hi = kKeyCount;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    int cmp = strcmp(key, kKeys[mid]);
+    if (cmp == 0) {
+      return static_cast<int>(mid);
+    }
+    if (cmp < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return -1;
+}
+
+// =============================================================================
+// MESSAGEPACK WRITER
+// =============================================================================
+
+struct Writer {
+  uint8_t *out;
+  size_t capacity;  // 0 = measure only
+  size_t length;
+
+  void byte(uint8_t b) {
+    if (length < capacity) {
+      out[length] = b;
+    }
+    length++;
+  }
+
+  void bigEndian(uint64_t value, uint8_t bytes) {
+    while (bytes-- > 0) {
+      byte(static_cast<uint8_t>(value >> (8 * bytes)));
+    }
+  }
+
+  void raw(const char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      byte(static_cast<uint8_t>(data[i]));
+    }
+  }
+};
+
+static void writeUint(Writer &w, uint64_t value) {
+  if (value < 0x80) {
+    w.byte(static_cast<uint8_t>(value));  // positive fixint
+  } else if (value <= 0xFF) {
+    w.byte(0xCC);
+    w.bigEndian(value, 1);
+  } else if (value <= 0xFFFF) {
+    w.byte(0xCD);
+    w.bigEndian(value, 2);
+  } else if (value <= 0xFFFFFFFFULL) {
+    w.byte(0xCE);
+    w.bigEndian(value, 4);
+  } else {
+    w.byte(0xCF);
+    w.bigEndian(value, 8);
+  }
+}
+
+static void writeInt(Writer &w, int64_t value) {
+  if (value >= 0) {
+    writeUint(w, static_cast<uint64_t>(value));
+  } else if (value >= -32) {
+    w.byte(static_cast<uint8_t>(value));  // negative fixint
+  } else if (value >= INT8_MIN) {
+    w.byte(0xD0);
+    w.bigEndian(static_cast<uint64_t>(value), 1);
+  } else if (value >= INT16_MIN) {
+    w.byte(0xD1);
+    w.bigEndian(static_cast<uint64_t>(value), 2);
+  } else if (value >= INT32_MIN) {
+    w.byte(0xD2);
+    w.bigEndian(static_cast<uint64_t>(value), 4);
+  } else {
+    w.byte(0xD3);
+    w.bigEndian(static_cast<uint64_t>(value), 8);
+  }
+}
+
+static void writeFloat(Writer &w, double value) {
+  if (isnan(value) || isinf(value)) {
+    w.byte(0xC0);
+    return;
+  }
+  float single = static_cast<float>(value);
+  if (static_cast<double>(single) == value) {
+    uint32_t bits;
+    memcpy(&bits, &single, sizeof(bits));
+    w.byte(0xCA);
+    w.bigEndian(bits, 4);
+  } else {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    w.byte(0xCB);
+    w.bigEndian(bits, 8);
+  }
+}
+
+static void writeString(Writer &w, const char *data, size_t size) {
+  if (size < 32) {
+    w.byte(static_cast<uint8_t>(0xA0 | size));
+  } else if (size <= 0xFF) {
+    w.byte(0xD9);
+    w.bigEndian(size, 1);
+  } else if (size <= 0xFFFF) {
+    w.byte(0xDA);
+    w.bigEndian(size, 2);
+  } else {
+    w.byte(0xDB);
+    w.bigEndian(size, 4);
+  }
+  w.raw(data, size);
+}
+
+static void writeHeader(Writer &w, size_t size, uint8_t fix, uint8_t fixMax, uint8_t tag16) {
+  if (size <= fixMax) {
+    w.byte(static_cast<uint8_t>(fix | size));
+  } else if (size <= 0xFFFF) {
+    w.byte(tag16);
+    w.bigEndian(size, 2);
+  } else {
+    w.byte(static_cast<uint8_t>(tag16 + 1));  // array32 / map32
+    w.bigEndian(size, 4);
+  }
+}
+
+static void writeValue(Writer &w, JsonVariantConst value) {
+  if (value.isNull()) {
+    w.byte(0xC0);
+  } else if (value.is<bool>()) {
+    w.byte(value.as<bool>() ? 0xC3 : 0xC2);
+  } else if (value.is<const char *>()) {
+    JsonString s = value.as<JsonString>();
+    writeString(w, s.c_str(), s.size());
+  } else if (value.is<JsonArrayConst>()) {
+    JsonArrayConst array = value.as<JsonArrayConst>();
+    writeHeader(w, array.size(), 0x90, 15, 0xDC);
+    for (JsonVariantConst item : array) {
+      writeValue(w, item);
+    }
+  } else if (value.is<JsonObjectConst>()) {
+    JsonObjectConst object = value.as<JsonObjectConst>();
+    writeHeader(w, object.size(), 0x80, 15, 0xDE);
+    for (JsonPairConst kv : object) {
+      int id = keyId(kv.key().c_str());
+      if (id >= 0) {
+        w.byte(static_cast<uint8_t>(id));
+      } else {
+        writeString(w, kv.key().c_str(), kv.key().size());
+      }
+      writeValue(w, kv.value());
+    }
+#if ARDUINOJSON_USE_LONG_LONG
+  } else if (value.is<int64_t>()) {
+    writeInt(w, value.as<int64_t>());
+  } else if (value.is<uint64_t>()) {
+    writeUint(w, value.as<uint64_t>());
+#else
+  } else if (value.is<long>()) {
+    writeInt(w, value.as<long>());
+  } else if (value.is<unsigned long>()) {
+    writeUint(w, value.as<unsigned long>());
+#endif
+  } else {
+    writeFloat(w, value.as<double>());
+  }
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+const char *WsEncoding_name(WsEncoding encoding) {
+  switch (encoding) {
+    case WsEncoding::JSON:    return "json";
+    case WsEncoding::MSGPACK: return "msgpack";
+    default:                  return "unknown";
+  }
+}
+
+void WsCodec_setup() {
+  if (s_keysFrame) {
+    return;
+  }
+  StaticJsonDocument<1024> doc;
+  doc["type"] = "keys";
+  JsonArray keys = doc.createNestedArray("keys");
+  for (size_t i = 0; i < kKeyCount; i++) {
+    keys.add(kKeys[i]);
+  }
+
+  AsyncWebSocketSharedBuffer frame(new (std::nothrow) std::vector<uint8_t>(measureMsgPack(doc)));
+  if (frame) {
+    serializeMsgPack(doc, reinterpret_cast<char *>(frame->data()), frame->size());
+    s_keysFrame = frame;
+  }
+}
+
+WsEncoding WsCodec_forSubprotocol(const String &offered) {
+  return offered == Config::WS_MSGPACK_SUBPROTOCOL ? WsEncoding::MSGPACK : WsEncoding::JSON;
+}
+
+AsyncWebSocketSharedBuffer WsCodec_keysFrame() {
+  return s_keysFrame;
+}
+
+size_t WsCodec_measure(const JsonDocument &doc) {
+  Writer w = {nullptr, 0, 0};
+  writeValue(w, doc.as<JsonVariantConst>());
+  return w.length;
+}
+
+size_t WsCodec_write(const JsonDocument &doc, uint8_t *out, size_t capacity) {
+  Writer w = {out, capacity, 0};
+  writeValue(w, doc.as<JsonVariantConst>());
+  return w.length;
+}
+
+WsCodecBenchResult WsCodec_benchmark(const JsonDocument &doc) {
+  WsCodecBenchResult result = {};
+  result.iterations = BENCH_ITERATIONS;
+  result.json.bytes = measureJson(doc);
+  result.msgpack.bytes = measureMsgPack(doc);
+  result.msgpackKeys.bytes = WsCodec_measure(doc);
+
+  size_t largest = result.json.bytes + 1;  // serializeJson() adds a terminator
+  if (result.msgpack.bytes > largest) largest = result.msgpack.bytes;
+  if (result.msgpackKeys.bytes > largest) largest = result.msgpackKeys.bytes;
+  std::vector<char> buffer(largest);
+  uint32_t start;
+
+  start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    s_sink = s_sink + serializeJson(doc, buffer.data(), buffer.size());
+  }
+  result.json.cycles = (ESP.getCycleCount() - start) / BENCH_ITERATIONS;
+
+  start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    s_sink = s_sink + serializeMsgPack(doc, buffer.data(), buffer.size());
+  }
+  result.msgpack.cycles = (ESP.getCycleCount() - start) / BENCH_ITERATIONS;
+
+  start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    s_sink = s_sink + WsCodec_write(doc, reinterpret_cast<uint8_t *>(buffer.data()), buffer.size());
+  }
+  result.msgpackKeys.cycles = (ESP.getCycleCount() - start) / BENCH_ITERATIONS;
+
+  return result;
+}
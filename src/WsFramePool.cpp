@@ -0,0 +1,119 @@
+/**
+ * =============================================================================
+ * WsFramePool.cpp - Shared WebSocket Frames (Serialize Once, Send to All)
+ * =============================================================================
+ *
+ * Claiming a pooled frame is one pass over WS_FRAME_POOL_SIZE reference
+ * counts under a spinlock: a frame whose count is 1 is referenced by the
+ * pool alone; copying the pointer while holding the lock claims it. The
+ * AsyncTCP task drops its references after sending without the lock,
+ * which can only turn a busy frame into a free one.
+ *
+ * Serializing resizes the vector within its reserved capacity, so a
+ * pooled frame is never reallocated unless a message outgrows
+ * WS_FRAME_BYTES. JSON and MessagePack frames share the pool.
+ *
+ * =============================================================================
+ */
+
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "Config.h"
+#include "WsFramePool.h"
+
+static AsyncWebSocketSharedBuffer s_pool[Config::WS_FRAME_POOL_SIZE];
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static WsFramePoolStats s_stats = {};
+
+static AsyncWebSocketSharedBuffer newFrame(size_t capacity) {
+  AsyncWebSocketSharedBuffer frame(new (std::nothrow) std::vector<uint8_t>());
+  if (!frame) {
+    return nullptr;
+  }
+  frame->reserve(capacity);
+  return frame;
+}
+
+static void count(bool pooled) {
+  portENTER_CRITICAL(&s_mux);
+  if (pooled) {
+    s_stats.pooled++;
+  } else {
+    s_stats.allocated++;
+  }
+  portEXIT_CRITICAL(&s_mux);
+}
+
+static void write(std::vector<uint8_t> &bytes, const JsonDocument &doc, WsEncoding encoding) {
+  /**
+   * MessagePack is written at its measured size. JSON: measureJson() + 1
+   * for the terminator serializeJson() writes; the frame itself is sent
+   * without it.
+   */
+  if (encoding == WsEncoding::MSGPACK) {
+    bytes.resize(WsCodec_measure(doc));
+    WsCodec_write(doc, bytes.data(), bytes.size());
+    return;
+  }
+  size_t length = measureJson(doc);
+  bytes.resize(length + 1);
+  serializeJson(doc, reinterpret_cast<char *>(bytes.data()), length + 1);
+  bytes.resize(length);
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+void WsFramePool_setup() {
+  for (size_t i = 0; i < Config::WS_FRAME_POOL_SIZE; i++) {
+    if (!s_pool[i]) {
+      s_pool[i] = newFrame(Config::WS_FRAME_BYTES);
+    }
+  }
+}
+
+AsyncWebSocketSharedBuffer WsFramePool_serialize(const JsonDocument &doc, WsEncoding encoding) {
+  AsyncWebSocketSharedBuffer frame;
+  portENTER_CRITICAL(&s_mux);
+  for (size_t i = 0; i < Config::WS_FRAME_POOL_SIZE; i++) {
+    if (s_pool[i] && s_pool[i].use_count() == 1) {
+      frame = s_pool[i];
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&s_mux);
+
+  bool pooled = static_cast<bool>(frame);
+  if (!pooled) {
+    frame = newFrame(Config::WS_FRAME_BYTES);
+    if (!frame) {
+      return nullptr;
+    }
+  }
+  count(pooled);
+  write(*frame, doc, encoding);
+  return frame;
+}
+
+bool WsFramePool_serializeInto(AsyncWebSocketSharedBuffer &frame, const JsonDocument &doc, size_t capacity,
+                               WsEncoding encoding) {
+  bool reuse = frame && frame.use_count() == 1;
+  AsyncWebSocketSharedBuffer target = reuse ? frame : newFrame(capacity);
+  if (!target) {
+    return false;
+  }
+  write(*target, doc, encoding);
+  count(reuse);
+  frame = target;
+  return true;
+}
+
+WsFramePoolStats WsFramePool_stats() {
+  portENTER_CRITICAL(&s_mux);
+  WsFramePoolStats stats = s_stats;
+  portEXIT_CRITICAL(&s_mux);
+  return stats;
+}
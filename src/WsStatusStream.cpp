@@ -0,0 +1,251 @@
+/**
+ * =============================================================================
+ * WsStatusStream.cpp - Sequenced Status Snapshots and Deltas for /ws
+ * =============================================================================
+ *
+ *   publish(topic, status) ──► topic's keys ──► diff against base[topic]
+ *                                                   │
+ *                                   delta frame ◄───┘ (seq[topic] + 1)
+ *                                   base[topic] = keys, seq stored in it
+ *
+ *   snapshot(topic) ──► base[topic] serialized once per seq and encoding
+ *
+ * Values are compared deeply. Numbers compare as doubles with NaN equal
+ * to NaN, so an offline sensor (NaN, sent as null) does not put its
+ * array into every delta.
+ *
+ * =============================================================================
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "WsFramePool.h"
+#include "WsStatusStream.h"
+
+struct TopicStream {
+  StaticJsonDocument<3072> base;  // Last broadcast, incl. "type", "topic", "seq"
+  bool hasBase;
+  uint32_t seq;
+  AsyncWebSocketSharedBuffer snapshot[WS_ENCODING_COUNT];  // base serialized (cache)
+};
+
+struct KeyTopic {
+  const char *key;
+  WsTopic topic;
+};
+
+// Keys outside the DEVICE topic
+static const KeyTopic kKeyTopics[] = {
+  {"pcState", WsTopic::PC},
+  {"reachability", WsTopic::PC},
+  {"hangState", WsTopic::PC},
+  {"heartbeatAgeSec", WsTopic::PC},
+  {"powerRelayActive", WsTopic::PC},
+  {"resetRelayActive", WsTopic::PC},
+  {"pwrLedRaw", WsTopic::PC},
+  {"channels", WsTopic::PC},
+  {"hddLedRaw", WsTopic::HDD},
+  {"pin4LastChangeSec", WsTopic::HDD},
+  {"hddLastActiveSec", WsTopic::HDD},
+  {"hddActivity", WsTopic::HDD},
+  {"hddActivity60s", WsTopic::HDD},
+  {"hddEdgeRate", WsTopic::HDD},
+  {"temperature", WsTopic::SENSORS},
+  {"sensors", WsTopic::SENSORS},
+  {"pcPowerWatts", WsTopic::SENSORS},
+  {"pcPowerDraw", WsTopic::SENSORS},
+  {"ota", WsTopic::OTA},
+};
+
+static TopicStream s_streams[WS_STATUS_TOPIC_COUNT];
+static SemaphoreHandle_t s_mutex = nullptr;
+static WsStatusStreamStats s_stats = {};
+
+static WsTopic topicOf(const char *key) {
+  for (const KeyTopic &entry : kKeyTopics) {
+    if (strcmp(key, entry.key) == 0) {
+      return entry.topic;
+    }
+  }
+  return WsTopic::DEVICE;
+}
+
+static bool isStatusTopic(WsTopic topic) {
+  return static_cast<size_t>(topic) < WS_STATUS_TOPIC_COUNT;
+}
+
+static bool sameValue(JsonVariantConst a, JsonVariantConst b) {
+  if (a.is<JsonObjectConst>()) {
+    if (!b.is<JsonObjectConst>() || a.size() != b.size()) return false;
+    for (JsonPairConst kv : a.as<JsonObjectConst>()) {
+      if (!sameValue(kv.value(), b[kv.key()])) return false;
+    }
+    return true;
+  }
+  if (a.is<JsonArrayConst>()) {
+    if (!b.is<JsonArrayConst>() || a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+      if (!sameValue(a[i], b[i])) return false;
+    }
+    return true;
+  }
+  if (a.is<double>() && b.is<double>()) {
+    double x = a.as<double>();
+    double y = b.as<double>();
+    return x == y || (isnan(x) && isnan(y));
+  }
+  return a == b;
+}
+
+static bool isMeta(JsonString key) {
+  return key == "type" || key == "topic" || key == "seq";
+}
+
+static AsyncWebSocketSharedBuffer snapshotLocked(TopicStream &stream, WsEncoding encoding) {
+  AsyncWebSocketSharedBuffer &frame = stream.snapshot[static_cast<size_t>(encoding)];
+  if (!frame) {
+    frame = WsFramePool_serialize(stream.base, encoding);
+    if (frame) {
+      s_stats.fullFrames++;
+      s_stats.fullBytes += frame->size();
+    }
+  }
+  return frame;
+}
+
+static void dropSnapshots(TopicStream &stream) {
+  for (size_t e = 0; e < WS_ENCODING_COUNT; e++) {
+    stream.snapshot[e] = nullptr;
+  }
+}
+
+static void setBase(TopicStream &stream, WsTopic topic, const JsonDocument &status) {
+  stream.base.clear();
+  stream.base["type"] = "status";
+  stream.base["topic"] = WsTopic_name(topic);
+  for (JsonPairConst kv : status.as<JsonObjectConst>()) {
+    if (!isMeta(kv.key()) && topicOf(kv.key().c_str()) == topic) {
+      stream.base[kv.key()] = kv.value();
+    }
+  }
+  stream.base["seq"] = stream.seq;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+void WsStatusStream_setup() {
+  if (!s_mutex) {
+    s_mutex = xSemaphoreCreateMutex();
+  }
+}
+
+WsFrames WsStatusStream_publish(WsTopic topic, const JsonDocument &status, uint8_t encodings) {
+  WsFrames frames;
+  if (!isStatusTopic(topic) || !s_mutex || xSemaphoreTake(s_mutex, portMAX_DELAY) != pdTRUE) {
+    return frames;
+  }
+  TopicStream &stream = s_streams[static_cast<size_t>(topic)];
+
+  if (!stream.hasBase) {
+    // No base yet: every subscriber gets the whole topic
+    stream.seq++;
+    setBase(stream, topic, status);
+    stream.hasBase = true;
+    dropSnapshots(stream);
+    for (size_t e = 0; e < WS_ENCODING_COUNT; e++) {
+      if (encodings & WsEncoding_bit(static_cast<WsEncoding>(e))) {
+        frames.frame[e] = snapshotLocked(stream, static_cast<WsEncoding>(e));
+      }
+    }
+  } else {
+    StaticJsonDocument<3072> delta;
+    delta["type"] = "delta";
+    delta["topic"] = WsTopic_name(topic);
+    JsonObject set = delta.createNestedObject("set");
+    JsonObjectConst now = status.as<JsonObjectConst>();
+    for (JsonPairConst kv : now) {
+      if (!isMeta(kv.key()) && topicOf(kv.key().c_str()) == topic &&
+          !sameValue(kv.value(), stream.base[kv.key()])) {
+        set[kv.key()] = kv.value();
+      }
+    }
+    JsonArray unset;
+    for (JsonPairConst kv : stream.base.as<JsonObjectConst>()) {
+      if (!isMeta(kv.key()) && !now.containsKey(kv.key())) {
+        if (unset.isNull()) unset = delta.createNestedArray("unset");
+        unset.add(kv.key());
+      }
+    }
+
+    if (set.size() > 0 || !unset.isNull()) {
+      // Serialize before the base changes; "unset" may point into it
+      delta["seq"] = ++stream.seq;
+      for (size_t e = 0; e < WS_ENCODING_COUNT; e++) {
+        if (!(encodings & WsEncoding_bit(static_cast<WsEncoding>(e)))) {
+          continue;
+        }
+        AsyncWebSocketSharedBuffer &frame = frames.frame[e];
+        frame = WsFramePool_serialize(delta, static_cast<WsEncoding>(e));
+        if (frame) {
+          s_stats.deltaFrames++;
+          s_stats.deltaBytes += frame->size();
+        }
+      }
+      setBase(stream, topic, status);
+      dropSnapshots(stream);
+    }
+  }
+
+  xSemaphoreGive(s_mutex);
+  return frames;
+}
+
+AsyncWebSocketSharedBuffer WsStatusStream_snapshot(WsTopic topic, WsEncoding encoding, bool resync,
+                                                   uint32_t *seq) {
+  if (!isStatusTopic(topic) || !s_mutex || xSemaphoreTake(s_mutex, portMAX_DELAY) != pdTRUE) {
+    return nullptr;
+  }
+  TopicStream &stream = s_streams[static_cast<size_t>(topic)];
+  AsyncWebSocketSharedBuffer frame;
+  if (stream.hasBase) {
+    frame = snapshotLocked(stream, encoding);
+    if (resync) s_stats.resyncs++;
+    if (seq) *seq = stream.seq;
+  }
+  xSemaphoreGive(s_mutex);
+  return frame;
+}
+
+uint32_t WsStatusStream_seq(WsTopic topic) {
+  uint32_t seq = 0;
+  if (isStatusTopic(topic) && s_mutex && xSemaphoreTake(s_mutex, portMAX_DELAY) == pdTRUE) {
+    seq = s_streams[static_cast<size_t>(topic)].seq;
+    xSemaphoreGive(s_mutex);
+  }
+  return seq;
+}
+
+void WsStatusStream_reset(WsTopic topic) {
+  if (!isStatusTopic(topic) || !s_mutex || xSemaphoreTake(s_mutex, portMAX_DELAY) != pdTRUE) {
+    return;
+  }
+  TopicStream &stream = s_streams[static_cast<size_t>(topic)];
+  if (stream.hasBase) {
+    stream.hasBase = false;
+    stream.base.clear();
+    dropSnapshots(stream);
+  }
+  xSemaphoreGive(s_mutex);
+}
+
+WsStatusStreamStats WsStatusStream_stats() {
+  WsStatusStreamStats stats = {};
+  if (s_mutex && xSemaphoreTake(s_mutex, portMAX_DELAY) == pdTRUE) {
+    stats = s_stats;
+    xSemaphoreGive(s_mutex);
+  }
+  return stats;
+}
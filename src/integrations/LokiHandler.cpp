@@ -12,6 +12,10 @@
  * 
  * Log levels: DEBUG, INFO, WARN, ERROR
  * 
+ * A push that takes longer than LOKI_STALL_MS is reported as a stall to
+ * the health monitor; pushes then pause for LOKI_BACKOFF_MS so a slow
+ * Loki host cannot keep the telemetry task busy. Logs stay buffered.
+ * 
  * =============================================================================
  */
 
@@ -23,11 +27,15 @@
 
 #include "Config.h"
 #include "Constants.h"
+#include "HealthMonitor.h"
+#include "Profiler.h"
+#include "TimerService.h"
 #include "integrations/LokiHandler.h"
 
 // Global objects
 extern StoredConfig g_config;
 extern RuntimeState g_state;
+extern TimerWheel g_telemetryTimers;
 
 // =============================================================================
 // LOG BUFFER
@@ -44,8 +52,32 @@ static LogEntry g_logBuffer[LOG_BUFFER_SIZE];
 static size_t g_logCount = 0;
 static size_t g_logWriteIdx = 0;
 
-static uint32_t g_lastPushMs = 0;
+static Timer g_pushTimer;
 static constexpr uint32_t PUSH_INTERVAL_MS = 10000;  // Push every 10 seconds
+static constexpr uint16_t HTTP_TIMEOUT_MS = 5000;    // Bound a slow Loki host
+
+// Loki_log() may be called from any task while the telemetry task pushes
+static SemaphoreHandle_t g_lokiMutex = nullptr;
+
+class LokiLock {
+ public:
+  LokiLock() : locked_(false) {
+    if (g_lokiMutex) {
+      locked_ = (xSemaphoreTake(g_lokiMutex, pdMS_TO_TICKS(1000)) == pdTRUE);
+    }
+  }
+
+  ~LokiLock() {
+    if (locked_) {
+      xSemaphoreGive(g_lokiMutex);
+    }
+  }
+
+  bool locked() const { return locked_; }
+
+ private:
+  bool locked_;
+};
 
 // =============================================================================
 // INTERNAL HELPERS
@@ -54,9 +86,9 @@ static constexpr uint32_t PUSH_INTERVAL_MS = 10000;  // Push every 10 seconds
 static uint64_t getTimestampNs() {
   /**
    * Get current timestamp in nanoseconds (Loki format).
-   * Uses millis() since ESP32 doesn't have RTC by default.
+   * Uses uptime since ESP32 doesn't have RTC by default.
    */
-  return (uint64_t)millis() * 1000000ULL;
+  return TimerService_nowMs() * 1000000ULL;
 }
 
 static void addLogEntry(const String &level, const String &message) {
@@ -87,19 +119,6 @@ static bool pushToLoki() {
     return false;
   }
   
-  HTTPClient http;
-  String url = g_config.lokiHost + "/loki/api/v1/push";
-  
-  http.begin(url);
-  http.addHeader("Content-Type", "application/json");
-  
-  // Add basic auth if configured
-  if (g_config.lokiUser.length() > 0) {
-    String auth = g_config.lokiUser + ":" + g_config.lokiPass;
-    String encoded = base64::encode(auth);
-    http.addHeader("Authorization", "Basic " + encoded);
-  }
-  
   // Build Loki push payload
   // Format: {"streams":[{"stream":{labels},"values":[["timestamp","line"],...]}]}
   DynamicJsonDocument doc(4096);
@@ -112,27 +131,52 @@ static bool pushToLoki() {
   labels["device"] = g_state.deviceId;
   labels["hostname"] = g_state.hostname;
   
-  // Values (log entries)
+  // Values (log entries) - copied under the lock, sent without it
   JsonArray values = stream.createNestedArray("values");
-  
-  size_t startIdx = (g_logWriteIdx + LOG_BUFFER_SIZE - g_logCount) % LOG_BUFFER_SIZE;
-  for (size_t i = 0; i < g_logCount; i++) {
-    size_t idx = (startIdx + i) % LOG_BUFFER_SIZE;
-    LogEntry &entry = g_logBuffer[idx];
+  size_t sentCount = 0;
+  {
+    LokiLock lock;
+    if (!lock.locked()) return false;
     
-    JsonArray value = values.createNestedArray();
-    value.add(String(entry.timestampNs));
-    value.add("[" + entry.level + "] " + entry.message);
+    size_t startIdx = (g_logWriteIdx + LOG_BUFFER_SIZE - g_logCount) % LOG_BUFFER_SIZE;
+    for (size_t i = 0; i < g_logCount; i++) {
+      size_t idx = (startIdx + i) % LOG_BUFFER_SIZE;
+      LogEntry &entry = g_logBuffer[idx];
+      
+      JsonArray value = values.createNestedArray();
+      value.add(String(entry.timestampNs));
+      value.add("[" + entry.level + "] " + entry.message);
+    }
+    sentCount = g_logCount;
   }
   
   String payload;
   serializeJson(doc, payload);
   
+  HTTPClient http;
+  String url = g_config.lokiHost + "/loki/api/v1/push";
+  
+  http.setConnectTimeout(HTTP_TIMEOUT_MS);
+  http.setTimeout(HTTP_TIMEOUT_MS);
+  http.begin(url);
+  http.addHeader("Content-Type", "application/json");
+  
+  // Add basic auth if configured
+  if (g_config.lokiUser.length() > 0) {
+    String auth = g_config.lokiUser + ":" + g_config.lokiPass;
+    String encoded = base64::encode(auth);
+    http.addHeader("Authorization", "Basic " + encoded);
+  }
+  
   int httpCode = http.POST(payload);
   http.end();
   
   if (httpCode == 204 || httpCode == 200) {
-    g_logCount = 0;  // Clear buffer on success
+    // Clear what we sent; entries logged during the POST stay queued
+    LokiLock lock;
+    if (lock.locked()) {
+      g_logCount = (g_logCount > sentCount) ? g_logCount - sentCount : 0;
+    }
     return true;
   } else {
     Serial.printf("Loki push failed: %d\n", httpCode);
@@ -152,7 +196,10 @@ void Loki_log(const char *level, const char *message) {
   Serial.printf("[%s] %s\n", level, message);
   
   if (g_config.lokiHost.length() > 0) {
-    addLogEntry(String(level), String(message));
+    LokiLock lock;
+    if (lock.locked()) {
+      addLogEntry(String(level), String(message));
+    }
   }
 }
 
@@ -175,31 +222,45 @@ void Loki_warn(const char *message) { Loki_log("WARN", message); }
 void Loki_error(const char *message) { Loki_log("ERROR", message); }
 
 // =============================================================================
-// SETUP & LOOP
+// SETUP
 // =============================================================================
 
+static void onPushTimer(void *);
+
+static void onBackoffDone(void *) {
+  Serial.println("Loki pushes resumed");
+  g_telemetryTimers.armPeriodic(g_pushTimer, PUSH_INTERVAL_MS, onPushTimer);
+}
+
+static void onPushTimer(void *) {
+  ProfileScope scope(ProfileStage::LOKI);
+  HealthMonitor_start(Subsystem::LOKI);
+  pushToLoki();
+  bool stalled = HealthMonitor_takeRecovery(Subsystem::LOKI);
+  HealthMonitor_stop(Subsystem::LOKI);
+
+  // The push stalled: pause instead of hitting the slow host again
+  if (stalled) {
+    Serial.printf("Loki push stalled - pausing pushes for %u s\n", Config::LOKI_BACKOFF_MS / 1000);
+    g_telemetryTimers.arm(g_pushTimer, Config::LOKI_BACKOFF_MS, onBackoffDone);
+  }
+}
+
 void LokiHandler_setup() {
   /**
-   * Initialize Loki handler.
+   * Initialize Loki handler and start the periodic push timer
+   * (telemetry task, so the blocking HTTP POST never delays control).
    */
+  if (!g_lokiMutex) {
+    g_lokiMutex = xSemaphoreCreateMutex();
+  }
+  
   if (g_config.lokiHost.length() > 0) {
     Serial.print("Loki logging enabled: ");
     Serial.println(g_config.lokiHost);
+    HealthMonitor_configure(Subsystem::LOKI, Config::LOKI_STALL_MS);
+    g_telemetryTimers.armPeriodic(g_pushTimer, PUSH_INTERVAL_MS, onPushTimer);
   } else {
     Serial.println("Loki logging: disabled (no host configured)");
   }
 }
-
-void LokiHandler_loop() {
-  /**
-   * Periodically push logs to Loki.
-   */
-  if (g_config.lokiHost.length() == 0) {
-    return;
-  }
-  
-  if (millis() - g_lastPushMs > PUSH_INTERVAL_MS) {
-    g_lastPushMs = millis();
-    pushToLoki();
-  }
-}
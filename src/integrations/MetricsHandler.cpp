@@ -15,28 +15,63 @@
 
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
-#include <WiFi.h>
 
+#include "BootTimeline.h"
+#include "CommandQueue.h"
 #include "Config.h"
 #include "Constants.h"
+#include "HangRecovery.h"
+#include "HddActivity.h"
+#include "HealthMonitor.h"
+#include "Heartbeat.h"
+#include "I2cBus.h"
+#include "IoExpander.h"
+#include "PCController.h"
+#include "PcChannels.h"
+#include "PowerManager.h"
+#include "Profiler.h"
+#include "Reachability.h"
+#include "StatusPublisher.h"
+#include "Sensors.h"
+#include "TaskScheduler.h"
+#include "WsClients.h"
+#include "WsFramePool.h"
+#include "WsStatusStream.h"
 #include "integrations/MetricsHandler.h"
 
 // Global objects from main.cpp
 extern AsyncWebServer g_server;
 extern StoredConfig g_config;
 extern RuntimeState g_state;
+extern PCController g_pc;
+extern SeqLock<StatusSnapshot> g_statusSnapshot;
 
 // =============================================================================
 // PROMETHEUS METRICS FORMAT
 // =============================================================================
 
+static String labelValue(const String &value) {
+  // Escape a free-text label value (channel names come from the config)
+  String out;
+  out.reserve(value.length());
+  for (size_t i = 0; i < value.length(); i++) {
+    char c = value[i];
+    if (c == '\\' || c == '"') out += '\\';
+    if (c == '\n') { out += "\\n"; continue; }
+    out += c;
+  }
+  return out;
+}
+
 static String buildMetrics() {
   /**
    * Build Prometheus metrics in text exposition format.
    * See: https://prometheus.io/docs/instrumenting/exposition_formats/
+   * Runtime values come from one status snapshot, so a scrape is consistent.
    */
+  StatusSnapshot s = g_statusSnapshot.read();
   String m;
-  m.reserve(2048);
+  m.reserve(8192);
   
   String labels = String("{device=\"") + g_state.deviceId + "\",hostname=\"" + g_state.hostname + "\"}";
   
@@ -46,35 +81,35 @@ static String buildMetrics() {
   m += "restarter_info{device=\"" + g_state.deviceId + "\",hostname=\"" + g_state.hostname + 
        "\",firmware=\"" + Config::FW_VERSION + "\"} 1\n\n";
   
-  // PC State (0=OFF, 1=BOOTING, 2=RUNNING, 3=RESTARTING)
-  m += "# HELP restarter_pc_state PC power state (0=OFF, 1=BOOTING, 2=RUNNING, 3=RESTARTING)\n";
+  // PC State (0=OFF, 1=BOOTING, 2=RUNNING, 3=RESTARTING, 4=SLEEP, 5=UNKNOWN_BLINK)
+  m += "# HELP restarter_pc_state PC power state (0=OFF, 1=BOOTING, 2=RUNNING, 3=RESTARTING, 4=SLEEP, 5=UNKNOWN_BLINK)\n";
   m += "# TYPE restarter_pc_state gauge\n";
-  m += "restarter_pc_state" + labels + " " + String(static_cast<int>(g_state.pcState)) + "\n\n";
+  m += "restarter_pc_state" + labels + " " + String(static_cast<int>(s.pcState)) + "\n\n";
   
   // PC power state as boolean (1=ON, 0=OFF)
   m += "# HELP restarter_pc_power PC power state (1=ON, 0=OFF)\n";
   m += "# TYPE restarter_pc_power gauge\n";
-  m += "restarter_pc_power" + labels + " " + String(g_state.pcState != PCState::OFF ? 1 : 0) + "\n\n";
+  m += "restarter_pc_power" + labels + " " + String(s.pcState != PCState::OFF ? 1 : 0) + "\n\n";
   
   // Relay states
   m += "# HELP restarter_power_relay Power relay active state\n";
   m += "# TYPE restarter_power_relay gauge\n";
-  m += "restarter_power_relay" + labels + " " + String(g_state.powerRelayActive ? 1 : 0) + "\n\n";
+  m += "restarter_power_relay" + labels + " " + String(s.powerRelayActive ? 1 : 0) + "\n\n";
   
   m += "# HELP restarter_reset_relay Reset relay active state\n";
   m += "# TYPE restarter_reset_relay gauge\n";
-  m += "restarter_reset_relay" + labels + " " + String(g_state.resetRelayActive ? 1 : 0) + "\n\n";
+  m += "restarter_reset_relay" + labels + " " + String(s.resetRelayActive ? 1 : 0) + "\n\n";
   
   // Temperature
   m += "# HELP restarter_temperature_celsius Internal temperature in Celsius\n";
   m += "# TYPE restarter_temperature_celsius gauge\n";
-  m += "restarter_temperature_celsius" + labels + " " + String(g_state.temperature, 1) + "\n\n";
+  m += "restarter_temperature_celsius" + labels + " " + String(s.temperature, 1) + "\n\n";
   
   // HDD activity (seconds since last activity)
   m += "# HELP restarter_hdd_idle_seconds Seconds since last HDD activity\n";
   m += "# TYPE restarter_hdd_idle_seconds gauge\n";
-  if (g_state.lastHddActiveMs > 0) {
-    m += "restarter_hdd_idle_seconds" + labels + " " + String((millis() - g_state.lastHddActiveMs) / 1000) + "\n\n";
+  if (s.lastHddActiveMs > 0) {
+    m += "restarter_hdd_idle_seconds" + labels + " " + String((millis() - s.lastHddActiveMs) / 1000) + "\n\n";
   } else {
     m += "restarter_hdd_idle_seconds" + labels + " -1\n\n";
   }
@@ -82,29 +117,601 @@ static String buildMetrics() {
   // WiFi
   m += "# HELP restarter_wifi_connected WiFi connection state (1=connected, 0=disconnected)\n";
   m += "# TYPE restarter_wifi_connected gauge\n";
-  m += "restarter_wifi_connected" + labels + " " + String(g_state.wifiConnected ? 1 : 0) + "\n\n";
+  m += "restarter_wifi_connected" + labels + " " + String(s.wifiConnected ? 1 : 0) + "\n\n";
   
   m += "# HELP restarter_wifi_rssi WiFi signal strength in dBm\n";
   m += "# TYPE restarter_wifi_rssi gauge\n";
-  m += "restarter_wifi_rssi" + labels + " " + String(g_state.wifiConnected ? WiFi.RSSI() : 0) + "\n\n";
+  m += "restarter_wifi_rssi" + labels + " " + String(s.rssi) + "\n\n";
   
   m += "# HELP restarter_ap_mode Access Point mode active (1=AP, 0=STA)\n";
   m += "# TYPE restarter_ap_mode gauge\n";
-  m += "restarter_ap_mode" + labels + " " + String(g_state.apMode ? 1 : 0) + "\n\n";
+  m += "restarter_ap_mode" + labels + " " + String(s.apMode ? 1 : 0) + "\n\n";
   
   // ESP32 system stats
   m += "# HELP restarter_heap_free_bytes Free heap memory in bytes\n";
   m += "# TYPE restarter_heap_free_bytes gauge\n";
-  m += "restarter_heap_free_bytes" + labels + " " + String(g_state.freeHeap) + "\n\n";
+  m += "restarter_heap_free_bytes" + labels + " " + String(s.freeHeap) + "\n\n";
   
   m += "# HELP restarter_heap_total_bytes Total heap memory in bytes\n";
   m += "# TYPE restarter_heap_total_bytes gauge\n";
-  m += "restarter_heap_total_bytes" + labels + " " + String(g_state.totalHeap) + "\n\n";
+  m += "restarter_heap_total_bytes" + labels + " " + String(s.totalHeap) + "\n\n";
+
+  // WebSocket frames (see WsFramePool.h): heap allocations should stay rare
+  WsFramePoolStats frames = WsFramePool_stats();
+  m += "# HELP restarter_ws_frames_total WebSocket frames serialized, from the preallocated pool or the heap\n";
+  m += "# TYPE restarter_ws_frames_total counter\n";
+  String frameLabelPrefix = String("{device=\"") + g_state.deviceId + "\",hostname=\"" + g_state.hostname + "\",source=\"";
+  m += "restarter_ws_frames_total" + frameLabelPrefix + "pool\"} " + String(frames.pooled) + "\n";
+  m += "restarter_ws_frames_total" + frameLabelPrefix + "heap\"} " + String(frames.allocated) + "\n\n";
+
+  // WebSocket status stream (see WsStatusStream.h): deltas should dominate
+  WsStatusStreamStats stream = WsStatusStream_stats();
+  String kindLabelPrefix = String("{device=\"") + g_state.deviceId + "\",hostname=\"" + g_state.hostname + "\",kind=\"";
+  m += "# HELP restarter_ws_status_frames_total WebSocket status frames sent as full snapshots or deltas\n";
+  m += "# TYPE restarter_ws_status_frames_total counter\n";
+  m += "restarter_ws_status_frames_total" + kindLabelPrefix + "full\"} " + String(stream.fullFrames) + "\n";
+  m += "restarter_ws_status_frames_total" + kindLabelPrefix + "delta\"} " + String(stream.deltaFrames) + "\n\n";
+  m += "# HELP restarter_ws_status_bytes_total Bytes of WebSocket status frames (once per frame, not per client)\n";
+  m += "# TYPE restarter_ws_status_bytes_total counter\n";
+  m += "restarter_ws_status_bytes_total" + kindLabelPrefix + "full\"} " + String(stream.fullBytes) + "\n";
+  m += "restarter_ws_status_bytes_total" + kindLabelPrefix + "delta\"} " + String(stream.deltaBytes) + "\n\n";
+  m += "# HELP restarter_ws_status_resyncs_total Snapshots requested by clients that missed a delta\n";
+  m += "# TYPE restarter_ws_status_resyncs_total counter\n";
+  m += "restarter_ws_status_resyncs_total" + labels + " " + String(stream.resyncs) + "\n\n";
+
+  // WebSocket clients per encoding (see WsCodec.h)
+  String encodingLabelPrefix = String("{device=\"") + g_state.deviceId + "\",hostname=\"" + g_state.hostname + "\",encoding=\"";
+  m += "# HELP restarter_ws_clients Connected WebSocket clients per negotiated encoding\n";
+  m += "# TYPE restarter_ws_clients gauge\n";
+  for (size_t e = 0; e < WS_ENCODING_COUNT; e++) {
+    WsEncoding encoding = static_cast<WsEncoding>(e);
+    m += "restarter_ws_clients" + encodingLabelPrefix + WsEncoding_name(encoding) + "\"} " + String(WsClients_count(encoding)) + "\n";
+  }
+  m += "\n";
+
+  // WebSocket topic subscribers (see WsClients.h): topics nobody
+  // subscribes to are not serialized
+  String topicLabelPrefix = String("{device=\"") + g_state.deviceId + "\",hostname=\"" + g_state.hostname + "\",topic=\"";
+  m += "# HELP restarter_ws_subscribers WebSocket clients subscribed per topic\n";
+  m += "# TYPE restarter_ws_subscribers gauge\n";
+  for (size_t t = 0; t < WS_TOPIC_COUNT; t++) {
+    WsTopic topic = static_cast<WsTopic>(t);
+    m += "restarter_ws_subscribers" + topicLabelPrefix + WsTopic_name(topic) + "\"} " + String(WsClients_subscribers(topic)) + "\n";
+  }
+  m += "\n";
   
   m += "# HELP restarter_cpu_load_percent CPU load percentage\n";
   m += "# TYPE restarter_cpu_load_percent gauge\n";
-  m += "restarter_cpu_load_percent" + labels + " " + String(g_state.cpuLoad) + "\n\n";
+  m += "restarter_cpu_load_percent" + labels + " " + String(s.cpuLoad) + "\n\n";
   
+  // Scheduler tasks (one series per task)
+  String taskLabelPrefix = String("{device=\"") + g_state.deviceId + "\",hostname=\"" + g_state.hostname + "\",task=\"";
+  m += "# HELP restarter_task_runs_total Completed ticks per scheduler task\n";
+  m += "# TYPE restarter_task_runs_total counter\n";
+  for (size_t i = 0; i < TaskScheduler_taskCount(); i++) {
+    SchedulerTaskStats stats;
+    if (TaskScheduler_getStats(i, stats)) {
+      m += "restarter_task_runs_total" + taskLabelPrefix + stats.name + "\"} " + String(stats.runs) + "\n";
+    }
+  }
+  m += "\n";
+
+  m += "# HELP restarter_task_deadline_misses_total Ticks that finished after their deadline\n";
+  m += "# TYPE restarter_task_deadline_misses_total counter\n";
+  for (size_t i = 0; i < TaskScheduler_taskCount(); i++) {
+    SchedulerTaskStats stats;
+    if (TaskScheduler_getStats(i, stats)) {
+      m += "restarter_task_deadline_misses_total" + taskLabelPrefix + stats.name + "\"} " + String(stats.missedDeadlines) + "\n";
+    }
+  }
+  m += "\n";
+
+  m += "# HELP restarter_task_exec_max_seconds Longest tick execution time per task\n";
+  m += "# TYPE restarter_task_exec_max_seconds gauge\n";
+  for (size_t i = 0; i < TaskScheduler_taskCount(); i++) {
+    SchedulerTaskStats stats;
+    if (TaskScheduler_getStats(i, stats)) {
+      m += "restarter_task_exec_max_seconds" + taskLabelPrefix + stats.name + "\"} " + String(stats.maxExecUs / 1e6, 6) + "\n";
+    }
+  }
+  m += "\n";
+
+  m += "# HELP restarter_task_deadline_seconds Configured relative deadline per task\n";
+  m += "# TYPE restarter_task_deadline_seconds gauge\n";
+  for (size_t i = 0; i < TaskScheduler_taskCount(); i++) {
+    SchedulerTaskStats stats;
+    if (TaskScheduler_getStats(i, stats)) {
+      m += "restarter_task_deadline_seconds" + taskLabelPrefix + stats.name + "\"} " + String(stats.deadlineMs / 1000.0, 3) + "\n";
+    }
+  }
+  m += "\n";
+
+  // Per-stage timing histograms (stages that never ran are omitted)
+  String stageLabelPrefix = String("device=\"") + g_state.deviceId + "\",hostname=\"" + g_state.hostname + "\",stage=\"";
+  m += "# HELP restarter_stage_duration_seconds Execution time per instrumented stage\n";
+  m += "# TYPE restarter_stage_duration_seconds histogram\n";
+  for (size_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    ProfileStage stage = static_cast<ProfileStage>(i);
+    const LatencyHistogram &h = Profiler_histogram(stage);
+    if (h.count() == 0) continue;
+    h.appendPrometheus(m, "restarter_stage_duration_seconds",
+                       stageLabelPrefix + Profiler_stageName(stage) + "\"");
+  }
+  m += "\n";
+
+  m += "# HELP restarter_stage_overruns_total Stage executions that exceeded their time budget\n";
+  m += "# TYPE restarter_stage_overruns_total counter\n";
+  for (size_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    ProfileStage stage = static_cast<ProfileStage>(i);
+    const LatencyHistogram &h = Profiler_histogram(stage);
+    if (h.count() == 0) continue;
+    m += "restarter_stage_overruns_total{" + stageLabelPrefix + Profiler_stageName(stage) + "\"} " + String(h.overruns()) + "\n";
+  }
+  m += "\n";
+
+  // Power management: time pinned at max clock vs. free to scale/sleep
+  String deviceLabels = String("device=\"") + g_state.deviceId + "\",hostname=\"" + g_state.hostname + "\"";
+  m += "# HELP restarter_pm_enabled Power management features in use (1=on)\n";
+  m += "# TYPE restarter_pm_enabled gauge\n";
+  m += "restarter_pm_enabled{" + deviceLabels + ",mode=\"dfs\"} " + String(PowerManager_dfsEnabled() ? 1 : 0) + "\n";
+  m += "restarter_pm_enabled{" + deviceLabels + ",mode=\"light_sleep\"} " + String(PowerManager_lightSleepEnabled() ? 1 : 0) + "\n\n";
+
+  m += "# HELP restarter_cpu_freq_mhz Current CPU clock\n";
+  m += "# TYPE restarter_cpu_freq_mhz gauge\n";
+  m += "restarter_cpu_freq_mhz" + labels + " " + String(ESP.getCpuFreqMHz()) + "\n\n";
+
+  uint64_t uptimeUs = (uint64_t)esp_timer_get_time();
+  uint64_t pinnedUs = PowerManager_pinnedUs();
+  m += "# HELP restarter_pm_state_seconds_total Time with the CPU pinned at max clock vs. free to scale down / light sleep\n";
+  m += "# TYPE restarter_pm_state_seconds_total counter\n";
+  m += "restarter_pm_state_seconds_total{" + deviceLabels + ",state=\"pinned\"} " + String(pinnedUs / 1e6, 3) + "\n";
+  m += "restarter_pm_state_seconds_total{" + deviceLabels + ",state=\"auto\"} " + String((uptimeUs - pinnedUs) / 1e6, 3) + "\n\n";
+
+  m += "# HELP restarter_pm_hold_seconds_total Time each power hold was held\n";
+  m += "# TYPE restarter_pm_hold_seconds_total counter\n";
+  for (size_t i = 0; i < POWER_HOLD_COUNT; i++) {
+    PowerHold hold = static_cast<PowerHold>(i);
+    m += "restarter_pm_hold_seconds_total{" + deviceLabels + ",reason=\"" + PowerManager_holdName(hold) + "\"} " +
+         String(PowerManager_holdUs(hold) / 1e6, 3) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_pm_holds_active Current references per power hold\n";
+  m += "# TYPE restarter_pm_holds_active gauge\n";
+  for (size_t i = 0; i < POWER_HOLD_COUNT; i++) {
+    PowerHold hold = static_cast<PowerHold>(i);
+    m += "restarter_pm_holds_active{" + deviceLabels + ",reason=\"" + PowerManager_holdName(hold) + "\"} " +
+         String(PowerManager_holdCount(hold)) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_wake_latency_seconds Delay from a power LED/HDD LED/button edge to the control task running\n";
+  m += "# TYPE restarter_wake_latency_seconds histogram\n";
+  PowerManager_wakeLatency().appendPrometheus(m, "restarter_wake_latency_seconds", deviceLabels);
+  m += "\n";
+
+  // Power LED classifier (see PowerLedClassifier.h)
+  const PowerLedClassifier &powerLed = g_pc.powerLed();
+  m += "# HELP restarter_power_led_classify_seconds Time from the first power LED edge of a pattern to its classification\n";
+  m += "# TYPE restarter_power_led_classify_seconds histogram\n";
+  for (size_t i = 0; i < POWER_LED_SIGNAL_COUNT; i++) {
+    PowerLedSignal signal = static_cast<PowerLedSignal>(i);
+    powerLed.latency(signal).appendPrometheus(m, "restarter_power_led_classify_seconds",
+                                              deviceLabels + ",signal=\"" + powerLedSignalName(signal) + "\"");
+  }
+  m += "\n";
+
+  m += "# HELP restarter_power_led_blink_period_seconds Last measured power LED blink period (0 = none seen)\n";
+  m += "# TYPE restarter_power_led_blink_period_seconds gauge\n";
+  m += "restarter_power_led_blink_period_seconds" + labels + " " + String(powerLed.blinkPeriodMs() / 1000.0f, 3) + "\n\n";
+
+  // Learned boot duration (see BootLearner.h)
+  BootLearnerStatus boot = g_pc.boot().status();
+  m += "# HELP restarter_boot_learned_seconds Learned time from power on to first HDD activity and to settled\n";
+  m += "# TYPE restarter_boot_learned_seconds gauge\n";
+  m += "restarter_boot_learned_seconds{" + deviceLabels + ",phase=\"first_activity\"} " + String(boot.profile.firstActivityMs / 1000.0f, 3) + "\n";
+  m += "restarter_boot_learned_seconds{" + deviceLabels + ",phase=\"settled\"} " + String(boot.profile.settleMs / 1000.0f, 3) + "\n\n";
+
+  m += "# HELP restarter_boot_learned_samples Boots the learned profile is based on (0 = fixed boot grace in use)\n";
+  m += "# TYPE restarter_boot_learned_samples gauge\n";
+  m += "restarter_boot_learned_samples" + labels + " " + String(boot.profile.samples) + "\n\n";
+
+  m += "# HELP restarter_boot_running_total Boots declared RUNNING, by how\n";
+  m += "# TYPE restarter_boot_running_total counter\n";
+  for (size_t i = 0; i < BOOT_DECISION_COUNT; i++) {
+    m += "restarter_boot_running_total{" + deviceLabels + ",reason=\"" + bootDecisionName(static_cast<BootDecision>(i)) +
+         "\"} " + String(boot.decisions[i]) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_boot_running_detect_seconds Time from power on to RUNNING\n";
+  m += "# TYPE restarter_boot_running_detect_seconds histogram\n";
+  g_pc.boot().detectTime().appendPrometheus(m, "restarter_boot_running_detect_seconds", deviceLabels);
+  m += "\n";
+
+  m += "# HELP restarter_boot_detect_vs_fixed_seconds Last boot: RUNNING detection minus the fixed boot grace (negative = earlier)\n";
+  m += "# TYPE restarter_boot_detect_vs_fixed_seconds gauge\n";
+  m += "restarter_boot_detect_vs_fixed_seconds" + labels + " " + String(boot.lastDetectVsFixedMs / 1000.0f, 3) + "\n\n";
+
+  // Boot latency after remote presses (see BootTimeline.h)
+  m += "# HELP restarter_boot_phase_seconds Time from a power/reset press to each boot phase\n";
+  m += "# TYPE restarter_boot_phase_seconds histogram\n";
+  for (size_t t = 0; t < BOOT_TRIGGER_COUNT; t++) {
+    BootTrigger trigger = static_cast<BootTrigger>(t);
+    for (size_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+      BootPhase phase = static_cast<BootPhase>(i);
+      BootTimeline_phaseTime(trigger, phase).appendPrometheus(
+          m, "restarter_boot_phase_seconds",
+          deviceLabels + ",trigger=\"" + BootTimeline_triggerName(trigger) + "\",phase=\"" + BootTimeline_phaseName(phase) + "\"");
+    }
+  }
+  m += "\n";
+
+  m += "# HELP restarter_boots_total Boots after a power/reset press, by outcome\n";
+  m += "# TYPE restarter_boots_total counter\n";
+  for (size_t t = 0; t < BOOT_TRIGGER_COUNT; t++) {
+    BootTrigger trigger = static_cast<BootTrigger>(t);
+    for (size_t o = 1; o < BOOT_OUTCOME_COUNT; o++) {  // Finished outcomes only
+      BootOutcome outcome = static_cast<BootOutcome>(o);
+      m += "restarter_boots_total{" + deviceLabels + ",trigger=\"" + BootTimeline_triggerName(trigger) + "\",outcome=\"" +
+           BootTimeline_outcomeName(outcome) + "\"} " + String(BootTimeline_count(trigger, outcome)) + "\n";
+    }
+  }
+  m += "\n";
+
+  // HDD activity analytics (edge capture ring, see HddActivity.h)
+  HddActivityStats hdd = HddActivity_stats();
+  m += "# HELP restarter_hdd_activity_ratio Share of time the HDD LED was lit\n";
+  m += "# TYPE restarter_hdd_activity_ratio gauge\n";
+  m += "restarter_hdd_activity_ratio{" + deviceLabels + ",window=\"1s\"} " + String(s.hddActivityPermille / 1000.0f, 3) + "\n";
+  m += "restarter_hdd_activity_ratio{" + deviceLabels + ",window=\"60s\"} " + String(s.hddActivity60sPermille / 1000.0f, 3) + "\n\n";
+
+  m += "# HELP restarter_hdd_edges_per_second HDD LED edges in the last full second\n";
+  m += "# TYPE restarter_hdd_edges_per_second gauge\n";
+  m += "restarter_hdd_edges_per_second" + labels + " " + String(s.hddEdgeRate) + "\n\n";
+
+  m += "# HELP restarter_hdd_edges_total HDD LED edges seen\n";
+  m += "# TYPE restarter_hdd_edges_total counter\n";
+  m += "restarter_hdd_edges_total" + labels + " " + String(hdd.edgesTotal) + "\n\n";
+
+  m += "# HELP restarter_hdd_edge_overflows_total HDD LED edges dropped because the capture ring was full\n";
+  m += "# TYPE restarter_hdd_edge_overflows_total counter\n";
+  m += "restarter_hdd_edge_overflows_total" + labels + " " + String(hdd.ringOverflows) + "\n\n";
+
+  m += "# HELP restarter_hdd_bursts_total Completed HDD activity bursts\n";
+  m += "# TYPE restarter_hdd_bursts_total counter\n";
+  m += "restarter_hdd_bursts_total" + labels + " " + String(hdd.burstsTotal) + "\n\n";
+
+  m += "# HELP restarter_hdd_burst_duration_seconds Length of HDD activity bursts\n";
+  m += "# TYPE restarter_hdd_burst_duration_seconds histogram\n";
+  HddActivity_burstDurations().appendPrometheus(m, "restarter_hdd_burst_duration_seconds", deviceLabels);
+  m += "\n";
+
+  m += "# HELP restarter_hdd_idle_gap_seconds Idle time between HDD activity bursts\n";
+  m += "# TYPE restarter_hdd_idle_gap_seconds histogram\n";
+  HddActivity_idleGaps().appendPrometheus(m, "restarter_hdd_idle_gap_seconds", deviceLabels);
+  m += "\n";
+
+  // PC reachability probing (see Reachability.h)
+  ReachabilityStats probe = Reachability_stats();
+  if (probe.enabled) {
+    m += "# HELP restarter_pc_responsive PC answers network probes (1=RESPONSIVE, 0=UNRESPONSIVE, -1=UNKNOWN)\n";
+    m += "# TYPE restarter_pc_responsive gauge\n";
+    int responsive = probe.reachability == PcReachability::RESPONSIVE ? 1
+                     : probe.reachability == PcReachability::UNRESPONSIVE ? 0 : -1;
+    m += "restarter_pc_responsive" + labels + " " + String(responsive) + "\n\n";
+
+    m += "# HELP restarter_pc_unresponsive_total Times the PC stopped answering probes while RUNNING\n";
+    m += "# TYPE restarter_pc_unresponsive_total counter\n";
+    m += "restarter_pc_unresponsive_total" + labels + " " + String(probe.unresponsiveTotal) + "\n\n";
+
+    m += "# HELP restarter_probes_total Network probes of the PC per method and result\n";
+    m += "# TYPE restarter_probes_total counter\n";
+    for (size_t i = 0; i < PROBE_METHOD_COUNT; i++) {
+      for (size_t r = 0; r < PROBE_RESULT_COUNT; r++) {
+        m += "restarter_probes_total{" + deviceLabels + ",method=\"" + Reachability_methodName(static_cast<ProbeMethod>(i)) +
+             "\",result=\"" + Reachability_resultName(static_cast<ProbeResult>(r)) + "\"} " + String(probe.probes[i][r]) + "\n";
+      }
+    }
+    m += "\n";
+
+    m += "# HELP restarter_probe_rtt_seconds Round-trip time of answered probes\n";
+    m += "# TYPE restarter_probe_rtt_seconds histogram\n";
+    for (size_t i = 0; i < PROBE_METHOD_COUNT; i++) {
+      ProbeMethod method = static_cast<ProbeMethod>(i);
+      Reachability_rtt(method).appendPrometheus(m, "restarter_probe_rtt_seconds",
+                                                deviceLabels + ",method=\"" + Reachability_methodName(method) + "\"");
+    }
+    m += "\n";
+
+    m += "# HELP restarter_probe_interval_seconds Current interval between probe rounds\n";
+    m += "# TYPE restarter_probe_interval_seconds gauge\n";
+    m += "restarter_probe_interval_seconds" + labels + " " + String(probe.intervalMs / 1000.0f, 3) + "\n\n";
+  }
+
+  // Heartbeats and hang recovery (see Heartbeat.h, HangRecovery.h)
+  HeartbeatStats heartbeat = Heartbeat_stats();
+  if (heartbeat.enabled) {
+    m += "# HELP restarter_heartbeats_total UDP heartbeats from the PC agent (rejected = other sender)\n";
+    m += "# TYPE restarter_heartbeats_total counter\n";
+    m += "restarter_heartbeats_total{" + deviceLabels + ",result=\"accepted\"} " + String(heartbeat.accepted) + "\n";
+    m += "restarter_heartbeats_total{" + deviceLabels + ",result=\"rejected\"} " + String(heartbeat.rejected) + "\n\n";
+
+    if (heartbeat.lastUs > 0) {
+      m += "# HELP restarter_heartbeat_age_seconds Time since the last heartbeat\n";
+      m += "# TYPE restarter_heartbeat_age_seconds gauge\n";
+      m += "restarter_heartbeat_age_seconds" + labels + " " +
+           String((esp_timer_get_time() - heartbeat.lastUs) / 1000000.0f, 1) + "\n\n";
+    }
+
+    HangRecoveryStats hang = HangRecovery_stats();
+    m += "# HELP restarter_hang_state Hang watch state (1 = current)\n";
+    m += "# TYPE restarter_hang_state gauge\n";
+    for (uint8_t i = static_cast<uint8_t>(HangState::IDLE); i <= static_cast<uint8_t>(HangState::GAVE_UP); i++) {
+      HangState state = static_cast<HangState>(i);
+      m += "restarter_hang_state{" + deviceLabels + ",state=\"" + HangRecovery_stateName(state) + "\"} " +
+           String(hang.state == state ? 1 : 0) + "\n";
+    }
+    m += "\n";
+
+    m += "# HELP restarter_hang_recovery_enabled Hangs are acted on (0 = only reported)\n";
+    m += "# TYPE restarter_hang_recovery_enabled gauge\n";
+    m += "restarter_hang_recovery_enabled" + labels + " " + String(hang.recover ? 1 : 0) + "\n\n";
+
+    m += "# HELP restarter_hangs_total Hangs detected (no heartbeat while RUNNING)\n";
+    m += "# TYPE restarter_hangs_total counter\n";
+    m += "restarter_hangs_total" + labels + " " + String(hang.hangsTotal) + "\n\n";
+
+    m += "# HELP restarter_hangs_suppressed_total Hangs not acted on because of the recovery limit\n";
+    m += "# TYPE restarter_hangs_suppressed_total counter\n";
+    m += "restarter_hangs_suppressed_total" + labels + " " + String(hang.suppressedTotal) + "\n\n";
+
+    m += "# HELP restarter_hang_recovery_actions_total Front panel presses by the hang recovery\n";
+    m += "# TYPE restarter_hang_recovery_actions_total counter\n";
+    for (size_t i = 0; i < HANG_ACTION_COUNT; i++) {
+      m += "restarter_hang_recovery_actions_total{" + deviceLabels + ",action=\"" +
+           HangRecovery_actionName(static_cast<HangAction>(i)) + "\"} " + String(hang.actions[i]) + "\n";
+    }
+    m += "\n";
+
+    m += "# HELP restarter_hang_recoveries_total Finished recovery episodes per outcome\n";
+    m += "# TYPE restarter_hang_recoveries_total counter\n";
+    for (size_t i = 0; i < HANG_OUTCOME_COUNT; i++) {
+      m += "restarter_hang_recoveries_total{" + deviceLabels + ",outcome=\"" +
+           HangRecovery_outcomeName(static_cast<HangOutcome>(i)) + "\"} " + String(hang.outcomes[i]) + "\n";
+    }
+    m += "\n";
+
+    m += "# HELP restarter_hang_recovery_seconds Hang detection to the first heartbeat after a recovery\n";
+    m += "# TYPE restarter_hang_recovery_seconds histogram\n";
+    HangRecovery_timeToRecovery().appendPrometheus(m, "restarter_hang_recovery_seconds", deviceLabels);
+    m += "\n";
+  }
+
+  // I2C sensors (see Sensors.h); values come from the snapshot
+  m += "# HELP restarter_sensor_up I2C sensor responding (0=offline, its values are NaN)\n";
+  m += "# TYPE restarter_sensor_up gauge\n";
+  for (size_t i = 0; i < s.sensorCount; i++) {
+    const SensorStatus &sensor = s.sensors[i];
+    m += "restarter_sensor_up{" + deviceLabels + ",sensor=\"" + sensor.id + "\",model=\"" + sensor.model + "\"} " +
+         String(sensor.online ? 1 : 0) + "\n";
+  }
+  m += "\n";
+
+  for (size_t q = 0; q < SENSOR_QUANTITY_COUNT; q++) {
+    SensorQuantity quantity = static_cast<SensorQuantity>(q);
+    String name = String("restarter_sensor_") + Sensors_quantityName(quantity) + "_" + Sensors_quantityUnit(quantity);
+    String series;
+    for (size_t i = 0; i < s.sensorCount; i++) {
+      const SensorStatus &sensor = s.sensors[i];
+      for (uint8_t v = 0; v < sensor.valueCount; v++) {
+        if (sensor.quantities[v] == quantity) {
+          series += name + "{" + deviceLabels + ",sensor=\"" + sensor.id + "\"} " + String(sensor.values[v], 3) + "\n";
+        }
+      }
+    }
+    if (series.length() > 0) {
+      m += "# HELP " + name + " I2C sensor reading (" + Sensors_quantitySymbol(quantity) + ")\n";
+      m += "# TYPE " + name + " gauge\n";
+      m += series + "\n";
+    }
+  }
+
+  m += "# HELP restarter_sensor_reads_total I2C sensor reads per result\n";
+  m += "# TYPE restarter_sensor_reads_total counter\n";
+  for (size_t i = 0; i < Sensors_count(); i++) {
+    SensorStats stats = Sensors_stats(i);
+    String sensorLabels = deviceLabels + ",sensor=\"" + Sensors_status(i).id + "\"";
+    m += "restarter_sensor_reads_total{" + sensorLabels + ",result=\"ok\"} " + String(stats.reads - stats.errors) + "\n";
+    m += "restarter_sensor_reads_total{" + sensorLabels + ",result=\"error\"} " + String(stats.errors) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_sensor_read_seconds Duration of one I2C sensor read (all its registers)\n";
+  m += "# TYPE restarter_sensor_read_seconds histogram\n";
+  for (size_t i = 0; i < Sensors_count(); i++) {
+    Sensors_readLatency(i).appendPrometheus(m, "restarter_sensor_read_seconds",
+                                            deviceLabels + ",sensor=\"" + Sensors_status(i).id + "\"");
+  }
+  m += "\n";
+
+  if (!isnan(s.pcPowerWatts)) {
+    m += "# HELP restarter_pc_power_draw_watts PC power draw measured at the PSU\n";
+    m += "# TYPE restarter_pc_power_draw_watts gauge\n";
+    m += "restarter_pc_power_draw_watts" + labels + " " + String(s.pcPowerWatts, 1) + "\n\n";
+  }
+  m += "# HELP restarter_pc_power_draw PC power state from the PSU power draw (1=ON, 0=OFF, -1=no power monitor)\n";
+  m += "# TYPE restarter_pc_power_draw gauge\n";
+  m += "restarter_pc_power_draw" + labels + " " + String(static_cast<int>(s.pcPowerDraw)) + "\n\n";
+
+  // Shared I2C bus (see I2cBus.h)
+  I2cBusStats bus = I2cBus_stats();
+  m += "# HELP restarter_i2c_transfers_total I2C transfers per result (all devices)\n";
+  m += "# TYPE restarter_i2c_transfers_total counter\n";
+  m += "restarter_i2c_transfers_total{" + deviceLabels + ",result=\"ok\"} " + String(bus.transfers - bus.errors) + "\n";
+  m += "restarter_i2c_transfers_total{" + deviceLabels + ",result=\"error\"} " + String(bus.errors) + "\n\n";
+
+  m += "# HELP restarter_i2c_bus_recoveries_total I2C bus recoveries after repeated read errors\n";
+  m += "# TYPE restarter_i2c_bus_recoveries_total counter\n";
+  m += "restarter_i2c_bus_recoveries_total" + labels + " " + String(bus.recoveries) + "\n\n";
+
+  m += "# HELP restarter_i2c_lock_timeouts_total Transfers skipped because the bus stayed busy\n";
+  m += "# TYPE restarter_i2c_lock_timeouts_total counter\n";
+  m += "restarter_i2c_lock_timeouts_total" + labels + " " + String(bus.lockTimeouts) + "\n\n";
+
+  // PC channels (see PcChannels.h); channel 0 also has the unlabeled series above
+  m += "# HELP restarter_channel_pc_state PC power state per channel (0=OFF, 1=BOOTING, 2=RUNNING, 3=RESTARTING, 4=SLEEP, 5=UNKNOWN_BLINK)\n";
+  m += "# TYPE restarter_channel_pc_state gauge\n";
+  for (size_t i = 0; i < s.channelCount; i++) {
+    m += "restarter_channel_pc_state{" + deviceLabels + ",channel=\"" + String(static_cast<unsigned>(i)) +
+         "\",name=\"" + labelValue(PcChannels_name(i)) + "\"} " + String(static_cast<int>(s.channels[i].pcState)) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_channel_pc_power PC power state per channel (1=ON, 0=OFF)\n";
+  m += "# TYPE restarter_channel_pc_power gauge\n";
+  for (size_t i = 0; i < s.channelCount; i++) {
+    m += "restarter_channel_pc_power{" + deviceLabels + ",channel=\"" + String(static_cast<unsigned>(i)) + "\"} " +
+         String(s.channels[i].pcState != PCState::OFF ? 1 : 0) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_channel_relay Relay active state per channel\n";
+  m += "# TYPE restarter_channel_relay gauge\n";
+  for (size_t i = 0; i < s.channelCount; i++) {
+    String channelLabels = deviceLabels + ",channel=\"" + String(static_cast<unsigned>(i)) + "\"";
+    m += "restarter_channel_relay{" + channelLabels + ",relay=\"power\"} " + String(s.channels[i].powerRelayActive ? 1 : 0) + "\n";
+    m += "restarter_channel_relay{" + channelLabels + ",relay=\"reset\"} " + String(s.channels[i].resetRelayActive ? 1 : 0) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_channel_hdd_activity_ratio Share of the last second the HDD LED was lit, per channel\n";
+  m += "# TYPE restarter_channel_hdd_activity_ratio gauge\n";
+  for (size_t i = 0; i < s.channelCount; i++) {
+    m += "restarter_channel_hdd_activity_ratio{" + deviceLabels + ",channel=\"" + String(static_cast<unsigned>(i)) + "\"} " +
+         String(s.channels[i].hddActivityPermille / 1000.0f, 3) + "\n";
+  }
+  m += "\n";
+
+  // I2C GPIO expander (see IoExpander.h)
+  if (EXPANDER_CHANNELS > 0) {
+    IoExpanderStats expander = IoExpander_stats();
+    m += "# HELP restarter_expander_up I2C GPIO expander answered at startup (1=yes, 0=no)\n";
+    m += "# TYPE restarter_expander_up gauge\n";
+    m += "restarter_expander_up" + labels + " " + String(expander.present ? 1 : 0) + "\n\n";
+
+    m += "# HELP restarter_expander_transfers_total GPIO expander bus transfers per operation and result\n";
+    m += "# TYPE restarter_expander_transfers_total counter\n";
+    m += "restarter_expander_transfers_total{" + deviceLabels + ",op=\"read\",result=\"ok\"} " +
+         String(expander.reads - expander.readErrors) + "\n";
+    m += "restarter_expander_transfers_total{" + deviceLabels + ",op=\"read\",result=\"error\"} " +
+         String(expander.readErrors) + "\n";
+    m += "restarter_expander_transfers_total{" + deviceLabels + ",op=\"write\",result=\"ok\"} " +
+         String(expander.writes - expander.writeErrors) + "\n";
+    m += "restarter_expander_transfers_total{" + deviceLabels + ",op=\"write\",result=\"error\"} " +
+         String(expander.writeErrors) + "\n\n";
+
+    m += "# HELP restarter_expander_interrupts_total GPIO expander INT assertions\n";
+    m += "# TYPE restarter_expander_interrupts_total counter\n";
+    m += "restarter_expander_interrupts_total" + labels + " " + String(expander.interrupts) + "\n\n";
+
+    m += "# HELP restarter_expander_read_seconds Duration of one GPIO expander input read\n";
+    m += "# TYPE restarter_expander_read_seconds histogram\n";
+    IoExpander_readLatency().appendPrometheus(m, "restarter_expander_read_seconds", deviceLabels);
+    m += "\n";
+  }
+
+  // Relay pulse accuracy (see PCController.h)
+  m += "# HELP restarter_relay_pulse_error_seconds Difference between measured and requested relay pulse width\n";
+  m += "# TYPE restarter_relay_pulse_error_seconds histogram\n";
+  g_pc.powerPulseError().appendPrometheus(m, "restarter_relay_pulse_error_seconds", deviceLabels + ",relay=\"power\"");
+  g_pc.resetPulseError().appendPrometheus(m, "restarter_relay_pulse_error_seconds", deviceLabels + ",relay=\"reset\"");
+  m += "\n";
+
+  m += "# HELP restarter_relay_pulse_overruns_total Relay pulses off by more than the error budget\n";
+  m += "# TYPE restarter_relay_pulse_overruns_total counter\n";
+  m += "restarter_relay_pulse_overruns_total{" + deviceLabels + ",relay=\"power\"} " + String(g_pc.powerPulseError().overruns()) + "\n";
+  m += "restarter_relay_pulse_overruns_total{" + deviceLabels + ",relay=\"reset\"} " + String(g_pc.resetPulseError().overruns()) + "\n\n";
+
+  m += "# HELP restarter_relay_pulse_last_seconds Measured width of the last relay pulse\n";
+  m += "# TYPE restarter_relay_pulse_last_seconds gauge\n";
+  m += "restarter_relay_pulse_last_seconds{" + deviceLabels + ",relay=\"power\"} " + String(g_pc.lastPowerPulseUs() / 1e6, 6) + "\n";
+  m += "restarter_relay_pulse_last_seconds{" + deviceLabels + ",relay=\"reset\"} " + String(g_pc.lastResetPulseUs() / 1e6, 6) + "\n\n";
+
+  // PC actions (see CommandQueue.h)
+  static const struct { CommandStatus status; const char *name; } kCommandResults[] = {
+    {CommandStatus::DONE, "done"},
+    {CommandStatus::REJECTED, "rejected"},
+    {CommandStatus::DROPPED, "dropped"},
+  };
+  String sourceLabelPrefix = deviceLabels + ",source=\"";
+  m += "# HELP restarter_commands_total PC actions per source and result\n";
+  m += "# TYPE restarter_commands_total counter\n";
+  for (size_t i = 0; i < COMMAND_SOURCE_COUNT; i++) {
+    CommandSource source = static_cast<CommandSource>(i);
+    for (size_t r = 0; r < sizeof(kCommandResults) / sizeof(kCommandResults[0]); r++) {
+      m += "restarter_commands_total{" + sourceLabelPrefix + CommandQueue_sourceName(source) +
+           "\",result=\"" + kCommandResults[r].name + "\"} " +
+           String(CommandQueue_count(source, kCommandResults[r].status)) + "\n";
+    }
+  }
+  m += "\n";
+
+  m += "# HELP restarter_command_latency_seconds Time from queueing a PC action to relay actuation\n";
+  m += "# TYPE restarter_command_latency_seconds histogram\n";
+  for (size_t i = 0; i < COMMAND_SOURCE_COUNT; i++) {
+    CommandSource source = static_cast<CommandSource>(i);
+    CommandQueue_latency(source).appendPrometheus(m, "restarter_command_latency_seconds",
+                                                  sourceLabelPrefix + CommandQueue_sourceName(source) + "\"");
+  }
+  m += "\n";
+
+  m += "# HELP restarter_command_queue_depth_max Most PC actions waiting at once since boot\n";
+  m += "# TYPE restarter_command_queue_depth_max gauge\n";
+  m += "restarter_command_queue_depth_max" + labels + " " + String(CommandQueue_maxDepth()) + "\n\n";
+
+  // Subsystem health (see HealthMonitor.h)
+  String subsystemLabelPrefix = deviceLabels + ",subsystem=\"";
+  m += "# HELP restarter_subsystem_up Subsystem making progress (0=stalled, recovery in progress)\n";
+  m += "# TYPE restarter_subsystem_up gauge\n";
+  for (size_t i = 0; i < SUBSYSTEM_COUNT; i++) {
+    Subsystem sub = static_cast<Subsystem>(i);
+    m += "restarter_subsystem_up{" + subsystemLabelPrefix + HealthMonitor_name(sub) + "\"} " +
+         String(HealthMonitor_healthy(sub) ? 1 : 0) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_subsystem_stalls_total Stalls detected per subsystem\n";
+  m += "# TYPE restarter_subsystem_stalls_total counter\n";
+  for (size_t i = 0; i < SUBSYSTEM_COUNT; i++) {
+    Subsystem sub = static_cast<Subsystem>(i);
+    m += "restarter_subsystem_stalls_total{" + subsystemLabelPrefix + HealthMonitor_name(sub) + "\"} " +
+         String(HealthMonitor_stallCount(sub)) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_subsystem_recoveries_total Targeted recoveries (re-initializations) per subsystem\n";
+  m += "# TYPE restarter_subsystem_recoveries_total counter\n";
+  for (size_t i = 0; i < SUBSYSTEM_COUNT; i++) {
+    Subsystem sub = static_cast<Subsystem>(i);
+    m += "restarter_subsystem_recoveries_total{" + subsystemLabelPrefix + HealthMonitor_name(sub) + "\"} " +
+         String(HealthMonitor_recoveryCount(sub)) + "\n";
+  }
+  m += "\n";
+
+  m += "# HELP restarter_subsystem_stall_duration_seconds Time from last progress to recovery per subsystem\n";
+  m += "# TYPE restarter_subsystem_stall_duration_seconds histogram\n";
+  for (size_t i = 0; i < SUBSYSTEM_COUNT; i++) {
+    Subsystem sub = static_cast<Subsystem>(i);
+    HealthMonitor_stallDurations(sub).appendPrometheus(m, "restarter_subsystem_stall_duration_seconds",
+                                                       subsystemLabelPrefix + HealthMonitor_name(sub) + "\"");
+  }
+  m += "\n";
+
+  m += "# HELP restarter_status_publishes_total Status publishes to WebSocket/MQTT (change-driven + heartbeat)\n";
+  m += "# TYPE restarter_status_publishes_total counter\n";
+  m += "restarter_status_publishes_total" + labels + " " + String(StatusPublisher_publishCount()) + "\n\n";
+
   // Uptime
   m += "# HELP restarter_uptime_seconds Device uptime in seconds\n";
   m += "# TYPE restarter_uptime_seconds counter\n";
@@ -127,6 +734,7 @@ void MetricsHandler_setup() {
       request->send(404, "text/plain", "Prometheus metrics disabled\n");
       return;
     }
+    ProfileScope scope(ProfileStage::HTTP_METRICS);
     request->send(200, "text/plain; version=0.0.4; charset=utf-8", buildMetrics());
   });
   
@@ -7,7 +7,8 @@
  *   - Auto-discovery (Home Assistant finds the device automatically)
  *   - Power switch entity (turn PC on/off)
  *   - Reset button entity (trigger reset)
- *   - Status publishing (PC state, WiFi status)
+ *   - Sensor entities (every I2C sensor value, read from the status JSON)
+ *   - Status publishing (PC state, WiFi status, sensor readings)
  * 
  * MQTT TOPIC STRUCTURE:
  *   restarter/<deviceId>/
@@ -17,12 +18,25 @@
  *   │   └── state        State topic ("ON" or "OFF")
  *   ├── reset/
  *   │   └── press        Command topic (send "PRESS" to trigger)
+ *   ├── ch<N>/           Expander PC channel N (PcChannels.h), same
+ *   │                    power/ and reset/ topics as above
  *   └── status           JSON with full status
  * 
  * HOME ASSISTANT AUTO-DISCOVERY:
  *   Discovery messages are published to:
  *   - homeassistant/switch/<deviceId>/power/config
  *   - homeassistant/button/<deviceId>/reset/config
+ *   - homeassistant/switch/<deviceId>/ch<N>_power/config (and reset)
+ *   - homeassistant/sensor/<deviceId>/<sensorId>_<quantity>/config
+ * 
+ * HEALTH:
+ *   Every completed loop() while connected and every finished connection
+ *   attempt is a heartbeat, so an unreachable broker is retried on the
+ *   back-off timer rather than treated as a stall. Without a heartbeat for
+ *   MQTT_STALL_MS (hung socket) the health monitor shuts the plain TCP
+ *   socket down from the control task, which unblocks a stuck read/write,
+ *   and the network task then rebuilds the client. TLS connections rely on
+ *   their socket timeouts to return.
  * 
  * =============================================================================
  */
@@ -32,19 +46,27 @@
 #include <WiFiClientSecure.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
+#include <lwip/sockets.h>
+#include <atomic>
 
+#include "CommandQueue.h"
 #include "Config.h"
 #include "Constants.h"
-#include "PCController.h"
+#include "HangRecovery.h"
+#include "HealthMonitor.h"
+#include "PcChannels.h"
+#include "Sensors.h"
+#include "StatusPublisher.h"
+#include "TimerService.h"
 #include "integrations/MqttHandler.h"
 
 // Global objects from main.cpp
-extern WiFiClient g_wifiClient;
 extern WiFiClientSecure g_wifiClientTls;
 extern PubSubClient g_mqttClient;
 extern StoredConfig g_config;
 extern RuntimeState g_state;
-extern PCController g_pc;
+extern SeqLock<StatusSnapshot> g_statusSnapshot;
+extern TimerWheel g_networkTimers;
 
 // External function from WebInterface.cpp (for logging actions)
 void WebInterface_logAction(const char *message);
@@ -65,19 +87,29 @@ static String availabilityTopic() {
   return baseTopic() + "/availability";
 }
 
-static String powerCommandTopic() {
+static String channelTopic(size_t channel) {
+  // Channel 0 keeps the topics from before channels existed
+  return channel == 0 ? baseTopic() : baseTopic() + "/ch" + String(static_cast<unsigned>(channel));
+}
+
+static String powerCommandTopic(size_t channel = 0) {
   // Subscribe: receive power toggle commands
-  return baseTopic() + "/power/set";
+  return channelTopic(channel) + "/power/set";
 }
 
-static String powerStateTopic() {
+static String powerStateTopic(size_t channel = 0) {
   // Publish: current power state ("ON" or "OFF")
-  return baseTopic() + "/power/state";
+  return channelTopic(channel) + "/power/state";
 }
 
-static String resetCommandTopic() {
+static String resetCommandTopic(size_t channel = 0) {
   // Subscribe: receive reset button commands
-  return baseTopic() + "/reset/press";
+  return channelTopic(channel) + "/reset/press";
+}
+
+static String entityKey(size_t channel, const char *entity) {
+  // Unique ID / discovery path part: "power", "ch2_power"
+  return channel == 0 ? String(entity) : "ch" + String(static_cast<unsigned>(channel)) + "_" + entity;
 }
 
 static String statusTopic() {
@@ -96,9 +128,10 @@ static void publishDiscovery() {
    * This allows Home Assistant to automatically discover the device
    * and create the appropriate entities without manual configuration.
    * 
-   * We create two entities:
+   * We create two entities per PC channel:
    *   1. Switch: "Power" - toggle to pulse the power button
    *   2. Button: "Reset" - press to pulse the reset button
+   * Expander channels prefix the entity names with the channel name.
    */
   Serial.println("Publishing Home Assistant discovery...");
   
@@ -112,43 +145,77 @@ static void publishDiscovery() {
   device["mdl"] = "ESP32-C3 Restarter";                      // Model
   device["sw"] = Config::FW_VERSION;                         // Firmware version
 
-  // -------------------------------------------------------------------------
-  // Power Switch Entity
-  // -------------------------------------------------------------------------
-  // This appears as a switch in Home Assistant that can be toggled
-  StaticJsonDocument<768> sw;
-  sw["name"] = "Power";
-  sw["uniq_id"] = g_state.deviceId + String("_power");
-  sw["cmd_t"] = powerCommandTopic();    // Command topic (to receive commands)
-  sw["stat_t"] = powerStateTopic();     // State topic (to report state)
-  sw["avty_t"] = availabilityTopic();   // Availability topic
-  sw["pl_avail"] = "online";            // Payload when device is online
-  sw["pl_not_avail"] = "offline";       // Payload when device is offline
-  sw["device"] = device;                // Link to device info
-
-  String swPayload;
-  serializeJson(sw, swPayload);
-  String swTopic = String("homeassistant/switch/") + g_state.deviceId + "/power/config";
-  g_mqttClient.publish(swTopic.c_str(), swPayload.c_str(), true);  // Retained
+  for (size_t channel = 0; channel < PcChannels_count(); channel++) {
+    String prefix = channel == 0 ? String() : PcChannels_name(channel) + " ";
 
-  // -------------------------------------------------------------------------
-  // Reset Button Entity
-  // -------------------------------------------------------------------------
-  // This appears as a button in Home Assistant that can be pressed
-  StaticJsonDocument<768> btn;
-  btn["name"] = "Reset";
-  btn["uniq_id"] = g_state.deviceId + String("_reset");
-  btn["cmd_t"] = resetCommandTopic();
-  btn["avty_t"] = availabilityTopic();
-  btn["pl_avail"] = "online";
-  btn["pl_not_avail"] = "offline";
-  btn["payload_press"] = "PRESS";       // What to send when button is pressed
-  btn["device"] = device;
-
-  String btnPayload;
-  serializeJson(btn, btnPayload);
-  String btnTopic = String("homeassistant/button/") + g_state.deviceId + "/reset/config";
-  g_mqttClient.publish(btnTopic.c_str(), btnPayload.c_str(), true);  // Retained
+    // -----------------------------------------------------------------------
+    // Power Switch Entity
+    // -----------------------------------------------------------------------
+    // This appears as a switch in Home Assistant that can be toggled
+    StaticJsonDocument<768> sw;
+    sw["name"] = prefix + "Power";
+    sw["uniq_id"] = g_state.deviceId + "_" + entityKey(channel, "power");
+    sw["cmd_t"] = powerCommandTopic(channel);  // Command topic (to receive commands)
+    sw["stat_t"] = powerStateTopic(channel);   // State topic (to report state)
+    sw["avty_t"] = availabilityTopic();        // Availability topic
+    sw["pl_avail"] = "online";                 // Payload when device is online
+    sw["pl_not_avail"] = "offline";            // Payload when device is offline
+    sw["device"] = device;                     // Link to device info
+
+    String swPayload;
+    serializeJson(sw, swPayload);
+    String swTopic = String("homeassistant/switch/") + g_state.deviceId + "/" + entityKey(channel, "power") + "/config";
+    g_mqttClient.publish(swTopic.c_str(), swPayload.c_str(), true);  // Retained
+
+    // -----------------------------------------------------------------------
+    // Reset Button Entity
+    // -----------------------------------------------------------------------
+    // This appears as a button in Home Assistant that can be pressed
+    StaticJsonDocument<768> btn;
+    btn["name"] = prefix + "Reset";
+    btn["uniq_id"] = g_state.deviceId + "_" + entityKey(channel, "reset");
+    btn["cmd_t"] = resetCommandTopic(channel);
+    btn["avty_t"] = availabilityTopic();
+    btn["pl_avail"] = "online";
+    btn["pl_not_avail"] = "offline";
+    btn["payload_press"] = "PRESS";            // What to send when button is pressed
+    btn["device"] = device;
+
+    String btnPayload;
+    serializeJson(btn, btnPayload);
+    String btnTopic = String("homeassistant/button/") + g_state.deviceId + "/" + entityKey(channel, "reset") + "/config";
+    g_mqttClient.publish(btnTopic.c_str(), btnPayload.c_str(), true);  // Retained
+  }
+
+  // ---------------------------------------------------------------------------
+  // Sensor Entities
+  // ---------------------------------------------------------------------------
+  // One per value of every I2C sensor, taken from the status JSON
+  for (size_t i = 0; i < Sensors_count(); i++) {
+    SensorStatus sensor = Sensors_status(i);
+    for (uint8_t v = 0; v < sensor.valueCount; v++) {
+      const char *quantity = Sensors_quantityName(sensor.quantities[v]);
+      String key = String(sensor.id) + "_" + quantity;
+
+      StaticJsonDocument<768> sn;
+      sn["name"] = String(sensor.model) + " 0x" + String(sensor.address, HEX) + " " + quantity;
+      sn["uniq_id"] = g_state.deviceId + "_" + key;
+      sn["stat_t"] = statusTopic();
+      sn["val_tpl"] = String("{{ value_json.sensors.") + sensor.id + "." + quantity + " }}";
+      sn["dev_cla"] = quantity;  // Quantity names are Home Assistant device classes
+      sn["unit_of_meas"] = Sensors_quantitySymbol(sensor.quantities[v]);
+      sn["stat_cla"] = "measurement";
+      sn["avty_t"] = availabilityTopic();
+      sn["pl_avail"] = "online";
+      sn["pl_not_avail"] = "offline";
+      sn["device"] = device;
+
+      String snPayload;
+      serializeJson(sn, snPayload);
+      String snTopic = String("homeassistant/sensor/") + g_state.deviceId + "/" + key + "/config";
+      g_mqttClient.publish(snTopic.c_str(), snPayload.c_str(), true);  // Retained
+    }
+  }
   
   Serial.println("Discovery published successfully");
 }
@@ -162,21 +229,35 @@ static void mqttCallback(char *topic, byte *payload, unsigned int length) {
    * Handle incoming MQTT messages.
    * 
    * Called when we receive a message on a subscribed topic.
-   * We check which topic it came from and trigger the appropriate action.
+   * We check which topic it came from and queue the appropriate action
+   * for the control task (fire-and-forget; the state topic follows).
    */
   String topicStr(topic);
   
   Serial.print("MQTT message on topic: ");
   Serial.println(topicStr);
   
-  if (topicStr == powerCommandTopic()) {
-    // Power command received - pulse the power button
-    g_pc.pulsePower();
-    WebInterface_logAction("Power pulse requested (MQTT)");
-  } else if (topicStr == resetCommandTopic()) {
-    // Reset command received - pulse the reset button
-    g_pc.pulseReset();
-    WebInterface_logAction("Reset pulse requested (MQTT)");
+  for (size_t channel = 0; channel < PcChannels_count(); channel++) {
+    String prefix = channel == 0 ? String() : "[" + PcChannels_name(channel) + "] ";
+    uint8_t target = static_cast<uint8_t>(channel);
+    if (topicStr == powerCommandTopic(channel)) {
+      // Power command received - pulse the power button
+      if (CommandQueue_submit(PcCommand::POWER_PULSE, CommandSource::MQTT, target) != 0) {
+        WebInterface_logAction((prefix + "Power pulse requested (MQTT)").c_str());
+      } else {
+        WebInterface_logAction((prefix + "Power pulse dropped (MQTT, queue full)").c_str());
+      }
+      return;
+    }
+    if (topicStr == resetCommandTopic(channel)) {
+      // Reset command received - pulse the reset button
+      if (CommandQueue_submit(PcCommand::RESET_PULSE, CommandSource::MQTT, target) != 0) {
+        WebInterface_logAction((prefix + "Reset pulse requested (MQTT)").c_str());
+      } else {
+        WebInterface_logAction((prefix + "Reset pulse dropped (MQTT, queue full)").c_str());
+      }
+      return;
+    }
   }
 }
 
@@ -184,6 +265,22 @@ static void mqttCallback(char *topic, byte *payload, unsigned int length) {
 // CONNECTION
 // =============================================================================
 
+// Socket of the open plain connection, -1 otherwise. Set by the network
+// task after a connect and cleared before the socket is closed, so the
+// control task's abort hook never touches a closed (and reused) fd.
+static std::atomic<int> s_socketFd{-1};
+
+class MqttSocketClient : public WiFiClient {
+public:
+  void stop() override {
+    // Also reached from inside PubSubClient (keepalive timeout, lost link)
+    s_socketFd.store(-1);
+    WiFiClient::stop();
+  }
+};
+
+static MqttSocketClient s_plainClient;  // Standard client for non-TLS MQTT
+
 static bool connectMqtt() {
   /**
    * Connect to the MQTT broker.
@@ -244,18 +341,29 @@ static bool connectMqtt() {
     );
   }
 
+  // A finished attempt is progress; only a hung connect counts as a stall
+  HealthMonitor_beat(Subsystem::MQTT);
+
   if (ok) {
     Serial.println("MQTT connected!");
+    if (!g_config.mqttTls) {
+      s_socketFd.store(s_plainClient.fd());
+    }
     
     // Publish "online" to availability topic
     g_mqttClient.publish(availabilityTopic().c_str(), "online", true);
     
     // Subscribe to command topics
-    g_mqttClient.subscribe(powerCommandTopic().c_str());
-    g_mqttClient.subscribe(resetCommandTopic().c_str());
+    for (size_t channel = 0; channel < PcChannels_count(); channel++) {
+      g_mqttClient.subscribe(powerCommandTopic(channel).c_str());
+      g_mqttClient.subscribe(resetCommandTopic(channel).c_str());
+    }
     
     // Publish Home Assistant discovery
     publishDiscovery();
+    
+    // Refresh retained state on the next status publish
+    StatusPublisher_markDirty(StatusField::PC_STATE | StatusField::NETWORK);
   } else {
     Serial.print("MQTT connection failed, state: ");
     Serial.println(g_mqttClient.state());
@@ -264,6 +372,44 @@ static bool connectMqtt() {
   return ok;
 }
 
+// Reconnect back-off; armed while disconnected, fires in the network task
+static Timer g_reconnectTimer;
+
+static void onReconnect(void *) {
+  if (g_state.wifiConnected && !g_mqttClient.connected()) {
+    connectMqtt();
+  }
+}
+
+static void abortStalledSocket() {
+  /**
+   * Health monitor abort hook (control task). shutdown() is safe while the
+   * network task is blocked on the same socket and makes that call return.
+   * Only the recorded fd is used: it is cleared before every close.
+   */
+  int fd = s_socketFd.load();
+  if (fd >= 0) {
+    shutdown(fd, SHUT_RDWR);
+  }
+}
+
+static void rebuildClient() {
+  /**
+   * Stall recovery (network task): drop the connection and client state,
+   * then reconnect right away. The rest of the device is untouched.
+   */
+  Serial.println("MQTT stalled - rebuilding client");
+  g_mqttClient.disconnect();
+  if (g_config.mqttTls) {
+    g_wifiClientTls.stop();
+    g_mqttClient.setClient(g_wifiClientTls);
+  } else {
+    s_plainClient.stop();
+    g_mqttClient.setClient(s_plainClient);
+  }
+  g_networkTimers.cancel(g_reconnectTimer);
+}
+
 // =============================================================================
 // SETUP
 // =============================================================================
@@ -282,11 +428,13 @@ void MqttHandler_setup() {
     Serial.println("MQTT handler initialized (TLS enabled)");
   } else {
     // Use standard client for plain MQTT
-    g_mqttClient.setClient(g_wifiClient);
+    g_mqttClient.setClient(s_plainClient);
     Serial.println("MQTT handler initialized (no TLS)");
   }
   
   g_mqttClient.setCallback(mqttCallback);
+  g_mqttClient.setBufferSize(Config::MQTT_BUFFER_SIZE);  // Status with channels, discovery
+  HealthMonitor_configure(Subsystem::MQTT, Config::MQTT_STALL_MS, abortStalledSocket);
 }
 
 // =============================================================================
@@ -300,25 +448,36 @@ void MqttHandler_loop() {
    * 
    * This function:
    *   - Skips if WiFi is not connected or MQTT is not configured
+   *   - Rebuilds the client if the health monitor reports a stall
    *   - Processes incoming messages if connected
-   *   - Attempts reconnection if disconnected (with rate limiting)
+   *   - Attempts reconnection right away, then every MQTT_RECONNECT_MS
+   *     from a timer while disconnected
    */
-  static uint32_t lastAttemptMs = 0;
-  
-  // Skip if WiFi not connected or MQTT not configured
+  // Skip if WiFi not connected or MQTT not configured (not watched then)
   if (!g_state.wifiConnected || g_config.mqttHost.length() == 0) {
+    HealthMonitor_stop(Subsystem::MQTT);
     return;
   }
+  HealthMonitor_start(Subsystem::MQTT);
+
+  if (HealthMonitor_takeRecovery(Subsystem::MQTT)) {
+    rebuildClient();
+  }
   
   // If connected, process the message loop
   if (g_mqttClient.connected()) {
-    g_mqttClient.loop();
+    if (g_reconnectTimer.armed()) {
+      g_networkTimers.cancel(g_reconnectTimer);
+    }
+    if (g_mqttClient.loop()) {
+      HealthMonitor_beat(Subsystem::MQTT);
+    }
     return;
   }
   
-  // Not connected - try to reconnect (with rate limiting)
-  if (millis() - lastAttemptMs > Config::MQTT_RECONNECT_MS) {
-    lastAttemptMs = millis();
+  // Not connected - first attempt now, retries from the timer
+  if (!g_reconnectTimer.armed()) {
+    g_networkTimers.armPeriodic(g_reconnectTimer, Config::MQTT_RECONNECT_MS, onReconnect);
     connectMqtt();
   }
 }
@@ -327,30 +486,64 @@ void MqttHandler_loop() {
 // STATE PUBLISHING
 // =============================================================================
 
+static const char *pcStateName(PCState state) {
+  return (state == PCState::OFF) ? "OFF" :
+         (state == PCState::BOOTING) ? "BOOTING" :
+         (state == PCState::RUNNING) ? "RUNNING" :
+         (state == PCState::SLEEP) ? "SLEEP" :
+         (state == PCState::UNKNOWN_BLINK) ? "UNKNOWN_BLINK" : "RESTARTING";
+}
+
 void MqttHandler_publishState() {
   /**
    * Publish current state to MQTT.
-   * Called periodically from main loop.
+   * Called by StatusPublisher on state changes and heartbeat.
    * 
    * Publishes:
    *   - Power state to power/state topic ("ON" or "OFF")
-   *   - Full status JSON to status topic
+   *   - Full status JSON to status topic (incl. network reachability,
+   *     hang watch state and sensor readings)
    */
   if (!g_mqttClient.connected()) {
     return;
   }
   
-  // Publish power state (for the Home Assistant switch)
-  const char *powerState = (g_state.pcState == PCState::OFF) ? "OFF" : "ON";
-  g_mqttClient.publish(powerStateTopic().c_str(), powerState, true);
+  StatusSnapshot s = g_statusSnapshot.read();
+
+  // Publish power state per channel (for the Home Assistant switches)
+  for (size_t channel = 0; channel < s.channelCount; channel++) {
+    const char *powerState = (s.channels[channel].pcState == PCState::OFF) ? "OFF" : "ON";
+    g_mqttClient.publish(powerStateTopic(channel).c_str(), powerState, true);
+  }
 
   // Publish full status JSON (for dashboards and automation)
-  StaticJsonDocument<256> doc;
-  doc["pcState"] = static_cast<uint8_t>(g_state.pcState);
-  doc["pcStateName"] = (g_state.pcState == PCState::OFF) ? "OFF" :
-                       (g_state.pcState == PCState::BOOTING) ? "BOOTING" :
-                       (g_state.pcState == PCState::RUNNING) ? "RUNNING" : "RESTARTING";
-  doc["wifiConnected"] = g_state.wifiConnected;
+  StaticJsonDocument<1024> doc;
+  doc["pcState"] = static_cast<uint8_t>(s.pcState);
+  doc["pcStateName"] = pcStateName(s.pcState);
+  doc["reachability"] = Reachability_name(s.reachability);
+  doc["hangState"] = HangRecovery_stateName(s.hangState);
+  doc["wifiConnected"] = s.wifiConnected;
+  if (s.channelCount > 1) {
+    JsonArray channels = doc.createNestedArray("channels");
+    for (size_t channel = 0; channel < s.channelCount; channel++) {
+      JsonObject out = channels.createNestedObject();
+      out["channel"] = channel;
+      out["name"] = PcChannels_name(channel);
+      out["pcStateName"] = pcStateName(s.channels[channel].pcState);
+    }
+  }
+  // Sensor values by sensor ID and quantity (offline = null)
+  JsonObject sensors = doc.createNestedObject("sensors");
+  for (size_t i = 0; i < s.sensorCount; i++) {
+    JsonObject values = sensors.createNestedObject(s.sensors[i].id);
+    for (uint8_t v = 0; v < s.sensors[i].valueCount; v++) {
+      values[Sensors_quantityName(s.sensors[i].quantities[v])] = s.sensors[i].values[v];
+    }
+  }
+  if (s.pcPowerDraw >= 0) {
+    doc["pcPowerWatts"] = s.pcPowerWatts;
+    doc["pcPowerDraw"] = s.pcPowerDraw == 1 ? "ON" : "OFF";
+  }
   
   String payload;
   serializeJson(doc, payload);
@@ -5,8 +5,27 @@
  * 
  * Initializes and runs the PC Restarter firmware.
  * 
- * setup() - Hardware init, WiFi, web server, MQTT
- * loop()  - Factory reset, PC state, network services, status broadcast
+ * setup() - Hardware init, WiFi, web server, MQTT, task creation
+ * loop()  - Unused; work runs in the scheduler tasks below
+ *
+ * TASKS (see TaskScheduler.h):
+ *   control   - PC actions (CommandQueue), factory reset, PC state, HDD sensing,
+ *               expander PC channels, hang recovery, subsystem stall check
+ *   network   - WiFi, web server, MQTT, status broadcast
+ *   telemetry - Metrics, Loki, heap/CPU monitoring, scheduled restart
+ *
+ * Each task owns a TimerWheel (see TimerService.h) and advances it at the
+ * start of its tick; time-based work is armed there instead of polled.
+ *
+ * HEALTH (see HealthMonitor.h):
+ *   WiFi, MQTT, Loki, OTA and WebSocket report heartbeats; a stalled one
+ *   is re-initialized on its own. The task watchdog below only resets the
+ *   device if a whole task stops running.
+ *
+ * POWER (see PowerManager.h):
+ *   The control task stretches its period while nothing is pending so the
+ *   CPU can scale down / light sleep; power LED and button edges release
+ *   it early through their ISRs.
  * 
  * =============================================================================
  */
@@ -21,10 +40,26 @@
 
 #include "Config.h"
 #include "Constants.h"
+#include "CommandQueue.h"
 #include "PCController.h"
-#include "TempSensor.h"
 #include "FactoryReset.h"
+#include "FastGpio.h"
+#include "GpioTrace.h"
+#include "HangRecovery.h"
+#include "HddActivity.h"
+#include "HealthMonitor.h"
+#include "Heartbeat.h"
+#include "I2cBus.h"
+#include "IoExpander.h"
 #include "OtaUpdate.h"
+#include "PcChannels.h"
+#include "PowerManager.h"
+#include "Profiler.h"
+#include "Reachability.h"
+#include "Sensors.h"
+#include "StatusPublisher.h"
+#include "TaskScheduler.h"
+#include "TimerService.h"
 #include "integrations/MqttHandler.h"
 #include "integrations/MetricsHandler.h"
 #include "integrations/LokiHandler.h"
@@ -37,35 +72,64 @@ constexpr uint32_t WDT_TIMEOUT_SEC = 30;        // Watchdog timeout (seconds)
 constexpr uint32_t HEAP_WARNING_THRESHOLD = 20000;  // Warn if heap below 20KB
 constexpr uint32_t HEAP_CRITICAL_THRESHOLD = 10000; // Restart if below 10KB
 
+constexpr uint32_t CONTROL_TASK_STACK = 4096;
+constexpr uint32_t NETWORK_TASK_STACK = 8192;
+constexpr uint32_t TELEMETRY_TASK_STACK = 8192;
+
 // =============================================================================
 // GLOBAL OBJECTS
 // =============================================================================
 
 StoredConfig g_config;
 RuntimeState g_state;
+SeqLock<StatusSnapshot> g_statusSnapshot;  // Cross-task view of g_state (see Constants.h)
 
 AsyncWebServer g_server(80);
 AsyncWebSocket g_ws("/ws");
-WiFiClient g_wifiClient;           // Standard client for non-TLS MQTT
 WiFiClientSecure g_wifiClientTls;  // Secure client for TLS MQTT
 PubSubClient g_mqttClient;         // Will be configured with appropriate client
 PCController g_pc;
-TempSensor g_tempSensor;
 
-bool g_restartPending = false;
-uint32_t g_restartAtMs = 0;
+// One timer wheel per scheduler task; callbacks run in the owning task
+TimerWheel g_controlTimers;
+TimerWheel g_networkTimers;
+TimerWheel g_telemetryTimers;
 
-// Latch brief HDD pulses in an ISR so activity isn't missed between loop cycles.
-static volatile bool s_hddActiveLatched = false;
-static volatile bool s_hddChangedLatched = false;
+// Scheduler index of the control task (for early release from ISRs)
+static int s_controlTaskIndex = -1;
 
+// Timestamp every HDD edge so brief pulses aren't missed between loop cycles.
+// HDD edges don't release the control task early; the ring is drained on the
+// next tick.
 static void IRAM_ATTR onHddSignalChange() {
-  s_hddChangedLatched = true;
-  const int rawHdd = digitalRead(Config::PIN_HDD_LED);
-  const bool hddActive = rawHdd == (Config::HDD_LED_ACTIVE_HIGH ? HIGH : LOW);
-  if (hddActive) {
-    s_hddActiveLatched = true;
-  }
+  PowerManager_rearmWakeFromIsr(Config::PIN_HDD_LED);
+  bool active = HddLedPin::active();  // Inlined register read, IRAM-safe
+  HddActivity_recordEdgeFromIsr(active);
+  GpioTrace_record(GpioTraceChannel::HDD_LED, active);
+}
+
+// Power LED and factory button edges need a prompt control tick
+static void IRAM_ATTR onPowerSignalChange() {
+  PowerManager_rearmWakeFromIsr(Config::PIN_PWR_LED);
+  bool active = PowerLedPin::active();
+  g_pc.recordPowerEdgeFromIsr(active);
+  GpioTrace_record(GpioTraceChannel::POWER_LED, active);
+  PowerManager_markEdgeFromIsr();
+  TaskScheduler_wakeFromIsr(static_cast<size_t>(s_controlTaskIndex));
+}
+
+// Expander INT: an expander power LED changed; the control task reads it
+static void IRAM_ATTR onExpanderInterrupt() {
+  PowerManager_rearmWakeFromIsr(static_cast<uint8_t>(Config::PIN_EXPANDER_INT));
+  IoExpander_markInterruptFromIsr();
+  PowerManager_markEdgeFromIsr();
+  TaskScheduler_wakeFromIsr(static_cast<size_t>(s_controlTaskIndex));
+}
+
+static void IRAM_ATTR onFactoryButtonChange() {
+  PowerManager_rearmWakeFromIsr(Config::PIN_FACTORY_RESET);
+  PowerManager_markEdgeFromIsr();
+  TaskScheduler_wakeFromIsr(static_cast<size_t>(s_controlTaskIndex));
 }
 
 // =============================================================================
@@ -74,9 +138,9 @@ static void IRAM_ATTR onHddSignalChange() {
 
 void Networking_setup();
 void Networking_loop();
+bool Networking_loadBootProfile(size_t channel, BootProfile &profile);
+bool Networking_saveBootProfile(size_t channel, const BootProfile &profile);
 void WebInterface_setup();
-void WebInterface_loop();
-void WebInterface_broadcastStatus();
 
 // =============================================================================
 // WATCHDOG & HEAP MONITORING
@@ -88,21 +152,14 @@ static uint32_t s_lastHeapWarnMs = 0;
 static void setupWatchdog() {
   /**
    * Initialize hardware watchdog timer.
-   * If loop() doesn't feed the WDT within timeout, device restarts.
+   * Each scheduler task subscribes itself and feeds the WDT once per tick;
+   * if any of them stops running, the device restarts.
    * API: esp_task_wdt_init(timeout_sec, panic) for Arduino ESP32 2.0.x (ESP-IDF 4.x)
    */
   esp_task_wdt_init(WDT_TIMEOUT_SEC, true);
-  esp_task_wdt_add(nullptr);  // Add current task
   Serial.printf("Watchdog enabled: %d sec timeout\n", WDT_TIMEOUT_SEC);
 }
 
-static void feedWatchdog() {
-  /**
-   * Reset watchdog timer. Must be called regularly in loop().
-   */
-  esp_task_wdt_reset();
-}
-
 static void checkHeapHealth() {
   /**
    * Monitor heap usage and take action if critically low.
@@ -135,91 +192,232 @@ static void checkHeapHealth() {
 // LOCAL HELPERS
 // =============================================================================
 
-static uint32_t s_loopTimeAccumUs = 0;
-static uint32_t s_loopCount = 0;
-static uint32_t s_lastCpuCalcMs = 0;
+static uint64_t s_lastCpuCalcMs = 0;
+static Timer s_systemStatsTimer;
+static Timer s_sensorTimer;
+static Timer s_restartTimer;
+static Timer s_bootProfileTimer;
 
 /**
- * Update PC controller and sync state to global RuntimeState
+ * Update PC controller, sync state to global RuntimeState and publish
+ * the control task's part of the status snapshot
  */
 static void updatePCState() {
-  static int s_prevRawHdd = -1;
-  g_pc.update();
-  
-  g_state.pcState = g_pc.state();
-  g_state.powerRelayActive = g_pc.powerRelayActive();
-  g_state.resetRelayActive = g_pc.resetRelayActive();
-  g_state.temperature = g_tempSensor.readTemperature();
-  
-  int rawPwr = digitalRead(Config::PIN_PWR_LED);
-  int rawHdd = digitalRead(Config::PIN_HDD_LED);
+  {
+    ProfileScope scope(ProfileStage::PC_CONTROL);
+    g_pc.update(HddActivity_stats().ratioPermille);
+    
+    g_state.pcState = g_pc.state();
+    g_state.powerRelayActive = g_pc.powerRelayActive();
+    g_state.resetRelayActive = g_pc.resetRelayActive();
+
+    // Keep full clock (and no light sleep) while a relay is closed
+    static bool s_relayHeld = false;
+    bool relayActive = g_state.powerRelayActive || g_state.resetRelayActive;
+    if (relayActive != s_relayHeld) {
+      s_relayHeld = relayActive;
+      if (relayActive) {
+        PowerManager_acquire(PowerHold::RELAY);
+      } else {
+        PowerManager_release(PowerHold::RELAY);
+      }
+    }
+  }
+  {
+    ProfileScope scope(ProfileStage::PC_CHANNELS);
+    PcChannels_update();
+  }
+  ProfileScope scope(ProfileStage::HDD_SENSE);
+  int rawPwr = PowerLedPin::level() ? HIGH : LOW;
+  int rawHdd = HddLedPin::level() ? HIGH : LOW;
   g_state.pwrLedRaw = (rawPwr == HIGH) ? 1 : 0;
   g_state.hddLedRaw = (rawHdd == HIGH) ? 1 : 0;
 
-  bool hddActive = rawHdd == (Config::HDD_LED_ACTIVE_HIGH ? HIGH : LOW);
-  bool hddLatched = false;
-  bool hddChangedLatched = false;
-  noInterrupts();
-  hddLatched = s_hddActiveLatched;
-  s_hddActiveLatched = false;
-  hddChangedLatched = s_hddChangedLatched;
-  s_hddChangedLatched = false;
-  interrupts();
-
-  const uint32_t nowMs = millis();
-  const bool hddChangedNow = (s_prevRawHdd >= 0) && (rawHdd != s_prevRawHdd);
-  if (hddChangedNow || hddChangedLatched) {
-    g_state.lastHddChangeMs = nowMs;
-  }
-  s_prevRawHdd = rawHdd;
+  HddActivity_process(rawHdd == (Config::HDD_LED_ACTIVE_HIGH ? HIGH : LOW));
+  const HddActivityStats hdd = HddActivity_stats();
+  g_state.lastHddChangeMs = hdd.lastChangeMs;
+  g_state.lastHddActiveMs = hdd.lastActiveMs;
 
-  if (hddActive || hddLatched) {
-    g_state.lastHddActiveMs = nowMs;
-  }
+  g_statusSnapshot.update([&hdd](StatusSnapshot &s) {
+    s.pcState = g_state.pcState;
+    s.powerRelayActive = g_state.powerRelayActive;
+    s.resetRelayActive = g_state.resetRelayActive;
+    s.pwrLedRaw = g_state.pwrLedRaw;
+    s.hddLedRaw = g_state.hddLedRaw;
+    s.lastHddActiveMs = g_state.lastHddActiveMs;
+    s.lastHddChangeMs = g_state.lastHddChangeMs;
+    s.hddActivityPermille = hdd.ratioPermille;
+    s.hddActivity60sPermille = hdd.ratio60sPermille;
+    s.hddEdgeRate = hdd.edgesPerSecond;
+    PcChannels_publish(s);
+  });
 }
 
 /**
- * Update ESP32 system stats (memory, CPU load)
+ * Update ESP32 system stats (memory, CPU load) and check heap health.
+ * Runs once per second from the telemetry timer wheel.
+ * CPU load is the share of wall time spent inside scheduler task ticks.
+ * Publishes the telemetry task's part of the status snapshot.
  */
-static void updateSystemStats(uint32_t loopDurationUs) {
+static void updateSystemStats(void *) {
+  ProfileScope scope(ProfileStage::HEALTH);
+  checkHeapHealth();
+
   g_state.freeHeap = ESP.getFreeHeap();
   g_state.totalHeap = ESP.getHeapSize();
   
-  s_loopTimeAccumUs += loopDurationUs;
-  s_loopCount++;
-  
-  if (millis() - s_lastCpuCalcMs >= 1000) {
-    uint32_t totalTimeUs = (millis() - s_lastCpuCalcMs) * 1000;
-    if (totalTimeUs > 0) {
-      g_state.cpuLoad = (uint8_t)((s_loopTimeAccumUs * 100) / totalTimeUs);
-      if (g_state.cpuLoad > 100) g_state.cpuLoad = 100;
+  uint64_t nowMs = TimerService_nowMs();
+  uint64_t totalTimeUs = (nowMs - s_lastCpuCalcMs) * 1000;
+  uint32_t busyUs = TaskScheduler_takeBusyUs();
+  if (totalTimeUs > 0) {
+    uint64_t load = ((uint64_t)busyUs * 100) / totalTimeUs;
+    g_state.cpuLoad = (uint8_t)(load > 100 ? 100 : load);
+  }
+  s_lastCpuCalcMs = nowMs;
+
+  int8_t rssi = WiFi.isConnected() ? static_cast<int8_t>(WiFi.RSSI()) : 0;
+  g_statusSnapshot.update([rssi](StatusSnapshot &s) {
+    s.freeHeap = g_state.freeHeap;
+    s.totalHeap = g_state.totalHeap;
+    s.cpuLoad = g_state.cpuLoad;
+    s.rssi = rssi;
+  });
+}
+
+static void restartNow(void *) {
+  Serial.println("Restarting to apply new configuration...");
+  ESP.restart();
+}
+
+/**
+ * Restart the device after `delayMs` (e.g. after a config save, so the
+ * HTTP response can still be sent). Safe to call from any task.
+ */
+void scheduleRestart(uint32_t delayMs) {
+  g_telemetryTimers.arm(s_restartTimer, delayMs, restartNow);
+}
+
+/**
+ * Read the I2C sensors that are due (SENSOR_TICK_MS) from the telemetry
+ * timer wheel, so sensor traffic never runs in the control task.
+ */
+static void sampleSensors(void *) {
+  ProfileScope scope(ProfileStage::SENSORS);
+  Sensors_sample();
+}
+
+/**
+ * Persist each channel's learned boot profile after each learned boot.
+ * NVS writes can stall for milliseconds, so they stay out of the control
+ * task.
+ */
+static void saveBootProfile(void *) {
+  static uint32_t s_savedRevision[Config::PC_CHANNELS_MAX] = {};
+  for (size_t channel = 0; channel < PcChannels_count(); channel++) {
+    BootLearnerStatus boot = PcChannels_get(channel)->boot().status();
+    if (boot.revision != s_savedRevision[channel] && Networking_saveBootProfile(channel, boot.profile)) {
+      s_savedRevision[channel] = boot.revision;
     }
-    s_loopTimeAccumUs = 0;
-    s_loopCount = 0;
-    s_lastCpuCalcMs = millis();
   }
 }
 
+// =============================================================================
+// TASK BODIES
+// =============================================================================
+
 /**
- * Broadcast status to WebSocket and MQTT at configured interval
+ * Pick the control task's next period: fast while a power LED debounce is
+ * in progress, otherwise stretched up to the idle period (but never past
+ * the next control timer or expander poll). Relay pulses don't need the
+ * fast period; their release runs on esp_timer one-shots (see
+ * PCController.h).
  */
-static void broadcastStatus() {
-  static uint32_t lastMs = 0;
-  if (millis() - lastMs > Config::STATUS_BROADCAST_MS) {
-    lastMs = millis();
-    WebInterface_broadcastStatus();
-    MqttHandler_publishState();
+static void adaptControlPeriod() {
+  uint32_t periodMs = Config::CONTROL_TASK_PERIOD_MS;
+  bool busy = g_pc.powerSignalSettling() || PcChannels_settling();
+  if (!busy) {
+    uint32_t untilTimerMs = g_controlTimers.msUntilNext();
+    uint32_t untilPollMs = PcChannels_msUntilPoll();
+    if (untilPollMs < untilTimerMs) {
+      untilTimerMs = untilPollMs;
+    }
+    periodMs = untilTimerMs < Config::CONTROL_TASK_IDLE_PERIOD_MS ? untilTimerMs
+                                                                  : Config::CONTROL_TASK_IDLE_PERIOD_MS;
+    if (periodMs < Config::CONTROL_TASK_PERIOD_MS) {
+      periodMs = Config::CONTROL_TASK_PERIOD_MS;
+    }
   }
+  TaskScheduler_setPeriodMs(static_cast<size_t>(s_controlTaskIndex), periodMs);
 }
 
 /**
- * Handle scheduled restart (after config save)
+ * Control task: everything that touches the PC front panel.
+ * Highest priority - must never wait on the network.
  */
-static void handleScheduledRestart() {
-  if (g_restartPending && millis() > g_restartAtMs) {
-    Serial.println("Restarting to apply new configuration...");
-    ESP.restart();
+static void controlTick() {
+  PowerManager_recordWake();
+  g_controlTimers.advance();
+  {
+    ProfileScope scope(ProfileStage::COMMANDS);
+    CommandQueue_drain();
+  }
+  {
+    ProfileScope scope(ProfileStage::FACTORY_RESET);
+    FactoryReset_loop();
   }
+  updatePCState();
+  adaptControlPeriod();
+}
+
+/**
+ * Network task: WiFi, web server housekeeping, MQTT, PC reachability probes
+ * and status broadcast.
+ * MQTT publishing stays here because PubSubClient is not thread-safe.
+ */
+static void networkTick() {
+  g_networkTimers.advance();
+  {
+    ProfileScope scope(ProfileStage::NETWORKING);
+    Networking_loop();
+  }
+  {
+    ProfileScope scope(ProfileStage::MQTT);
+    MqttHandler_loop();
+  }
+  {
+    ProfileScope scope(ProfileStage::REACHABILITY);
+    Reachability_loop();
+  }
+  {
+    ProfileScope scope(ProfileStage::STATUS_PUBLISH);
+    StatusPublisher_loop();
+  }
+}
+
+/**
+ * Telemetry task: slow or blocking reporting work (Loki HTTP POST),
+ * health monitoring, I2C sensor sampling, boot profile saves (NVS) and
+ * the scheduled restart. Loki pushes, system stats, sensor batches,
+ * profile saves and the restart are timers on g_telemetryTimers.
+ */
+static void telemetryTick() {
+  g_telemetryTimers.advance();
+  MetricsHandler_loop();
+}
+
+static void setupTasks() {
+  s_controlTaskIndex = TaskScheduler_addTask({"control", controlTick,
+                                              Config::CONTROL_TASK_PERIOD_MS, Config::CONTROL_TASK_DEADLINE_MS,
+                                              CONTROL_TASK_STACK, Config::CONTROL_TASK_PRIORITY});
+  CommandQueue_setConsumerTask(s_controlTaskIndex);
+  PCController::setControlTask(s_controlTaskIndex);
+  TaskScheduler_addTask({"network", networkTick,
+                         Config::NETWORK_TASK_PERIOD_MS, Config::NETWORK_TASK_DEADLINE_MS,
+                         NETWORK_TASK_STACK, Config::NETWORK_TASK_PRIORITY});
+  TaskScheduler_addTask({"telemetry", telemetryTick,
+                         Config::TELEMETRY_TASK_PERIOD_MS, Config::TELEMETRY_TASK_DEADLINE_MS,
+                         TELEMETRY_TASK_STACK, Config::TELEMETRY_TASK_PRIORITY});
+  TaskScheduler_start();
 }
 
 // =============================================================================
@@ -232,24 +430,61 @@ void setup() {
   Serial.printf("Firmware: %s\n", Config::FW_VERSION);
   Serial.printf("Free heap: %u bytes\n", ESP.getFreeHeap());
   
-  // Watchdog
+  // Watchdog, diagnostics, power & timers
   setupWatchdog();
+  Profiler_setup();
+  PowerManager_setup();
+  g_controlTimers.begin();
+  g_networkTimers.begin();
+  g_telemetryTimers.begin();
+  HealthMonitor_setup();
   
   // Hardware
   g_pc.begin();
-  g_tempSensor.begin(0, 1);
+  CommandQueue_setup();
+  I2cBus_setup();
+  Sensors_setup();
+  PcChannels_setup();
+  HddActivity_setup(HddLedPin::active());
   attachInterrupt(digitalPinToInterrupt(Config::PIN_HDD_LED), onHddSignalChange, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(Config::PIN_PWR_LED), onPowerSignalChange, CHANGE);
   FactoryReset_setup();
+  attachInterrupt(digitalPinToInterrupt(Config::PIN_FACTORY_RESET), onFactoryButtonChange, CHANGE);
+  PowerManager_enableGpioWake(Config::PIN_HDD_LED);
+  PowerManager_enableGpioWake(Config::PIN_PWR_LED);
+  PowerManager_enableGpioWake(Config::PIN_FACTORY_RESET);
+  if (Config::PIN_EXPANDER_INT >= 0 && IoExpander_present()) {
+    pinMode(Config::PIN_EXPANDER_INT, INPUT_PULLUP);  // Open-drain INT
+    attachInterrupt(digitalPinToInterrupt(Config::PIN_EXPANDER_INT), onExpanderInterrupt, FALLING);
+    PowerManager_enableGpioWake(Config::PIN_EXPANDER_INT);
+  }
   
   // Network & Services
   Networking_setup();
+  for (size_t channel = 0; channel < PcChannels_count(); channel++) {
+    BootProfile bootProfile;
+    if (Networking_loadBootProfile(channel, bootProfile)) {
+      PcChannels_get(channel)->setBootProfile(bootProfile);
+    }
+  }
   WebInterface_setup();
   OtaUpdate_setup();
+  Reachability_setup();
+  Heartbeat_setup();
+  HangRecovery_setup();
   
   // Integrations
   MqttHandler_setup();
   MetricsHandler_setup();
   LokiHandler_setup();
+  StatusPublisher_setup();
+  
+  // Periodic work
+  s_lastCpuCalcMs = TimerService_nowMs();
+  g_telemetryTimers.armPeriodic(s_systemStatsTimer, 1000, updateSystemStats);
+  g_telemetryTimers.armPeriodic(s_sensorTimer, Config::SENSOR_TICK_MS, sampleSensors);
+  g_telemetryTimers.armPeriodic(s_bootProfileTimer, Config::BOOT_PROFILE_SAVE_MS, saveBootProfile);
+  setupTasks();
   
   Serial.printf("Setup complete. Free heap: %u bytes\n", ESP.getFreeHeap());
   Serial.println("=== Running ===\n");
@@ -260,27 +495,7 @@ void setup() {
 // =============================================================================
 
 void loop() {
-  uint32_t loopStartUs = micros();
-
-  // Feed watchdog first
-  feedWatchdog();
-  
-  // Core functionality
-  FactoryReset_loop();
-  updatePCState();
-  
-  Networking_loop();
-  WebInterface_loop();
-  MqttHandler_loop();
-  MetricsHandler_loop();
-  LokiHandler_loop();
-  
-  broadcastStatus();
-  handleScheduledRestart();
-  
-  // Health monitoring
-  checkHeapHealth();
-  updateSystemStats(micros() - loopStartUs);
-  
-  delay(5);  // Yield to RTOS, prevents 100% CPU
+  // All periodic work runs in the scheduler tasks; the Arduino loop task
+  // is no longer needed and gives its stack back to the heap.
+  vTaskDelete(nullptr);
 }
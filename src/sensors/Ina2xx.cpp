@@ -0,0 +1,91 @@
+/**
+ * =============================================================================
+ * Ina2xx.cpp - INA219/INA226 Current and Power Monitor Implementation
+ * =============================================================================
+ *
+ * REGISTERS (16 bit, MSB first):
+ *   0x00 Configuration   0x01 Shunt voltage (signed)   0x02 Bus voltage
+ *   INA226 only: 0xFE Manufacturer ID   0xFF Die ID
+ *
+ * CONFIGURATION:
+ *   INA226  0x4527  16 averages, 1.1 ms shunt/bus conversion, continuous
+ *                   (one result every ~35 ms)
+ *   INA219  0x3FFF  32 V range, ±320 mV shunt, 128-sample averaging,
+ *                   continuous (one result every ~136 ms)
+ *
+ * INA219 BUS VOLTAGE: bits 15:3 = value (4 mV), bit 1 CNVR, bit 0 OVF.
+ *
+ * =============================================================================
+ */
+
+#include "Config.h"
+#include "sensors/Ina2xx.h"
+
+static constexpr uint8_t REG_CONFIG = 0x00;
+static constexpr uint8_t REG_SHUNT_VOLTAGE = 0x01;
+static constexpr uint8_t REG_BUS_VOLTAGE = 0x02;
+static constexpr uint8_t REG_MANUFACTURER_ID = 0xFE;
+static constexpr uint8_t REG_DIE_ID = 0xFF;
+
+static constexpr uint16_t INA226_MANUFACTURER_TI = 0x5449;
+static constexpr uint16_t INA226_DIE = 0x226;   // Die ID bits 15:4
+static constexpr uint16_t INA226_CONFIG = 0x4527;
+static constexpr uint16_t INA219_CONFIG = 0x3FFF;
+
+static constexpr float INA226_SHUNT_LSB_V = 2.5e-6f;
+static constexpr float INA226_BUS_LSB_V = 1.25e-3f;
+static constexpr float INA219_SHUNT_LSB_V = 10e-6f;
+static constexpr float INA219_BUS_LSB_V = 4e-3f;
+
+// =============================================================================
+// DETECTION & CONFIGURATION
+// =============================================================================
+
+bool Ina2xx::detectIna226(uint8_t address) {
+  uint16_t manufacturer = 0;
+  uint16_t die = 0;
+  return I2cBus_readRegister16(address, REG_MANUFACTURER_ID, manufacturer) &&
+         manufacturer == INA226_MANUFACTURER_TI &&
+         I2cBus_readRegister16(address, REG_DIE_ID, die) &&
+         (die >> 4) == INA226_DIE;
+}
+
+bool Ina2xx::detectIna219(uint8_t address) {
+  uint16_t config = 0;
+  uint16_t bus = 0;
+  return I2cBus_readRegister16(address, REG_CONFIG, config) && (config & 0xC000) == 0 &&
+         I2cBus_readRegister16(address, REG_BUS_VOLTAGE, bus) && (bus & 0x0004) == 0;
+}
+
+bool Ina2xx::configure() {
+  uint16_t config = _variant == Variant::INA226 ? INA226_CONFIG : INA219_CONFIG;
+  return I2cBus_writeRegister16(_address, REG_CONFIG, config);
+}
+
+// =============================================================================
+// MEASUREMENT
+// =============================================================================
+
+bool Ina2xx::read(float *values) {
+  uint16_t shunt = 0;
+  uint16_t bus = 0;
+  if (!I2cBus_readRegister16(_address, REG_SHUNT_VOLTAGE, shunt) ||
+      !I2cBus_readRegister16(_address, REG_BUS_VOLTAGE, bus)) {
+    return false;
+  }
+
+  float shuntVolts;
+  float busVolts;
+  if (_variant == Variant::INA226) {
+    shuntVolts = static_cast<int16_t>(shunt) * INA226_SHUNT_LSB_V;
+    busVolts = bus * INA226_BUS_LSB_V;
+  } else {
+    shuntVolts = static_cast<int16_t>(shunt) * INA219_SHUNT_LSB_V;
+    busVolts = (bus >> 3) * INA219_BUS_LSB_V;
+  }
+  float amps = shuntVolts / Config::POWER_SHUNT_OHMS;
+  values[0] = busVolts;
+  values[1] = amps;
+  values[2] = busVolts * amps;
+  return true;
+}
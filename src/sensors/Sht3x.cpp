@@ -0,0 +1,92 @@
+/**
+ * =============================================================================
+ * Sht3x.cpp - SHT3x Humidity Sensor Implementation
+ * =============================================================================
+ *
+ * COMMANDS (16 bit, MSB first):
+ *   0x2130  Periodic mode, 1 mps, high repeatability
+ *   0xE000  Fetch data: T (2) CRC (1) RH (2) CRC (1)
+ *   0x3093  Break (stop periodic mode)
+ *   0xF32D  Read status register: status (2) CRC (1)
+ *
+ * CONVERSION:
+ *   T  = -45 + 175 * raw / 65535  [°C]
+ *   RH = 100 * raw / 65535        [%]
+ *
+ * CRC-8: polynomial 0x31, init 0xFF, over the two data bytes.
+ *
+ * =============================================================================
+ */
+
+#include "Config.h"
+#include "sensors/Sht3x.h"
+
+static constexpr uint16_t CMD_PERIODIC_1MPS_HIGH = 0x2130;
+static constexpr uint16_t CMD_FETCH_DATA = 0xE000;
+static constexpr uint16_t CMD_BREAK = 0x3093;
+static constexpr uint16_t CMD_READ_STATUS = 0xF32D;
+
+static constexpr uint32_t BREAK_TIME_US = 1000;  // Until the next command is accepted
+
+static bool sendCommand(uint8_t address, uint16_t command) {
+  uint8_t data[2] = {static_cast<uint8_t>(command >> 8), static_cast<uint8_t>(command & 0xFF)};
+  return I2cBus_write(address, data, sizeof(data));
+}
+
+static uint8_t crc8(const uint8_t *data, size_t length) {
+  uint8_t crc = 0xFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static bool wordValid(const uint8_t *word) {
+  return crc8(word, 2) == word[2];
+}
+
+static uint16_t wordValue(const uint8_t *word) {
+  return static_cast<uint16_t>((word[0] << 8) | word[1]);
+}
+
+// =============================================================================
+// DETECTION & CONFIGURATION
+// =============================================================================
+
+bool Sht3x::detect(uint8_t address) {
+  if (!sendCommand(address, CMD_BREAK)) {
+    return false;
+  }
+  delayMicroseconds(BREAK_TIME_US);
+  uint8_t status[3];
+  return sendCommand(address, CMD_READ_STATUS) &&
+         I2cBus_read(address, status, sizeof(status)) &&
+         wordValid(status);
+}
+
+bool Sht3x::configure() {
+  return sendCommand(_address, CMD_PERIODIC_1MPS_HIGH);
+}
+
+// =============================================================================
+// MEASUREMENT
+// =============================================================================
+
+bool Sht3x::read(float *values) {
+  /**
+   * A CRC error counts as a failed read like a NACK; a corrupted word
+   * never reaches the published value.
+   */
+  uint8_t data[6];
+  if (!sendCommand(_address, CMD_FETCH_DATA) ||
+      !I2cBus_read(_address, data, sizeof(data)) ||
+      !wordValid(&data[0]) || !wordValid(&data[3])) {
+    return false;
+  }
+  values[0] = -45.0f + 175.0f * wordValue(&data[0]) / 65535.0f;
+  values[1] = 100.0f * wordValue(&data[3]) / 65535.0f;
+  return true;
+}
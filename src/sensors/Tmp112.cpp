@@ -0,0 +1,132 @@
+/**
+ * =============================================================================
+ * Tmp112.cpp - TMP112 Temperature Sensor Implementation
+ * =============================================================================
+ *
+ * TMP112 REGISTER MAP:
+ *   - 0x00: Temperature Register (read-only)
+ *   - 0x01: Configuration Register
+ *   - 0x02: Low Temperature Threshold
+ *   - 0x03: High Temperature Threshold
+ *
+ * TEMPERATURE FORMAT:
+ *   - 12-bit resolution, left-aligned in 16-bit register
+ *   - Resolution: 0.0625°C per LSB
+ *   - Two's complement for negative temperatures
+ *
+ * CONFIGURATION REGISTER (MSB first):
+ *   [OS R1 R0 F1 F0 POL TM SD] [CR1 CR0 AL EM 0 0 0 0]
+ *   CR1:CR0 = conversion rate (00 = 0.25 Hz, 01 = 1 Hz, 10 = 4 Hz, 11 = 8 Hz)
+ *
+ * =============================================================================
+ */
+
+#include "Config.h"
+#include "sensors/Tmp112.h"
+
+static constexpr uint8_t REG_TEMPERATURE = 0x00;
+static constexpr uint8_t REG_CONFIG = 0x01;
+static constexpr uint8_t REG_T_LOW = 0x02;
+static constexpr uint8_t REG_T_HIGH = 0x03;
+
+// Two faults in a row before ALERT changes, comparator mode, ALERT active low
+static constexpr uint16_t CONFIG_BASE = 0x6800;
+
+// Bits that read the same on every TMP112: R1:R0 = 11, low nibble = 0000
+static constexpr uint16_t CONFIG_FIXED_MASK = 0x600F;
+static constexpr uint16_t CONFIG_FIXED_VALUE = 0x6000;
+
+static uint16_t conversionRateBits(uint32_t intervalMs) {
+  // Slowest rate that still converts at least once per sample interval
+  if (intervalMs >= 4000) return 0x0000;  // 0.25 Hz
+  if (intervalMs >= 1000) return 0x0040;  // 1 Hz
+  if (intervalMs >= 250) return 0x0080;   // 4 Hz
+  return 0x00C0;                          // 8 Hz
+}
+
+static uint16_t celsiusToRegister(float celsius) {
+  int16_t counts = static_cast<int16_t>(celsius / 0.0625f);
+  return static_cast<uint16_t>(counts << 4);
+}
+
+static float registerToCelsius(uint16_t value) {
+  // 12-bit left-aligned two's complement; arithmetic shift keeps the sign
+  return (static_cast<int16_t>(value) >> 4) * 0.0625f;
+}
+
+// =============================================================================
+// DETECTION & CONFIGURATION
+// =============================================================================
+
+bool Tmp112::detect(uint8_t address) {
+  uint16_t config = 0;
+  return I2cBus_readRegister16(address, REG_CONFIG, config) &&
+         (config & CONFIG_FIXED_MASK) == CONFIG_FIXED_VALUE;
+}
+
+bool Tmp112::configure() {
+  /**
+   * Program conversion rate and ALERT thresholds, and restart the filter
+   * (the sensor may have been offline for a while).
+   * @return true if the sensor acknowledged every write
+   */
+  _windowFill = 0;
+  _filtered = NAN;
+  uint16_t config = CONFIG_BASE | conversionRateBits(Config::TEMP_SAMPLE_INTERVAL_MS);
+  return I2cBus_writeRegister16(_address, REG_CONFIG, config) &&
+         I2cBus_writeRegister16(_address, REG_T_LOW, celsiusToRegister(Config::TEMP_ALERT_LOW_C)) &&
+         I2cBus_writeRegister16(_address, REG_T_HIGH, celsiusToRegister(Config::TEMP_ALERT_HIGH_C));
+}
+
+// =============================================================================
+// TEMPERATURE READING
+// =============================================================================
+
+bool Tmp112::read(float *values) {
+  /**
+   * Read the temperature register (0x00): 2 bytes, MSB first.
+   *
+   * DATA FORMAT:
+   *   The temperature is stored as a 12-bit value, left-aligned
+   *   in a 16-bit register. We need to shift right by 4 bits.
+   *
+   *   MSB                 LSB
+   *   [D11 D10 D9 D8 D7 D6 D5 D4] [D3 D2 D1 D0 X X X X]
+   *
+   *   Combined and shifted: (MSB << 8 | LSB) >> 4
+   */
+  uint16_t value = 0;
+  if (!I2cBus_readRegister16(_address, REG_TEMPERATURE, value)) {
+    return false;
+  }
+  _filtered = filter(registerToCelsius(value));
+  values[0] = _filtered;
+  return true;
+}
+
+// =============================================================================
+// FILTERING
+// =============================================================================
+
+float Tmp112::filter(float celsius) {
+  /**
+   * Median of the last three samples, then EWMA. The median drops a
+   * single corrupted read instead of letting the EWMA smear it out.
+   */
+  _window[_windowPos] = celsius;
+  _windowPos = (_windowPos + 1) % 3;
+  if (_windowFill < 3) _windowFill++;
+
+  float median = celsius;
+  if (_windowFill == 3) {
+    float a = _window[0];
+    float b = _window[1];
+    float c = _window[2];
+    median = fmaxf(fminf(a, b), fminf(fmaxf(a, b), c));
+  }
+
+  if (isnan(_filtered)) {
+    return median;
+  }
+  return _filtered + Config::TEMP_EWMA_ALPHA * (median - _filtered);
+}
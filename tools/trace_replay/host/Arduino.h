@@ -0,0 +1,97 @@
+/**
+ * =============================================================================
+ * Arduino.h - Host Shim for tools/trace_replay
+ * =============================================================================
+ *
+ * Just enough of the Arduino-ESP32 API to compile the front panel logic
+ * (PCController, PowerLedClassifier, HddActivity) on Linux. There is one
+ * thread, so critical sections are no-ops; time comes from the replay's
+ * virtual clock (esp_timer.h).
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "esp_attr.h"
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+// FreeRTOS critical sections (single-threaded replay)
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+#define portENTER_CRITICAL_SAFE(mux) ((void)(mux))
+#define portEXIT_CRITICAL_SAFE(mux) ((void)(mux))
+
+// FreeRTOS types used by Config.h
+typedef unsigned int UBaseType_t;
+
+inline void pinMode(uint8_t, uint8_t) {}
+
+/**
+ * Arduino String, only what the compiled sources use.
+ */
+class String {
+public:
+  String() {}
+  String(const char *text) : s_(text ? text : "") {}
+  String(int value) : s_(std::to_string(value)) {}
+  String(unsigned value) : s_(std::to_string(value)) {}
+  String(unsigned long value) : s_(std::to_string(value)) {}
+  String(double value, unsigned decimals = 2) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", static_cast<int>(decimals), value);
+    s_ = buf;
+  }
+
+  const char *c_str() const { return s_.c_str(); }
+  size_t length() const { return s_.size(); }
+  String &operator+=(const String &other) { s_ += other.s_; return *this; }
+  String &operator+=(const char *other) { s_ += other; return *this; }
+  friend String operator+(String a, const String &b) { a += b; return a; }
+  friend String operator+(String a, const char *b) { a += b; return a; }
+
+private:
+  std::string s_;
+};
+
+/**
+ * Firmware log output. The replay tool sets the prefix (virtual time) and
+ * can mute it (--quiet).
+ */
+class HostSerial {
+public:
+  bool enabled = true;
+  const char *(*prefix)() = nullptr;
+
+  void println(const char *text) { printf("%s\n", text); }  // Member printf (prefix, mute)
+
+  void printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+    if (!enabled) return;
+    if (prefix) fputs(prefix(), stdout);
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+  }
+};
+
+extern HostSerial Serial;
@@ -0,0 +1,9 @@
+/**
+ * esp_attr.h - Host Shim for tools/trace_replay
+ */
+
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define FORCE_INLINE_ATTR static inline __attribute__((always_inline))
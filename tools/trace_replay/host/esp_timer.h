@@ -0,0 +1,44 @@
+/**
+ * =============================================================================
+ * esp_timer.h - Host Shim for tools/trace_replay
+ * =============================================================================
+ *
+ * esp_timer_get_time() returns the replay's virtual clock. One-shot timers
+ * cannot be armed, so PCController releases relays by polling (the replay
+ * never presses them anyway).
+ *
+ * =============================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void *arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char *name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+extern int64_t g_virtualTimeUs;
+
+inline int64_t esp_timer_get_time() { return g_virtualTimeUs; }
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t *, esp_timer_handle_t *out) {
+  static int s_dummy;
+  *out = reinterpret_cast<esp_timer_handle_t>(&s_dummy);
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t, uint64_t) { return ESP_FAIL; }
+inline esp_err_t esp_timer_stop(esp_timer_handle_t) { return ESP_OK; }
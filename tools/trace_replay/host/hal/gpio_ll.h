@@ -0,0 +1,21 @@
+/**
+ * hal/gpio_ll.h - Host Shim for tools/trace_replay
+ */
+
+#pragma once
+
+#include "soc/gpio_struct.h"
+
+typedef int gpio_num_t;
+
+static inline int gpio_ll_get_level(gpio_dev_t *hw, gpio_num_t gpio) {
+  return (hw->in >> gpio) & 1;
+}
+
+static inline void gpio_ll_set_level(gpio_dev_t *hw, gpio_num_t gpio, uint32_t level) {
+  if (level) {
+    hw->out |= 1u << gpio;
+  } else {
+    hw->out &= ~(1u << gpio);
+  }
+}
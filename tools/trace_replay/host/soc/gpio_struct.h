@@ -0,0 +1,14 @@
+/**
+ * soc/gpio_struct.h - Host Shim for tools/trace_replay
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t in;    // Input levels, set by the replay from the trace
+  uint32_t out;   // Output levels written by the firmware
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
@@ -0,0 +1,326 @@
+/**
+ * =============================================================================
+ * trace_replay.cpp - Replay a GPIO Trace Through the Firmware Logic (Linux)
+ * =============================================================================
+ *
+ * Feeds a trace from GET /api/debug/trace through the unmodified firmware
+ * sources - PCController::update() with its PowerLedClassifier and
+ * BootLearner, and the HDD activity tracker - on a virtual clock. Edges are delivered as the
+ * interrupts would deliver them, and the control task is ticked with its
+ * real adaptive period (CONTROL_TASK_PERIOD_MS while settling, otherwise
+ * CONTROL_TASK_IDLE_PERIOD_MS). An hour of trace replays in milliseconds.
+ *
+ * BUILD (from the repository root):
+ *
+ *   g++ -std=gnu++11 -O2 -Wall -Itools/trace_replay/host -Iinclude \
+ *       tools/trace_replay/trace_replay.cpp src/PCController.cpp \
+ *       src/PowerLedClassifier.cpp src/BootLearner.cpp src/BootTimeline.cpp \
+ *       src/HddActivity.cpp src/GpioTrace.cpp -o trace_replay
+ *
+ * USAGE:
+ *
+ *   curl -u admin:PASSWORD -o trace.bin http://restarter-xxxx.local/api/debug/trace
+ *   ./trace_replay trace.bin                  # state changes + summary
+ *   ./trace_replay --edges trace.bin          # also print every edge
+ *   ./trace_replay --boot-grace-ms 30000 trace.bin
+ *
+ * To tune the classifier or the boot learner, change the POWER_LED_* or
+ * BOOT_* constants in Config.h, rebuild and replay the same trace again.
+ * The replay starts with nothing learned (bootGraceMs is the ceiling).
+ *
+ * Relay edges are printed for context only: the replay does not press
+ * relays, so RESTARTING never appears in the replayed states.
+ *
+ * =============================================================================
+ */
+
+#include <chrono>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "Config.h"
+#include "Constants.h"
+#include "GpioTrace.h"
+#include "HddActivity.h"
+#include "PCController.h"
+
+// Host shim state (see host/)
+int64_t g_virtualTimeUs = 0;
+gpio_dev_t GPIO = {};
+HostSerial Serial;
+
+// Firmware globals used by the compiled sources
+StoredConfig g_config;
+PCController g_pc;
+
+// Traces cover channel 0 only; no expander on the host
+bool IoExpander_setOutput(uint8_t, bool) { return false; }
+uint16_t IoExpander_levels() { return 0; }
+bool IoExpander_outputWritten(uint8_t, bool, int64_t &) { return false; }
+
+// The replay ticks the control task itself; nothing to wake
+void TaskScheduler_wake(size_t) {}
+
+static int64_t s_startUs = 0;
+
+static const char *virtualTimePrefix() {
+  static char buf[32];
+  snprintf(buf, sizeof(buf), "%12.6f  fw         ", (g_virtualTimeUs - s_startUs) / 1e6);
+  return buf;
+}
+
+static const char *pcStateName(PCState state) {
+  switch (state) {
+    case PCState::OFF:           return "OFF";
+    case PCState::BOOTING:       return "BOOTING";
+    case PCState::RUNNING:       return "RUNNING";
+    case PCState::RESTARTING:    return "RESTARTING";
+    case PCState::SLEEP:         return "SLEEP";
+    case PCState::UNKNOWN_BLINK: return "UNKNOWN_BLINK";
+  }
+  return "?";
+}
+
+static constexpr size_t PC_STATE_COUNT = 6;
+
+// =============================================================================
+// TRACE FILE
+// =============================================================================
+
+static bool loadTrace(const char *path, GpioTraceHeader &header, std::vector<GpioTraceRecord> &records) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    return false;
+  }
+  bool ok = fread(&header, sizeof(header), 1, file) == 1;
+  if (ok && (memcmp(header.magic, "RTRC", 4) != 0 || header.version != GPIO_TRACE_VERSION ||
+             header.recordSize != sizeof(GpioTraceRecord))) {
+    fprintf(stderr, "%s: not a version %u GPIO trace\n", path, GPIO_TRACE_VERSION);
+    ok = false;
+  }
+  if (ok) {
+    records.resize(header.recordCount);
+    ok = header.recordCount == 0 ||
+         fread(records.data(), sizeof(GpioTraceRecord), header.recordCount, file) == header.recordCount;
+    if (!ok) fprintf(stderr, "%s: truncated\n", path);
+  }
+  fclose(file);
+  return ok;
+}
+
+static int64_t recordTimeUs(const GpioTraceRecord &record) {
+  return static_cast<int64_t>((static_cast<uint64_t>(record.timeHi) << 32) | record.timeLo);
+}
+
+// =============================================================================
+// VIRTUAL HARDWARE
+// =============================================================================
+
+static void setInput(uint8_t pin, bool activeHigh, bool active) {
+  bool high = active == activeHigh;
+  if (high) {
+    GPIO.in |= 1u << pin;
+  } else {
+    GPIO.in &= ~(1u << pin);
+  }
+}
+
+struct ReplayStats {
+  uint32_t transitions[PC_STATE_COUNT] = {};
+  int64_t timeInStateUs[PC_STATE_COUNT] = {};
+  uint32_t ticks = 0;
+};
+
+static ReplayStats s_stats;
+static PCState s_lastState = PCState::OFF;
+static int64_t s_lastStateUs = 0;
+
+static void controlTick() {
+  /**
+   * The parts of the control task that see the front panel inputs.
+   */
+  g_pc.update(HddActivity_stats().ratioPermille);
+  HddActivity_process(HddLedPin::active());
+  s_stats.ticks++;
+
+  PCState state = g_pc.state();
+  if (state != s_lastState) {
+    int64_t nowUs = g_virtualTimeUs;
+    s_stats.timeInStateUs[static_cast<size_t>(s_lastState)] += nowUs - s_lastStateUs;
+    s_stats.transitions[static_cast<size_t>(state)]++;
+    printf("%12.6f  state      %-13s (power LED: %s", (nowUs - s_startUs) / 1e6, pcStateName(state),
+           powerLedSignalName(g_pc.powerLed().signal()));
+    if (state == PCState::SLEEP || state == PCState::UNKNOWN_BLINK) {
+      printf(", period %u ms, duty %u%%", g_pc.powerLed().blinkPeriodMs(),
+             g_pc.powerLed().blinkDutyPermille() / 10);
+    }
+    printf(")\n");
+    s_lastState = state;
+    s_lastStateUs = nowUs;
+  }
+}
+
+static int64_t tickPeriodUs() {
+  uint32_t periodMs = g_pc.powerSignalSettling() ? Config::CONTROL_TASK_PERIOD_MS
+                                                 : Config::CONTROL_TASK_IDLE_PERIOD_MS;
+  return static_cast<int64_t>(periodMs) * 1000;
+}
+
+// =============================================================================
+// SUMMARY
+// =============================================================================
+
+static void printHistogram(const char *name, const LatencyHistogram &h) {
+  if (h.count() == 0) return;
+  printf("  %-22s n=%-5u mean=%8.1f ms  p95<=%8.1f ms  max=%8.1f ms\n", name, h.count(),
+         h.meanUs() / 1000.0, h.percentileUs(95) / 1000.0, h.maxUs() / 1000.0);
+}
+
+static void printSummary(int64_t endUs, double wallSeconds) {
+  s_stats.timeInStateUs[static_cast<size_t>(s_lastState)] += endUs - s_lastStateUs;
+  double traceSeconds = (endUs - s_startUs) / 1e6;
+
+  printf("\nReplayed %.3f s of trace in %.3f s (%u control ticks)\n", traceSeconds, wallSeconds,
+         s_stats.ticks);
+  printf("\nPC states:\n");
+  for (size_t i = 0; i < PC_STATE_COUNT; i++) {
+    if (s_stats.transitions[i] == 0 && s_stats.timeInStateUs[i] == 0) continue;
+    printf("  %-13s entered %4u x, %10.3f s\n", pcStateName(static_cast<PCState>(i)),
+           s_stats.transitions[i], s_stats.timeInStateUs[i] / 1e6);
+  }
+
+  printf("\nPower LED classification latency:\n");
+  for (size_t i = 0; i < POWER_LED_SIGNAL_COUNT; i++) {
+    PowerLedSignal signal = static_cast<PowerLedSignal>(i);
+    printHistogram(powerLedSignalName(signal), g_pc.powerLed().latency(signal));
+  }
+
+  HddActivityStats hdd = HddActivity_stats();
+  printf("\nHDD LED:\n");
+  printf("  edges %u, bursts %u, activity last 60 s %.1f%%\n", hdd.edgesTotal, hdd.burstsTotal,
+         hdd.ratio60sPermille / 10.0);
+  printHistogram("burst duration", HddActivity_burstDurations());
+  printHistogram("idle gap", HddActivity_idleGaps());
+
+  BootLearnerStatus boot = g_pc.boot().status();
+  printf("\nBoot learner:\n");
+  printf("  RUNNING %u x settled, %u x timeout; last %.3f s (%+.3f s vs fixed grace)\n",
+         boot.decisions[static_cast<size_t>(BootDecision::SETTLED)],
+         boot.decisions[static_cast<size_t>(BootDecision::TIMEOUT)], boot.lastDetectMs / 1000.0,
+         boot.lastDetectVsFixedMs / 1000.0);
+  if (boot.profile.samples > 0) {
+    printf("  learned settle %.3f s, first activity %.3f s (%u boots)\n", boot.profile.settleMs / 1000.0,
+           boot.profile.firstActivityMs / 1000.0, boot.profile.samples);
+  }
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+static void usage() {
+  fprintf(stderr,
+          "usage: trace_replay [--edges] [--quiet] [--boot-grace-ms N] trace.bin\n"
+          "  --edges            print every recorded edge\n"
+          "  --quiet            hide firmware log lines\n"
+          "  --boot-grace-ms N  override the boot grace period stored in the trace\n");
+}
+
+int main(int argc, char **argv) {
+  bool printEdges = false;
+  long bootGraceMs = -1;
+  const char *path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--edges") == 0) {
+      printEdges = true;
+    } else if (strcmp(argv[i], "--quiet") == 0) {
+      Serial.enabled = false;
+    } else if (strcmp(argv[i], "--boot-grace-ms") == 0 && i + 1 < argc) {
+      bootGraceMs = strtol(argv[++i], nullptr, 10);
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (!path) {
+    usage();
+    return 2;
+  }
+
+  GpioTraceHeader header;
+  std::vector<GpioTraceRecord> records;
+  if (!loadTrace(path, header, records)) {
+    return 1;
+  }
+
+  printf("%s: %u records, %u overwritten%s%s\n", path, header.recordCount, header.overwritten,
+         (header.flags & GPIO_TRACE_FLAG_CAPTURING) ? ", capture was running" : "",
+         (header.flags & GPIO_TRACE_FLAG_NO_HDD) ? ", no HDD LED" : "");
+
+  g_config.channels[0].bootGraceMs = bootGraceMs >= 0 ? static_cast<uint32_t>(bootGraceMs) : header.bootGraceMs;
+  Serial.prefix = virtualTimePrefix;
+
+  // Known state at baseUs
+  auto baseActive = [&header](GpioTraceChannel channel) {
+    return (header.baseLevels & (1u << static_cast<uint8_t>(channel))) != 0;
+  };
+  s_startUs = static_cast<int64_t>(header.baseUs);
+  g_virtualTimeUs = s_startUs;
+  setInput(Config::PIN_PWR_LED, Config::PWR_LED_ACTIVE_HIGH, baseActive(GpioTraceChannel::POWER_LED));
+  setInput(Config::PIN_HDD_LED, Config::HDD_LED_ACTIVE_HIGH, baseActive(GpioTraceChannel::HDD_LED));
+  g_pc.begin();
+  HddActivity_setup(HddLedPin::active());
+  s_lastStateUs = s_startUs;
+  controlTick();
+
+  auto wallStart = std::chrono::steady_clock::now();
+  int64_t nextTickUs = s_startUs + tickPeriodUs();
+  for (const GpioTraceRecord &record : records) {
+    int64_t tUs = recordTimeUs(record);
+    while (nextTickUs <= tUs) {
+      g_virtualTimeUs = nextTickUs;
+      controlTick();
+      nextTickUs += tickPeriodUs();
+    }
+    g_virtualTimeUs = tUs;
+
+    GpioTraceChannel channel = static_cast<GpioTraceChannel>(record.channel);
+    bool active = record.level != 0;
+    if (printEdges || channel == GpioTraceChannel::POWER_RELAY || channel == GpioTraceChannel::RESET_RELAY) {
+      printf("%12.6f  %-10s %s\n", (tUs - s_startUs) / 1e6, GpioTrace_channelName(channel),
+             active ? "active" : "inactive");
+    }
+
+    switch (channel) {
+      case GpioTraceChannel::POWER_LED:
+        // Interrupt, then the early control tick it requests
+        setInput(Config::PIN_PWR_LED, Config::PWR_LED_ACTIVE_HIGH, active);
+        g_pc.recordPowerEdgeFromIsr(active);
+        controlTick();
+        nextTickUs = tUs + tickPeriodUs();
+        break;
+      case GpioTraceChannel::HDD_LED:
+        setInput(Config::PIN_HDD_LED, Config::HDD_LED_ACTIVE_HIGH, active);
+        HddActivity_recordEdgeFromIsr(active);
+        break;
+      default:
+        break;
+    }
+  }
+
+  int64_t endUs = static_cast<int64_t>(header.endUs);
+  while (nextTickUs <= endUs) {
+    g_virtualTimeUs = nextTickUs;
+    controlTick();
+    nextTickUs += tickPeriodUs();
+  }
+  g_virtualTimeUs = endUs;
+
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  printSummary(endUs, wallSeconds);
+  return 0;
+}